@@ -0,0 +1,218 @@
+#include "callgraph.h"
+#include "controlflow.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    /**
+     * Returns the stack offset after the instruction at @p address, given the offset @p offset before it.
+     * @throws std::runtime_error if the instruction loads SP with an unknown value
+     * @param graph control flow graph containing the instruction
+     * @param address address of the instruction
+     * @param offset number of bytes pushed before the instruction
+     * @return number of bytes pushed after the instruction
+     */
+    long stack_offset_after(const ControlFlowGraph &graph, const word address, const long offset) {
+        const Opcode opcode = graph.get_opcode(address);
+        if (opcode > 0x00FF) {
+            return offset;
+        }
+        if ((opcode & 0xCF) == 0xC5) { // PUSH
+            return offset + 2;
+        }
+        if ((opcode & 0xCF) == 0xC1) { // POP
+            return offset - 2;
+        }
+        switch (opcode) {
+            case 0x3B: return offset + 1; // DEC SP
+            case 0x33: return offset - 1; // INC SP
+            case 0xE8: return offset - extend_sign(static_cast<int8_t>(graph.get_operand(address))); // ADD SP, e8
+            case 0x31: return 0;          // LD SP, d16 sets up a new stack
+            case 0xF9:                    // LD SP, HL
+                throw std::runtime_error("SP is loaded from HL at address " + to_string_hex_prefixed(address) + ".");
+            default:   return offset;
+        }
+    }
+}
+
+CallGraph::CallGraph(const Bytestring &memory, const std::vector<word> &entryAddresses)
+: _memory(memory)
+{
+    for (const word address : entryAddresses) {
+        find_or_add_routine(address);
+    }
+    for (size_t routine = 0; routine < _routines.size(); ++routine) { // analysing a routine may add its callees
+        try {
+            analyze_routine(routine);
+        } catch (const std::exception &e) {
+            _routines[routine].error = e.what();
+        }
+    }
+    find_components();
+    propagate_stack_depths();
+}
+
+const std::vector<CallGraphRoutine>& CallGraph::get_routines() const noexcept {
+    return _routines;
+}
+
+const std::vector<std::vector<size_t>>& CallGraph::get_components() const noexcept {
+    return _components;
+}
+
+std::vector<word> CallGraph::deepest_call_path(size_t routine) const {
+    std::vector<word> path{_routines[routine].address};
+    while (_routines[routine].deepestCall.has_value()) {
+        routine = _routines[routine].callSites[*_routines[routine].deepestCall].callee;
+        path.push_back(_routines[routine].address);
+    }
+    return path;
+}
+
+size_t CallGraph::find_or_add_routine(const word address) {
+    const auto [iterator, isInserted] = _routineIndices.emplace(address, _routines.size());
+    if (isInserted) {
+        _routines.push_back(CallGraphRoutine{address});
+    }
+    return iterator->second;
+}
+
+void CallGraph::analyze_routine(const size_t routine) {
+    const ControlFlowGraph graph(_memory, _routines[routine].address);
+    const std::vector<ControlFlowGraph::BasicBlock> &blocks = graph.get_blocks();
+
+    // the maximum stack offset at the beginning of each block, which is propagated until no offset grows
+    std::vector<std::optional<long>> offsets(blocks.size());
+    std::vector<size_t> numberOfUpdates(blocks.size(), 0);
+    offsets[graph.get_entry_block()] = 0;
+    std::vector<size_t> pending{graph.get_entry_block()};
+    while (!pending.empty()) {
+        const size_t index = pending.back();
+        pending.pop_back();
+        long offset = *offsets[index];
+        for (const word address : graph.get_instruction_addresses(blocks[index])) {
+            offset = stack_offset_after(graph, address, offset);
+        }
+        for (const ControlFlowGraph::Edge &edge : blocks[index].successors) {
+            if (edge.target == ControlFlowGraph::EXIT || (offsets[edge.target].has_value() && *offsets[edge.target] >= offset)) {
+                continue;
+            }
+            if (++numberOfUpdates[edge.target] > blocks.size()) {
+                throw std::runtime_error("The stack grows in the loop at address " + to_string_hex_prefixed(blocks[edge.target].begin) + ".");
+            }
+            offsets[edge.target] = offset;
+            pending.push_back(edge.target);
+        }
+    }
+
+    long localDepth = 0;
+    std::vector<CallSite> callSites{};
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        if (!offsets[index].has_value()) {
+            continue;
+        }
+        long offset = *offsets[index];
+        for (const word address : graph.get_instruction_addresses(blocks[index])) {
+            if (address == blocks[index].lastInstruction && blocks[index].callee.has_value()) {
+                callSites.push_back(CallSite{address, find_or_add_routine(*blocks[index].callee), offset});
+            }
+            offset = stack_offset_after(graph, address, offset);
+            localDepth = std::max(localDepth, offset);
+        }
+    }
+    _routines[routine].callSites = std::move(callSites);
+    _routines[routine].localStackDepth = static_cast<size_t>(localDepth);
+}
+
+void CallGraph::find_components() {
+    constexpr size_t UNVISITED = static_cast<size_t>(-1);
+    std::vector<size_t> indices(_routines.size(), UNVISITED);
+    std::vector<size_t> lowLinks(_routines.size(), 0);
+    std::vector<bool> isOnStack(_routines.size(), false);
+    std::vector<size_t> stack{};
+    size_t nextIndex = 0;
+
+    const auto visit = [&](const size_t routine) {
+        indices[routine] = lowLinks[routine] = nextIndex++;
+        stack.push_back(routine);
+        isOnStack[routine] = true;
+    };
+
+    // depth-first search with an explicit stack of routines and the positions of their next call sites
+    for (size_t root = 0; root < _routines.size(); ++root) {
+        if (indices[root] != UNVISITED) {
+            continue;
+        }
+        visit(root);
+        std::vector<std::pair<size_t, size_t>> searchStack{{root, 0}};
+        while (!searchStack.empty()) {
+            const size_t routine = searchStack.back().first;
+            const size_t callSite = searchStack.back().second++;
+            if (callSite < _routines[routine].callSites.size()) {
+                const size_t callee = _routines[routine].callSites[callSite].callee;
+                if (indices[callee] == UNVISITED) {
+                    visit(callee);
+                    searchStack.emplace_back(callee, 0);
+                } else if (isOnStack[callee]) {
+                    lowLinks[routine] = std::min(lowLinks[routine], indices[callee]);
+                }
+                continue;
+            }
+
+            searchStack.pop_back();
+            if (!searchStack.empty()) {
+                const size_t caller = searchStack.back().first;
+                lowLinks[caller] = std::min(lowLinks[caller], lowLinks[routine]);
+            }
+            if (lowLinks[routine] != indices[routine]) {
+                continue;
+            }
+            std::vector<size_t> component{};
+            size_t member = 0;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                isOnStack[member] = false;
+                component.push_back(member);
+                _routines[member].component = _components.size();
+            } while (member != routine);
+
+            const bool callsItself = std::any_of(_routines[routine].callSites.cbegin(), _routines[routine].callSites.cend(),
+                                                 [&](const CallSite &site) { return site.callee == routine; });
+            for (const size_t recursive : component) {
+                _routines[recursive].isRecursive = (component.size() > 1 || callsItself);
+            }
+            _components.push_back(std::move(component));
+        }
+    }
+}
+
+void CallGraph::propagate_stack_depths() {
+    for (const std::vector<size_t> &component : _components) {
+        CallGraphRoutine &routine = _routines[component.front()];
+        if (routine.isRecursive || !routine.error.empty()) {
+            continue; // unbounded or unknown
+        }
+        long depth = static_cast<long>(routine.localStackDepth);
+        bool isBounded = true;
+        for (size_t callSite = 0; callSite < routine.callSites.size(); ++callSite) {
+            const std::optional<size_t> &calleeDepth = _routines[routine.callSites[callSite].callee].stackDepth;
+            if (!calleeDepth.has_value()) {
+                isBounded = false;
+                break;
+            }
+            const long callDepth = routine.callSites[callSite].stackOffset + static_cast<long>(RETURN_ADDRESS_SIZE + *calleeDepth);
+            if (callDepth > depth) {
+                depth = callDepth;
+                routine.deepestCall = callSite;
+            }
+        }
+        if (isBounded) {
+            routine.stackDepth = static_cast<size_t>(depth);
+        } else {
+            routine.deepestCall.reset();
+        }
+    }
+}
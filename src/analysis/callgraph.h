@@ -0,0 +1,110 @@
+#ifndef GAMEBOY_DISASSEMBLE_CALLGRAPH_H
+#define GAMEBOY_DISASSEMBLE_CALLGRAPH_H
+
+#include "../instructions/constants.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A call of another routine, i.e. a CALL, CALL cc or RST instruction.
+ */
+struct CallSite {
+    word address;      ///< address of the call
+    size_t callee;     ///< index of the called routine
+    long stackOffset;  ///< maximum number of bytes the routine has pushed when calling, excluding the return address
+};
+
+/**
+ * A routine of the call graph, i.e. the code reached from an address which is an entry point or is called.
+ */
+struct CallGraphRoutine {
+    word address;
+    std::vector<CallSite> callSites{};
+    size_t localStackDepth{0};  ///< maximum number of bytes the routine pushes itself, excluding called routines
+    size_t component{0};        ///< index of the strongly connected component of the routine
+    bool isRecursive{false};    ///< true if the routine may call itself, directly or via other routines
+    std::string error{};        ///< the reason why the routine cannot be analysed, e.g. an indirect jump, or empty
+    std::optional<size_t> stackDepth{}; ///< worst-case stack depth including called routines, unless it is unbounded or unknown
+    std::optional<size_t> deepestCall{}; ///< index into callSites of the call on the deepest path, if it is deeper than the routine itself
+};
+
+/**
+ * Class CallGraph. The routines reached from a set of entry points and the calls between them,
+ * with the worst-case stack depth of each routine.
+ *
+ * Each routine's control flow graph is traversed, and the bytes the routine pushes are tracked per basic block:
+ * PUSH, DEC SP and ADD SP with a negative offset grow the stack, POP, INC SP and ADD SP with a positive offset shrink it,
+ * and LD SP, d16 starts a new stack. The stack depth of a routine is the maximum of its own depth and of the depth
+ * at each of its calls plus the return address plus the callee's stack depth.
+ *
+ * Recursion is found as the strongly connected components of Tarjan's algorithm, which are completed callees first,
+ * so that the stack depths are propagated in one pass over the components. The stack depth of routines which are recursive,
+ * or call such a routine or a routine which cannot be analysed, is unbounded.
+ */
+class CallGraph {
+public:
+    static constexpr size_t RETURN_ADDRESS_SIZE = 2; ///< bytes pushed by each call and interrupt
+
+    /**
+     * Constructor. Builds the call graph of the routines reached from @p entryAddresses and determines their stack depths.
+     * @param memory the bytes, indexed by address
+     * @param entryAddresses addresses of the routines which are not called, e.g. the entry point and the interrupt handlers
+     */
+    CallGraph(const Bytestring &memory, const std::vector<word> &entryAddresses);
+
+    /**
+     * Returns all routines, starting with those of the entry addresses in their order.
+     * @return the routines
+     */
+    const std::vector<CallGraphRoutine>& get_routines() const noexcept;
+
+    /**
+     * Returns the strongly connected components, each as the indices of its routines, in the order in which
+     * Tarjan's algorithm completes them, i.e. each component follows all components it calls.
+     * @return the components
+     */
+    const std::vector<std::vector<size_t>>& get_components() const noexcept;
+
+    /**
+     * Returns the addresses of the routines on the deepest call path starting at routine @p routine.
+     * @param routine index of the first routine
+     * @return addresses of the routines, starting with the one of @p routine
+     */
+    std::vector<word> deepest_call_path(const size_t routine) const;
+
+private:
+
+    /**
+     * Traverses the routine @p routine, records its calls, adding routines which are not known yet, and its own stack depth.
+     * @throws std::runtime_error if the routine cannot be analysed
+     * @param routine index of the routine
+     */
+    void analyze_routine(const size_t routine);
+
+    /**
+     * Returns the index of the routine at @p address, adding it if it is not known yet.
+     * @param address address of the routine
+     * @return index of the routine
+     */
+    size_t find_or_add_routine(const word address);
+
+    /**
+     * Finds the strongly connected components with Tarjan's algorithm and marks the recursive routines.
+     */
+    void find_components();
+
+    /**
+     * Computes the stack depths of all routines, one component after the other.
+     */
+    void propagate_stack_depths();
+
+    const Bytestring &_memory;
+    std::vector<CallGraphRoutine> _routines{};
+    std::unordered_map<word, size_t> _routineIndices{}; ///< index of each routine by address
+    std::vector<std::vector<size_t>> _components{};
+};
+
+#endif //GAMEBOY_DISASSEMBLE_CALLGRAPH_H
@@ -0,0 +1,228 @@
+#include "controlflow.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    /**
+     * Enumerator for how an instruction passes on the control flow.
+     */
+    enum class Transfer {
+        NONE,                ///< continues with the following instruction
+        JUMP,                ///< JR, JP
+        CONDITIONAL_JUMP,    ///< JR cc, JP cc
+        CALL,                ///< CALL, RST
+        CONDITIONAL_CALL,    ///< CALL cc
+        RETURN,              ///< RET, RETI
+        CONDITIONAL_RETURN,  ///< RET cc
+        INDIRECT_JUMP        ///< JP HL
+    };
+
+    /**
+     * Returns how the instruction @p opcode passes on the control flow.
+     * @param opcode opcode, where prefixed opcodes are 0xCB00 - 0xCBFF
+     * @return the kind of transfer
+     */
+    constexpr Transfer get_transfer(const Opcode opcode) noexcept {
+        if (opcode > 0x00FF) {
+            return Transfer::NONE;
+        }
+        if ((opcode & 0xC7) == 0xC7) { // RST
+            return Transfer::CALL;
+        }
+        switch (opcode) {
+            case 0x18: case 0xC3:                       return Transfer::JUMP;
+            case 0x20: case 0x28: case 0x30: case 0x38:
+            case 0xC2: case 0xCA: case 0xD2: case 0xDA: return Transfer::CONDITIONAL_JUMP;
+            case 0xCD:                                  return Transfer::CALL;
+            case 0xC4: case 0xCC: case 0xD4: case 0xDC: return Transfer::CONDITIONAL_CALL;
+            case 0xC9: case 0xD9:                       return Transfer::RETURN;
+            case 0xC0: case 0xC8: case 0xD0: case 0xD8: return Transfer::CONDITIONAL_RETURN;
+            case 0xE9:                                  return Transfer::INDIRECT_JUMP;
+            default:                                    return Transfer::NONE;
+        }
+    }
+
+    /**
+     * Returns the address the branch @p opcode at @p address with operand @p operand leads to.
+     * @param opcode a jump, call or RST
+     * @param address address of the branch
+     * @param operand the branch's immediate operand
+     * @return the target address
+     */
+    word branch_target(const Opcode opcode, const word address, const word operand) noexcept {
+        if ((opcode & 0xC7) == 0xC7) {
+            return static_cast<word>(opcode & 0x38);
+        }
+        const bool isRelative = (opcode == 0x18 || (opcode < 0x40 && (opcode & 0xE7) == 0x20));
+        return isRelative ? relative_jump_target(address, static_cast<byte>(operand)) : operand;
+    }
+}
+
+word relative_jump_target(const word address, const byte offset) noexcept {
+    constexpr word JUMP_LENGTH = 2;
+    return static_cast<word>(address + JUMP_LENGTH + extend_sign(static_cast<int8_t>(offset)));
+}
+
+ControlFlowGraph::ControlFlowGraph(const Bytestring &memory, const word entryAddress)
+: _memory(memory), _isLeader(memory.size(), false)
+{
+    find_instructions(entryAddress);
+    build_blocks(entryAddress);
+}
+
+const std::vector<ControlFlowGraph::BasicBlock>& ControlFlowGraph::get_blocks() const noexcept {
+    return _blocks;
+}
+
+size_t ControlFlowGraph::get_entry_block() const noexcept {
+    return _entryBlock;
+}
+
+unsigned ControlFlowGraph::edge_cycles(const BasicBlock &block, const Edge &edge) noexcept {
+    return block.cycles + (edge.isBranchTaken ? block.lastCycles.taken : block.lastCycles.notTaken);
+}
+
+std::vector<word> ControlFlowGraph::get_instruction_addresses(const BasicBlock &block) const {
+    std::vector<word> addresses{};
+    addresses.reserve(block.numberOfInstructions);
+    for (word address = block.begin; addresses.size() < block.numberOfInstructions; ) {
+        addresses.push_back(address);
+        address = static_cast<word>(address + _instructions.at(address).length);
+    }
+    return addresses;
+}
+
+Opcode ControlFlowGraph::get_opcode(const word address) const {
+    return _instructions.at(address).opcode;
+}
+
+word ControlFlowGraph::get_operand(const word address) const {
+    return _instructions.at(address).operand;
+}
+
+ControlFlowGraph::Instruction ControlFlowGraph::decode(const word address) const {
+    if (address >= _memory.size()) {
+        throw std::runtime_error("Control flow leaves the memory at address " + to_string_hex_prefixed(address) + ".");
+    }
+    const byte firstByte = _memory[address];
+    const size_t length = instruction_length(firstByte);
+    if (address + length > _memory.size()) {
+        throw std::runtime_error("Instruction at address " + to_string_hex_prefixed(address) + " exceeds the memory.");
+    }
+
+    const Opcode opcode = (firstByte == 0xCB) ? static_cast<Opcode>(0xCB00 | _memory[address + 1]) : firstByte;
+    if (instruction_cycles(opcode).taken == 0) {
+        throw std::runtime_error("Unused opcode " + to_string_hex_prefixed(firstByte) + " at address " + to_string_hex_prefixed(address) + ".");
+    }
+    if (firstByte == 0xE9) {
+        throw std::runtime_error("Indirect jump at address " + to_string_hex_prefixed(address) + " cannot be followed.");
+    }
+
+    word operand = 0;
+    if (firstByte != 0xCB && length == 2) {
+        operand = _memory[address + 1];
+    } else if (length == 3) {
+        operand = little_endian_to_number(_memory[address + 1], _memory[address + 2]);
+    }
+    return Instruction{opcode, static_cast<word>(length), operand};
+}
+
+void ControlFlowGraph::find_instructions(const word entryAddress) {
+    std::vector<word> pending{};
+    const auto add_leader = [&](const word address) {
+        if (address >= _isLeader.size()) {
+            throw std::runtime_error("Control flow leaves the memory at address " + to_string_hex_prefixed(address) + ".");
+        }
+        if (!_isLeader[address]) {
+            _isLeader[address] = true;
+            pending.push_back(address);
+        }
+    };
+    add_leader(entryAddress);
+
+    while (!pending.empty()) {
+        word address = pending.back();
+        pending.pop_back();
+        // decode the straight-line code until the next branch, or until previously decoded code is reached
+        while (_instructions.count(address) == 0) {
+            const Instruction instruction = decode(address);
+            _instructions.emplace(address, instruction);
+            const word following = static_cast<word>(address + instruction.length);
+
+            const Transfer transfer = get_transfer(instruction.opcode);
+            if (transfer == Transfer::NONE) {
+                address = following;
+                continue;
+            }
+            if (transfer == Transfer::JUMP || transfer == Transfer::CONDITIONAL_JUMP) {
+                add_leader(branch_target(instruction.opcode, address, instruction.operand));
+            }
+            if (transfer != Transfer::JUMP && transfer != Transfer::RETURN) {
+                add_leader(following);
+            }
+            break;
+        }
+    }
+}
+
+void ControlFlowGraph::build_blocks(const word entryAddress) {
+    std::unordered_map<word, size_t> blockIndices{};
+    for (size_t address = 0; address < _isLeader.size(); ++address) {
+        if (_isLeader[address]) {
+            blockIndices.emplace(static_cast<word>(address), _blocks.size());
+            _blocks.push_back(BasicBlock{static_cast<word>(address)});
+        }
+    }
+    _entryBlock = blockIndices.at(entryAddress);
+
+    for (BasicBlock &block : _blocks) {
+        word address = block.begin;
+        Instruction instruction = _instructions.at(address);
+        ++block.numberOfInstructions;
+        // extend the block until its last instruction branches or the following one starts another block
+        while (get_transfer(instruction.opcode) == Transfer::NONE && !_isLeader[static_cast<word>(address + instruction.length)]) {
+            block.cycles += instruction_cycles(instruction.opcode).taken;
+            address = static_cast<word>(address + instruction.length);
+            instruction = _instructions.at(address);
+            ++block.numberOfInstructions;
+        }
+        block.lastInstruction = address;
+        block.end = static_cast<word>(address + instruction.length);
+        block.lastCycles = instruction_cycles(instruction.opcode);
+
+        const Transfer transfer = get_transfer(instruction.opcode);
+        const size_t following = (transfer == Transfer::JUMP || transfer == Transfer::RETURN) ? EXIT : blockIndices.at(block.end);
+        switch (transfer) {
+            case Transfer::NONE:
+                block.successors.push_back({following, true});
+                break;
+            case Transfer::JUMP:
+                block.successors.push_back({blockIndices.at(branch_target(instruction.opcode, address, instruction.operand)), true});
+                break;
+            case Transfer::CONDITIONAL_JUMP:
+                block.successors.push_back({blockIndices.at(branch_target(instruction.opcode, address, instruction.operand)), true});
+                block.successors.push_back({following, false});
+                break;
+            case Transfer::CALL:
+                block.callee = branch_target(instruction.opcode, address, instruction.operand);
+                block.successors.push_back({following, true});
+                break;
+            case Transfer::CONDITIONAL_CALL:
+                block.callee = branch_target(instruction.opcode, address, instruction.operand);
+                block.successors.push_back({following, true});
+                block.successors.push_back({following, false});
+                break;
+            case Transfer::RETURN:
+                block.successors.push_back({EXIT, true});
+                break;
+            case Transfer::CONDITIONAL_RETURN:
+                block.successors.push_back({EXIT, true});
+                block.successors.push_back({following, false});
+                break;
+            case Transfer::INDIRECT_JUMP: // rejected when decoding
+                break;
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef GAMEBOY_DISASSEMBLE_CONTROLFLOW_H
+#define GAMEBOY_DISASSEMBLE_CONTROLFLOW_H
+
+#include "../instructions/constants.h"
+#include "../instructions/cycles.h"
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Returns the target of the relative jump at @p address with offset @p offset.
+ * As the CPU executes them, offsets are relative to the address following the two-byte jump.
+ * @param address address of the jump
+ * @param offset the jump's operand
+ * @return the target address
+ */
+word relative_jump_target(const word address, const byte offset) noexcept;
+
+/**
+ * Class ControlFlowGraph. The basic blocks of a routine, which are found by following all branches from its entry address.
+ *
+ * Every branch ends a basic block, and so does every CALL and RST, whose callee is recorded,
+ * so that an analysis can treat calls as single instructions of the calling routine.
+ * Returns end the routine; edges leaving a block by returning lead to EXIT.
+ * The bytes are indexed by their addresses, e.g. a ROM whose banks 0 and 1 are mapped to 0x0000 - 0x7FFF.
+ */
+class ControlFlowGraph {
+public:
+    static constexpr size_t EXIT = static_cast<size_t>(-1); ///< target of edges which return from the routine
+
+    /**
+     * A transition from the end of a basic block to another block, or to EXIT.
+     */
+    struct Edge {
+        size_t target;      ///< index of the successor block, or EXIT
+        bool isBranchTaken; ///< false only if the block's last instruction is a conditional branch which is not taken
+    };
+
+    /**
+     * A sequence of instructions which is only entered at its first instruction and only left after its last one.
+     */
+    struct BasicBlock {
+        word begin{0};            ///< address of the first instruction
+        word end{0};              ///< address following the last instruction
+        word lastInstruction{0};  ///< address of the last instruction
+        size_t numberOfInstructions{0};
+        unsigned cycles{0};       ///< clock cycles of all instructions but the last
+        InstructionCycles lastCycles{}; ///< clock cycles of the last instruction
+        std::optional<word> callee{}; ///< routine called by the last instruction if it is a CALL or RST
+        std::vector<Edge> successors{};
+    };
+
+    /**
+     * Constructor. Decodes the routine starting at @p entryAddress and splits it into basic blocks.
+     * @throws std::runtime_error if the routine contains an indirect jump, an unused opcode or leaves @p memory
+     * @param memory the bytes, indexed by address
+     * @param entryAddress address of the routine's first instruction
+     */
+    ControlFlowGraph(const Bytestring &memory, const word entryAddress);
+
+    /**
+     * Returns all basic blocks in ascending order of their addresses.
+     * @return the basic blocks
+     */
+    const std::vector<BasicBlock>& get_blocks() const noexcept;
+
+    /**
+     * Returns the index of the block starting at the entry address.
+     * @return block index
+     */
+    size_t get_entry_block() const noexcept;
+
+    /**
+     * Returns the clock cycles spent in @p block when it is left via @p edge, excluding a called routine.
+     * @param block the block
+     * @param edge one of the block's successors
+     * @return clock cycles
+     */
+    static unsigned edge_cycles(const BasicBlock &block, const Edge &edge) noexcept;
+
+    /**
+     * Returns the addresses of the instructions of @p block.
+     * @param block one of the blocks
+     * @return the addresses in ascending order
+     */
+    std::vector<word> get_instruction_addresses(const BasicBlock &block) const;
+
+    /**
+     * Returns the opcode of the instruction at @p address.
+     * @throws std::out_of_range if no instruction of the routine starts at @p address
+     * @param address address of the instruction
+     * @return opcode, where prefixed opcodes are 0xCB00 - 0xCBFF
+     */
+    Opcode get_opcode(const word address) const;
+
+    /**
+     * Returns the immediate operand of the instruction at @p address.
+     * @throws std::out_of_range if no instruction of the routine starts at @p address
+     * @param address address of the instruction
+     * @return the operand, zero if there is none
+     */
+    word get_operand(const word address) const;
+
+private:
+
+    /**
+     * An instruction of the routine, decoded as far as needed for following the control flow.
+     */
+    struct Instruction {
+        Opcode opcode;
+        word length;
+        word operand; ///< immediate operand, zero if there is none
+    };
+
+    /**
+     * Decodes the instruction at @p address.
+     * @throws std::runtime_error if the instruction is no valid instruction within the memory
+     * @param address address of the instruction
+     * @return the instruction
+     */
+    Instruction decode(const word address) const;
+
+    /**
+     * Follows all branches from the entry address, decoding every reachable instruction and marking the first instructions of blocks.
+     * @param entryAddress address of the routine's first instruction
+     */
+    void find_instructions(const word entryAddress);
+
+    /**
+     * Groups the decoded instructions into basic blocks and connects them.
+     * @param entryAddress address of the routine's first instruction
+     */
+    void build_blocks(const word entryAddress);
+
+    const Bytestring &_memory;
+    std::unordered_map<word, Instruction> _instructions{}; ///< all reachable instructions by address
+    std::vector<bool> _isLeader{}; ///< true for the addresses of the first instructions of blocks
+    std::vector<BasicBlock> _blocks{};
+    size_t _entryBlock{0};
+};
+
+#endif //GAMEBOY_DISASSEMBLE_CONTROLFLOW_H
@@ -0,0 +1,125 @@
+#include "liveness.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    /**
+     * Checks whether the unprefixed instruction @p opcode calls a routine.
+     * @param opcode unprefixed opcode
+     * @return true for CALL, CALL cc and RST
+     */
+    constexpr bool is_call(const byte opcode) noexcept {
+        return opcode == 0xCD || (opcode & 0xE7) == 0xC4 || (opcode & 0xC7) == 0xC7;
+    }
+}
+
+LivenessAnalysis::LivenessAnalysis(const ControlFlowGraph &graph)
+: _graph(graph)
+{
+    const std::vector<ControlFlowGraph::BasicBlock> &blocks = graph.get_blocks();
+    _uses.assign(blocks.size(), 0);
+    _definitions.assign(blocks.size(), 0);
+    _liveIn.assign(blocks.size(), 0);
+    _liveOut.assign(blocks.size(), 0);
+
+    std::vector<std::vector<size_t>> predecessors(blocks.size());
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        for (const word address : _graph.get_instruction_addresses(blocks[index])) {
+            const InstructionEffects effects = effects_at(address);
+            _uses[index] |= static_cast<ResourceSet>(effects.reads & ~_definitions[index]);
+            _definitions[index] |= static_cast<ResourceSet>(effects.writes & ~resources::MEMORY);
+        }
+        for (const ControlFlowGraph::Edge &edge : blocks[index].successors) {
+            if (edge.target != ControlFlowGraph::EXIT) {
+                predecessors[edge.target].push_back(index);
+            }
+        }
+    }
+
+    // blocks are visited from the highest address down, which for straight-line code follows the flow backwards
+    std::vector<size_t> worklist(blocks.size());
+    std::vector<bool> isPending(blocks.size(), true);
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        worklist[index] = index;
+    }
+    while (!worklist.empty()) {
+        const size_t index = worklist.back();
+        worklist.pop_back();
+        isPending[index] = false;
+
+        ResourceSet liveOut = 0;
+        for (const ControlFlowGraph::Edge &edge : blocks[index].successors) {
+            liveOut |= (edge.target == ControlFlowGraph::EXIT) ? resources::ALL : _liveIn[edge.target];
+        }
+        _liveOut[index] = liveOut;
+        const ResourceSet liveIn = static_cast<ResourceSet>(_uses[index] | (liveOut & ~_definitions[index]));
+        if (liveIn == _liveIn[index]) {
+            continue;
+        }
+        _liveIn[index] = liveIn;
+        for (const size_t predecessor : predecessors[index]) {
+            if (!isPending[predecessor]) {
+                isPending[predecessor] = true;
+                worklist.push_back(predecessor);
+            }
+        }
+    }
+}
+
+ResourceSet LivenessAnalysis::get_live_in(const size_t block) const noexcept {
+    return _liveIn[block];
+}
+
+ResourceSet LivenessAnalysis::get_live_out(const size_t block) const noexcept {
+    return _liveOut[block];
+}
+
+ResourceSet LivenessAnalysis::live_after(const word address) const {
+    const std::vector<ControlFlowGraph::BasicBlock> &blocks = _graph.get_blocks();
+    const auto following = std::upper_bound(blocks.cbegin(), blocks.cend(), address, [](const word lhs, const ControlFlowGraph::BasicBlock &rhs) {
+        return lhs < rhs.begin;
+    });
+    if (following != blocks.cbegin()) {
+        const auto block = following - 1;
+        const std::vector<word> addresses = _graph.get_instruction_addresses(*block);
+        ResourceSet live = _liveOut[static_cast<size_t>(block - blocks.cbegin())];
+        for (auto instruction = addresses.crbegin(); instruction != addresses.crend(); ++instruction) {
+            if (*instruction == address) {
+                return live;
+            }
+            const InstructionEffects effects = effects_at(*instruction);
+            live = static_cast<ResourceSet>(effects.reads | (live & ~(effects.writes & ~resources::MEMORY)));
+        }
+    }
+    throw std::out_of_range("Error: No instruction of the routine starts at address " + to_string_hex_prefixed(address) + ".");
+}
+
+std::vector<word> LivenessAnalysis::find_dead_stores() const {
+    std::vector<word> deadStores{};
+    const std::vector<ControlFlowGraph::BasicBlock> &blocks = _graph.get_blocks();
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        const std::vector<word> addresses = _graph.get_instruction_addresses(blocks[index]);
+        ResourceSet live = _liveOut[index];
+        for (auto instruction = addresses.crbegin(); instruction != addresses.crend(); ++instruction) {
+            const InstructionEffects effects = effects_at(*instruction);
+            if (effects.writes != 0 && (effects.writes & (live | resources::MEMORY)) == 0) {
+                deadStores.push_back(*instruction);
+                continue; // its reads are not needed either
+            }
+            live = static_cast<ResourceSet>(effects.reads | (live & ~(effects.writes & ~resources::MEMORY)));
+        }
+    }
+    std::sort(deadStores.begin(), deadStores.end());
+    return deadStores;
+}
+
+InstructionEffects LivenessAnalysis::effects_at(const word address) const {
+    const Opcode opcode = _graph.get_opcode(address);
+    InstructionEffects effects = instruction_effects(opcode);
+    if (opcode <= 0x00FF && is_call(static_cast<byte>(opcode))) {
+        effects.reads |= resources::REGISTERS;
+    }
+    return effects;
+}
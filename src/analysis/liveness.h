@@ -0,0 +1,70 @@
+#ifndef GAMEBOY_DISASSEMBLE_LIVENESS_H
+#define GAMEBOY_DISASSEMBLE_LIVENESS_H
+
+#include "controlflow.h"
+#include "../instructions/effects.h"
+
+#include <vector>
+
+/**
+ * Class LivenessAnalysis. Finds the registers and flags of a routine whose values may still be read, i.e. are live.
+ *
+ * The effects of a basic block are summarised as the resources it reads before writing them and the resources it writes.
+ * The sets of live resources at the blocks' beginnings and ends are then propagated backwards with a worklist until they
+ * no longer change. Since the sets are bitsets of a fixed number of resources, each block changes only a few times,
+ * so the analysis takes linear time. Since called routines are not analysed, calls are assumed to read every register,
+ * and returns to leave every register live. Memory is always live, as writing one address does not overwrite the others.
+ */
+class LivenessAnalysis {
+public:
+    /**
+     * Constructor. Analyses the routine of @p graph.
+     * @param graph the routine's control flow graph
+     */
+    explicit LivenessAnalysis(const ControlFlowGraph &graph);
+
+    /**
+     * Returns the resources live at the beginning of block @p block.
+     * @param block index of the block
+     * @return live resources
+     */
+    ResourceSet get_live_in(const size_t block) const noexcept;
+
+    /**
+     * Returns the resources live at the end of block @p block.
+     * @param block index of the block
+     * @return live resources
+     */
+    ResourceSet get_live_out(const size_t block) const noexcept;
+
+    /**
+     * Returns the resources live after the instruction at @p address.
+     * @throws std::out_of_range if no instruction of the routine starts at @p address
+     * @param address address of the instruction
+     * @return live resources
+     */
+    ResourceSet live_after(const word address) const;
+
+    /**
+     * Finds the instructions whose results are never read, i.e. which only write registers and flags that are not live afterwards.
+     * @return the addresses of the instructions in ascending order
+     */
+    std::vector<word> find_dead_stores() const;
+
+private:
+
+    /**
+     * Returns the effects of the instruction at @p address, where calls read every register.
+     * @param address address of the instruction
+     * @return the instruction's effects within the routine
+     */
+    InstructionEffects effects_at(const word address) const;
+
+    const ControlFlowGraph &_graph;
+    std::vector<ResourceSet> _uses{};        ///< resources each block reads before writing them
+    std::vector<ResourceSet> _definitions{}; ///< resources each block writes
+    std::vector<ResourceSet> _liveIn{};
+    std::vector<ResourceSet> _liveOut{};
+};
+
+#endif //GAMEBOY_DISASSEMBLE_LIVENESS_H
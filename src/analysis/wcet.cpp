@@ -0,0 +1,341 @@
+#include "wcet.h"
+#include "controlflow.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+    using Block = ControlFlowGraph::BasicBlock;
+    using Edge = ControlFlowGraph::Edge;
+
+    constexpr size_t UNREACHABLE = static_cast<size_t>(-1);
+    constexpr size_t CONTINUE = ControlFlowGraph::EXIT - 1; ///< end of paths which take a back edge to their loop's first block
+
+    /**
+     * A natural loop, i.e. the blocks from which a back edge to the loop's header can be reached without passing the header.
+     */
+    struct Loop {
+        size_t header;
+        size_t bound;
+        std::vector<bool> body;  ///< true for the indices of the blocks in the loop
+        size_t size{0};          ///< number of blocks in the loop
+        size_t parent{0};        ///< index of the innermost enclosing loop, or the number of loops for the routine itself
+        size_t iterationCycles{0};
+        std::map<size_t, size_t> exits{}; ///< cycles from entering the loop to leaving it for each block outside, or EXIT
+    };
+
+    /**
+     * The longest path from a block to the end of its region, and its first step.
+     */
+    struct LongestPath {
+        size_t cycles{UNREACHABLE};
+        size_t move{0}; ///< the edge taken, or for a nested loop the block it is left for
+    };
+
+    /**
+     * Class RoutineAnalysis. The WCET of one routine, given the WCETs of the routines it calls.
+     *
+     * The routine and each of its loops are regions. In a region, the nested loops are replaced by their summaries,
+     * and back edges to the region's header end paths, so that the longest paths are found in an acyclic graph.
+     */
+    class RoutineAnalysis {
+    public:
+        RoutineAnalysis(const ControlFlowGraph &graph, const LoopBounds &loopBounds, const std::function<const WcetResult&(word)> &calleeWcet)
+        : _graph(graph), _blocks(graph.get_blocks()), _loopBounds(loopBounds), _calleeWcet(calleeWcet) {
+            find_loops();
+        }
+
+        WcetResult analyze() {
+            const size_t routine = _loops.size();
+            for (size_t loop = 0; loop < _loops.size(); ++loop) {
+                summarize(loop);
+            }
+            const size_t cycles = longest_path(_graph.get_entry_block(), routine, ControlFlowGraph::EXIT).cycles;
+            if (cycles == UNREACHABLE) {
+                throw std::runtime_error("Routine at address " + to_string_hex_prefixed(_blocks[_graph.get_entry_block()].begin) + " never returns.");
+            }
+            WcetResult result{cycles, {}};
+            append_path(_graph.get_entry_block(), routine, ControlFlowGraph::EXIT, 1, result.criticalPath);
+            return result;
+        }
+
+    private:
+
+        /**
+         * Finds the back edges by a depth-first search and collects their natural loops, sorted innermost first.
+         */
+        void find_loops() {
+            std::vector<std::vector<size_t>> predecessors(_blocks.size());
+            for (size_t index = 0; index < _blocks.size(); ++index) {
+                for (const Edge &edge : _blocks[index].successors) {
+                    if (edge.target != ControlFlowGraph::EXIT) {
+                        predecessors[edge.target].push_back(index);
+                    }
+                }
+            }
+
+            // headers and the sources of their back edges, i.e. edges to blocks on the search stack
+            std::map<size_t, std::vector<size_t>> backEdges{};
+            enum class State : uint8_t {NEW, ON_STACK, DONE};
+            std::vector<State> states(_blocks.size(), State::NEW);
+            std::vector<std::pair<size_t, size_t>> stack{{_graph.get_entry_block(), 0}};
+            states[_graph.get_entry_block()] = State::ON_STACK;
+            while (!stack.empty()) {
+                auto &[index, successor] = stack.back();
+                if (successor == _blocks[index].successors.size()) {
+                    states[index] = State::DONE;
+                    stack.pop_back();
+                    continue;
+                }
+                const size_t target = _blocks[index].successors[successor++].target;
+                if (target == ControlFlowGraph::EXIT) {
+                    continue;
+                }
+                if (states[target] == State::ON_STACK) {
+                    backEdges[target].push_back(index);
+                } else if (states[target] == State::NEW) {
+                    states[target] = State::ON_STACK;
+                    stack.emplace_back(target, 0);
+                }
+            }
+
+            for (const auto &[header, sources] : backEdges) {
+                const word address = _blocks[header].begin;
+                const auto bound = _loopBounds.find(address);
+                if (bound == _loopBounds.end() || bound->second == 0) {
+                    throw std::runtime_error("Loop at address " + to_string_hex_prefixed(address) + " has no bound.");
+                }
+                Loop loop{header, bound->second, std::vector<bool>(_blocks.size(), false)};
+                loop.body[header] = true;
+                std::vector<size_t> pending{};
+                for (const size_t source : sources) {
+                    if (!loop.body[source]) {
+                        loop.body[source] = true;
+                        pending.push_back(source);
+                    }
+                }
+                while (!pending.empty()) {
+                    const size_t index = pending.back();
+                    pending.pop_back();
+                    for (const size_t predecessor : predecessors[index]) {
+                        if (!loop.body[predecessor]) {
+                            loop.body[predecessor] = true;
+                            pending.push_back(predecessor);
+                        }
+                    }
+                }
+                for (size_t index = 0; index < _blocks.size(); ++index) {
+                    if (!loop.body[index]) {
+                        continue;
+                    }
+                    ++loop.size;
+                    if (index != header && std::any_of(predecessors[index].cbegin(), predecessors[index].cend(), [&](const size_t p) { return !loop.body[p]; })) {
+                        throw std::runtime_error("Loop at address " + to_string_hex_prefixed(address) + " is also entered at address "
+                                                 + to_string_hex_prefixed(_blocks[index].begin) + ".");
+                    }
+                }
+                _loops.push_back(std::move(loop));
+            }
+
+            std::stable_sort(_loops.begin(), _loops.end(), [](const Loop &lhs, const Loop &rhs) { return lhs.size < rhs.size; });
+            _innermostLoops.assign(_blocks.size(), _loops.size());
+            for (size_t loop = _loops.size(); loop-- > 0;) {
+                for (size_t index = 0; index < _blocks.size(); ++index) {
+                    if (_loops[loop].body[index]) {
+                        _innermostLoops[index] = loop;
+                    }
+                }
+            }
+            for (Loop &loop : _loops) {
+                const size_t self = static_cast<size_t>(&loop - _loops.data());
+                loop.parent = _loops.size();
+                for (size_t outer = self + 1; outer < _loops.size(); ++outer) {
+                    if (_loops[outer].body[loop.header]) {
+                        loop.parent = outer;
+                        break;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Computes the cycles of the longest iteration of @p loop and of leaving it for each of its exits.
+         * @param loop index of the loop, whose nested loops are summarised already
+         */
+        void summarize(const size_t loop) {
+            Loop &current = _loops[loop];
+            const size_t iteration = longest_path(current.header, loop, CONTINUE).cycles;
+            current.iterationCycles = (iteration == UNREACHABLE) ? 0 : iteration;
+            for (size_t index = 0; index < _blocks.size(); ++index) {
+                if (!current.body[index]) {
+                    continue;
+                }
+                for (const Edge &edge : _blocks[index].successors) {
+                    if ((edge.target != ControlFlowGraph::EXIT && current.body[edge.target]) || current.exits.count(edge.target) != 0) {
+                        continue;
+                    }
+                    const size_t cycles = longest_path(current.header, loop, edge.target).cycles;
+                    if (cycles != UNREACHABLE) {
+                        current.exits.emplace(edge.target, (current.bound - 1) * current.iterationCycles + cycles);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Returns the nested loop of @p region which is entered at block @p index.
+         * @param index index of a block of the region
+         * @param region index of the loop, or the number of loops for the routine itself
+         * @return index of the nested loop, or @p region if the block is no header of a nested loop
+         */
+        size_t nested_loop(const size_t index, const size_t region) const noexcept {
+            size_t loop = _innermostLoops[index];
+            while (loop != region && _loops[loop].parent != region) {
+                loop = _loops[loop].parent;
+            }
+            return loop;
+        }
+
+        /**
+         * Checks whether a path of @p region ends when it reaches @p target, and if so, returns how it ends.
+         * @param target index of a block, or EXIT
+         * @param region index of the loop, or the number of loops for the routine itself
+         * @return CONTINUE for the back edge to the loop's header, @p target if it is outside the region, and nothing otherwise
+         */
+        std::optional<size_t> end_of_path(const size_t target, const size_t region) const noexcept {
+            if (target == ControlFlowGraph::EXIT) {
+                return target;
+            }
+            if (region == _loops.size()) {
+                return std::nullopt;
+            }
+            if (target == _loops[region].header) {
+                return CONTINUE;
+            }
+            return _loops[region].body[target] ? std::nullopt : std::optional<size_t>{target};
+        }
+
+        /**
+         * Returns the cycles of leaving block @p index via @p edge, including the routine it calls.
+         * @param index index of the block
+         * @param edge one of the block's successors
+         * @return clock cycles
+         */
+        size_t edge_cycles(const size_t index, const Edge &edge) const {
+            const Block &block = _blocks[index];
+            const size_t cycles = ControlFlowGraph::edge_cycles(block, edge);
+            return (edge.isBranchTaken && block.callee.has_value()) ? cycles + _calleeWcet(*block.callee).cycles : cycles;
+        }
+
+        /**
+         * Returns the longest path in @p region from block @p index to @p end.
+         * @param index index of the first block
+         * @param region index of the loop, or the number of loops for the routine itself
+         * @param end the end of the path, see end_of_path()
+         * @return the path's cycles, which are UNREACHABLE if there is no such path, and its first step
+         */
+        LongestPath longest_path(const size_t index, const size_t region, const size_t end) {
+            const auto key = std::make_tuple(region, end, index);
+            const auto memoized = _longestPaths.find(key);
+            if (memoized != _longestPaths.end()) {
+                return memoized->second;
+            }
+
+            LongestPath longest{};
+            const auto consider = [&](const size_t cycles, const size_t target, const size_t move) {
+                const std::optional<size_t> pathEnd = end_of_path(target, region);
+                const size_t remaining = pathEnd.has_value() ? ((*pathEnd == end) ? 0 : UNREACHABLE) : longest_path(target, region, end).cycles;
+                if (remaining != UNREACHABLE && (longest.cycles == UNREACHABLE || cycles + remaining > longest.cycles)) {
+                    longest = LongestPath{cycles + remaining, move};
+                }
+            };
+            const size_t loop = nested_loop(index, region);
+            if (loop != region) {
+                for (const auto &[target, cycles] : _loops[loop].exits) {
+                    consider(cycles, target, target);
+                }
+            } else {
+                const std::vector<Edge> &successors = _blocks[index].successors;
+                for (size_t edge = 0; edge < successors.size(); ++edge) {
+                    consider(edge_cycles(index, successors[edge]), successors[edge].target, edge);
+                }
+            }
+            _longestPaths.emplace(key, longest);
+            return longest;
+        }
+
+        /**
+         * Appends the blocks of the longest path in @p region from block @p index to @p end to @p path.
+         * @param index index of the first block
+         * @param region index of the loop, or the number of loops for the routine itself
+         * @param end the end of the path
+         * @param executions how often the path is executed
+         * @param path the critical path
+         */
+        void append_path(size_t index, const size_t region, const size_t end, const size_t executions, std::vector<CriticalPathStep> &path) {
+            while (true) {
+                const LongestPath longest = longest_path(index, region, end);
+                const size_t loop = nested_loop(index, region);
+                size_t target = longest.move;
+                if (loop != region) {
+                    const Loop &nested = _loops[loop];
+                    if (nested.bound > 1 && nested.iterationCycles > 0) {
+                        append_path(nested.header, loop, CONTINUE, executions * (nested.bound - 1), path);
+                    }
+                    append_path(nested.header, loop, target, executions, path);
+                } else {
+                    const Block &block = _blocks[index];
+                    const Edge &edge = block.successors[longest.move];
+                    target = edge.target;
+                    const bool isCall = edge.isBranchTaken && block.callee.has_value();
+                    path.push_back(CriticalPathStep{block.begin, executions, edge_cycles(index, edge),
+                                                    isCall ? block.callee : std::nullopt});
+                }
+                if (end_of_path(target, region).has_value()) {
+                    return;
+                }
+                index = target;
+            }
+        }
+
+        const ControlFlowGraph &_graph;
+        const std::vector<Block> &_blocks;
+        const LoopBounds &_loopBounds;
+        const std::function<const WcetResult&(word)> &_calleeWcet;
+        std::vector<Loop> _loops{};            ///< all loops, innermost first
+        std::vector<size_t> _innermostLoops{}; ///< the innermost loop of each block, or the number of loops
+        std::map<std::tuple<size_t, size_t, size_t>, LongestPath> _longestPaths{}; ///< by region, end and first block
+    };
+}
+
+WcetAnalyzer::WcetAnalyzer(const Bytestring &memory, const LoopBounds &loopBounds)
+: _memory(memory), _loopBounds(loopBounds)
+{}
+
+const WcetResult& WcetAnalyzer::analyze(const word entryAddress) {
+    const auto result = _results.find(entryAddress);
+    if (result != _results.end()) {
+        return result->second;
+    }
+    if (!_routinesInProgress.insert(entryAddress).second) {
+        throw std::runtime_error("Routine at address " + to_string_hex_prefixed(entryAddress) + " is called recursively.");
+    }
+
+    const ControlFlowGraph graph(_memory, entryAddress);
+    const std::function<const WcetResult&(word)> calleeWcet = [this](const word callee) -> const WcetResult& {
+        return analyze(callee);
+    };
+    WcetResult wcet{};
+    try {
+        wcet = RoutineAnalysis(graph, _loopBounds, calleeWcet).analyze();
+    } catch (...) { // a failed routine is no longer in progress, so that it can be analysed again, e.g. with other bounds
+        _routinesInProgress.erase(entryAddress);
+        throw;
+    }
+    _routinesInProgress.erase(entryAddress);
+    return _results.emplace(entryAddress, std::move(wcet)).first->second;
+}
@@ -0,0 +1,65 @@
+#ifndef GAMEBOY_DISASSEMBLE_WCET_H
+#define GAMEBOY_DISASSEMBLE_WCET_H
+
+#include "../instructions/constants.h"
+#include "../instructions/loopbounds.h"
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * A basic block on the critical path of a routine.
+ */
+struct CriticalPathStep {
+    word address;      ///< address of the block's first instruction
+    size_t executions; ///< how often the block is executed along the critical path, e.g. the bound of its loop
+    size_t cycles;     ///< clock cycles of one execution, including the routine called at its end
+    std::optional<word> callee{}; ///< routine called at the end of the block, if any
+};
+
+/**
+ * The worst-case execution time of a routine and the path through it which takes that long.
+ */
+struct WcetResult {
+    size_t cycles{0};
+    std::vector<CriticalPathStep> criticalPath{};
+};
+
+/**
+ * Class WcetAnalyzer. Estimates the worst-case execution time (WCET) of routines from their control flow graphs and the cycle table.
+ *
+ * The WCET is the longest path from the entry to a return, where each block costs the cycles of its instructions,
+ * taking conditional branches costing their taken or not-taken cycles, and calls cost the callee's WCET.
+ * Loops are found as the back edges of a depth-first search. A loop costs its longest exit path plus its bound minus one
+ * times its longest iteration, so every loop needs a bound. Loops which are entered elsewhere than at their first block,
+ * recursion and indirect jumps cannot be bounded and are rejected.
+ * Nested loops are summarised innermost first, and the WCETs of called routines are computed once, so the analysis is linear
+ * in the size of the code for all but deeply nested loops with many exits.
+ */
+class WcetAnalyzer {
+public:
+    /**
+     * Constructor.
+     * @param memory the bytes, indexed by address
+     * @param loopBounds the bounds of all loops which are analysed
+     */
+    WcetAnalyzer(const Bytestring &memory, const LoopBounds &loopBounds);
+
+    /**
+     * Returns the WCET of the routine starting at @p entryAddress, including all routines it calls.
+     * @throws std::runtime_error if the routine cannot be analysed, e.g. if a loop has no bound
+     * @param entryAddress address of the routine's first instruction
+     * @return the WCET and critical path
+     */
+    const WcetResult& analyze(const word entryAddress);
+
+private:
+    const Bytestring &_memory;
+    const LoopBounds &_loopBounds;
+    std::unordered_map<word, WcetResult> _results{}; ///< WCETs of the routines analysed so far
+    std::unordered_set<word> _routinesInProgress{};  ///< routines whose analysis is pending, for detecting recursion
+};
+
+#endif //GAMEBOY_DISASSEMBLE_WCET_H
@@ -1,4 +1,19 @@
 #include "assemble.h"
+#include "tokenizer.h"
+#include "../analysis/callgraph.h"
+#include "../analysis/wcet.h"
+#include "../disassembler/cartridge.h"
+#include "../disassembler/disassemble.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <thread>
 
 void assemble_instruction(const BaseInstruction instruction) {
     for (const byte bte : instruction.bytestr())
@@ -7,3 +22,445 @@ void assemble_instruction(const BaseInstruction instruction) {
     }
 
 }
+
+RomImage assemble_rom(const std::string &code, const byte fillByte, const std::string &sourcePath,
+                      std::vector<PeepholeStatistics> *peepholeStatistics) {
+    Diagnostics diagnostics{};
+    Tokenizer tokenizer(code);
+    TokenVector tokenVector = tokenizer.tokenize_parallel(diagnostics);
+    Parser parser(code, tokenVector, sourcePath);
+    parser.set_peephole_optimization(peepholeStatistics != nullptr);
+
+    const Bytestring machineCode = parser.assemble(diagnostics);
+    diagnostics.throw_if_errors();
+    if (peepholeStatistics != nullptr) {
+        *peepholeStatistics = parser.get_peephole_statistics();
+    }
+    // like the linker places sections, each block of code is written at the address given by its ORG
+    RomImage romImage(RomImage::MINIMUM_BANKS, fillByte);
+    const std::vector<Parser::OutputBlock> &blocks = parser.get_output_blocks();
+    const std::vector<std::pair<size_t, size_t>> &codeRanges = parser.get_code_ranges();
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        const size_t begin = blocks[index].offset;
+        const size_t end = (index + 1 < blocks.size()) ? blocks[index + 1].offset : machineCode.size();
+        if (end > begin) {
+            romImage.write(blocks[index].address, Bytestring(machineCode.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                             machineCode.begin() + static_cast<std::ptrdiff_t>(end)));
+        }
+        // ranges of consecutive instructions may continue into the following block
+        for (const auto &[offset, size] : codeRanges) {
+            const size_t codeBegin = std::max(offset, begin);
+            const size_t codeEnd = std::min(offset + size, end);
+            if (codeBegin < codeEnd) {
+                romImage.mark_code(blocks[index].address + (codeBegin - begin), codeEnd - codeBegin);
+            }
+        }
+    }
+    return romImage;
+}
+
+namespace {
+    /**
+     * Reads the whole source file at @p sourcePath.
+     * @throws std::runtime_error if the file cannot be read
+     * @param sourcePath path of the assembly source file
+     * @return content of the file
+     */
+    std::string read_source_file(const std::string &sourcePath) {
+        std::ifstream sourceFile(sourcePath);
+        if (!sourceFile) {
+            throw std::runtime_error("Cannot open source file '" + sourcePath + "'.");
+        }
+        std::stringstream sourceStream;
+        sourceStream << sourceFile.rdbuf();
+        return sourceStream.str();
+    }
+
+    /**
+     * Prints the size of @p romImage written to @p outputPath and the throughput in bytes/s.
+     * @param romImage the written ROM image
+     * @param outputPath path of the ROM file
+     * @param elapsed time taken for assembling and writing the image
+     */
+    void print_throughput(const RomImage &romImage, const std::string &outputPath, const std::chrono::duration<double> &elapsed) {
+        const double seconds = std::max(elapsed.count(), 1e-9);
+        std::cout << "Wrote " << romImage.size() << " bytes (" << romImage.number_of_banks() << " banks) to "
+                  << outputPath << " in " << elapsed.count() * 1000.0 << " ms, "
+                  << static_cast<size_t>(romImage.size() / seconds) << " bytes/s" << std::endl;
+    }
+
+    /**
+     * Writes the checksums into the header region of @p romImage. If instructions are emitted at the checksum bytes,
+     * the checksums are left out and the overlapping bytes are reported.
+     * @param romImage the image to complete
+     * @param ostr stream receiving the diagnostic
+     */
+    void write_checksums(RomImage &romImage, std::ostream &ostr) {
+        if (!romImage.update_checksums()) {
+            const std::pair<size_t, size_t> code = *romImage.find_code(cartridge::HEADER_CHECKSUM, cartridge::HEADER_END);
+            ostr << "Warning: Instructions are emitted at " << to_string_hex_prefixed(static_cast<word>(code.first)) << " - "
+                 << to_string_hex_prefixed(static_cast<word>(code.second - 1)) << ", where the checksums at "
+                 << to_string_hex_prefixed(cartridge::HEADER_CHECKSUM) << " - " << to_string_hex_prefixed(static_cast<word>(cartridge::HEADER_END - 1))
+                 << " belong, so no checksums are written and the image does not pass the boot ROM's header check." << std::endl;
+        }
+    }
+
+    /**
+     * Prints how often each peephole rule has been applied and the bytes and clock cycles it saved.
+     * @param statistics the savings, indexed like PeepholeOptimizer::get_rules()
+     */
+    void print_peephole_statistics(const std::vector<PeepholeStatistics> &statistics) {
+        PeepholeStatistics total{};
+        for (size_t rule = 0; rule < statistics.size(); ++rule) {
+            if (statistics[rule].applications > 0) {
+                std::cout << PeepholeOptimizer::get_rules()[rule].name << ": " << statistics[rule].applications << " times, "
+                          << statistics[rule].bytesSaved << " bytes and " << statistics[rule].cyclesSaved << " cycles saved" << std::endl;
+            }
+            total.bytesSaved += statistics[rule].bytesSaved;
+            total.cyclesSaved += statistics[rule].cyclesSaved;
+        }
+        std::cout << "Peephole optimization saved " << total.bytesSaved << " bytes and " << total.cyclesSaved << " cycles" << std::endl;
+    }
+
+    /**
+     * Places @p instructions at their addresses in a 64 KiB memory image, which ORG may move away from their offsets in the bytecode.
+     * @param instructions the assembled instructions
+     * @return the memory image, whose unused bytes are 0xFF like those of a ROM image
+     */
+    Bytestring build_memory_image(const std::vector<DecodedInstruction> &instructions) {
+        Bytestring memory(0x10000, 0xFF);
+        for (const DecodedInstruction &decodedInstruction : instructions) {
+            const Bytestring bytes = decodedInstruction.instruction->bytestr();
+            for (size_t index = 0; index < bytes.size() && decodedInstruction.address + index < memory.size(); ++index) {
+                memory[decodedInstruction.address + index] = bytes[index];
+            }
+        }
+        return memory;
+    }
+
+    /**
+     * Tokenizes the source file at @p sourcePath for a Parser.
+     * @throws std::runtime_error if the file cannot be read
+     * @throws std::logic_error in case of a lexical error
+     * @param sourcePath path of the assembly source file
+     * @param code the file's content, which is read
+     * @return the tokens
+     */
+    TokenVector tokenize_source_file(const std::string &sourcePath, std::string &code) {
+        code = read_source_file(sourcePath);
+        Diagnostics diagnostics{};
+        TokenVector tokenVector = Tokenizer(code).tokenize(diagnostics);
+        diagnostics.throw_if_errors();
+        return tokenVector;
+    }
+}
+
+void assemble_file(const std::string &sourcePath, const std::string &outputPath, const bool reportThroughput, const bool optimize) {
+    const std::string code = read_source_file(sourcePath);
+
+    std::vector<PeepholeStatistics> peepholeStatistics{};
+    const auto start = std::chrono::steady_clock::now();
+    RomImage romImage = assemble_rom(code, 0xFF, sourcePath, optimize ? &peepholeStatistics : nullptr);
+    write_checksums(romImage, std::cerr);
+    romImage.save(outputPath);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (reportThroughput) {
+        print_throughput(romImage, outputPath, elapsed);
+    }
+    if (optimize) {
+        print_peephole_statistics(peepholeStatistics);
+    }
+}
+
+void print_file_listing(const std::string &sourcePath, std::ostream &ostr) {
+    std::string code{};
+    const TokenVector tokenVector = tokenize_source_file(sourcePath, code);
+    Parser parser(code, tokenVector, sourcePath);
+    print_listing(parser.parse_decoded(), ostr);
+}
+
+bool print_file_wcet(const std::string &sourcePath, const std::string &label, const size_t budget, std::ostream &ostr) {
+    std::string code{};
+    const TokenVector tokenVector = tokenize_source_file(sourcePath, code);
+    Parser parser(code, tokenVector, sourcePath);
+    const Bytestring memory = build_memory_image(parser.parse_decoded());
+
+    const std::optional<long> entryAddress = parser.get_symbol_value(label);
+    if (!entryAddress.has_value() || !is_unsigned_16_bit(*entryAddress)) {
+        throw std::runtime_error("Label '" + label + "' is not defined.");
+    }
+    WcetAnalyzer analyzer(memory, parser.get_loop_bounds());
+    const WcetResult &wcet = analyzer.analyze(static_cast<word>(*entryAddress));
+
+    ostr << "WCET of " << label << " (" << to_string_hex_prefixed(static_cast<word>(*entryAddress)) << "): "
+         << wcet.cycles << " cycles, budget " << budget << " cycles\n";
+    ostr << "Critical path:\n";
+    for (const CriticalPathStep &step : wcet.criticalPath) {
+        ostr << "  " << to_string_hex_prefixed(step.address) << "  x" << std::left << std::setw(6) << step.executions
+             << std::right << std::setw(8) << step.cycles << " cycles";
+        if (step.callee.has_value()) {
+            ostr << "  (calls " << to_string_hex_prefixed(*step.callee) << ")";
+        }
+        ostr << '\n';
+    }
+    return wcet.cycles <= budget;
+}
+
+bool print_file_stack_depths(const std::string &sourcePath, const size_t limit, std::ostream &ostr) {
+    std::string code{};
+    const TokenVector tokenVector = tokenize_source_file(sourcePath, code);
+    Parser parser(code, tokenVector, sourcePath);
+    const std::vector<DecodedInstruction> instructions = parser.parse_decoded();
+    const Bytestring memory = build_memory_image(instructions);
+
+    // the entry point, or else the first instruction, followed by the interrupt vectors which contain code
+    const auto has_instruction_at = [&](const word address) {
+        return std::any_of(instructions.cbegin(), instructions.cend(), [&](const DecodedInstruction &instruction) { return instruction.address == address; });
+    };
+    const std::vector<word> interruptVectors{0x0040, 0x0048, 0x0050, 0x0058, 0x0060};
+    std::vector<word> entryAddresses{};
+    if (has_instruction_at(0x0100)) {
+        entryAddresses.push_back(0x0100);
+    } else if (!instructions.empty()
+               && std::find(interruptVectors.cbegin(), interruptVectors.cend(), instructions.front().address) == interruptVectors.cend()) {
+        entryAddresses.push_back(instructions.front().address);
+    }
+    const bool hasEntryPoint = !entryAddresses.empty();
+    std::copy_if(interruptVectors.cbegin(), interruptVectors.cend(), std::back_inserter(entryAddresses), has_instruction_at);
+
+    const CallGraph callGraph(memory, entryAddresses);
+    const std::vector<CallGraphRoutine> &routines = callGraph.get_routines();
+    const auto print_path = [&](const size_t routine) {
+        const std::vector<word> path = callGraph.deepest_call_path(routine);
+        for (size_t index = 0; index < path.size(); ++index) {
+            ostr << ((index == 0) ? "" : " -> ") << to_string_hex_prefixed(path[index]);
+        }
+    };
+
+    // interrupts push the return address, and one of them may occur on the deepest path of the main code
+    std::optional<size_t> worstCase = hasEntryPoint ? routines.front().stackDepth : std::optional<size_t>{0};
+    size_t deepestInterrupt = 0;
+    for (size_t routine = 0; routine < entryAddresses.size(); ++routine) {
+        const bool isInterrupt = (routine > 0 || !hasEntryPoint);
+        ostr << (isInterrupt ? "Interrupt " : "Entry ") << to_string_hex_prefixed(entryAddresses[routine]) << ": ";
+        if (!routines[routine].stackDepth.has_value()) {
+            ostr << "unbounded stack depth\n";
+            worstCase.reset();
+            continue;
+        }
+        const size_t depth = *routines[routine].stackDepth + (isInterrupt ? CallGraph::RETURN_ADDRESS_SIZE : 0);
+        deepestInterrupt = isInterrupt ? std::max(deepestInterrupt, depth) : deepestInterrupt;
+        ostr << depth << " bytes" << (isInterrupt ? " including the return address" : "") << ", deepest path ";
+        print_path(routine);
+        ostr << '\n';
+    }
+    for (const CallGraphRoutine &routine : routines) {
+        if (routine.isRecursive) {
+            ostr << "Recursive routine " << to_string_hex_prefixed(routine.address) << '\n';
+        }
+        if (!routine.error.empty()) {
+            ostr << "Routine " << to_string_hex_prefixed(routine.address) << " cannot be analysed: " << routine.error << '\n';
+        }
+    }
+    if (!worstCase.has_value()) {
+        ostr << "Worst-case stack depth: unbounded, limit " << limit << " bytes\n";
+        return false;
+    }
+    ostr << "Worst-case stack depth: " << *worstCase + deepestInterrupt << " bytes, limit " << limit << " bytes\n";
+    return *worstCase + deepestInterrupt <= limit;
+}
+
+ObjectFile assemble_object(const std::string &code, const std::string &sourcePath, const std::shared_ptr<TokenCache> &tokenCache) {
+    Diagnostics diagnostics{};
+    Tokenizer tokenizer(code);
+    TokenVector tokenVector = tokenizer.tokenize(diagnostics);
+    Parser parser(code, tokenVector, sourcePath);
+    if (tokenCache != nullptr) {
+        parser.set_token_cache(tokenCache);
+    }
+
+    ObjectFile objectFile = parser.assemble_object(diagnostics);
+    diagnostics.throw_if_errors();
+    return objectFile;
+}
+
+std::vector<ObjectFile> assemble_objects(const std::vector<std::string> &sourcePaths, const size_t numberOfThreads,
+                                         std::shared_ptr<TokenCache> tokenCache) {
+    if (tokenCache == nullptr) {
+        tokenCache = std::make_shared<TokenCache>();
+    }
+    std::vector<ObjectFile> objectFiles(sourcePaths.size());
+    std::vector<std::string> errors(sourcePaths.size());
+    std::vector<std::exception_ptr> fileErrors(sourcePaths.size());
+
+    // each worker takes the next file which is not assembled yet
+    std::atomic<size_t> nextFile{0};
+    const auto assemble_files = [&]() {
+        for (size_t fileIndex = nextFile++; fileIndex < sourcePaths.size(); fileIndex = nextFile++) {
+            try {
+                objectFiles[fileIndex] = assemble_object(read_source_file(sourcePaths[fileIndex]), sourcePaths[fileIndex], tokenCache);
+            } catch (const std::logic_error &error) {
+                errors[fileIndex] = "In file \"" + sourcePaths[fileIndex] + "\":\n" + error.what();
+            } catch (...) {
+                fileErrors[fileIndex] = std::current_exception();
+            }
+        }
+    };
+
+    const size_t hardwareThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    const size_t numberOfWorkers = std::min((numberOfThreads == 0) ? hardwareThreads : numberOfThreads, std::max<size_t>(sourcePaths.size(), 1));
+    std::vector<std::thread> workers{};
+    workers.reserve(numberOfWorkers);
+    for (size_t worker = 0; worker < numberOfWorkers; ++worker) {
+        workers.emplace_back(assemble_files);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    std::string message{};
+    for (size_t fileIndex = 0; fileIndex < sourcePaths.size(); ++fileIndex) {
+        if (fileErrors[fileIndex]) {
+            std::rethrow_exception(fileErrors[fileIndex]);
+        }
+        message += errors[fileIndex];
+    }
+    if (!message.empty()) {
+        throw std::logic_error(message);
+    }
+    return objectFiles;
+}
+
+namespace {
+    /**
+     * Returns the path of the cached object file of the source file at @p sourcePath.
+     * @param sourcePath path of the assembly source file
+     * @param cacheDirectory directory holding the object files
+     * @return path of the object file
+     */
+    std::filesystem::path cached_object_path(const std::string &sourcePath, const std::string &cacheDirectory) {
+        const std::string normalPath = std::filesystem::absolute(sourcePath).lexically_normal().string();
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << fnv1a_hash(normalPath) << ".gbo";
+        return std::filesystem::path(cacheDirectory) / name.str();
+    }
+
+    /**
+     * Maps the cached object file at @p objectPath of the source file at @p sourcePath.
+     * @param sourcePath path of the assembly source file
+     * @param objectPath path of the cached object file
+     * @return the object file, or std::nullopt if it is missing, malformed or
+     * if one of the files it was assembled from changed since
+     */
+    std::optional<ObjectFileView> load_cached_object(const std::string &sourcePath, const std::filesystem::path &objectPath) {
+        std::optional<ObjectFileView> objectFile{};
+        try {
+            objectFile.emplace(std::make_shared<const MappedFile>(objectPath.string()));
+            if (objectFile->number_of_files() == 0 ||
+                objectFile->file(0) != std::filesystem::path(sourcePath).lexically_normal().string()) {
+                return std::nullopt; // different source files whose paths have the same hash
+            }
+            for (size_t fileIndex = 0; fileIndex < objectFile->number_of_files(); ++fileIndex) {
+                const MappedFile file{std::string(objectFile->file(fileIndex))};
+                const std::string_view content(reinterpret_cast<const char*>(file.data()), file.size());
+                if (fnv1a_hash(content) != objectFile->file_hash(fileIndex)) {
+                    return std::nullopt;
+                }
+            }
+        } catch (const std::runtime_error &) { // the object file or one of the files it was assembled from cannot be read
+            return std::nullopt;
+        }
+        return objectFile;
+    }
+
+    /**
+     * Writes the encoded object file @p bytes to @p objectPath. The file is written under a temporary name first,
+     * so that other processes never map a partially written object file.
+     * @throws std::runtime_error if the file cannot be written
+     * @param bytes the encoded object file
+     * @param objectPath path of the cached object file
+     */
+    void save_cached_object(const Bytestring &bytes, const std::filesystem::path &objectPath) {
+        std::filesystem::path temporaryPath = objectPath;
+        temporaryPath += ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!file) {
+                throw std::runtime_error("Cannot write object file '" + temporaryPath.string() + "'.");
+            }
+        }
+        std::error_code error{};
+        std::filesystem::rename(temporaryPath, objectPath, error);
+        if (error) {
+            throw std::runtime_error("Cannot write object file '" + objectPath.string() + "'.");
+        }
+    }
+}
+
+std::vector<ObjectFileView> load_or_assemble_objects(const std::vector<std::string> &sourcePaths, const std::string &cacheDirectory,
+                                                     const size_t numberOfThreads) {
+    std::error_code error{};
+    std::filesystem::create_directories(cacheDirectory, error);
+    if (error) {
+        throw std::runtime_error("Cannot create cache directory '" + cacheDirectory + "'.");
+    }
+
+    std::vector<std::optional<ObjectFileView>> objectFiles{};
+    objectFiles.reserve(sourcePaths.size());
+    std::vector<std::filesystem::path> objectPaths{};
+    objectPaths.reserve(sourcePaths.size());
+    std::vector<std::string> changedPaths{};
+    std::vector<size_t> changedIndices{};
+    for (size_t fileIndex = 0; fileIndex < sourcePaths.size(); ++fileIndex) {
+        objectPaths.push_back(cached_object_path(sourcePaths[fileIndex], cacheDirectory));
+        objectFiles.push_back(load_cached_object(sourcePaths[fileIndex], objectPaths.back()));
+        if (!objectFiles.back().has_value()) {
+            changedPaths.push_back(sourcePaths[fileIndex]);
+            changedIndices.push_back(fileIndex);
+        }
+    }
+
+    // only the changed source files are assembled, their encoded object files are used directly instead of being mapped again
+    std::vector<ObjectFile> assembledFiles = assemble_objects(changedPaths, numberOfThreads);
+    for (size_t i = 0; i < changedIndices.size(); ++i) {
+        auto bytes = std::make_shared<const Bytestring>(serialize_object_file(assembledFiles[i]));
+        save_cached_object(*bytes, objectPaths[changedIndices[i]]);
+        objectFiles[changedIndices[i]].emplace(std::move(bytes));
+    }
+
+    std::vector<ObjectFileView> result{};
+    result.reserve(objectFiles.size());
+    for (std::optional<ObjectFileView> &objectFile : objectFiles) {
+        result.push_back(std::move(*objectFile));
+    }
+    return result;
+}
+
+void assemble_and_link_files(const std::vector<std::string> &sourcePaths, const std::string &outputPath, const bool reportThroughput,
+                             const std::string &cacheDirectory) {
+    const auto start = std::chrono::steady_clock::now();
+    Linker linker{};
+    if (cacheDirectory.empty()) {
+        for (const ObjectFile &objectFile : assemble_objects(sourcePaths)) {
+            linker.add(objectFile);
+        }
+    } else {
+        for (ObjectFileView &objectFile : load_or_assemble_objects(sourcePaths, cacheDirectory)) {
+            linker.add(std::move(objectFile));
+        }
+    }
+    RomImage romImage = linker.link();
+    write_checksums(romImage, std::cerr);
+    romImage.save(outputPath);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (reportThroughput) {
+        print_throughput(romImage, outputPath, elapsed);
+        const std::vector<size_t> freeSpace = linker.get_free_space();
+        for (size_t bank = 0; bank < freeSpace.size(); ++bank) {
+            std::cout << "Bank " << bank << ": " << freeSpace[bank] << " bytes free" << std::endl;
+        }
+    }
+}
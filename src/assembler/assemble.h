@@ -1,8 +1,130 @@
 #ifndef GAMEBOY_DISASSEMBLE_ASSEMBLE_H
 #define GAMEBOY_DISASSEMBLE_ASSEMBLE_H
 
+#include "linker.h"
 #include "parser.h"
+#include "romimage.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
 
 void assemble_instruction(const BaseInstruction instruction);
 
+/**
+ * Assembles GameBoy assembly source @p code into a ROM image.
+ * The machine code is placed at the beginning of the image, the rest keeps @p fillByte.
+ * @throws std::logic_error containing every lexical and syntactical error of @p code
+ * @param code source code
+ * @param fillByte byte with which unused areas of the image are filled
+ * @param sourcePath path of the source file, relative to which included files are searched
+ * @param peepholeStatistics if not null, the peephole optimization is enabled and its savings per rule are stored here
+ * @return the assembled ROM image
+ */
+RomImage assemble_rom(const std::string &code, const byte fillByte = 0xFF, const std::string &sourcePath = "",
+                      std::vector<PeepholeStatistics> *peepholeStatistics = nullptr);
+
+/**
+ * Assembles the source file at @p sourcePath and writes the ROM image to @p outputPath.
+ * The header checksum and the global checksum of the image are computed and written into its header,
+ * replacing data reserving them, unless instructions are emitted there, which is reported on std::cerr.
+ * @throws std::runtime_error if one of the files cannot be read or written
+ * @throws std::logic_error in case of a lexical or syntactical error
+ * @param sourcePath path of the assembly source file
+ * @param outputPath path of the ROM file which is written
+ * @param reportThroughput if true, the image size and the assembly throughput in bytes/s are printed
+ * @param optimize if true, the peephole optimization is applied and the bytes and cycles saved by each rule are printed
+ */
+void assemble_file(const std::string &sourcePath, const std::string &outputPath, const bool reportThroughput = false,
+                   const bool optimize = false);
+
+/**
+ * Assembles the source file at @p sourcePath and prints a listing of its instructions,
+ * each with its address, its clock cycles and the running total of the clock cycles.
+ * @throws std::runtime_error if the file cannot be read
+ * @throws std::logic_error in case of a lexical or syntactical error
+ * @param sourcePath path of the assembly source file
+ * @param ostr output stream
+ */
+void print_file_listing(const std::string &sourcePath, std::ostream &ostr = std::cout);
+
+/**
+ * Assembles the source file at @p sourcePath and prints the worst-case execution time of the routine at @p label
+ * and its critical path, i.e. the blocks executed on the longest path with their clock cycles.
+ * The bounds of the routine's loops are given by LOOPBOUND commands in the source.
+ * @throws std::runtime_error if the file cannot be read, @p label is not defined or the routine cannot be analysed
+ * @throws std::logic_error in case of a lexical or syntactical error
+ * @param sourcePath path of the assembly source file
+ * @param label name of the label at the routine's first instruction
+ * @param budget maximum number of clock cycles the routine may take
+ * @param ostr output stream
+ * @return true if the worst-case execution time is within @p budget
+ */
+bool print_file_wcet(const std::string &sourcePath, const std::string &label, const size_t budget, std::ostream &ostr = std::cout);
+
+/**
+ * Assembles the source file at @p sourcePath and prints the worst-case stack depth of the entry point at 0x0100
+ * and of each interrupt handler, with the deepest call path of each, and the recursive routines.
+ * The worst case is the depth of the entry point plus that of the deepest interrupt handler.
+ * Without code at 0x0100, the first instruction is taken as the entry point.
+ * @throws std::runtime_error if the file cannot be read
+ * @throws std::logic_error in case of a lexical or syntactical error
+ * @param sourcePath path of the assembly source file
+ * @param limit maximum number of bytes the stack may take
+ * @param ostr output stream
+ * @return true if the worst-case stack depth is bounded and within @p limit
+ */
+bool print_file_stack_depths(const std::string &sourcePath, const size_t limit, std::ostream &ostr = std::cout);
+
+/**
+ * Assembles GameBoy assembly source @p code on its own into an object file, which is placed into a ROM by the Linker.
+ * @throws std::logic_error containing every lexical and syntactical error of @p code
+ * @param code source code
+ * @param sourcePath path of the source file, relative to which included files are searched
+ * @param tokenCache cache of the tokens of included files, shared with the assembly of other files; if empty, a new cache is used
+ * @return the object file
+ */
+ObjectFile assemble_object(const std::string &code, const std::string &sourcePath = "", const std::shared_ptr<TokenCache> &tokenCache = nullptr);
+
+/**
+ * Assembles the source files at @p sourcePaths into object files in parallel, each file on its own.
+ * All files share one token cache, so that a file included by several of them is tokenized once.
+ * @throws std::runtime_error if one of the files cannot be read
+ * @throws std::logic_error containing the errors of all files
+ * @param sourcePaths paths of the assembly source files
+ * @param numberOfThreads maximum number of worker threads, 0 selects the number of hardware threads
+ * @param tokenCache cache of the tokens of included files; if empty, a new cache is used for this call
+ * @return the object files in the order of @p sourcePaths
+ */
+std::vector<ObjectFile> assemble_objects(const std::vector<std::string> &sourcePaths, const size_t numberOfThreads = 0,
+                                         std::shared_ptr<TokenCache> tokenCache = nullptr);
+
+/**
+ * Returns the object files of the source files at @p sourcePaths, using the object files cached in @p cacheDirectory.
+ * A cached object file is memory-mapped and used as long as none of the files it was assembled from changed,
+ * the other source files are assembled in parallel and their object files are stored in the cache.
+ * @throws std::runtime_error if one of the files cannot be read or written
+ * @throws std::logic_error containing the errors of all assembled files
+ * @param sourcePaths paths of the assembly source files
+ * @param cacheDirectory directory holding the object files, which is created if necessary
+ * @param numberOfThreads maximum number of worker threads, 0 selects the number of hardware threads
+ * @return the object files in the order of @p sourcePaths
+ */
+std::vector<ObjectFileView> load_or_assemble_objects(const std::vector<std::string> &sourcePaths, const std::string &cacheDirectory,
+                                                     const size_t numberOfThreads = 0);
+
+/**
+ * Assembles the source files at @p sourcePaths separately, links them and writes the ROM image to @p outputPath.
+ * The header checksum and the global checksum of the image are computed and written into its header,
+ * replacing data reserving them, unless instructions are emitted there, which is reported on std::cerr.
+ * @throws std::runtime_error if one of the files cannot be read or written
+ * @throws std::logic_error in case of a lexical, syntactical or link error
+ * @param sourcePaths paths of the assembly source files
+ * @param outputPath path of the ROM file which is written
+ * @param reportThroughput if true, the image size and the assembly throughput in bytes/s are printed
+ * @param cacheDirectory if not empty, object files are cached in this directory and only changed source files are assembled
+ */
+void assemble_and_link_files(const std::vector<std::string> &sourcePaths, const std::string &outputPath, const bool reportThroughput = false,
+                             const std::string &cacheDirectory = "");
+
 #endif //GAMEBOY_DISASSEMBLE_ASSEMBLE_H
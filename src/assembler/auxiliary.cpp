@@ -13,10 +13,42 @@ unsigned get_length(const InstructionPtr &instruction)
     return decode_length(instruction->opcode());
 }
 
+std::string to_string_error_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                          const size_t columnNumber, const std::string &errorMessage, const size_t highlightWidth) {
+    std::string extendedString = errorMessage + " at " + get_position_string(lineNumber, columnNumber) + '\n';
+    if (!code.empty()) {
+        extendedString += to_string_line_and_highlight(code, lineIndex, lineNumber, columnNumber, highlightWidth);
+    }
+    return extendedString;
+}
+
+std::string to_string_error_and_highlight_with_reference(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                                         const size_t columnNumber, const size_t referenceLineNumber,
+                                                         const size_t referenceColumnNumber, const std::string &errorMessage,
+                                                         const size_t highlightWidth, const size_t referenceHighlightWidth) {
+    std::string extendedString = errorMessage + " at " + get_position_string(lineNumber, columnNumber) + '\n';
+    if (!code.empty()) {
+        extendedString += to_string_line_and_highlight(code, lineIndex, lineNumber, columnNumber, highlightWidth);
+        extendedString += "This expression is referring to\n";
+        extendedString += to_string_line_and_highlight(code, lineIndex, referenceLineNumber, referenceColumnNumber, referenceHighlightWidth);
+    }
+    return extendedString;
+}
+
 bool is_sign(const char character) noexcept {
     return (character == '+' || character == '-') ? true : false;
 }
 
+bool is_operator_start(const char character) noexcept {
+    switch (character) {
+        case '+': case '-': case '*': case '/': case '<': case '>':
+        case '&': case '|': case '~': case '(': case ')':
+            return true;
+        default:
+            return false;
+    }
+}
+
 std::string to_upper(const std::string &str) {
     std::string tmp(str);
     std::transform(tmp.begin(), tmp.end(), tmp.begin(), [](const char c) { return toupper(c); } );
@@ -47,4 +79,9 @@ bool is_register_8_bit(const Token &token) noexcept {
 
 bool is_register_16_bit(const Token &token) noexcept {
     return is_register_16_bit(to_register(token.get_string()));
+}
+
+bool is_address_operand(const Token &token) noexcept {
+    return token.get_token_type() == TokenType::ADDRESS
+        || (token.get_token_type() == TokenType::IDENTIFIER && token.get_string().front() == '(' && !is_register(token));
 }
\ No newline at end of file
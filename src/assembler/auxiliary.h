@@ -29,6 +29,41 @@ std::string to_string(const std::vector<T> &vector);
  */
 unsigned get_length(const InstructionPtr &instruction);
 
+/**
+ * Returns a string, in which an @p errorMessage is displayed and
+ * a certain section of the code's line is highlighted.
+ *
+ * @param code Source code which is highlighted
+ * @param lineIndex line index built from @p code
+ * @param lineNumber number of line in which the marking takes place
+ * @param columnNumber column position in which the highlighting starts
+ * @param errorMessage an error message printed before the highlighted line
+ * @param highlightWidth the width of the highlighting starting from the position @p columnNumber
+ * @return the error message followed by the highlighted line
+ */
+std::string to_string_error_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                          const size_t columnNumber, const std::string &errorMessage, const size_t highlightWidth = 1);
+
+/**
+ * Returns a string, in which an @p errorMessage is displayed and a certain section of the code's line
+ * as well as the section of the referred expression are highlighted.
+ *
+ * @param code Source code which is highlighted
+ * @param lineIndex line index built from @p code
+ * @param lineNumber number of line in which the marking takes place
+ * @param columnNumber column position in which the highlighting starts
+ * @param referenceLineNumber number of line in which the marking of the reference takes place
+ * @param referenceColumnNumber column position in which the reference highlighting starts
+ * @param errorMessage an error message printed before the highlighted line
+ * @param highlightWidth the width of the highlighting starting from the position @p columnNumber
+ * @param referenceHighlightWidth the width of the reference highlighting starting from the position @p referenceColumnNumber
+ * @return the error message followed by both highlighted lines
+ */
+std::string to_string_error_and_highlight_with_reference(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                                         const size_t columnNumber, const size_t referenceLineNumber,
+                                                         const size_t referenceColumnNumber, const std::string &errorMessage,
+                                                         const size_t highlightWidth, const size_t referenceHighlightWidth);
+
 /**
  * Throws an error containing a string, in which an @p errorMessage is displayed and
  * a certain section of the code's line is highlighted.
@@ -44,6 +79,22 @@ unsigned get_length(const InstructionPtr &instruction);
 template<typename ExceptionType = std::logic_error>
 void throw_exception_and_highlight(const std::string &code, const size_t lineNumber, const size_t columnNumber, const std::string &errorMessage, const size_t highlightWidth = 1);
 
+/**
+ * Throws an error containing a string, in which an @p errorMessage is displayed and
+ * a certain section of the code's line is highlighted. The line is sliced using @p lineIndex.
+ * @throws @p ExceptionType
+ *
+ * @tparam ExceptionType type of exception which is thrown
+ * @param code Source code which is highlighted
+ * @param lineIndex line index built from @p code
+ * @param lineNumber number of line in which the marking takes place
+ * @param columnNumber column position in which the highlighting starts
+ * @param errorMessage an error message printed before the highlighted line
+ * @param highlightWidth the width of the highlighting starting from the position @p columnNumber
+ */
+template<typename ExceptionType = std::logic_error>
+void throw_exception_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber, const size_t columnNumber, const std::string &errorMessage, const size_t highlightWidth = 1);
+
 
 /**
  * Throws an error containing a string, in which an @p errorMessage is displayed and
@@ -66,6 +117,28 @@ void throw_exception_and_highlight_with_reference(const std::string &code, const
                                                   const size_t referenceColumnNumber, const std::string &errorMessage,
                                                   const size_t highlightWidth, const size_t referenceHighlightWidth);
 
+/**
+ * Throws an error containing a string, in which an @p errorMessage is displayed and
+ * a certain section of the code's line is highlighted. The lines are sliced using @p lineIndex.
+ * @throws @p ExceptionType
+ *
+ * @tparam ExceptionType type of exception which is thrown
+ * @param code Source code which is highlighted
+ * @param lineIndex line index built from @p code
+ * @param lineNumber number of line in which the marking takes place
+ * @param columnNumber column position in which the highlighting starts
+ * @param referenceLineNumber number of line in which the marking of the reference takes place
+ * @param referenceColumnNumber column position in which the reference highlighting starts
+ * @param errorMessage an error message printed before the highlighted line
+ * @param highlightWidth the width of the highlighting starting from the position @p columnNumber
+ * @param referenceHighlightWidth the width of the reference highlighting starting from the position @p referenceColumnNumber
+ */
+template<typename ExceptionType = std::logic_error>
+void throw_exception_and_highlight_with_reference(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                                  const size_t columnNumber, const size_t referenceLineNumber,
+                                                  const size_t referenceColumnNumber, const std::string &errorMessage,
+                                                  const size_t highlightWidth, const size_t referenceHighlightWidth);
+
 /**
  * Checks whether a @p character is either '+' or '-'.
  * @param character character
@@ -73,6 +146,13 @@ void throw_exception_and_highlight_with_reference(const std::string &code, const
  */
 bool is_sign(const char character) noexcept;
 
+/**
+ * Checks whether a @p character starts an operator of an expression, i.e. + - * / < > & | ~ ( ).
+ * @param character character
+ * @return true if @p character starts an operator
+ */
+bool is_operator_start(const char character) noexcept;
+
 /**
  * Converts the string @p str to uppercase.
  * @param str string
@@ -117,5 +197,13 @@ bool is_register_8_bit(const Token &token) noexcept;
  */
 bool is_register_16_bit(const Token &token) noexcept;
 
+/**
+ * Checks whether a token is the address of a memory operand, i.e. a parenthesized number like (0xFF00)
+ * or a folded parenthesized expression like (X+1), but no register like (HL).
+ * @param token a token
+ * @return true if @p token is an address
+ */
+bool is_address_operand(const Token &token) noexcept;
+
 #include "auxiliary.hpp"
 #endif //GAMEBOY_DISASSEMBLE_AUXILIIARY_H
@@ -20,11 +20,14 @@ std::string to_string(const std::vector<T> &vector) {
 template<typename ExceptionType>
 void throw_exception_and_highlight(const std::string &code, const size_t lineNumber, const size_t columnNumber,
                                    const std::string &errorMessage, const size_t highlightWidth) {
-    std::string extendedString = errorMessage + " at " + get_position_string(lineNumber, columnNumber) + '\n';
-    if (!code.empty()) {
-        extendedString += to_string_line_and_highlight(code, lineNumber, columnNumber, highlightWidth);
-    }
-    throw ExceptionType(extendedString);
+    throw_exception_and_highlight<ExceptionType>(code, code.empty() ? LineIndex{} : LineIndex(code),
+                                                 lineNumber, columnNumber, errorMessage, highlightWidth);
+}
+
+template<typename ExceptionType>
+void throw_exception_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                   const size_t columnNumber, const std::string &errorMessage, const size_t highlightWidth) {
+    throw ExceptionType(to_string_error_and_highlight(code, lineIndex, lineNumber, columnNumber, errorMessage, highlightWidth));
 }
 
 template<typename ExceptionType>
@@ -32,11 +35,18 @@ void throw_exception_and_highlight_with_reference(const std::string &code, const
                                                   const size_t columnNumber, const size_t referenceLineNumber,
                                                   const size_t referenceColumnNumber, const std::string &errorMessage,
                                                   const size_t highlightWidth, const size_t referenceHighlightWidth) {
-    std::string extendedString = errorMessage + " at " + get_position_string(lineNumber, columnNumber) + '\n';
-    if (!code.empty()) {
-        extendedString += to_string_line_and_highlight(code, lineNumber, columnNumber, highlightWidth);
-        extendedString += "This expression is referring to\n";
-        extendedString += to_string_line_and_highlight(code, referenceLineNumber, referenceColumnNumber, referenceHighlightWidth);
-    }
-    throw ExceptionType(extendedString);
-}
\ No newline at end of file
+    throw_exception_and_highlight_with_reference<ExceptionType>(code, code.empty() ? LineIndex{} : LineIndex(code),
+                                                                lineNumber, columnNumber, referenceLineNumber,
+                                                                referenceColumnNumber, errorMessage,
+                                                                highlightWidth, referenceHighlightWidth);
+}
+
+template<typename ExceptionType>
+void throw_exception_and_highlight_with_reference(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber,
+                                                  const size_t columnNumber, const size_t referenceLineNumber,
+                                                  const size_t referenceColumnNumber, const std::string &errorMessage,
+                                                  const size_t highlightWidth, const size_t referenceHighlightWidth) {
+    throw ExceptionType(to_string_error_and_highlight_with_reference(code, lineIndex, lineNumber, columnNumber,
+                                                                     referenceLineNumber, referenceColumnNumber, errorMessage,
+                                                                     highlightWidth, referenceHighlightWidth));
+}
@@ -0,0 +1,46 @@
+#include "diagnostics.h"
+
+SourceError::SourceError(const std::string &message, const SourceSpan &span)
+        : std::logic_error(message),
+          _span(span) {}
+
+const SourceSpan& SourceError::get_span() const noexcept {
+    return _span;
+}
+
+void Diagnostics::report(const Diagnostic &diagnostic) {
+    _diagnostics.push_back(diagnostic);
+}
+
+void Diagnostics::report(const SourceError &sourceError) {
+    _diagnostics.push_back(Diagnostic{sourceError.get_span(), sourceError.what()});
+}
+
+bool Diagnostics::has_errors() const noexcept {
+    return !_diagnostics.empty();
+}
+
+size_t Diagnostics::size() const noexcept {
+    return _diagnostics.size();
+}
+
+const std::vector<Diagnostic>& Diagnostics::get_diagnostics() const noexcept {
+    return _diagnostics;
+}
+
+std::string Diagnostics::to_string() const {
+    std::string str{};
+    for (const Diagnostic &diagnostic : _diagnostics) {
+        str += diagnostic.message;
+    }
+    if (_diagnostics.size() > 1) {
+        str += std::to_string(_diagnostics.size()) + " errors found\n";
+    }
+    return str;
+}
+
+void Diagnostics::throw_if_errors() const {
+    if (has_errors()) {
+        throw std::logic_error(to_string());
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef GAMEBOY_DISASSEMBLE_DIAGNOSTICS_H
+#define GAMEBOY_DISASSEMBLE_DIAGNOSTICS_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Position and width of a passage in the source code.
+ */
+struct SourceSpan {
+    size_t lineNumber{0};   ///< line of the passage, starting at 1
+    size_t columnNumber{0}; ///< column of the first character of the passage, starting at 1
+    size_t width{1};        ///< number of highlighted characters
+};
+
+/**
+ * A single error found in the source code.
+ */
+struct Diagnostic {
+    SourceSpan span{};     ///< the erroneous passage
+    std::string message{}; ///< the error message including the highlighted source code
+};
+
+/**
+ * Exception type thrown by the tokenizer and the parser for an error in the source code.
+ * Besides the highlighted message, it carries the span of the erroneous passage,
+ * so that the error can be recorded as a Diagnostic when recovering.
+ */
+class SourceError : public std::logic_error {
+public:
+    SourceError(const std::string &message, const SourceSpan &span);
+
+    const SourceSpan& get_span() const noexcept;
+
+private:
+    SourceSpan _span{};
+};
+
+/**
+ * Class Diagnostics. Sink collecting all errors found while tokenizing and parsing,
+ * so that a single run reports every error instead of only the first one.
+ */
+class Diagnostics {
+public:
+    /**
+     * Records a new diagnostic.
+     * @param diagnostic the diagnostic to record
+     */
+    void report(const Diagnostic &diagnostic);
+
+    /**
+     * Records the error carried by @p sourceError.
+     * @param sourceError the error to record
+     */
+    void report(const SourceError &sourceError);
+
+    bool has_errors() const noexcept;
+
+    size_t size() const noexcept;
+
+    const std::vector<Diagnostic>& get_diagnostics() const noexcept;
+
+    /**
+     * Returns all recorded messages in the order they were reported.
+     * @return string containing every message
+     */
+    std::string to_string() const;
+
+    /**
+     * Throws a std::logic_error containing all recorded messages, if there are any.
+     * @throws std::logic_error if at least one error has been reported
+     */
+    void throw_if_errors() const;
+
+private:
+    std::vector<Diagnostic> _diagnostics{}; ///< all reported diagnostics
+};
+
+#endif //GAMEBOY_DISASSEMBLE_DIAGNOSTICS_H
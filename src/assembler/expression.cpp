@@ -0,0 +1,132 @@
+#include "expression.h"
+
+#include <stdexcept>
+#include <string>
+
+bool is_unary(const ExpressionOperation operation) noexcept {
+    switch (operation) {
+        case ExpressionOperation::NEGATE:
+        case ExpressionOperation::COMPLEMENT:
+        case ExpressionOperation::HIGH:
+        case ExpressionOperation::LOW:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int precedence(const ExpressionOperation operation) noexcept {
+    switch (operation) {
+        case ExpressionOperation::MULTIPLY:
+        case ExpressionOperation::DIVIDE:      return 5;
+        case ExpressionOperation::ADD:
+        case ExpressionOperation::SUBTRACT:    return 4;
+        case ExpressionOperation::SHIFT_LEFT:
+        case ExpressionOperation::SHIFT_RIGHT: return 3;
+        case ExpressionOperation::AND:         return 2;
+        case ExpressionOperation::OR:          return 1;
+        default:                               return 6; // unary operators
+    }
+}
+
+void Expression::push_constant(const long value) {
+    _instructions.push_back(Instruction{ExpressionOperation::PUSH_CONSTANT, value});
+}
+
+void Expression::push_symbol(const SymbolId symbolId) {
+    _instructions.push_back(Instruction{ExpressionOperation::PUSH_SYMBOL, static_cast<long>(symbolId)});
+}
+
+void Expression::apply(const ExpressionOperation operation) {
+    const size_t size = _instructions.size();
+    const auto is_constant_at = [this, size](const size_t distance) {
+        return size >= distance && _instructions[size - distance].operation == ExpressionOperation::PUSH_CONSTANT;
+    };
+
+    // an operand ending with a constant push consists of that push only, so the operands can be folded
+    if (is_unary(operation) && is_constant_at(1)) {
+        _instructions.back().operand = compute(operation, _instructions.back().operand, 0);
+    } else if (!is_unary(operation) && is_constant_at(1) && is_constant_at(2)) {
+        const long rhs = _instructions.back().operand;
+        _instructions.pop_back();
+        _instructions.back().operand = compute(operation, _instructions.back().operand, rhs);
+    } else {
+        _instructions.push_back(Instruction{operation, 0});
+    }
+}
+
+bool Expression::is_constant() const noexcept {
+    return _instructions.size() == 1 && _instructions.front().operation == ExpressionOperation::PUSH_CONSTANT;
+}
+
+long Expression::get_constant() const {
+    return _instructions.front().operand;
+}
+
+std::optional<long> Expression::evaluate(const std::function<std::optional<long>(SymbolId)> &symbolValue) const {
+    return evaluate(_instructions, symbolValue);
+}
+
+std::optional<long> Expression::evaluate(const std::vector<Instruction> &instructions,
+                                         const std::function<std::optional<long>(SymbolId)> &symbolValue) {
+    std::vector<long> stack{};
+    stack.reserve(instructions.size());
+
+    for (const Instruction &instruction : instructions) {
+        const size_t operands = (instruction.operation == ExpressionOperation::PUSH_CONSTANT
+                              || instruction.operation == ExpressionOperation::PUSH_SYMBOL) ? 0 : (is_unary(instruction.operation) ? 1 : 2);
+        if (stack.size() < operands) {
+            throw std::domain_error("Malformed expression");
+        }
+
+        if (instruction.operation == ExpressionOperation::PUSH_CONSTANT) {
+            stack.push_back(instruction.operand);
+        } else if (instruction.operation == ExpressionOperation::PUSH_SYMBOL) {
+            const std::optional<long> value = symbolValue(static_cast<SymbolId>(instruction.operand));
+            if (!value.has_value()) {
+                return std::nullopt;
+            }
+            stack.push_back(*value);
+        } else if (is_unary(instruction.operation)) {
+            stack.back() = compute(instruction.operation, stack.back(), 0);
+        } else {
+            const long rhs = stack.back();
+            stack.pop_back();
+            stack.back() = compute(instruction.operation, stack.back(), rhs);
+        }
+    }
+    if (stack.size() != 1) {
+        throw std::domain_error("Malformed expression");
+    }
+    return stack.back();
+}
+
+const std::vector<Expression::Instruction>& Expression::get_instructions() const noexcept {
+    return _instructions;
+}
+
+long Expression::compute(const ExpressionOperation operation, const long lhs, const long rhs) {
+    switch (operation) {
+        case ExpressionOperation::NEGATE:      return -lhs;
+        case ExpressionOperation::COMPLEMENT:  return ~lhs;
+        case ExpressionOperation::HIGH:        return (lhs >> 8) & 0xFF;
+        case ExpressionOperation::LOW:         return lhs & 0xFF;
+        case ExpressionOperation::MULTIPLY:    return lhs * rhs;
+        case ExpressionOperation::DIVIDE:
+            if (rhs == 0) {
+                throw std::domain_error("Division by zero");
+            }
+            return lhs / rhs;
+        case ExpressionOperation::ADD:         return lhs + rhs;
+        case ExpressionOperation::SUBTRACT:    return lhs - rhs;
+        case ExpressionOperation::SHIFT_LEFT:
+        case ExpressionOperation::SHIFT_RIGHT:
+            if (rhs < 0 || rhs >= 63) {
+                throw std::domain_error("Shift by " + std::to_string(rhs) + " bits");
+            }
+            return (operation == ExpressionOperation::SHIFT_LEFT) ? lhs << rhs : lhs >> rhs;
+        case ExpressionOperation::AND:         return lhs & rhs;
+        case ExpressionOperation::OR:          return lhs | rhs;
+        default:                               return lhs;
+    }
+}
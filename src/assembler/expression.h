@@ -0,0 +1,136 @@
+#ifndef GAMEBOY_DISASSEMBLE_EXPRESSION_H
+#define GAMEBOY_DISASSEMBLE_EXPRESSION_H
+
+#include "fixup.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+/**
+ * Enumerator for all operations of the expression bytecode.
+ */
+enum class ExpressionOperation : uint8_t {
+    PUSH_CONSTANT, ///< pushes the instruction's operand
+    PUSH_SYMBOL,   ///< pushes the value of the symbol whose ID is the instruction's operand
+    NEGATE,
+    COMPLEMENT,
+    HIGH,          ///< upper byte of a 16-bit value
+    LOW,           ///< lower byte of a 16-bit value
+    MULTIPLY,
+    DIVIDE,
+    ADD,
+    SUBTRACT,
+    SHIFT_LEFT,
+    SHIFT_RIGHT,
+    AND,
+    OR
+};
+
+/**
+ * Checks whether @p operation takes a single operand.
+ * @param operation expression operation
+ * @return true for NEGATE, COMPLEMENT, HIGH and LOW
+ */
+bool is_unary(const ExpressionOperation operation) noexcept;
+
+/**
+ * Returns the binding strength of the operator @p operation, higher values bind stronger.
+ * Unary operators bind strongest, followed by multiplicative, additive, shift, AND and OR operators.
+ * @param operation expression operation
+ * @return precedence of @p operation
+ */
+int precedence(const ExpressionOperation operation) noexcept;
+
+/**
+ * Class Expression. A constant expression compiled to reverse polish notation, e.g. "2 * (X + 1)"
+ * becomes PUSH 2, PUSH X, PUSH 1, ADD, MULTIPLY.
+ *
+ * Operators whose operands are constants are folded as soon as they are appended, so that
+ * an expression without symbols always consists of a single PUSH_CONSTANT instruction.
+ * Expressions referring to symbols which are not defined yet are evaluated once all symbols are known.
+ */
+class Expression {
+public:
+
+    /**
+     * A single instruction of the expression bytecode.
+     */
+    struct Instruction {
+        ExpressionOperation operation; ///< the operation
+        long operand;                  ///< the constant or the symbol ID of push operations, unused otherwise
+    };
+
+    /**
+     * Appends a constant.
+     * @param value the constant
+     */
+    void push_constant(const long value);
+
+    /**
+     * Appends a reference to a symbol whose value is not known yet.
+     * @param symbolId ID of the symbol
+     */
+    void push_symbol(const SymbolId symbolId);
+
+    /**
+     * Appends the operator @p operation, which is applied to the operands appended before.
+     * If all of its operands are constants, the operator is folded into a new constant.
+     * @throws std::domain_error in case of a division by zero or an invalid shift
+     * @param operation a unary or binary operation
+     */
+    void apply(const ExpressionOperation operation);
+
+    /**
+     * Checks whether the expression has been folded to a single constant.
+     * @return true if the expression does not depend on any symbol
+     */
+    bool is_constant() const noexcept;
+
+    /**
+     * Returns the value of an expression which has been folded to a single constant.
+     * @return the constant value
+     */
+    long get_constant() const;
+
+    /**
+     * Evaluates the expression.
+     * @throws std::domain_error in case of a division by zero or an invalid shift
+     * @param symbolValue returns the value of a symbol, or std::nullopt if the symbol is undefined
+     * @return the value of the expression, or std::nullopt if a symbol is undefined
+     */
+    std::optional<long> evaluate(const std::function<std::optional<long>(SymbolId)> &symbolValue) const;
+
+    /**
+     * Evaluates the expression bytecode @p instructions, e.g. one stored in an object file.
+     * @throws std::domain_error in case of a division by zero, an invalid shift or malformed bytecode
+     * @param instructions expression bytecode in reverse polish notation
+     * @param symbolValue returns the value of a symbol, or std::nullopt if the symbol is undefined
+     * @return the value of the expression, or std::nullopt if a symbol is undefined
+     */
+    static std::optional<long> evaluate(const std::vector<Instruction> &instructions,
+                                        const std::function<std::optional<long>(SymbolId)> &symbolValue);
+
+    /**
+     * Returns the expression's bytecode in reverse polish notation.
+     * @return instructions of the expression
+     */
+    const std::vector<Instruction>& get_instructions() const noexcept;
+
+private:
+
+    /**
+     * Computes the result of @p operation. The right operand @p rhs is ignored for unary operations.
+     * @throws std::domain_error in case of a division by zero or an invalid shift
+     * @param operation the operation
+     * @param lhs the (only) operand of unary operations or the left operand of binary operations
+     * @param rhs the right operand of binary operations
+     * @return result of the operation
+     */
+    static long compute(const ExpressionOperation operation, const long lhs, const long rhs);
+
+    std::vector<Instruction> _instructions{}; ///< bytecode in reverse polish notation
+};
+
+#endif //GAMEBOY_DISASSEMBLE_EXPRESSION_H
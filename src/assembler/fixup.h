@@ -0,0 +1,46 @@
+#ifndef GAMEBOY_DISASSEMBLE_FIXUP_H
+#define GAMEBOY_DISASSEMBLE_FIXUP_H
+
+#include "../instructions/constants.h"
+
+#include <cstdint>
+
+using SymbolId = uint32_t;
+
+/**
+ * Enumerator for all kinds of operands which can be patched after all symbols are known.
+ * The kind determines the conversion (and therefore the range check) applied when patching.
+ */
+enum class FixupKind : uint8_t {
+    NUMBER_8_BIT,
+    UNSIGNED_NUMBER_8_BIT,
+    SIGNED_NUMBER_8_BIT,
+    NUMBER_16_BIT,
+    UNSIGNED_NUMBER_16_BIT,
+    RELATIVE_OFFSET,
+    BIT_INDEX ///< bit index of BIT, SET and RES, which is encoded in bits 3-5 of the opcode's second byte
+};
+
+/**
+ * Returns the number of bytes which are patched by a fixup of kind @p kind.
+ * @param kind fixup kind
+ * @return width in bytes
+ */
+constexpr uint8_t fixup_width(const FixupKind kind) {
+    return (kind == FixupKind::NUMBER_16_BIT || kind == FixupKind::UNSIGNED_NUMBER_16_BIT) ? 2 : 1;
+}
+
+/**
+ * Struct Fixup. Records an operand in the output buffer which refers to a symbol
+ * that was not defined yet when its instruction was emitted.
+ */
+struct Fixup {
+    uint32_t offset; ///< position of the operand in the output buffer
+    uint32_t tokenIndex; ///< position of the operand's token in the token vector, used for error messages
+    SymbolId symbolId; ///< the symbol the operand refers to
+    word address; ///< address of the instruction containing the operand, needed for relative jumps
+    uint8_t width; ///< width of the operand in bytes
+    FixupKind kind; ///< kind of the operand
+};
+
+#endif //GAMEBOY_DISASSEMBLE_FIXUP_H
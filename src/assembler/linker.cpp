@@ -0,0 +1,345 @@
+#include "linker.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void Linker::add(const ObjectFile &objectFile) {
+    add(ObjectFileView(std::make_shared<const Bytestring>(serialize_object_file(objectFile))));
+}
+
+void Linker::add(ObjectFileView objectFile) {
+    _objectFiles.push_back(std::move(objectFile));
+}
+
+RomImage Linker::link(const byte fillByte) {
+    place_sections();
+    collect_symbols();
+    _diagnostics.throw_if_errors(); // relocations need the addresses of all sections and symbols
+
+    _numberOfBanks = RomImage::MINIMUM_BANKS;
+    for (const std::vector<Placement> &placements : _placements) {
+        for (const Placement &placement : placements) {
+            _numberOfBanks = std::max(_numberOfBanks, placement.bank + 1);
+        }
+    }
+
+    RomImage romImage(_numberOfBanks, fillByte);
+    for (size_t objectIndex = 0; objectIndex < _objectFiles.size(); ++objectIndex) {
+        const ObjectFileView &objectFile = _objectFiles[objectIndex];
+
+        std::vector<Bytestring> sectionData{};
+        sectionData.reserve(objectFile.number_of_sections());
+        for (size_t sectionIndex = 0; sectionIndex < objectFile.number_of_sections(); ++sectionIndex) {
+            const ObjectFileView::Section section = objectFile.section(sectionIndex);
+            sectionData.emplace_back(section.data, section.data + section.size);
+        }
+        for (size_t relocationIndex = 0; relocationIndex < objectFile.number_of_relocations(); ++relocationIndex) {
+            const ObjectFileView::Relocation relocation = objectFile.relocation(relocationIndex);
+            apply_relocation(objectIndex, relocation, sectionData[relocation.section]);
+        }
+        for (size_t sectionIndex = 0; sectionIndex < objectFile.number_of_sections(); ++sectionIndex) {
+            const Placement &placement = _placements[objectIndex][sectionIndex];
+            romImage.write(placement.bank * RomImage::BANK_SIZE + placement.offset, sectionData[sectionIndex]);
+        }
+        for (size_t codeRangeIndex = 0; codeRangeIndex < objectFile.number_of_code_ranges(); ++codeRangeIndex) {
+            const ObjectFileView::CodeRange codeRange = objectFile.code_range(codeRangeIndex);
+            const Placement &placement = _placements[objectIndex][codeRange.section];
+            romImage.mark_code(placement.bank * RomImage::BANK_SIZE + placement.offset + codeRange.offset, codeRange.size);
+        }
+    }
+
+    _diagnostics.throw_if_errors();
+    return romImage;
+}
+
+std::optional<long> Linker::get_symbol_value(const std::string &name) const {
+    const auto iterator = _globalSymbols.find(name);
+    if (iterator == _globalSymbols.cend()) {
+        return std::nullopt;
+    }
+    return iterator->second.value;
+}
+
+std::vector<size_t> Linker::get_free_space() const {
+    std::vector<size_t> freeSpace(_numberOfBanks, 0);
+    for (size_t bank = 0; bank < _numberOfBanks && bank < _freeRanges.size(); ++bank) {
+        for (const auto &[begin, end] : _freeRanges[bank]) {
+            freeSpace[bank] += end - begin;
+        }
+    }
+    return freeSpace;
+}
+
+void Linker::place_sections() {
+    _placements.assign(_objectFiles.size(), {});
+    _freeRanges.assign(RomImage::MAXIMUM_BANKS, {});
+    for (std::set<FreeBlock> &freeBlocks : _freeBlocks) {
+        freeBlocks.clear();
+    }
+    for (size_t bank = 0; bank < RomImage::MAXIMUM_BANKS; ++bank) {
+        _freeRanges[bank].emplace(0, RomImage::BANK_SIZE);
+        _freeBlocks[bank == 0 ? 0 : 1].insert(FreeBlock{RomImage::BANK_SIZE, bank, 0});
+    }
+
+    std::unordered_map<std::string_view, size_t> sectionNames{};
+    std::vector<std::pair<size_t, size_t>> floatingSections{}; // object and section index
+    for (size_t objectIndex = 0; objectIndex < _objectFiles.size(); ++objectIndex) {
+        const ObjectFileView &objectFile = _objectFiles[objectIndex];
+        _placements[objectIndex].resize(objectFile.number_of_sections());
+        for (size_t sectionIndex = 0; sectionIndex < objectFile.number_of_sections(); ++sectionIndex) {
+            const ObjectFileView::Section section = objectFile.section(sectionIndex);
+            const auto [iterator, isInserted] = sectionNames.emplace(section.name, objectIndex);
+            if (!isInserted) {
+                _diagnostics.report(Diagnostic{SourceSpan{}, "Link error: Section \"" + std::string(section.name) + "\" is defined in \"" +
+                                               std::string(_objectFiles[iterator->second].file(0)) + "\" and in \"" +
+                                               std::string(objectFile.file(0)) + "\"\n"});
+            }
+            if (!section.address.has_value()) {
+                floatingSections.emplace_back(objectIndex, sectionIndex);
+            }
+        }
+    }
+
+    const auto report_overflow = [&](const size_t objectIndex, const ObjectFileView::Section &section) {
+        std::string message = "Link error: Section \"" + std::string(section.name) + "\" of \"" + std::string(_objectFiles[objectIndex].file(0)) +
+                              "\" (" + std::to_string(section.size) + " bytes) does not fit into ";
+        message += section.bank.has_value() ? "bank " + std::to_string(*section.bank) : "any bank";
+        if (section.address.has_value()) {
+            message += " at address " + to_string_hex_prefixed(*section.address);
+        } else {
+            message += ", the largest free block has " + std::to_string(largest_free_block(section.type, section.bank)) + " bytes";
+        }
+        _diagnostics.report(Diagnostic{SourceSpan{}, message + "\n"});
+    };
+
+    // sections pinned to a bank and an address first, then those pinned to an address only
+    for (const bool isBankPinned : {true, false}) {
+        for (size_t objectIndex = 0; objectIndex < _objectFiles.size(); ++objectIndex) {
+            const ObjectFileView &objectFile = _objectFiles[objectIndex];
+            for (size_t sectionIndex = 0; sectionIndex < objectFile.number_of_sections(); ++sectionIndex) {
+                const ObjectFileView::Section section = objectFile.section(sectionIndex);
+                if (section.address.has_value() && section.bank.has_value() == isBankPinned && !place_pinned_section(objectIndex, sectionIndex)) {
+                    report_overflow(objectIndex, section);
+                }
+            }
+        }
+    }
+
+    // best-fit decreasing: sections pinned to a bank first, then the larger and the more strictly aligned ones first
+    std::vector<std::tuple<bool, size_t, uint8_t>> sortKeys(floatingSections.size());
+    std::vector<size_t> order(floatingSections.size());
+    for (size_t i = 0; i < floatingSections.size(); ++i) {
+        const ObjectFileView::Section section = _objectFiles[floatingSections[i].first].section(floatingSections[i].second);
+        sortKeys[i] = std::make_tuple(section.bank.has_value(), section.size, section.alignment);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](const size_t left, const size_t right) { return sortKeys[left] > sortKeys[right]; });
+    for (const size_t i : order) {
+        const auto [objectIndex, sectionIndex] = floatingSections[i];
+        if (!place_floating_section(objectIndex, sectionIndex)) {
+            report_overflow(objectIndex, _objectFiles[objectIndex].section(sectionIndex));
+        }
+    }
+}
+
+bool Linker::place_pinned_section(const size_t objectIndex, const size_t sectionIndex) {
+    const ObjectFileView::Section section = _objectFiles[objectIndex].section(sectionIndex);
+    // switchable banks are mapped behind bank 0
+    const size_t offset = (section.type == SectionType::ROM0) ? *section.address : *section.address - RomImage::BANK_SIZE;
+    if (offset + section.size > RomImage::BANK_SIZE) {
+        return false;
+    }
+
+    const size_t firstBank = (section.type == SectionType::ROM0) ? 0 : section.bank.value_or(1);
+    const size_t lastBank = (section.type == SectionType::ROM0) ? 0 : section.bank.value_or(RomImage::MAXIMUM_BANKS - 1);
+    for (size_t bank = firstBank; bank <= lastBank; ++bank) {
+        if (section.size > 0) { // the free block containing the section's first byte must also contain its last byte
+            const std::map<size_t, size_t> &freeRanges = _freeRanges[bank];
+            auto range = freeRanges.upper_bound(offset);
+            if (range == freeRanges.cbegin() || (--range)->second < offset + section.size) {
+                continue;
+            }
+            allocate(bank, offset, section.size);
+        }
+        _placements[objectIndex][sectionIndex] = Placement{bank, offset};
+        return true;
+    }
+    return false;
+}
+
+bool Linker::place_floating_section(const size_t objectIndex, const size_t sectionIndex) {
+    const ObjectFileView::Section section = _objectFiles[objectIndex].section(sectionIndex);
+    const size_t alignmentMask = (size_t{1} << section.alignment) - 1;
+    const auto aligned_begin = [alignmentMask](const size_t begin) { return (begin + alignmentMask) & ~alignmentMask; };
+
+    std::optional<Placement> placement{};
+    if (section.type == SectionType::ROMX && section.bank.has_value()) {
+        // the blocks of a single bank are few, thus they are searched directly for the best fit
+        size_t smallestSize = RomImage::BANK_SIZE + 1;
+        for (const auto &[begin, end] : _freeRanges[*section.bank]) {
+            if (aligned_begin(begin) + section.size <= end && end - begin < smallestSize) {
+                smallestSize = end - begin;
+                placement = Placement{*section.bank, aligned_begin(begin)};
+            }
+        }
+    } else {
+        // the first block which is large enough is the smallest one, the alignment may require a few more to be checked
+        const std::set<FreeBlock> &freeBlocks = _freeBlocks[section.type == SectionType::ROM0 ? 0 : 1];
+        for (auto block = freeBlocks.lower_bound(FreeBlock{section.size, 0, 0}); block != freeBlocks.cend(); ++block) {
+            if (aligned_begin(block->begin) + section.size <= block->begin + block->size) {
+                placement = Placement{block->bank, aligned_begin(block->begin)};
+                break;
+            }
+        }
+    }
+
+    if (!placement.has_value()) {
+        if (section.size > 0) {
+            return false;
+        }
+        placement = Placement{(section.type == SectionType::ROM0) ? 0 : section.bank.value_or(1), 0}; // empty sections take no space
+    }
+    if (section.size > 0) {
+        allocate(placement->bank, placement->offset, section.size);
+    }
+    _placements[objectIndex][sectionIndex] = *placement;
+    return true;
+}
+
+void Linker::allocate(const size_t bank, const size_t begin, const size_t size) {
+    std::map<size_t, size_t> &freeRanges = _freeRanges[bank];
+    std::set<FreeBlock> &freeBlocks = _freeBlocks[bank == 0 ? 0 : 1];
+
+    const auto range = std::prev(freeRanges.upper_bound(begin));
+    const size_t rangeBegin = range->first;
+    const size_t rangeEnd = range->second;
+    freeBlocks.erase(FreeBlock{rangeEnd - rangeBegin, bank, rangeBegin});
+    freeRanges.erase(range);
+
+    // the unused bytes before and after the section remain free
+    if (rangeBegin < begin) {
+        freeRanges.emplace(rangeBegin, begin);
+        freeBlocks.insert(FreeBlock{begin - rangeBegin, bank, rangeBegin});
+    }
+    if (begin + size < rangeEnd) {
+        freeRanges.emplace(begin + size, rangeEnd);
+        freeBlocks.insert(FreeBlock{rangeEnd - begin - size, bank, begin + size});
+    }
+}
+
+size_t Linker::largest_free_block(const SectionType type, const std::optional<uint32_t> bank) const {
+    if (type == SectionType::ROMX && bank.has_value()) {
+        size_t largest = 0;
+        for (const auto &[begin, end] : _freeRanges[*bank]) {
+            largest = std::max(largest, end - begin);
+        }
+        return largest;
+    }
+    const std::set<FreeBlock> &freeBlocks = _freeBlocks[type == SectionType::ROM0 ? 0 : 1];
+    return freeBlocks.empty() ? 0 : freeBlocks.crbegin()->size;
+}
+
+void Linker::collect_symbols() {
+    for (size_t objectIndex = 0; objectIndex < _objectFiles.size(); ++objectIndex) {
+        const ObjectFileView &objectFile = _objectFiles[objectIndex];
+        for (size_t symbolIndex = 0; symbolIndex < objectFile.number_of_symbols(); ++symbolIndex) {
+            const ObjectFileView::Symbol symbol = objectFile.symbol(symbolIndex);
+            if (!symbol.isExported || symbol.section == ObjectSymbol::UNDEFINED) {
+                continue;
+            }
+
+            const long value = (symbol.section == ObjectSymbol::ABSOLUTE) ? symbol.value
+                                                                           : section_address(objectIndex, symbol.section) + symbol.value;
+            const auto [iterator, isInserted] = _globalSymbols.emplace(symbol.name, GlobalSymbol{value, symbol.isLabel, objectIndex});
+            if (!isInserted) {
+                _diagnostics.report(Diagnostic{SourceSpan{}, "Link error: Symbol " + std::string(symbol.name) + " is defined in \"" +
+                                               std::string(_objectFiles[iterator->second.objectIndex].file(0)) + "\" and in \"" +
+                                               std::string(objectFile.file(0)) + "\"\n"});
+            }
+        }
+    }
+}
+
+void Linker::apply_relocation(const size_t objectIndex, const ObjectFileView::Relocation &relocation, Bytestring &data) {
+    const ObjectFileView &objectFile = _objectFiles[objectIndex];
+    _expressionBuffer.clear();
+    for (size_t i = 0; i < relocation.numberOfInstructions; ++i) {
+        _expressionBuffer.push_back(objectFile.instruction(relocation.firstInstruction + i));
+    }
+
+    bool isAddress = false;
+    std::string_view unresolvedName{};
+    std::optional<long> value{};
+    try {
+        value = Expression::evaluate(_expressionBuffer, [&](const SymbolId symbolIndex) -> std::optional<long> {
+            const ObjectFileView::Symbol symbol = objectFile.symbol(symbolIndex);
+            if (symbol.section == ObjectSymbol::UNDEFINED) {
+                const auto iterator = _globalSymbols.find(symbol.name);
+                if (iterator == _globalSymbols.cend()) {
+                    unresolvedName = symbol.name;
+                    return std::nullopt;
+                }
+                isAddress = isAddress || iterator->second.isAddress;
+                return iterator->second.value;
+            }
+            isAddress = isAddress || symbol.isLabel;
+            return (symbol.section == ObjectSymbol::ABSOLUTE) ? symbol.value : section_address(objectIndex, symbol.section) + symbol.value;
+        });
+    } catch (const std::domain_error &error) {
+        report(objectIndex, relocation, std::string("Link error: ") + error.what());
+        return;
+    }
+    if (!value.has_value()) {
+        report(objectIndex, relocation, "Link error: Symbol " + std::string(unresolvedName) + " is not defined in any object file");
+        return;
+    }
+
+    const auto expect = [&](const bool isValid, const std::string &expectation) {
+        if (!isValid) {
+            report(objectIndex, relocation, "Link error: Number " + std::to_string(*value) + " is expected to be " + expectation);
+        }
+        return isValid;
+    };
+    long operand = *value;
+    switch (relocation.kind) {
+        case FixupKind::NUMBER_8_BIT:           if (!expect(is_8_bit(operand), "8-bit")) { return; } break;
+        case FixupKind::UNSIGNED_NUMBER_8_BIT:  if (!expect(is_unsigned_8_bit(operand), "unsigned 8-bit")) { return; } break;
+        case FixupKind::SIGNED_NUMBER_8_BIT:    if (!expect(is_signed_8_bit(operand), "signed 8-bit")) { return; } break;
+        case FixupKind::NUMBER_16_BIT:          if (!expect(is_16_bit(operand), "16-bit")) { return; } break;
+        case FixupKind::UNSIGNED_NUMBER_16_BIT: if (!expect(is_unsigned_16_bit(operand), "unsigned 16-bit")) { return; } break;
+        case FixupKind::BIT_INDEX:              if (!expect(is_index(operand), "a bit index (0, ..., 7)")) { return; } break;
+        case FixupKind::RELATIVE_OFFSET:
+            if (!expect(is_unsigned_16_bit(operand), "unsigned 16-bit")) {
+                return;
+            }
+            if (isAddress) { // the offset is the distance between the instruction following the jump and the label
+                operand = relative_jump_offset(operand, static_cast<long>(section_address(objectIndex, relocation.section) + relocation.address));
+            }
+            if (!is_signed_8_bit(operand)) {
+                report(objectIndex, relocation, "Link error: The goal results in a jump of " + to_string_hex_signed_prefixed(operand) +
+                                                ", which is not a signed 8-bit number. Please use JP or JMP instead of JR");
+                return;
+            }
+            break;
+    }
+
+    if (relocation.kind == FixupKind::BIT_INDEX) {
+        data[relocation.offset] |= static_cast<byte>(operand << 3);
+    } else {
+        for (size_t i = 0; i < fixup_width(relocation.kind); ++i) { // little endian
+            data[relocation.offset + i] = static_cast<byte>(operand >> (8 * i));
+        }
+    }
+}
+
+long Linker::section_address(const size_t objectIndex, const size_t sectionIndex) const {
+    const Placement &placement = _placements[objectIndex][sectionIndex];
+    return static_cast<long>((placement.bank == 0) ? placement.offset : RomImage::BANK_SIZE + placement.offset);
+}
+
+void Linker::report(const size_t objectIndex, const ObjectFileView::Relocation &relocation, const std::string &message) {
+    const std::string path(_objectFiles[objectIndex].file(relocation.file));
+    _diagnostics.report(Diagnostic{SourceSpan{relocation.line, relocation.column, 1},
+                                   path + ":" + std::to_string(relocation.line) + ":" + std::to_string(relocation.column) + ": " + message + "\n"});
+}
@@ -0,0 +1,174 @@
+#ifndef GAMEBOY_DISASSEMBLE_LINKER_H
+#define GAMEBOY_DISASSEMBLE_LINKER_H
+
+#include "diagnostics.h"
+#include "objectfile.h"
+#include "romimage.h"
+
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Class Linker. Combines separately assembled object files into a ROM image.
+ * The object files are used in place in the binary object format, e.g. memory-mapped from a build cache.
+ *
+ * Linking happens in three steps: the sections are placed into ROM banks, pinned sections first,
+ * then the exported symbols of all object files are collected, and finally every relocation
+ * is evaluated and patched into the bytes of its section before the section is written into the image.
+ * Sections without an address are packed into the banks best-fit decreasing, i.e. from the largest to the smallest
+ * section, each into the smallest free block it fits in, which keeps the number of used banks low.
+ * Like the parser, the linker collects all errors and reports them at once.
+ */
+class Linker {
+public:
+
+    /**
+     * Adds an object file which is linked.
+     * @param objectFile the object file
+     */
+    void add(const ObjectFile &objectFile);
+
+    /**
+     * Adds an object file in the binary object format which is linked.
+     * @param objectFile view of the object file, which is kept until the linker is destroyed
+     */
+    void add(ObjectFileView objectFile);
+
+    /**
+     * Links all added object files into a ROM image, whose size is a whole number of banks.
+     * @throws std::logic_error containing all error messages
+     * @param fillByte byte with which unused areas of the image are filled
+     * @return the ROM image
+     */
+    RomImage link(const byte fillByte = 0xFF);
+
+    /**
+     * Returns the address of an exported symbol once the object files are linked.
+     * @param name name of the symbol
+     * @return the symbol's value, or std::nullopt if no object file exports it
+     */
+    std::optional<long> get_symbol_value(const std::string &name) const;
+
+    /**
+     * Returns the number of unused bytes in each bank of the image once the object files are linked.
+     * @return the free bytes, indexed by bank
+     */
+    std::vector<size_t> get_free_space() const;
+
+private:
+
+    /**
+     * Position of a section in the ROM.
+     */
+    struct Placement {
+        size_t bank{0};
+        size_t offset{0}; ///< offset of the first byte within the bank
+    };
+
+    /**
+     * Unused part of a bank, ordered by size and then by position, so that the smallest suitable block is found first.
+     */
+    struct FreeBlock {
+        size_t size;
+        size_t bank;
+        size_t begin; ///< offset within the bank
+
+        bool operator<(const FreeBlock &other) const noexcept {
+            return std::tie(size, bank, begin) < std::tie(other.size, other.bank, other.begin);
+        }
+    };
+
+    /**
+     * An exported symbol.
+     */
+    struct GlobalSymbol {
+        long value;     ///< the symbol's value, i.e. the absolute address of labels
+        bool isAddress; ///< true for labels, relative to whose addresses relative jumps are calculated
+        size_t objectIndex; ///< the object file which defines the symbol
+    };
+
+    /**
+     * Places all sections into banks. Sections pinned to an address are placed first, pinned to a bank and an address
+     * before those only pinned to an address. The remaining sections are placed best-fit decreasing,
+     * those pinned to a bank before those which may be placed anywhere.
+     */
+    void place_sections();
+
+    /**
+     * Places the section @p sectionIndex of object file @p objectIndex at its address in the first bank where it is unused.
+     * @param objectIndex index of the object file
+     * @param sectionIndex index of the section in the object file
+     * @return true if the section fits into a bank
+     */
+    bool place_pinned_section(const size_t objectIndex, const size_t sectionIndex);
+
+    /**
+     * Places the section @p sectionIndex of object file @p objectIndex into the smallest free block it fits in.
+     * @param objectIndex index of the object file
+     * @param sectionIndex index of the section in the object file
+     * @return true if the section fits into a bank
+     */
+    bool place_floating_section(const size_t objectIndex, const size_t sectionIndex);
+
+    /**
+     * Marks @p size bytes at @p begin of @p bank as used, which must be part of a free block.
+     * @param bank the bank
+     * @param begin offset within the bank
+     * @param size number of bytes
+     */
+    void allocate(const size_t bank, const size_t begin, const size_t size);
+
+    /**
+     * Returns the size of the largest free block in which a section of @p type could be placed.
+     * @param type the ROM area
+     * @param bank the bank the section is pinned to, if any
+     * @return number of bytes
+     */
+    size_t largest_free_block(const SectionType type, const std::optional<uint32_t> bank) const;
+
+    /**
+     * Collects the exported symbols of all object files and reports symbols which are exported more than once.
+     */
+    void collect_symbols();
+
+    /**
+     * Evaluates @p relocation of object file @p objectIndex and patches its value into @p data.
+     * @param objectIndex index of the object file
+     * @param relocation the relocation
+     * @param data the bytes of the relocation's section
+     */
+    void apply_relocation(const size_t objectIndex, const ObjectFileView::Relocation &relocation, Bytestring &data);
+
+    /**
+     * Returns the address at which the section @p sectionIndex of object file @p objectIndex starts.
+     * @param objectIndex index of the object file
+     * @param sectionIndex index of the section in the object file
+     * @return the address of the section's first byte
+     */
+    long section_address(const size_t objectIndex, const size_t sectionIndex) const;
+
+    /**
+     * Records an error found in relocation @p relocation of object file @p objectIndex.
+     * @param objectIndex index of the object file
+     * @param relocation the erroneous relocation
+     * @param message error message
+     */
+    void report(const size_t objectIndex, const ObjectFileView::Relocation &relocation, const std::string &message);
+
+    std::vector<ObjectFileView> _objectFiles{}; ///< all object files which are linked
+    std::vector<std::vector<Placement>> _placements{}; ///< placement of each section, indexed by object file and section
+    std::vector<std::map<size_t, size_t>> _freeRanges{}; ///< end of each free block of each bank, by the block's begin
+    std::set<FreeBlock> _freeBlocks[2]{}; ///< free blocks of bank 0 and of the switchable banks, smallest first
+    size_t _numberOfBanks{RomImage::MINIMUM_BANKS}; ///< number of banks of the linked image
+    std::unordered_map<std::string_view, GlobalSymbol> _globalSymbols{}; ///< all exported symbols by name, pointing into the object files
+    std::vector<Expression::Instruction> _expressionBuffer{}; ///< the expression of the relocation which is evaluated
+    Diagnostics _diagnostics{}; ///< all errors found while linking
+};
+
+#endif //GAMEBOY_DISASSEMBLE_LINKER_H
@@ -0,0 +1,85 @@
+#include "mappedfile.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GAMEBOY_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &path) {
+#ifdef GAMEBOY_HAS_MMAP
+    const int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Cannot open file '" + path + "'.");
+    }
+
+    struct stat fileStatus{};
+    if (::fstat(fileDescriptor, &fileStatus) != 0) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Cannot determine the size of file '" + path + "'.");
+    }
+    _size = static_cast<size_t>(fileStatus.st_size);
+
+    if (_size > 0) { // empty files cannot be mapped
+        void *mapping = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fileDescriptor);
+            throw std::runtime_error("Cannot map file '" + path + "' into memory.");
+        }
+        _data = static_cast<const byte*>(mapping);
+    }
+    ::close(fileDescriptor); // the mapping stays valid after closing
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file '" + path + "'.");
+    }
+    _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+        : _data(std::exchange(other._data, nullptr)),
+          _size(std::exchange(other._size, 0)),
+          _buffer(std::move(other._buffer)) {}
+
+MappedFile& MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _buffer = std::move(other._buffer);
+    }
+    return *this;
+}
+
+const byte* MappedFile::data() const noexcept {
+    return _data;
+}
+
+size_t MappedFile::size() const noexcept {
+    return _size;
+}
+
+void MappedFile::unmap() noexcept {
+#ifdef GAMEBOY_HAS_MMAP
+    if (_data != nullptr) {
+        ::munmap(const_cast<byte*>(_data), _size);
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,43 @@
+#ifndef GAMEBOY_DISASSEMBLE_MAPPEDFILE_H
+#define GAMEBOY_DISASSEMBLE_MAPPEDFILE_H
+
+#include "../instructions/constants.h"
+
+#include <string>
+
+/**
+ * Class MappedFile. Maps a file read-only into memory for the lifetime of the object,
+ * so that its content can be accessed without reading it into a buffer first.
+ * On platforms without mmap, the file is read into a buffer instead.
+ */
+class MappedFile {
+public:
+    /**
+     * Constructor. Maps the file @p path into memory.
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     * @param path path of the file
+     */
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile& operator=(MappedFile &&other) noexcept;
+
+    const byte* data() const noexcept;
+
+    size_t size() const noexcept;
+
+private:
+    /**
+     * Unmaps the file, if it is mapped.
+     */
+    void unmap() noexcept;
+
+    const byte *_data{nullptr}; ///< first byte of the mapped file
+    size_t _size{0};            ///< size of the file in bytes
+    Bytestring _buffer{};       ///< file content, only used if mmap is not available
+};
+
+#endif //GAMEBOY_DISASSEMBLE_MAPPEDFILE_H
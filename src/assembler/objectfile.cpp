@@ -0,0 +1,379 @@
+#include "objectfile.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    // layout of the header, all fields are 32-bit numbers
+    constexpr size_t HEADER_SIZE = 72;
+    constexpr size_t MAGIC_FIELD = 0;
+    constexpr size_t VERSION_FIELD = 4;
+    constexpr size_t FILE_COUNT_FIELD = 8;
+    constexpr size_t SECTION_COUNT_FIELD = 12;
+    constexpr size_t SYMBOL_COUNT_FIELD = 16;
+    constexpr size_t RELOCATION_COUNT_FIELD = 20;
+    constexpr size_t INSTRUCTION_COUNT_FIELD = 24;
+    constexpr size_t FILES_FIELD = 28;
+    constexpr size_t SECTIONS_FIELD = 32;
+    constexpr size_t SYMBOLS_FIELD = 36;
+    constexpr size_t RELOCATIONS_FIELD = 40;
+    constexpr size_t INSTRUCTIONS_FIELD = 44;
+    constexpr size_t STRINGS_FIELD = 48;
+    constexpr size_t STRINGS_SIZE_FIELD = 52;
+    constexpr size_t DATA_FIELD = 56;
+    constexpr size_t DATA_SIZE_FIELD = 60;
+    constexpr size_t CODE_RANGE_COUNT_FIELD = 64;
+    constexpr size_t CODE_RANGES_FIELD = 68;
+
+    // sizes of the records
+    constexpr size_t FILE_RECORD_SIZE = 16;        ///< path, reserved, 64-bit content hash
+    constexpr size_t SECTION_RECORD_SIZE = 24;     ///< name, data offset, size, bank, 16-bit address, 8-bit type, 8-bit flags,
+                                                   ///< 8-bit alignment, reserved
+    constexpr size_t SYMBOL_RECORD_SIZE = 20;      ///< name, section, 64-bit value, 8-bit flags, reserved
+    constexpr size_t RELOCATION_RECORD_SIZE = 32;  ///< section, offset, file, line, column, first instruction,
+                                                   ///< number of instructions, 16-bit address, 8-bit kind, reserved
+    constexpr size_t INSTRUCTION_RECORD_SIZE = 12; ///< 64-bit operand, 8-bit operation, reserved
+    constexpr size_t CODE_RANGE_RECORD_SIZE = 12;  ///< section, offset, size
+
+    constexpr uint8_t HAS_BANK = 0x01;    ///< section flag
+    constexpr uint8_t HAS_ADDRESS = 0x02; ///< section flag
+    constexpr uint8_t IS_EXPORTED = 0x01; ///< symbol flag
+    constexpr uint8_t IS_LABEL = 0x02;    ///< symbol flag
+
+    /**
+     * Writes @p value in little endian byte order to @p offset of @p bytes.
+     * @tparam T unsigned integer type
+     * @param bytes the buffer
+     * @param offset position in the buffer
+     * @param value the number
+     */
+    template<typename T>
+    void store(Bytestring &bytes, const size_t offset, const T value) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bytes[offset + i] = static_cast<byte>(value >> (8 * i));
+        }
+    }
+}
+
+Bytestring serialize_object_file(const ObjectFile &objectFile) {
+    // every distinct string is stored once in the string blob
+    std::string strings{};
+    std::unordered_map<std::string, uint32_t> stringOffsets{};
+    const auto intern = [&strings, &stringOffsets](const std::string &string) {
+        const auto [iterator, isInserted] = stringOffsets.emplace(string, static_cast<uint32_t>(strings.size()));
+        if (isInserted) {
+            strings += string;
+            strings += '\0';
+        }
+        return iterator->second;
+    };
+
+    size_t numberOfInstructions = 0;
+    for (const Relocation &relocation : objectFile.relocations) {
+        numberOfInstructions += relocation.expression.get_instructions().size();
+    }
+    size_t dataSize = 0;
+    size_t numberOfCodeRanges = 0;
+    for (const ObjectSection &section : objectFile.sections) {
+        dataSize += section.data.size();
+        numberOfCodeRanges += section.codeRanges.size();
+    }
+    for (const std::string &file : objectFile.files) {
+        intern(file);
+    }
+    for (const ObjectSection &section : objectFile.sections) {
+        intern(section.name);
+    }
+    for (const ObjectSymbol &symbol : objectFile.symbols) {
+        intern(symbol.name);
+    }
+
+    const size_t filesOffset = HEADER_SIZE;
+    const size_t sectionsOffset = filesOffset + objectFile.files.size() * FILE_RECORD_SIZE;
+    const size_t symbolsOffset = sectionsOffset + objectFile.sections.size() * SECTION_RECORD_SIZE;
+    const size_t relocationsOffset = symbolsOffset + objectFile.symbols.size() * SYMBOL_RECORD_SIZE;
+    const size_t instructionsOffset = relocationsOffset + objectFile.relocations.size() * RELOCATION_RECORD_SIZE;
+    const size_t codeRangesOffset = instructionsOffset + numberOfInstructions * INSTRUCTION_RECORD_SIZE;
+    const size_t stringsOffset = codeRangesOffset + numberOfCodeRanges * CODE_RANGE_RECORD_SIZE;
+    const size_t dataOffset = stringsOffset + strings.size();
+
+    Bytestring bytes(dataOffset + dataSize, 0);
+    store<uint32_t>(bytes, MAGIC_FIELD, ObjectFileView::MAGIC);
+    store<uint32_t>(bytes, VERSION_FIELD, ObjectFileView::VERSION);
+    store<uint32_t>(bytes, FILE_COUNT_FIELD, static_cast<uint32_t>(objectFile.files.size()));
+    store<uint32_t>(bytes, SECTION_COUNT_FIELD, static_cast<uint32_t>(objectFile.sections.size()));
+    store<uint32_t>(bytes, SYMBOL_COUNT_FIELD, static_cast<uint32_t>(objectFile.symbols.size()));
+    store<uint32_t>(bytes, RELOCATION_COUNT_FIELD, static_cast<uint32_t>(objectFile.relocations.size()));
+    store<uint32_t>(bytes, INSTRUCTION_COUNT_FIELD, static_cast<uint32_t>(numberOfInstructions));
+    store<uint32_t>(bytes, FILES_FIELD, static_cast<uint32_t>(filesOffset));
+    store<uint32_t>(bytes, SECTIONS_FIELD, static_cast<uint32_t>(sectionsOffset));
+    store<uint32_t>(bytes, SYMBOLS_FIELD, static_cast<uint32_t>(symbolsOffset));
+    store<uint32_t>(bytes, RELOCATIONS_FIELD, static_cast<uint32_t>(relocationsOffset));
+    store<uint32_t>(bytes, INSTRUCTIONS_FIELD, static_cast<uint32_t>(instructionsOffset));
+    store<uint32_t>(bytes, STRINGS_FIELD, static_cast<uint32_t>(stringsOffset));
+    store<uint32_t>(bytes, STRINGS_SIZE_FIELD, static_cast<uint32_t>(strings.size()));
+    store<uint32_t>(bytes, DATA_FIELD, static_cast<uint32_t>(dataOffset));
+    store<uint32_t>(bytes, DATA_SIZE_FIELD, static_cast<uint32_t>(dataSize));
+    store<uint32_t>(bytes, CODE_RANGE_COUNT_FIELD, static_cast<uint32_t>(numberOfCodeRanges));
+    store<uint32_t>(bytes, CODE_RANGES_FIELD, static_cast<uint32_t>(codeRangesOffset));
+
+    for (size_t index = 0; index < objectFile.files.size(); ++index) {
+        const size_t record = filesOffset + index * FILE_RECORD_SIZE;
+        store<uint32_t>(bytes, record, intern(objectFile.files[index]));
+        store<uint64_t>(bytes, record + 8, (index < objectFile.fileHashes.size()) ? objectFile.fileHashes[index] : 0);
+    }
+
+    size_t sectionDataOffset = 0;
+    size_t codeRangeIndex = 0;
+    for (size_t index = 0; index < objectFile.sections.size(); ++index) {
+        const ObjectSection &section = objectFile.sections[index];
+        const size_t record = sectionsOffset + index * SECTION_RECORD_SIZE;
+        store<uint32_t>(bytes, record, intern(section.name));
+        store<uint32_t>(bytes, record + 4, static_cast<uint32_t>(sectionDataOffset));
+        store<uint32_t>(bytes, record + 8, static_cast<uint32_t>(section.data.size()));
+        store<uint32_t>(bytes, record + 12, section.bank.value_or(0));
+        store<uint16_t>(bytes, record + 16, section.address.value_or(0));
+        bytes[record + 18] = static_cast<byte>(section.type);
+        bytes[record + 19] = static_cast<byte>((section.bank.has_value() ? HAS_BANK : 0) | (section.address.has_value() ? HAS_ADDRESS : 0));
+        bytes[record + 20] = section.alignment;
+
+        std::copy(section.data.begin(), section.data.end(), bytes.begin() + dataOffset + sectionDataOffset);
+        sectionDataOffset += section.data.size();
+
+        for (const auto &[offset, size] : section.codeRanges) {
+            const size_t codeRangeRecord = codeRangesOffset + codeRangeIndex * CODE_RANGE_RECORD_SIZE;
+            store<uint32_t>(bytes, codeRangeRecord, static_cast<uint32_t>(index));
+            store<uint32_t>(bytes, codeRangeRecord + 4, offset);
+            store<uint32_t>(bytes, codeRangeRecord + 8, size);
+            ++codeRangeIndex;
+        }
+    }
+
+    for (size_t index = 0; index < objectFile.symbols.size(); ++index) {
+        const ObjectSymbol &symbol = objectFile.symbols[index];
+        const size_t record = symbolsOffset + index * SYMBOL_RECORD_SIZE;
+        store<uint32_t>(bytes, record, intern(symbol.name));
+        store<uint32_t>(bytes, record + 4, symbol.section);
+        store<uint64_t>(bytes, record + 8, static_cast<uint64_t>(symbol.value));
+        bytes[record + 16] = static_cast<byte>((symbol.isExported ? IS_EXPORTED : 0) | (symbol.isLabel ? IS_LABEL : 0));
+    }
+
+    size_t instructionIndex = 0;
+    for (size_t index = 0; index < objectFile.relocations.size(); ++index) {
+        const Relocation &relocation = objectFile.relocations[index];
+        const std::vector<Expression::Instruction> &instructions = relocation.expression.get_instructions();
+        const size_t record = relocationsOffset + index * RELOCATION_RECORD_SIZE;
+        store<uint32_t>(bytes, record, relocation.section);
+        store<uint32_t>(bytes, record + 4, relocation.offset);
+        store<uint32_t>(bytes, record + 8, relocation.file);
+        store<uint32_t>(bytes, record + 12, relocation.line);
+        store<uint32_t>(bytes, record + 16, relocation.column);
+        store<uint32_t>(bytes, record + 20, static_cast<uint32_t>(instructionIndex));
+        store<uint32_t>(bytes, record + 24, static_cast<uint32_t>(instructions.size()));
+        store<uint16_t>(bytes, record + 28, relocation.address);
+        bytes[record + 30] = static_cast<byte>(relocation.kind);
+
+        for (const Expression::Instruction &instruction : instructions) {
+            const size_t instructionRecord = instructionsOffset + instructionIndex * INSTRUCTION_RECORD_SIZE;
+            store<uint64_t>(bytes, instructionRecord, static_cast<uint64_t>(instruction.operand));
+            bytes[instructionRecord + 8] = static_cast<byte>(instruction.operation);
+            ++instructionIndex;
+        }
+    }
+
+    std::copy(strings.begin(), strings.end(), bytes.begin() + stringsOffset);
+    return bytes;
+}
+
+ObjectFileView::ObjectFileView(std::shared_ptr<const MappedFile> file)
+        : _data(file->data()),
+          _size(file->size()) {
+    _owner = std::move(file);
+    validate();
+}
+
+ObjectFileView::ObjectFileView(std::shared_ptr<const Bytestring> bytes)
+        : _data(bytes->data()),
+          _size(bytes->size()) {
+    _owner = std::move(bytes);
+    validate();
+}
+
+size_t ObjectFileView::number_of_files() const noexcept {
+    return load<uint32_t>(FILE_COUNT_FIELD);
+}
+
+size_t ObjectFileView::number_of_sections() const noexcept {
+    return load<uint32_t>(SECTION_COUNT_FIELD);
+}
+
+size_t ObjectFileView::number_of_symbols() const noexcept {
+    return load<uint32_t>(SYMBOL_COUNT_FIELD);
+}
+
+size_t ObjectFileView::number_of_relocations() const noexcept {
+    return load<uint32_t>(RELOCATION_COUNT_FIELD);
+}
+
+size_t ObjectFileView::number_of_code_ranges() const noexcept {
+    return load<uint32_t>(CODE_RANGE_COUNT_FIELD);
+}
+
+std::string_view ObjectFileView::file(const size_t index) const {
+    return string_at(load<uint32_t>(load<uint32_t>(FILES_FIELD) + index * FILE_RECORD_SIZE));
+}
+
+uint64_t ObjectFileView::file_hash(const size_t index) const {
+    return load<uint64_t>(load<uint32_t>(FILES_FIELD) + index * FILE_RECORD_SIZE + 8);
+}
+
+ObjectFileView::Section ObjectFileView::section(const size_t index) const {
+    const size_t record = load<uint32_t>(SECTIONS_FIELD) + index * SECTION_RECORD_SIZE;
+    const uint8_t flags = _data[record + 19];
+
+    Section section{};
+    section.name = string_at(load<uint32_t>(record));
+    section.type = static_cast<SectionType>(_data[record + 18]);
+    if (flags & HAS_BANK) {
+        section.bank = load<uint32_t>(record + 12);
+    }
+    if (flags & HAS_ADDRESS) {
+        section.address = load<uint16_t>(record + 16);
+    }
+    section.data = _data + load<uint32_t>(DATA_FIELD) + load<uint32_t>(record + 4);
+    section.size = load<uint32_t>(record + 8);
+    section.alignment = _data[record + 20];
+    return section;
+}
+
+ObjectFileView::Symbol ObjectFileView::symbol(const size_t index) const {
+    const size_t record = load<uint32_t>(SYMBOLS_FIELD) + index * SYMBOL_RECORD_SIZE;
+    const uint8_t flags = _data[record + 16];
+    return Symbol{string_at(load<uint32_t>(record)),
+                  load<uint32_t>(record + 4),
+                  static_cast<long>(load<uint64_t>(record + 8)),
+                  (flags & IS_EXPORTED) != 0,
+                  (flags & IS_LABEL) != 0};
+}
+
+ObjectFileView::Relocation ObjectFileView::relocation(const size_t index) const {
+    const size_t record = load<uint32_t>(RELOCATIONS_FIELD) + index * RELOCATION_RECORD_SIZE;
+    return Relocation{load<uint32_t>(record),
+                      load<uint32_t>(record + 4),
+                      load<uint16_t>(record + 28),
+                      static_cast<FixupKind>(_data[record + 30]),
+                      load<uint32_t>(record + 8),
+                      load<uint32_t>(record + 12),
+                      load<uint32_t>(record + 16),
+                      load<uint32_t>(record + 20),
+                      load<uint32_t>(record + 24)};
+}
+
+Expression::Instruction ObjectFileView::instruction(const size_t index) const {
+    const size_t record = load<uint32_t>(INSTRUCTIONS_FIELD) + index * INSTRUCTION_RECORD_SIZE;
+    return Expression::Instruction{static_cast<ExpressionOperation>(_data[record + 8]), static_cast<long>(load<uint64_t>(record))};
+}
+
+ObjectFileView::CodeRange ObjectFileView::code_range(const size_t index) const {
+    const size_t record = load<uint32_t>(CODE_RANGES_FIELD) + index * CODE_RANGE_RECORD_SIZE;
+    return CodeRange{load<uint32_t>(record), load<uint32_t>(record + 4), load<uint32_t>(record + 8)};
+}
+
+void ObjectFileView::validate() const {
+    const auto fail = [](const std::string &reason) {
+        throw std::runtime_error("Invalid object file: " + reason);
+    };
+    const auto check_table = [this, &fail](const size_t offsetField, const size_t countField, const size_t recordSize) {
+        if (static_cast<uint64_t>(load<uint32_t>(offsetField)) + static_cast<uint64_t>(load<uint32_t>(countField)) * recordSize > _size) {
+            fail("a table exceeds the file");
+        }
+    };
+
+    if (_size < HEADER_SIZE || load<uint32_t>(MAGIC_FIELD) != MAGIC) {
+        fail("missing header");
+    }
+    if (load<uint32_t>(VERSION_FIELD) != VERSION) {
+        fail("version " + std::to_string(load<uint32_t>(VERSION_FIELD)) + " instead of " + std::to_string(VERSION));
+    }
+    check_table(FILES_FIELD, FILE_COUNT_FIELD, FILE_RECORD_SIZE);
+    check_table(SECTIONS_FIELD, SECTION_COUNT_FIELD, SECTION_RECORD_SIZE);
+    check_table(SYMBOLS_FIELD, SYMBOL_COUNT_FIELD, SYMBOL_RECORD_SIZE);
+    check_table(RELOCATIONS_FIELD, RELOCATION_COUNT_FIELD, RELOCATION_RECORD_SIZE);
+    check_table(INSTRUCTIONS_FIELD, INSTRUCTION_COUNT_FIELD, INSTRUCTION_RECORD_SIZE);
+    check_table(CODE_RANGES_FIELD, CODE_RANGE_COUNT_FIELD, CODE_RANGE_RECORD_SIZE);
+    check_table(STRINGS_FIELD, STRINGS_SIZE_FIELD, 1);
+    check_table(DATA_FIELD, DATA_SIZE_FIELD, 1);
+
+    const uint32_t stringsSize = load<uint32_t>(STRINGS_SIZE_FIELD);
+    if (stringsSize > 0 && _data[load<uint32_t>(STRINGS_FIELD) + stringsSize - 1] != '\0') {
+        fail("unterminated string");
+    }
+    const auto check_string = [stringsSize, &fail](const uint32_t offset) {
+        if (offset >= stringsSize) {
+            fail("a name exceeds the string table");
+        }
+    };
+
+    const size_t numberOfFiles = number_of_files();
+    for (size_t index = 0; index < numberOfFiles; ++index) {
+        check_string(load<uint32_t>(load<uint32_t>(FILES_FIELD) + index * FILE_RECORD_SIZE));
+    }
+    const size_t numberOfSections = number_of_sections();
+    for (size_t index = 0; index < numberOfSections; ++index) {
+        const size_t record = load<uint32_t>(SECTIONS_FIELD) + index * SECTION_RECORD_SIZE;
+        check_string(load<uint32_t>(record));
+        if (static_cast<uint64_t>(load<uint32_t>(record + 4)) + load<uint32_t>(record + 8) > load<uint32_t>(DATA_SIZE_FIELD)
+            || _data[record + 18] > static_cast<byte>(SectionType::ROMX) || _data[record + 20] > ObjectSection::MAXIMUM_ALIGNMENT) {
+            fail("malformed section");
+        }
+    }
+    const size_t numberOfSymbols = number_of_symbols();
+    for (size_t index = 0; index < numberOfSymbols; ++index) {
+        const size_t record = load<uint32_t>(SYMBOLS_FIELD) + index * SYMBOL_RECORD_SIZE;
+        check_string(load<uint32_t>(record));
+        const uint32_t section = load<uint32_t>(record + 4);
+        if (section >= numberOfSections && section != ObjectSymbol::UNDEFINED && section != ObjectSymbol::ABSOLUTE) {
+            fail("malformed symbol");
+        }
+    }
+    const size_t numberOfInstructions = load<uint32_t>(INSTRUCTION_COUNT_FIELD);
+    const size_t numberOfRelocations = number_of_relocations();
+    for (size_t index = 0; index < numberOfRelocations; ++index) {
+        const Relocation relocation = this->relocation(index);
+        if (relocation.section >= numberOfSections || relocation.kind > FixupKind::BIT_INDEX || relocation.file >= numberOfFiles
+            || static_cast<uint64_t>(relocation.offset) + fixup_width(relocation.kind) > section(relocation.section).size
+            || static_cast<uint64_t>(relocation.firstInstruction) + relocation.numberOfInstructions > numberOfInstructions) {
+            fail("malformed relocation");
+        }
+    }
+    for (size_t index = 0; index < numberOfInstructions; ++index) {
+        const Expression::Instruction instruction = this->instruction(index);
+        if (instruction.operation > ExpressionOperation::OR
+            || (instruction.operation == ExpressionOperation::PUSH_SYMBOL
+                && (instruction.operand < 0 || static_cast<size_t>(instruction.operand) >= numberOfSymbols))) {
+            fail("malformed expression");
+        }
+    }
+    const size_t numberOfCodeRanges = number_of_code_ranges();
+    for (size_t index = 0; index < numberOfCodeRanges; ++index) {
+        const CodeRange codeRange = code_range(index);
+        if (codeRange.section >= numberOfSections
+            || static_cast<uint64_t>(codeRange.offset) + codeRange.size > section(codeRange.section).size) {
+            fail("malformed code range");
+        }
+    }
+}
+
+template<typename T>
+T ObjectFileView::load(const size_t offset) const {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<T>(_data[offset + i]) << (8 * i));
+    }
+    return value;
+}
+
+std::string_view ObjectFileView::string_at(const uint32_t offset) const {
+    return std::string_view(reinterpret_cast<const char*>(_data + load<uint32_t>(STRINGS_FIELD) + offset));
+}
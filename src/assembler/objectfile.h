@@ -0,0 +1,218 @@
+#ifndef GAMEBOY_DISASSEMBLE_OBJECTFILE_H
+#define GAMEBOY_DISASSEMBLE_OBJECTFILE_H
+
+#include "expression.h"
+#include "fixup.h"
+#include "mappedfile.h"
+#include "../instructions/constants.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Enumerator for the ROM areas a section may be placed in.
+ */
+enum class SectionType : uint8_t {
+    ROM0, ///< bank 0, mapped to the addresses 0x0000 - 0x3FFF
+    ROMX  ///< one of the switchable banks 1, 2, ..., mapped to the addresses 0x4000 - 0x7FFF
+};
+
+/**
+ * A contiguous block of assembled bytes, which the linker places into a ROM bank.
+ * Sections without a fixed bank or address are placed wherever they fit.
+ */
+struct ObjectSection {
+    static constexpr uint8_t MAXIMUM_ALIGNMENT = 14; ///< a section aligned to 2^14 bytes starts at the beginning of a bank
+
+    std::string name{};             ///< name of the section, unique among all linked object files
+    SectionType type{SectionType::ROM0}; ///< the ROM area of the section
+    std::optional<uint32_t> bank{}; ///< the bank the section is pinned to, if any
+    std::optional<word> address{};  ///< the address the section is pinned to (set by ORG), if any
+    Bytestring data{};              ///< the assembled bytes
+    uint8_t alignment{0};           ///< number of low bits of the section's address which are zero
+    std::vector<std::pair<uint32_t, uint32_t>> codeRanges{}; ///< offset and size of each run of instructions in the data
+};
+
+/**
+ * A symbol defined or referred to by an object file.
+ */
+struct ObjectSymbol {
+    static constexpr uint32_t UNDEFINED = static_cast<uint32_t>(-1); ///< section of symbols defined by another object file
+    static constexpr uint32_t ABSOLUTE = static_cast<uint32_t>(-2);  ///< section of constants and labels in pinned sections
+
+    std::string name{};
+    uint32_t section{UNDEFINED}; ///< index of the section the symbol is defined in, or UNDEFINED or ABSOLUTE
+    long value{0};               ///< the offset within the section, or the absolute value
+    bool isExported{false};      ///< true if other object files may refer to the symbol
+    bool isLabel{false};         ///< true for labels, to whose addresses relative jumps are calculated
+};
+
+/**
+ * Operand in a section's bytes which depends on symbols whose values are only known once the sections are placed.
+ * The value of the expression is converted like a Fixup of the same kind and patched into the section.
+ */
+struct Relocation {
+    uint32_t section{0};   ///< index of the section containing the operand
+    uint32_t offset{0};    ///< position of the operand in the section's bytes
+    word address{0};       ///< offset of the instruction containing the operand within the section, needed for relative jumps
+    FixupKind kind{FixupKind::NUMBER_8_BIT};
+    uint32_t file{0};      ///< index of the source file of the operand, used for error messages
+    uint32_t line{0};      ///< line of the operand, used for error messages
+    uint32_t column{0};    ///< column of the operand, used for error messages
+    Expression expression{}; ///< the operand's value, whose symbol IDs are indices into the object file's symbols
+};
+
+/**
+ * Struct ObjectFile. The result of assembling one source file on its own,
+ * which is combined with other object files by the Linker.
+ */
+struct ObjectFile {
+    std::vector<std::string> files{};  ///< the source file (index 0), all files included by it and all binary files
+    std::vector<uint64_t> fileHashes{}; ///< FNV-1a hash of the content of each file, used for detecting changed sources
+    std::vector<ObjectSection> sections{};
+    std::vector<ObjectSymbol> symbols{};
+    std::vector<Relocation> relocations{};
+};
+
+/**
+ * Encodes @p objectFile in the binary object format read by ObjectFileView.
+ * @param objectFile the object file
+ * @return the encoded object file
+ */
+Bytestring serialize_object_file(const ObjectFile &objectFile);
+
+/**
+ * Class ObjectFileView. Read-only access to an object file in the binary object format,
+ * which is used in place, e.g. directly from a memory-mapped file, without decoding it into an ObjectFile.
+ *
+ * The format starts with a header holding the number and the position of each table, followed by the tables
+ * of files, sections, symbols, relocations, expression instructions and code ranges, which consist of fixed-size records,
+ * and by the string blob and the bytes of all sections. Names are offsets into the string blob,
+ * where each distinct string is stored once. All numbers are stored in little endian byte order.
+ */
+class ObjectFileView {
+public:
+    static constexpr uint32_t MAGIC = 0x46424F47;  ///< "GOBF" in little endian byte order
+    static constexpr uint32_t VERSION = 3;          ///< incremented with every change of the format
+
+    /**
+     * A section of the object file, whose bytes and name point into the object file.
+     */
+    struct Section {
+        std::string_view name{};
+        SectionType type{SectionType::ROM0};
+        std::optional<uint32_t> bank{};
+        std::optional<word> address{};
+        const byte *data{nullptr};
+        size_t size{0};
+        uint8_t alignment{0};
+    };
+
+    /**
+     * A symbol of the object file, whose name points into the object file.
+     */
+    struct Symbol {
+        std::string_view name{};
+        uint32_t section{ObjectSymbol::UNDEFINED};
+        long value{0};
+        bool isExported{false};
+        bool isLabel{false};
+    };
+
+    /**
+     * A relocation of the object file, whose expression consists of the instructions
+     * firstInstruction, ..., firstInstruction + numberOfInstructions - 1.
+     */
+    struct Relocation {
+        uint32_t section{0};
+        uint32_t offset{0};
+        word address{0};
+        FixupKind kind{FixupKind::NUMBER_8_BIT};
+        uint32_t file{0};
+        uint32_t line{0};
+        uint32_t column{0};
+        uint32_t firstInstruction{0};
+        uint32_t numberOfInstructions{0};
+    };
+
+    /**
+     * A run of instructions within the bytes of a section.
+     */
+    struct CodeRange {
+        uint32_t section{0};
+        uint32_t offset{0};
+        uint32_t size{0};
+    };
+
+    /**
+     * Constructor. Uses the object file mapped by @p file.
+     * @throws std::runtime_error if the file is not a valid object file of this version
+     * @param file the mapped object file
+     */
+    explicit ObjectFileView(std::shared_ptr<const MappedFile> file);
+
+    /**
+     * Constructor. Uses the object file encoded in @p bytes.
+     * @throws std::runtime_error if the bytes are not a valid object file of this version
+     * @param bytes the encoded object file
+     */
+    explicit ObjectFileView(std::shared_ptr<const Bytestring> bytes);
+
+    size_t number_of_files() const noexcept;
+
+    size_t number_of_sections() const noexcept;
+
+    size_t number_of_symbols() const noexcept;
+
+    size_t number_of_relocations() const noexcept;
+
+    size_t number_of_code_ranges() const noexcept;
+
+    std::string_view file(const size_t index) const;
+
+    uint64_t file_hash(const size_t index) const;
+
+    Section section(const size_t index) const;
+
+    Symbol symbol(const size_t index) const;
+
+    Relocation relocation(const size_t index) const;
+
+    Expression::Instruction instruction(const size_t index) const;
+
+    CodeRange code_range(const size_t index) const;
+
+private:
+    /**
+     * Checks the header and all records, so that the accessors need no further checks.
+     * @throws std::runtime_error if the object file is malformed
+     */
+    void validate() const;
+
+    /**
+     * Reads the little endian number of type @p T at @p offset.
+     * @tparam T unsigned integer type
+     * @param offset position in the object file
+     * @return the number
+     */
+    template<typename T>
+    T load(const size_t offset) const;
+
+    /**
+     * Returns the string starting at @p offset of the string blob.
+     * @param offset position in the string blob
+     * @return the string
+     */
+    std::string_view string_at(const uint32_t offset) const;
+
+    std::shared_ptr<const void> _owner{}; ///< the mapped file or the buffer holding the object file
+    const byte *_data{nullptr};           ///< first byte of the object file
+    size_t _size{0};                      ///< size of the object file in bytes
+};
+
+#endif //GAMEBOY_DISASSEMBLE_OBJECTFILE_H
@@ -1,6 +1,7 @@
 #include "parser.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 bool Parser::is_finished() const noexcept {
     return (_currentTokenPosition >= _tokenVector.size());
@@ -64,23 +65,363 @@ Token Parser::fetch_and_expect(const std::vector<TokenType> expectedTypes) {
 }
 
 const std::string &Parser::get_code() const noexcept {
-    return _code;
+    return *_sources.front().code;
 }
 
 void Parser::throw_logic_error_and_highlight(const Token &token, const std::string &errorMessage) const {
-    ::throw_exception_and_highlight(get_code(), token.get_line(), token.get_column(), errorMessage,
-                                    token.get_string().size());
+    throw SourceError(to_string_highlighted(token, errorMessage),
+                      SourceSpan{token.get_line(), token.get_column(), token.get_string().size()});
 }
 
 void Parser::throw_logic_error_and_highlight_with_reference(const Token &token, const Token &referenceToken, const std::string &errorMessage) const {
-    ::throw_exception_and_highlight_with_reference(get_code(), token.get_line(), token.get_column(),
-                                                   referenceToken.get_line(), referenceToken.get_column(),
-                                                   errorMessage, token.get_string().size(), referenceToken.get_string().size());
+    std::string message = to_string_highlighted(token, errorMessage);
+
+    // the referenced expression may stem from another file
+    const SourceFile &referenceSource = _sources[referenceToken.get_file_index()];
+    if (!referenceSource.code->empty()) {
+        message += "This expression is referring to\n" + to_string_file_prefix(referenceToken);
+        message += to_string_line_and_highlight(*referenceSource.code, *referenceSource.lineIndex, referenceToken.get_line(),
+                                                referenceToken.get_column(), referenceToken.get_string().size());
+    }
+    throw SourceError(message, SourceSpan{token.get_line(), token.get_column(), token.get_string().size()});
+}
+
+void Parser::report_and_highlight(const Token &token, const std::string &errorMessage) {
+    _diagnostics.report(SourceError(to_string_highlighted(token, errorMessage),
+                                    SourceSpan{token.get_line(), token.get_column(), token.get_string().size()}));
 }
 
 void Parser::throw_invalid_argument_and_highlight(const Token &token, const std::string &errorMessage) const {
-    ::throw_exception_and_highlight<std::invalid_argument>(get_code(), token.get_line(), token.get_column(), errorMessage,
-                                                           token.get_string().size());
+    throw_logic_error_and_highlight(token, errorMessage);
+}
+
+std::string Parser::to_string_highlighted(const Token &token, const std::string &errorMessage) const {
+    const SourceFile &source = _sources[token.get_file_index()];
+    return to_string_file_prefix(token) +
+           to_string_error_and_highlight(*source.code, *source.lineIndex, token.get_line(), token.get_column(),
+                                         errorMessage, token.get_string().size());
+}
+
+std::string Parser::to_string_file_prefix(const Token &token) const {
+    return (token.get_file_index() == 0) ? "" : "In file \"" + _sources[token.get_file_index()].path + "\":\n";
+}
+
+void Parser::relocate(const Fixup &fixup) {
+    const Token &token = _tokenVector[fixup.tokenIndex];
+    Expression expression{};
+    try {
+        append_relocatable_value(expression, fixup.symbolId);
+    } catch (const std::domain_error &error) {
+        throw_logic_error_and_highlight(token, std::string("Parse error: ") + error.what());
+    }
+
+    const size_t section = find_section(fixup.offset);
+    _relocations.push_back(Relocation{static_cast<uint32_t>(section),
+                                      static_cast<uint32_t>(fixup.offset - _sectionStarts[section]),
+                                      fixup.address,
+                                      fixup.kind,
+                                      static_cast<uint32_t>(token.get_file_index()),
+                                      static_cast<uint32_t>(token.get_line()),
+                                      static_cast<uint32_t>(token.get_column()),
+                                      std::move(expression)});
+}
+
+void Parser::append_relocatable_value(Expression &expression, const SymbolId symbolId) const {
+    const std::optional<NumericFromToken> &symbol = _symbols[symbolId];
+    if (symbol.has_value() && !is_relocatable_symbol(symbolId)) {
+        expression.push_constant(symbol->get_numeric());
+        return;
+    }
+
+    const auto iterator = _deferredExpressionIndices.find(symbolId);
+    if (symbol.has_value() || iterator == _deferredExpressionIndices.cend()) { // relocatable label or symbol of another file
+        expression.push_symbol(symbolId);
+        return;
+    }
+
+    // recursive definitions have been assigned a value when evaluated, hence the inlining terminates
+    for (const Expression::Instruction &instruction : _deferredExpressions[iterator->second].expression.get_instructions()) {
+        if (instruction.operation == ExpressionOperation::PUSH_CONSTANT) {
+            expression.push_constant(instruction.operand);
+        } else if (instruction.operation == ExpressionOperation::PUSH_SYMBOL) {
+            append_relocatable_value(expression, static_cast<SymbolId>(instruction.operand));
+        } else {
+            expression.apply(instruction.operation);
+        }
+    }
+}
+
+void Parser::run_passes() {
+    if (_isRelaxingBranches || _isOptimizing) { // further passes may be needed
+        _passInputs->tokens = _tokenVector;
+    }
+    parse_with_relaxation();
+    resolve_symbols();
+    if (_isOptimizing && !_diagnostics.has_errors()) {
+        std::unordered_map<size_t, PeepholeRewrite> rewrites = find_peephole_rewrites();
+        if (!rewrites.empty()) {
+            restart();
+            _rewrites = std::move(rewrites);
+            parse_with_relaxation();
+            resolve_symbols();
+        }
+    }
+    if (!_isRelocatable) {
+        check_output_blocks();
+    }
+}
+
+void Parser::check_output_blocks() {
+    // the blocks are visited in the order of their addresses, each is compared with the furthest reaching block before it
+    std::vector<size_t> order{};
+    for (size_t index = 0; index < _outputBlocks.size(); ++index) {
+        const size_t end = (index + 1 < _outputBlocks.size()) ? _outputBlocks[index + 1].offset : _output.size();
+        if (end > _outputBlocks[index].offset) {
+            order.push_back(index);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](const size_t lhs, const size_t rhs) {
+        return _outputBlocks[lhs].address < _outputBlocks[rhs].address;
+    });
+
+    const auto block_end = [&](const size_t index) {
+        const size_t end = (index + 1 < _outputBlocks.size()) ? _outputBlocks[index + 1].offset : _output.size();
+        return _outputBlocks[index].address + (end - _outputBlocks[index].offset);
+    };
+    std::optional<size_t> furthest{};
+    for (const size_t index : order) {
+        if (furthest.has_value() && _outputBlocks[index].address < block_end(*furthest)) {
+            const size_t later = std::max(index, *furthest); // the block starting later in the source has an ORG
+            const size_t earlier = std::min(index, *furthest);
+            report_and_highlight(_outputBlocks[later].orgToken, "Parse error: The code at " + to_string_hex_prefixed(_outputBlocks[later].address) +
+                                 " overlaps the code at " + to_string_hex_prefixed(_outputBlocks[earlier].address) +
+                                 ", which reaches up to " + to_string_hex_prefixed(static_cast<word>(block_end(earlier) - 1)));
+        }
+        if (!furthest.has_value() || block_end(index) > block_end(*furthest)) {
+            furthest = index;
+        }
+    }
+}
+
+std::unordered_map<size_t, PeepholeRewrite> Parser::find_peephole_rewrites() const {
+    std::unordered_set<Address> labelAddresses{};
+    for (const std::optional<NumericFromToken> &symbol : _symbols) {
+        if (symbol.has_value() && (symbol->get_token().get_token_type() == TokenType::GLOBAL_LABEL
+                                || symbol->get_token().get_token_type() == TokenType::LOCAL_LABEL)) {
+            labelAddresses.insert(static_cast<Address>(symbol->get_numeric()));
+        }
+    }
+
+    std::vector<PeepholeInstruction> instructions{};
+    instructions.reserve(_instructionOffsets.size());
+    for (size_t index = 0; index < _instructionOffsets.size(); ++index) {
+        const size_t offset = _instructionOffsets[index];
+        const bool isRelocatable = _isRelocatable && !_sections[find_section(offset)].address.has_value();
+        instructions.push_back(PeepholeInstruction{offset, _instructionAddresses[index],
+                                                   labelAddresses.count(_instructionAddresses[index]) > 0, isRelocatable, false});
+    }
+    for (const Relocation &relocation : _relocations) { // the instruction containing the operand is the last one starting before it
+        const size_t offset = _sectionStarts[relocation.section] + relocation.offset;
+        const auto iterator = std::upper_bound(_instructionOffsets.cbegin(), _instructionOffsets.cend(), offset);
+        if (iterator != _instructionOffsets.cbegin()) {
+            instructions[static_cast<size_t>(iterator - _instructionOffsets.cbegin()) - 1].hasRelocation = true;
+        }
+    }
+
+    return PeepholeOptimizer(_output, instructions, !_isRelocatable).find_rewrites();
+}
+
+bool Parser::emit_rewritten(const size_t instructionIndex, const BaseInstruction &instruction) {
+    const auto iterator = _rewrites.find(instructionIndex);
+    if (iterator == _rewrites.cend()) {
+        return false;
+    }
+    const PeepholeRewrite &rewrite = iterator->second;
+    const PeepholeRule &rule = PeepholeOptimizer::get_rules()[rewrite.rule];
+    const PeepholePattern &pattern = rule.patterns[rewrite.position];
+
+    Bytestring bytes{};
+    instruction.append_bytestr_to(bytes);
+    if (!PeepholeOptimizer::matches(pattern, bytes) || (pattern.immediate.has_value() && _pendingFixup.has_value())) {
+        return false;
+    }
+    if (rewrite.position > 0) { // removed if the first instruction of the sequence has been replaced
+        return _replacedInstruction == instructionIndex - rewrite.position;
+    }
+
+    Bytestring replacement{rule.opcode};
+    if (rule.operand == PeepholeOperand::KEPT) {
+        replacement.insert(replacement.end(), bytes.cbegin() + 1, bytes.cend());
+    } else if (rule.operand == PeepholeOperand::RELATIVE) {
+        if (_pendingFixup.has_value()) { // a forward jump, which is relaxed like JMP
+            if (!_isRelaxingBranches || _longJumps.count(instructionIndex) > 0) {
+                return false;
+            }
+            _pendingFixup->kind = FixupKind::RELATIVE_OFFSET;
+            replacement.push_back(0);
+        } else {
+            const long offset = relative_jump_offset(bytes[1] | (bytes[2] << 8), _currentAddress);
+            if ((_isRelocatable && !_sections.back().address.has_value()) || !is_signed_8_bit(offset)) {
+                return false;
+            }
+            replacement.push_back(static_cast<byte>(offset));
+        }
+    }
+
+    const bool isRelaxable = _pendingFixup.has_value() && rule.operand == PeepholeOperand::RELATIVE;
+    record_instruction(replacement.size());
+    _output.insert(_output.end(), replacement.cbegin(), replacement.cend());
+    record_pending_fixup();
+    if (isRelaxable) {
+        _relaxableJumps.push_back(RelaxableJump{_fixups.size() - 1, instructionIndex, _sections.size() - 1});
+    }
+    _currentAddress += static_cast<Address>(replacement.size());
+
+    _replacedInstruction = instructionIndex;
+    PeepholeStatistics &statistics = _peepholeStatistics[rewrite.rule];
+    ++statistics.applications;
+    statistics.bytesSaved += rule.bytesSaved;
+    statistics.cyclesSaved += rule.cyclesSaved;
+    return true;
+}
+
+void Parser::parse_with_relaxation() {
+    pre_parse();
+    while (_isRelaxingBranches && !_diagnostics.has_errors() && lengthen_out_of_range_jumps()) {
+        restart();
+        pre_parse();
+    }
+}
+
+bool Parser::lengthen_out_of_range_jumps() {
+    bool isLengthened = false;
+    for (const RelaxableJump &jump : _relaxableJumps) {
+        const Fixup &fixup = _fixups[jump.fixupIndex];
+        const std::optional<NumericFromToken> &symbol = _symbols[fixup.symbolId];
+
+        // only labels are relative to the jump, and only if both are absolute or in the same relocatable section
+        bool isInRange = false;
+        if (symbol.has_value() && (symbol->get_token().get_token_type() == TokenType::GLOBAL_LABEL
+                                || symbol->get_token().get_token_type() == TokenType::LOCAL_LABEL)) {
+            const bool isSectionRelocatable = _isRelocatable && !_sections[jump.sectionIndex].address.has_value();
+            const bool isSameSpace = is_relocatable_symbol(fixup.symbolId) ? isSectionRelocatable && _relocatableSymbols.at(fixup.symbolId) == jump.sectionIndex
+                                                                           : !isSectionRelocatable;
+            isInRange = isSameSpace && is_signed_8_bit(relative_jump_offset(symbol->get_numeric(), fixup.address));
+        }
+        if (!isInRange) {
+            isLengthened = _longJumps.insert(jump.instructionIndex).second || isLengthened;
+        }
+    }
+    return isLengthened;
+}
+
+void Parser::restart() {
+    Parser parser(std::string{}, TokenVector{});
+    parser._sources.assign(1, _sources.front());
+    parser._tokenVector = _passInputs->tokens;
+    parser._passInputs = std::move(_passInputs);
+    parser._tokenCache = _tokenCache;
+    parser._numberOfThreads = _numberOfThreads;
+    parser._minimumFixupsPerThread = _minimumFixupsPerThread;
+    parser._isRelocatable = _isRelocatable;
+    parser._isRelaxingBranches = _isRelaxingBranches;
+    parser._longJumps = std::move(_longJumps);
+    parser._isOptimizing = _isOptimizing;
+    parser._rewrites = std::move(_rewrites);
+    parser._numberOfPasses = _numberOfPasses + 1;
+    *this = std::move(parser);
+}
+
+ObjectFile Parser::build_object_file() const {
+    ObjectFile objectFile{};
+    for (const SourceFile &source : _sources) {
+        objectFile.files.push_back(source.path);
+        objectFile.fileHashes.push_back(fnv1a_hash(*source.code));
+    }
+    for (const auto &[path, hash] : _binaryFiles) {
+        objectFile.files.push_back(path);
+        objectFile.fileHashes.push_back(hash);
+    }
+
+    // the section of the code preceding the first SECTION is omitted if there is none
+    const size_t firstEnd = (_sections.size() > 1) ? _sectionStarts[1] : _output.size();
+    const size_t firstSection = (firstEnd == 0) ? 1 : 0;
+    for (size_t index = firstSection; index < _sections.size(); ++index) {
+        const size_t end = (index + 1 < _sections.size()) ? _sectionStarts[index + 1] : _output.size();
+        ObjectSection section = _sections[index];
+        section.data.assign(_output.begin() + _sectionStarts[index], _output.begin() + end);
+        for (const auto &[offset, size] : find_code_ranges(_sectionStarts[index], end)) {
+            section.codeRanges.emplace_back(static_cast<uint32_t>(offset - _sectionStarts[index]), static_cast<uint32_t>(size));
+        }
+        if (index == 0) {
+            section.name = _sources.front().path;
+        }
+        objectFile.sections.push_back(std::move(section));
+    }
+
+    std::vector<const std::string*> names(_symbols.size());
+    for (const auto &[name, symbolId] : _symbolIds) {
+        names[symbolId] = &name;
+    }
+
+    // only exported symbols and the symbols referred to by relocations are part of the object file
+    std::unordered_map<SymbolId, uint32_t> objectSymbolIndices{};
+    const auto add_symbol = [&](const SymbolId symbolId) {
+        const auto [iterator, isInserted] = objectSymbolIndices.emplace(symbolId, static_cast<uint32_t>(objectFile.symbols.size()));
+        if (isInserted) {
+            ObjectSymbol objectSymbol{*names[symbolId], ObjectSymbol::UNDEFINED, 0, false, false};
+            const std::optional<NumericFromToken> &symbol = _symbols[symbolId];
+            if (symbol.has_value()) {
+                const TokenType tokenType = symbol->get_token().get_token_type();
+                objectSymbol.isLabel = (tokenType == TokenType::GLOBAL_LABEL || tokenType == TokenType::LOCAL_LABEL);
+                const auto relocatable = _relocatableSymbols.find(symbolId);
+                objectSymbol.section = (relocatable == _relocatableSymbols.cend()) ? ObjectSymbol::ABSOLUTE
+                                                                                    : static_cast<uint32_t>(relocatable->second - firstSection);
+                objectSymbol.value = symbol->get_numeric();
+            }
+            objectFile.symbols.push_back(std::move(objectSymbol));
+        }
+        return iterator->second;
+    };
+
+    for (const SymbolId symbolId : _exportedSymbols) {
+        if (_symbols[symbolId].has_value()) { // constants depending on relocatable symbols are only known within the file
+            objectFile.symbols[add_symbol(symbolId)].isExported = true;
+        }
+    }
+    for (const Relocation &relocation : _relocations) {
+        Relocation objectRelocation = relocation;
+        objectRelocation.section -= static_cast<uint32_t>(firstSection);
+        objectRelocation.expression = Expression{};
+        for (const Expression::Instruction &instruction : relocation.expression.get_instructions()) {
+            if (instruction.operation == ExpressionOperation::PUSH_CONSTANT) {
+                objectRelocation.expression.push_constant(instruction.operand);
+            } else if (instruction.operation == ExpressionOperation::PUSH_SYMBOL) {
+                objectRelocation.expression.push_symbol(add_symbol(static_cast<SymbolId>(instruction.operand)));
+            } else {
+                objectRelocation.expression.apply(instruction.operation);
+            }
+        }
+        objectFile.relocations.push_back(std::move(objectRelocation));
+    }
+    return objectFile;
+}
+
+std::vector<std::pair<size_t, size_t>> Parser::find_code_ranges(const size_t begin, const size_t end) const {
+    std::vector<std::pair<size_t, size_t>> codeRanges{};
+    for (const auto &[offset, size] : _codeRanges) { // ranges may span section boundaries
+        const size_t codeBegin = std::max(offset, begin);
+        const size_t codeEnd = std::min(offset + size, end);
+        if (codeBegin < codeEnd) {
+            codeRanges.emplace_back(codeBegin, codeEnd - codeBegin);
+        }
+    }
+    return codeRanges;
+}
+
+size_t Parser::find_section(const size_t offset) const {
+    // empty sections share their start with the following section, which contains the byte
+    return static_cast<size_t>(std::upper_bound(_sectionStarts.cbegin(), _sectionStarts.cend(), offset) - _sectionStarts.cbegin()) - 1;
 }
 
 long Parser::to_number(const Token &numToken) const {
@@ -98,57 +439,80 @@ long Parser::to_number(const Token &numToken) const {
 }
 
 long Parser::to_number_conditional(const Token &numToken, const std::function<bool(long)> &condition, const std::string &errorStr) const {
-    long tokenNumber = to_number(numToken);
+    return check_number_conditional(numToken, to_number(numToken), condition, errorStr);
+}
 
-    if (!condition(tokenNumber)) {
+long Parser::check_number_conditional(const Token &numToken, const long number, const std::function<bool(long)> &condition, const std::string &errorStr) const {
+    if (!condition(number)) {
         // Get the reference token (e.g. a global or local label, or a constant) if present
         const Token referenceToken = determine_reference_token(numToken);
 
         if (referenceToken.is_invalid()) {
             throw_logic_error_and_highlight(numToken,
-                                            "Parse error: Number " + std::to_string(tokenNumber) +
+                                            "Parse error: Number " + std::to_string(number) +
                                             " is expected to be " + errorStr);
         } else {
             throw_logic_error_and_highlight_with_reference(numToken, referenceToken,
-                                                           "Parse error: Number " + std::to_string(tokenNumber) +
+                                                           "Parse error: Number " + std::to_string(number) +
                                                            " is expected to be " + errorStr);
         }
     }
-    return tokenNumber;
+    return number;
+}
+
+long Parser::check_value(const Token &token, const long value, const FixupKind kind, const size_t referenceAddress) const {
+    switch (kind) {
+        case FixupKind::NUMBER_8_BIT:           return check_number_conditional(token, value, is_8_bit<long>, "8-bit");
+        case FixupKind::UNSIGNED_NUMBER_8_BIT:  return check_number_conditional(token, value, is_unsigned_8_bit<long>, "unsigned 8-bit");
+        case FixupKind::SIGNED_NUMBER_8_BIT:    return check_number_conditional(token, value, is_signed_8_bit<long>, "signed 8-bit");
+        case FixupKind::NUMBER_16_BIT:          return check_number_conditional(token, value, is_16_bit<long>, "16-bit");
+        case FixupKind::UNSIGNED_NUMBER_16_BIT: return check_number_conditional(token, value, is_unsigned_16_bit<long>, "unsigned 16-bit");
+        case FixupKind::RELATIVE_OFFSET:        return check_relative_offset(token, check_value(token, value, FixupKind::UNSIGNED_NUMBER_16_BIT), referenceAddress);
+        case FixupKind::BIT_INDEX:              return check_index(token, value);
+    }
+    return value;
 }
 
-byte Parser::to_number_8_bit(const Token &numToken) const {
-    return static_cast<byte>(to_number_conditional(numToken, is_8_bit<long>, "8-bit"));
+byte Parser::to_number_8_bit(const Token &numToken) {
+    if (defer_if_unresolved(numToken, FixupKind::NUMBER_8_BIT)) { return 0; }
+    return static_cast<byte>(check_value(numToken, to_number(numToken), FixupKind::NUMBER_8_BIT));
 }
 
-byte Parser::to_unsigned_number_8_bit(const Token &numToken) const {
-    return static_cast<byte>(to_number_conditional(numToken, is_unsigned_8_bit<long>, "unsigned 8-bit"));
+byte Parser::to_unsigned_number_8_bit(const Token &numToken) {
+    if (defer_if_unresolved(numToken, FixupKind::UNSIGNED_NUMBER_8_BIT)) { return 0; }
+    return static_cast<byte>(check_value(numToken, to_number(numToken), FixupKind::UNSIGNED_NUMBER_8_BIT));
 }
 
-byte Parser::to_signed_number_8_bit(const Token &numToken) const {
-    return static_cast<byte>(to_number_conditional(numToken, is_signed_8_bit<long>, "signed 8-bit"));
+byte Parser::to_signed_number_8_bit(const Token &numToken) {
+    if (defer_if_unresolved(numToken, FixupKind::SIGNED_NUMBER_8_BIT)) { return 0; }
+    return static_cast<byte>(check_value(numToken, to_number(numToken), FixupKind::SIGNED_NUMBER_8_BIT));
 }
 
-long Parser::to_number_16_bit(const Token &numToken) const {
-    return to_number_conditional(numToken, is_16_bit<long>, "16-bit");
+long Parser::to_number_16_bit(const Token &numToken) {
+    if (defer_if_unresolved(numToken, FixupKind::NUMBER_16_BIT)) { return 0; }
+    return check_value(numToken, to_number(numToken), FixupKind::NUMBER_16_BIT);
 }
 
-long Parser::to_unsigned_number_16_bit(const Token &numToken) const {
-    return to_number_conditional(numToken, is_unsigned_16_bit<long>, "unsigned 16-bit");
+long Parser::to_unsigned_number_16_bit(const Token &numToken) {
+    if (defer_if_unresolved(numToken, FixupKind::UNSIGNED_NUMBER_16_BIT)) { return 0; }
+    return check_value(numToken, to_number(numToken), FixupKind::UNSIGNED_NUMBER_16_BIT);
 }
 
-byte Parser::to_relative_offset(const Token &positionToken, const size_t referenceAddress) const
+byte Parser::to_relative_offset(const Token &positionToken, const size_t referenceAddress)
 {
-    long tokenValue = to_unsigned_number_16_bit(positionToken);
+    if (defer_if_unresolved(positionToken, FixupKind::RELATIVE_OFFSET)) { return 0; }
+    return static_cast<byte>(check_value(positionToken, to_number(positionToken), FixupKind::RELATIVE_OFFSET, referenceAddress));
+}
 
+long Parser::check_relative_offset(const Token &positionToken, const long tokenValue, const size_t referenceAddress) const {
     // In case the positionToken is referring to a label, we must treat it differently
     const Token referenceToken = determine_reference_token(positionToken);
     const TokenType referenceType = referenceToken.get_token_type();
 
     long offset;
     if (referenceType == TokenType::LOCAL_LABEL || referenceType == TokenType::GLOBAL_LABEL) {
-        // the offset is determined by the number of words between the referenceAddress and the label's address
-        offset = tokenValue - referenceAddress;
+        // the offset is the distance between the label and the instruction following the jump
+        offset = relative_jump_offset(tokenValue, static_cast<long>(referenceAddress));
     } else {
         // otherwise it is the plain numeric value of the token
         offset = tokenValue;
@@ -156,7 +520,7 @@ byte Parser::to_relative_offset(const Token &positionToken, const size_t referen
 
     if (!(is_signed_8_bit(offset))) {
         const std::string errorMessage = "Parse error: The goal \"" + positionToken.get_string() +
-                                         "\" results in a jump of " + to_string_hex_signed_prefixed(offset) + ", which is not a signed 8-bit number. Please use JP instead of JR";
+                                         "\" results in a jump of " + to_string_hex_signed_prefixed(offset) + ", which is not a signed 8-bit number. Please use JP or JMP instead of JR";
         if (referenceType == TokenType::INVALID) { // token contains no reference
             throw_logic_error_and_highlight(positionToken, errorMessage);
         } else {
@@ -166,13 +530,33 @@ byte Parser::to_relative_offset(const Token &positionToken, const size_t referen
     return offset;
 }
 
-byte Parser::to_index(const Token &indexToken) const {
-    const long num = to_number(indexToken);
-    if (!is_index(num)) {
+std::optional<long> Parser::known_jump_distance(const Token &targetToken) const {
+    const bool isSectionRelocatable = _isRelocatable && !_sections.back().address.has_value();
+    if (targetToken.has_numeric_value()) { // an absolute address
+        return isSectionRelocatable ? std::nullopt : std::optional<long>(relative_jump_offset(to_number(targetToken), _currentAddress));
+    }
+
+    const auto iterator = _symbolIds.find(targetToken.get_string());
+    if (iterator == _symbolIds.cend() || !_symbols[iterator->second].has_value()) {
+        return std::nullopt;
+    }
+    const bool isSameSpace = is_relocatable_symbol(iterator->second) ? isSectionRelocatable && _relocatableSymbols.at(iterator->second) == _sections.size() - 1
+                                                                     : !isSectionRelocatable;
+    return isSameSpace ? std::optional<long>(relative_jump_offset(_symbols[iterator->second]->get_numeric(), _currentAddress))
+                       : std::nullopt;
+}
+
+byte Parser::to_index(const Token &indexToken) {
+    if (defer_if_unresolved(indexToken, FixupKind::BIT_INDEX)) { return 0; }
+    return static_cast<byte>(check_value(indexToken, to_number(indexToken), FixupKind::BIT_INDEX));
+}
+
+long Parser::check_index(const Token &indexToken, const long number) const {
+    if (!is_index(number)) {
         throw_logic_error_and_highlight(indexToken, "Parse error: Found expression \"" + indexToken.get_string() +
                                                     "\" but expected index (0, ..., 7)");
     }
-    return num;
+    return number;
 }
 
 FlagCondition Parser::to_flag_condition(const Token &conditionToken) const {
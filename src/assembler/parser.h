@@ -2,64 +2,394 @@
 #define GAMEBOY_DISASSEMBLE_PARSER_H
 
 #include "auxiliary.h"
+#include "diagnostics.h"
+#include "expression.h"
+#include "fixup.h"
+#include "mappedfile.h"
 #include "numericfromtoken.h"
+#include "objectfile.h"
+#include "peephole.h"
+#include "romimage.h"
+#include "tokencache.h"
 #include "tokenizer.h"
-#include "unresolvedinstruction.h"
+#include "../disassembler/decoder.h"
 #include "../instructions/instructions.h"
+#include "../instructions/loopbounds.h"
 
 #include "pretty_format.h"
 
+#include <filesystem>
 #include <functional>
-#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 /**
  * Class Parser. Used for parsing tokens which are provided by a tokenizer.
  * This tokenizer is passed via dependency injection.
  *
- * In case of a parsing error, a std::logic_error containing a string with
- * the highlighted source code and an error message is thrown.
+ * The parser works in a single pass: every instruction is encoded into the output buffer
+ * as soon as it is parsed. Operands referring to symbols which are not defined yet are encoded
+ * as zero and recorded as a Fixup, and all fixups are patched in one linear pass at the end.
+ *
+ * The pseudo-instruction JMP is assembled as JR if its target is in range and as JP otherwise.
+ * Forward jumps are assumed to be in range while branch relaxation is enabled. If one of them turns out
+ * to be out of range, it is assembled as JP and the source is parsed again, until no jump needs lengthening.
+ *
+ * The optional peephole optimization matches the PeepholeOptimizer's rules against the assembled code,
+ * e.g. LD A, 0 followed by code overwriting the flags becomes XOR A. The matched instructions are rewritten
+ * while the source is parsed once more, so that the shrunk code gets its addresses assigned anew.
+ *
+ * Code is organized in sections, which start with SECTION. assemble() returns the bytes of all sections
+ * in source order, where ORG sets the address of the following code and starts a new output block,
+ * which get_output_blocks() returns for placing the code into a ROM image. assemble_object() instead
+ * assembles each section relocatably: labels in sections without ORG are section offsets, and operands
+ * referring to them or to symbols of other files become relocations which are resolved by the Linker.
+ *
+ * Parsing errors do not stop the parser: each error is recorded as a Diagnostic,
+ * the rest of the erroneous line is skipped and parsing resumes at the next line.
+ * Once all tokens are parsed, a std::logic_error containing every error message
+ * with the highlighted source code is thrown, unless the diagnostics are requested explicitly.
  */
 class Parser {
 public:
-    using SymbolToNumeric = std::map<std::string, NumericFromToken>;
     using Address = word;
     using TokenVectorPosition = size_t;
-    using ReturnedInstruction = std::function<InstructionPtr(void)>;
+
+    /**
+     * A contiguous part of the output of assemble(), i.e. the code preceding the first ORG or following an ORG.
+     */
+    struct OutputBlock {
+        size_t offset{0};    ///< position of the block's first byte in the output
+        Address address{0}; ///< address of the block's first byte
+        Token orgToken{};    ///< the address of the ORG starting the block, used for error messages
+    };
 
     /**
      * Default constructor
-     * @param tokenizer tokenizer which is needed for retrieving the tokens
+     * @param code the source code from which @p tokenVector has been generated
+     * @param tokenVector the tokens to parse
+     * @param path path of the source file, relative to which included files are searched
      */
-    Parser(const std::string &code, const TokenVector& tokenVector)
-    : _code(code),
+    Parser(const std::string &code, const TokenVector& tokenVector, const std::string &path = "")
+    : _sources{SourceFile{std::filesystem::path(path).lexically_normal().string(), std::make_shared<const std::string>(code),
+                          std::make_shared<const LineIndex>(code), SourceFile::NO_PARENT}},
       _tokenVector(tokenVector)
     {}
 
     /**
-     * Parses the _tokenVector and returns the _instructionVector by moving.
-     * This invalidates the current _instructionVector, as ownership is passed
+     * Sets the cache from which the tokens of included files are taken.
+     * Sharing one cache between several parsers, also on different threads, avoids tokenizing unchanged files again.
+     * @param tokenCache token cache
+     */
+    void set_token_cache(const std::shared_ptr<TokenCache> &tokenCache) {
+        _tokenCache = tokenCache;
+    }
+
+    /**
+     * Sets the number of threads used for resolving the fixups once all tokens are parsed.
+     * @param numberOfThreads maximum number of worker threads, 0 selects the number of hardware threads
+     * @param minimumFixupsPerThread minimum number of fixups per worker thread, fewer fixups are resolved serially
+     */
+    void set_resolution_threads(const size_t numberOfThreads, const size_t minimumFixupsPerThread = DEFAULT_MINIMUM_FIXUPS_PER_THREAD) {
+        _numberOfThreads = numberOfThreads;
+        _minimumFixupsPerThread = minimumFixupsPerThread;
+    }
+
+    /**
+     * Enables or disables the relaxation of forward JMP instructions, which is enabled by default.
+     * Without relaxation, forward jumps are always assembled as JP, so that a single pass suffices.
+     * Further passes parse a copy of the tokens passed to the constructor, without tokenizing or reading any file again.
+     * @param isRelaxing true if forward jumps are assembled as JR whenever their target is in range
+     */
+    void set_branch_relaxation(const bool isRelaxing) noexcept {
+        _isRelaxingBranches = isRelaxing;
+    }
+
+    /**
+     * Returns the number of passes over the source which the last assembly took, i.e. 1 unless jumps were lengthened.
+     * @return number of passes
+     */
+    size_t get_number_of_passes() const noexcept {
+        return _numberOfPasses;
+    }
+
+    /**
+     * Enables or disables the peephole optimization, which is disabled by default.
+     * Like branch relaxation, the pass applying the rewrites parses a copy of the tokens passed to the constructor.
+     * @param isOptimizing true if the PeepholeOptimizer's rules are applied to the assembled code
+     */
+    void set_peephole_optimization(const bool isOptimizing) noexcept {
+        _isOptimizing = isOptimizing;
+    }
+
+    /**
+     * Returns how often each peephole rule has been applied by the last assembly and what it saved.
+     * @return the statistics, indexed like PeepholeOptimizer::get_rules()
+     */
+    const std::vector<PeepholeStatistics>& get_peephole_statistics() const noexcept {
+        return _peepholeStatistics;
+    }
+
+    /**
+     * Returns the loop bounds given by LOOPBOUND commands in the last assembly, which the WcetAnalyzer applies.
+     * @return the maximum number of iterations by the address of each loop's first instruction
+     */
+    const LoopBounds& get_loop_bounds() const noexcept {
+        return _loopBounds;
+    }
+
+    /**
+     * Returns the value of the symbol @p name after the last assembly, e.g. the address of a label.
+     * @param name name of the symbol, for local labels including their global label
+     * @return the value, or nothing if no such symbol has been defined
+     */
+    std::optional<long> get_symbol_value(const std::string &name) const {
+        const auto iterator = _symbolIds.find(name);
+        if (iterator == _symbolIds.cend() || !_symbols[iterator->second].has_value()) {
+            return std::nullopt;
+        }
+        return _symbols[iterator->second]->get_numeric();
+    }
+
+    /**
+     * Returns the blocks of the output of the last assembly, each placed at its own address.
+     * The bytes of a block reach up to the offset of the following block or the end of the output.
+     * @return the blocks in source order, starting with the one at offset 0
+     */
+    const std::vector<OutputBlock>& get_output_blocks() const noexcept {
+        return _outputBlocks;
+    }
+
+    /**
+     * Returns the parts of the output of the last assembly which hold instructions, as opposed to data like DB or DS.
+     * @return the offset and the size of each run of consecutive instructions, in ascending order
+     */
+    const std::vector<std::pair<size_t, size_t>>& get_code_ranges() const noexcept {
+        return _codeRanges;
+    }
+
+    static constexpr size_t DEFAULT_MINIMUM_FIXUPS_PER_THREAD = 4096; ///< fixups per worker thread worth the thread start
+    static constexpr size_t MAXIMUM_MACRO_EXPANSIONS = 100000; ///< limit of macro expansions, which stops infinitely recursive macros
+    static constexpr long MAXIMUM_REPETITIONS = 0x10000; ///< limit of the repetition count of REPT
+
+    /**
+     * Parses the _tokenVector and returns the resulting bytecode by moving.
+     * This invalidates the internal output buffer, as ownership is passed
      * to the outside of the class.
-     * @throws std::logic_error containing an error message and highlighted code
+     * @throws std::logic_error containing all error messages and highlighted code
+     * @return assembled bytecode
+     */
+    Bytestring assemble() {
+        run_passes();
+        _diagnostics.throw_if_errors();
+        return std::move(_output);
+    }
+
+    /**
+     * Parses the _tokenVector and returns the resulting bytecode by moving.
+     * Instead of throwing, all errors are reported to @p diagnostics.
+     * The bytecode is only meaningful if no errors have been reported.
+     * @param diagnostics sink to which all errors are reported
+     * @return assembled bytecode
+     */
+    Bytestring assemble(Diagnostics &diagnostics) {
+        run_passes();
+        for (const Diagnostic &diagnostic : _diagnostics.get_diagnostics()) {
+            diagnostics.report(diagnostic);
+        }
+        return std::move(_output);
+    }
+
+    /**
+     * Parses the _tokenVector as a separately assembled part of a program and returns its sections,
+     * symbols and relocations.
+     * @throws std::logic_error containing all error messages and highlighted code
+     * @return the object file, which is placed into the ROM by the Linker
+     */
+    ObjectFile assemble_object() {
+        _isRelocatable = true;
+        run_passes();
+        _diagnostics.throw_if_errors();
+        return build_object_file();
+    }
+
+    /**
+     * Parses the _tokenVector as a separately assembled part of a program and returns its sections,
+     * symbols and relocations. Instead of throwing, all errors are reported to @p diagnostics.
+     * @param diagnostics sink to which all errors are reported
+     * @return the object file, which is only meaningful if no errors have been reported
+     */
+    ObjectFile assemble_object(Diagnostics &diagnostics) {
+        _isRelocatable = true;
+        run_passes();
+        for (const Diagnostic &diagnostic : _diagnostics.get_diagnostics()) {
+            diagnostics.report(diagnostic);
+        }
+        return build_object_file();
+    }
+
+    /**
+     * Parses the _tokenVector and returns the parsed instructions.
+     * The instructions are decoded from the assembled bytecode at the recorded instruction offsets.
+     * @throws std::logic_error containing all error messages and highlighted code
      * @return vector of parsed instructions
      */
     InstructionVector parse() {
-        const std::vector<UnresolvedInstructionPtr> unresolvedInstructions = std::move(pre_parse());
-        return resolve_symbols(std::move(unresolvedInstructions));
+        const Bytestring bytecode = assemble();
+
+        InstructionVector instructionVector{};
+        instructionVector.reserve(_instructionOffsets.size());
+        for (const size_t offset : _instructionOffsets) {
+            Decoder decoder(bytecode, offset);
+            instructionVector.push_back(decoder.decode().instruction);
+        }
+        return instructionVector;
+    }
+
+    /**
+     * Parses the _tokenVector and returns the parsed instructions together with their addresses and clock cycles,
+     * e.g. for printing a listing of the assembled code.
+     * @throws std::logic_error containing all error messages and highlighted code
+     * @return the decoded instructions in the order of the source
+     */
+    std::vector<DecodedInstruction> parse_decoded() {
+        const Bytestring bytecode = assemble();
+
+        std::vector<DecodedInstruction> decodedInstructions{};
+        decodedInstructions.reserve(_instructionOffsets.size());
+        for (size_t index = 0; index < _instructionOffsets.size(); ++index) {
+            Decoder decoder(bytecode, _instructionOffsets[index]);
+            DecodedInstruction decodedInstruction = decoder.decode();
+            decodedInstruction.address = _instructionAddresses[index]; // the offset differs from the address after ORG
+            decodedInstructions.push_back(std::move(decodedInstruction));
+        }
+        return decodedInstructions;
     }
 
 private:
 
-    void symbol_emplace(const long number, const Token &token)
+    /**
+     * Expression which depends on symbols that were not defined yet when it was parsed.
+     * Its value is assigned to the symbol @p symbolId once all symbols are known.
+     */
+    struct DeferredExpression {
+        SymbolId symbolId;
+        Expression expression;
+        Token token;    ///< the token replacing the expression, or the name of an EQU constant
+        bool isEquate;  ///< true for EQU constants, whose unresolvable values are reported
+    };
+
+    /**
+     * State of a deferred expression during evaluation, used for detecting recursive definitions.
+     */
+    enum class EvaluationState : uint8_t {
+        PENDING,
+        ACTIVE,
+        DONE
+    };
+
+    /**
+     * A forward jump which is assembled as JR, assuming its target to be in range.
+     */
+    struct RelaxableJump {
+        size_t fixupIndex;       ///< the fixup of the jump's offset
+        size_t instructionIndex; ///< the index of the jump's instruction, which identifies it in the next pass
+        size_t sectionIndex;     ///< the section containing the jump
+    };
+
+    /**
+     * An IF statement whose ENDC has not been parsed yet.
+     */
+    struct ConditionalFrame {
+        Token ifToken;
+        bool isBranchTaken; ///< true if the IF branch is assembled
+        bool hasElse;       ///< true once the ELSE statement has been parsed
+    };
+
+    /**
+     * A macro, whose body is stored as tokens.
+     */
+    struct Macro {
+        Token nameToken;
+        TokenVector body; ///< the tokens of the lines between "NAME MACRO" and "ENDM"
+    };
+
+    /**
+     * The expansion of a macro invocation with certain arguments.
+     */
+    struct MacroExpansion {
+        TokenVector tokens; ///< the body with the substituted arguments
+        std::vector<std::pair<size_t, size_t>> argumentSlots; ///< position in tokens and index of each substituted argument
+    };
+
+    /**
+     * Operand which could not be resolved while its instruction is being parsed.
+     * It becomes a Fixup as soon as the instruction is emitted and its position is known.
+     */
+    struct PendingFixup {
+        FixupKind kind;
+        SymbolId symbolId;
+        TokenVectorPosition tokenIndex;
+    };
+
+    /**
+     * Returns the ID of the symbol @p name. If the symbol has not been seen yet,
+     * a new undefined entry is created in the symbol table.
+     * @param name name of the symbol
+     * @return the symbol's ID
+     */
+    SymbolId intern_symbol(const std::string &name)
     {
-        // TODO: change from map: string -> number
-        //           to some map: string -> token
-        if (token.get_token_type() == TokenType::GLOBAL_LABEL) {
-            // since global labels have the form 'GLOBALLABEL:',
-            // the trailing colon has to be removed
-            _symbolicTable.emplace(remove_last_character(token.get_string()), NumericFromToken(number, token));
-        } else {
-            _symbolicTable.emplace(token.get_string(), NumericFromToken(number, token));
+        const auto [iterator, isInserted] = _symbolIds.emplace(name, static_cast<SymbolId>(_symbols.size()));
+        if (isInserted) {
+            _symbols.emplace_back();
         }
+        return iterator->second;
+    }
+
+    /**
+     * Defines the symbol named by @p token, unless it has been defined before.
+     * @param number value of the symbol
+     * @param token label or name of a constant
+     * @return the symbol's ID if this is its first definition
+     */
+    std::optional<SymbolId> symbol_emplace(const long number, const Token &token)
+    {
+        // since global labels have the form 'GLOBALLABEL:',
+        // the trailing colon has to be removed
+        const std::string name = (token.get_token_type() == TokenType::GLOBAL_LABEL) ? remove_last_character(token.get_string())
+                                                                                      : token.get_string();
+        const SymbolId symbolId = intern_symbol(name);
+        std::optional<NumericFromToken> &symbol = _symbols[symbolId];
+        if (symbol.has_value()) { // the first definition of a symbol is kept
+            return std::nullopt;
+        }
+        symbol = NumericFromToken(number, token);
+        return symbolId;
+    }
+
+    /**
+     * Checks whether the value of the symbol @p symbolId is an offset within a section whose address is only known once linked.
+     * @param symbolId ID of the symbol
+     * @return true for labels in relocatable sections
+     */
+    bool is_relocatable_symbol(const SymbolId symbolId) const
+    {
+        return _relocatableSymbols.count(symbolId) > 0;
+    }
+
+    /**
+     * Checks whether the symbol @p token refers to has already been defined.
+     * @param token token containing the symbol's name
+     * @return true if the symbol is defined
+     */
+    bool is_symbol_defined(const Token &token) const
+    {
+        const auto iterator = _symbolIds.find(token.get_string());
+        return (iterator != _symbolIds.cend()) && _symbols[iterator->second].has_value();
     }
 
     /**
@@ -70,11 +400,10 @@ private:
      */
     NumericFromToken symbol_lookup(const Token &token) const
     {
-        try {
-            return _symbolicTable.at(token.get_string());
-        } catch (...) {
+        if (!is_symbol_defined(token)) {
             throw_logic_error_and_highlight(token, "Parse error: Using the symbol \"" + token.get_string() + "\" which has not been assigned yet");
         }
+        return _symbols[_symbolIds.at(token.get_string())].value();
     }
 
     /**
@@ -116,43 +445,357 @@ private:
     }
 
     /**
-     * Takes a vector of UnresolvedInstructionPtr, resolves them and returns the vector of resolved instructions
-     * @param unresolvedInstructions Vector of unresolved instructions
-     * @return vector containing resolved instructions
+     * Evaluates deferred expressions first, then patches all recorded fixups in the output buffer. Since all symbols are known at this point,
+     * unresolvable symbols and out-of-range values are reported here.
+     * The symbol table is frozen during this phase, so that large numbers of fixups are patched
+     * in parallel. Each worker collects its errors, which are merged in source order afterwards.
+     */
+    void resolve_symbols() {
+        evaluate_deferred_expressions();
+
+        const size_t hardwareThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+        const size_t maximumWorkers = std::max<size_t>(_fixups.size() / std::max<size_t>(_minimumFixupsPerThread, 1), 1);
+        const size_t numberOfWorkers = std::min((_numberOfThreads == 0) ? hardwareThreads : _numberOfThreads, maximumWorkers);
+
+        std::vector<std::vector<Diagnostic>> workerDiagnostics(numberOfWorkers);
+        std::vector<std::vector<size_t>> workerRelocations(numberOfWorkers); // fixups which are left to the linker
+        const auto resolve_range = [this, &workerDiagnostics, &workerRelocations, numberOfWorkers](const size_t worker) {
+            const size_t begin = _fixups.size() * worker / numberOfWorkers;
+            const size_t end = _fixups.size() * (worker + 1) / numberOfWorkers;
+            for (size_t i = begin; i < end; ++i) {
+                try {
+                    if (!resolve_fixup(_fixups[i])) {
+                        workerRelocations[worker].push_back(i);
+                    }
+                } catch (const SourceError &sourceError) {
+                    workerDiagnostics[worker].push_back(Diagnostic{sourceError.get_span(), sourceError.what()});
+                }
+            }
+        };
+
+        if (numberOfWorkers == 1) {
+            resolve_range(0);
+        } else {
+            std::vector<std::thread> workers{};
+            workers.reserve(numberOfWorkers);
+            for (size_t worker = 0; worker < numberOfWorkers; ++worker) {
+                workers.emplace_back(resolve_range, worker);
+            }
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        for (const std::vector<Diagnostic> &diagnostics : workerDiagnostics) {
+            for (const Diagnostic &diagnostic : diagnostics) {
+                _diagnostics.report(diagnostic);
+            }
+        }
+        // relocations intern the symbols they refer to, hence they are recorded after the workers have finished
+        for (const std::vector<size_t> &fixupIndices : workerRelocations) {
+            for (const size_t fixupIndex : fixupIndices) {
+                try {
+                    relocate(_fixups[fixupIndex]);
+                } catch (const SourceError &sourceError) {
+                    _diagnostics.report(sourceError);
+                }
+            }
+        }
+    }
+
+    /**
+     * Resolves the symbol of @p fixup using the frozen symbol table and patches the output buffer.
+     * Only the bytes of @p fixup's instruction are written, so different fixups may be resolved concurrently.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     * @param fixup the fixup to resolve
+     * @return false if the symbol is relocatable or undefined when assembling an object file, i.e. if the fixup must be relocated
+     */
+    bool resolve_fixup(const Fixup &fixup) {
+        const Token &token = _tokenVector[fixup.tokenIndex];
+        const std::optional<NumericFromToken> &symbol = _symbols[fixup.symbolId];
+        if (_isRelocatable && (!symbol.has_value() || is_relocatable_symbol(fixup.symbolId))) {
+            return false;
+        }
+        if (!symbol.has_value()) {
+            throw_logic_error_and_highlight(token, "Parse error: Symbol " + token.get_string() + " could not be resolved");
+        }
+
+        const long value = check_value(token, symbol->get_numeric(), fixup.kind, fixup.address);
+        if (fixup.kind == FixupKind::BIT_INDEX) {
+            _output[fixup.offset] |= static_cast<byte>(value << 3);
+        } else {
+            patch(fixup, value);
+        }
+        return true;
+    }
+
+    /**
+     * Records a relocation for @p fixup, whose value is left to the linker.
+     * The relocation's expression refers to relocatable and undefined symbols only,
+     * every other symbol is replaced by its value.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     * @param fixup fixup whose symbol is relocatable or undefined
+     */
+    void relocate(const Fixup &fixup);
+
+    /**
+     * Appends the value of the symbol @p symbolId to @p expression. Unresolved deferred expressions are inlined,
+     * so that the appended instructions only refer to relocatable and undefined symbols.
+     * @throws std::domain_error in case of a division by zero or an invalid shift
+     * @param expression the expression to append to
+     * @param symbolId ID of the symbol
+     */
+    void append_relocatable_value(Expression &expression, const SymbolId symbolId) const;
+
+    /**
+     * Builds the object file from the output buffer, the sections and the relocations once all symbols are resolved.
+     * @return the object file
      */
-    InstructionVector resolve_symbols(const std::vector<UnresolvedInstructionPtr> &unresolvedInstructions) {
-        InstructionVector resolvedInstructions(unresolvedInstructions.size());
-        std::transform(unresolvedInstructions.cbegin(), unresolvedInstructions.cend(), resolvedInstructions.begin(),
-                       [](const UnresolvedInstructionPtr &f) { return std::move(f->resolve()); });
-        return resolvedInstructions;
+    ObjectFile build_object_file() const;
+
+    /**
+     * Collects the runs of consecutive instructions in [@p begin, @p end) of the output buffer.
+     * @param begin offset of the first byte
+     * @param end offset after the last byte
+     * @return the offset and the size of each run, in ascending order
+     */
+    std::vector<std::pair<size_t, size_t>> find_code_ranges(const size_t begin, const size_t end) const;
+
+    /**
+     * Returns the index of the section containing the byte at @p offset of the output buffer.
+     * @param offset position in the output buffer
+     * @return index into _sections
+     */
+    size_t find_section(const size_t offset) const;
+
+    /**
+     * Writes @p value in little endian format into the operand described by @p fixup.
+     * @param fixup the fixup to patch
+     * @param value the resolved value
+     */
+    void patch(const Fixup &fixup, const long value) {
+        for (size_t i = 0; i < fixup.width; ++i) {
+            _output[fixup.offset + i] = static_cast<byte>(value >> (8 * i));
+        }
     }
 
     /**
-     * Builds a vector of unresolved instructions from the available tokens.
-     * @throws std::logic_error containing an error message and highlighted code passage in case of parsing error.
-     * @return Vector of unresolved instructions
+     * Parses all tokens with branch relaxation and resolves all symbols. If the peephole optimization is enabled,
+     * the rewrites found in the assembled code are applied by parsing all tokens once more.
+     */
+    void run_passes();
+
+    /**
+     * Matches the peephole rules against the instructions of the current pass.
+     * @return the rewrite of each instruction which is replaced or removed, by the index of the instruction
+     */
+    std::unordered_map<size_t, PeepholeRewrite> find_peephole_rewrites() const;
+
+    /**
+     * Emits the replacement of instruction @p instructionIndex if a peephole rewrite of the previous pass applies to it.
+     * A rewrite is skipped if the instruction differs from the one of the previous pass,
+     * e.g. because its immediate depends on an address, or a jump turned relative is out of range.
+     * @param instructionIndex index of the instruction
+     * @param instruction the instruction which is rewritten
+     * @return true if the instruction has been replaced or removed
+     */
+    bool emit_rewritten(const size_t instructionIndex, const BaseInstruction &instruction);
+
+    /**
+     * Parses all tokens like pre_parse(). While forward jumps assumed to be in range are out of range,
+     * they are marked for being assembled as JP and all tokens are parsed again.
+     * Since jumps are only ever lengthened, the addresses converge after at most one pass per JMP.
+     */
+    void parse_with_relaxation();
+
+    /**
+     * Marks every relaxable jump whose target is out of range or has no known distance for being assembled as JP.
+     * @return true if a jump has been marked which was assembled as JR
      */
-    std::vector<UnresolvedInstructionPtr> pre_parse() {
-        std::vector<UnresolvedInstructionPtr> returnVector{};
+    bool lengthen_out_of_range_jumps();
 
+    /**
+     * Resets the parser to the state before the first pass, keeping its settings, the jumps which are assembled as JP
+     * and the peephole rewrites.
+     * Since parsing modifies the token vector, the tokens are restored from the copy made before the first pass.
+     * Included files, binary files and macro expansions are taken from the PassInputs instead of being read or built again.
+     */
+    void restart();
+
+    /**
+     * Reports each output block which overlaps a block preceding it in the address space,
+     * since both would be written to the same addresses of the ROM image.
+     */
+    void check_output_blocks();
+
+    /**
+     * Parses all tokens and writes the resulting bytecode into the output buffer.
+     * Every parsing error is recorded in _diagnostics and parsing continues with the next line.
+     */
+    void pre_parse() {
+        _isEmitting = true;
         while (!is_finished()) {
+            _statementStart = get_current_token_position();
+            _pendingFixup.reset();
 
-            if (std::optional<UnresolvedInstructionPtr> unresolvedInstruction = parse_gameboy_instruction()) { // GameBoy instruction
-                // if an error occurs while parsing, the instruction is not constructed
-                // and the address is not incremented
-                _currentAddress += unresolvedInstruction.value()->length();
-                returnVector.push_back(std::move(unresolvedInstruction.value()));
+            const TokenType statementType = read_current().get_token_type();
+            if (statementType == TokenType::END_OF_LINE || statementType == TokenType::END_OF_FILE) { // empty statement
+                increment_position();
                 continue;
             }
 
-            if (parse_assembler_specific_commands()) { continue; } // assembler-specific instruction
-            if (update_label()) { continue; } // label
+            try {
+                fold_expressions();
+                if (parse_gameboy_instruction()) { continue; } // GameBoy instruction
+                if (parse_assembler_specific_commands()) { continue; } // assembler-specific instruction
+                if (update_label()) { continue; } // label
+
+                throw_logic_error_and_highlight(read_current(), "Parse error: Found unknown expression '" +
+                                                read_current().get_string() + "'.");
+            } catch (const SourceError &sourceError) {
+                if (!statement_has_invalid_token()) { // otherwise, the tokenizer has already reported the error
+                    _diagnostics.report(sourceError);
+                }
+                skip_statement();
+            }
+        }
+        for (const ConditionalFrame &conditional : _conditionals) {
+            report_and_highlight(conditional.ifToken, "Parse error: IF is not terminated by ENDC");
+        }
+        _isEmitting = false;
+    }
 
-            throw_logic_error_and_highlight(read_current(), "Parse error: Found unknown expression '" +
-                                            read_current().get_string() + "'.");
+    /**
+     * Returns the position of the END_OF_LINE or END_OF_FILE token terminating the current statement.
+     * @return position of the terminating token, or the size of the token vector if there is none
+     */
+    TokenVectorPosition find_statement_end() const noexcept {
+        TokenVectorPosition position = _statementStart;
+        while (position < _tokenVector.size()
+            && _tokenVector[position].get_token_type() != TokenType::END_OF_LINE
+            && _tokenVector[position].get_token_type() != TokenType::END_OF_FILE) {
+            ++position;
+        }
+        return position;
+    }
+
+    /**
+     * Skips all remaining tokens of the current statement including its terminating token,
+     * so that parsing resumes at the beginning of the next line.
+     */
+    void skip_statement() noexcept {
+        _currentTokenPosition = std::min(find_statement_end() + 1, _tokenVector.size());
+    }
+
+    /**
+     * Checks whether the current statement contains an INVALID token, i.e. a token for which
+     * the tokenizer has reported a lexical error.
+     * @return true if an INVALID token is part of the current statement
+     */
+    bool statement_has_invalid_token() const noexcept {
+        for (TokenVectorPosition position = _statementStart; position < find_statement_end(); ++position) {
+            if (_tokenVector[position].get_token_type() == TokenType::INVALID) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Appends the bytecode of @p instruction to the output buffer and advances the current address.
+     * If one of the instruction's operands could not be resolved, the corresponding fixup is recorded.
+     * @tparam InstructionType the instruction class, whose LENGTH advances the current address
+     * @param instruction the instruction to emit
+     */
+    template<typename InstructionType>
+    void emit(const InstructionType &instruction) {
+        const size_t instructionIndex = _numberOfInstructions++;
+        if (!_rewrites.empty() && emit_rewritten(instructionIndex, instruction)) {
+            return;
+        }
+
+        record_instruction(InstructionType::LENGTH);
+        instruction.append_bytestr_to(_output);
+        record_pending_fixup();
+        _currentAddress += InstructionType::LENGTH;
+    }
+
+    /**
+     * Records the position of an instruction of @p length bytes which is about to be appended to the output buffer.
+     * @param length size of the instruction in bytes
+     */
+    void record_instruction(const size_t length) {
+        _instructionOffsets.push_back(_output.size());
+        _instructionAddresses.push_back(_currentAddress);
+        if (!_codeRanges.empty() && _codeRanges.back().first + _codeRanges.back().second == _output.size()) {
+            _codeRanges.back().second += length;
+        } else {
+            _codeRanges.emplace_back(_output.size(), length);
         }
+    }
+
+    /**
+     * Records the fixup of the unresolved operand of the instruction which has just been appended to the output buffer, if any.
+     */
+    void record_pending_fixup() {
+        if (_pendingFixup.has_value()) {
+            // the unresolved operand always occupies the last bytes of the instruction
+            const uint8_t width = fixup_width(_pendingFixup->kind);
+            _fixups.push_back(Fixup{static_cast<uint32_t>(_output.size() - width),
+                                    static_cast<uint32_t>(_pendingFixup->tokenIndex),
+                                    _pendingFixup->symbolId,
+                                    _currentAddress,
+                                    width,
+                                    _pendingFixup->kind});
+            _pendingFixup.reset();
+        }
+    }
+
+    /**
+     * Checks whether @p numToken refers to a symbol which is not defined yet, but may be defined later on,
+     * or to a label whose address is only known once the object file is linked.
+     * @param numToken operand token
+     * @return true if the operand must be patched by a fixup
+     */
+    bool is_forward_reference(const Token &numToken) const {
+        if (!_isEmitting || numToken.has_numeric_value() || numToken.is_invalid()) {
+            return false;
+        }
+        const auto iterator = _symbolIds.find(numToken.get_string());
+        return iterator == _symbolIds.cend() || !_symbols[iterator->second].has_value() || is_relocatable_symbol(iterator->second);
+    }
 
-        return returnVector;
+    /**
+     * Checks whether @p numToken refers to a symbol which is not defined yet. In that case,
+     * a pending fixup of kind @p kind is recorded and the caller must encode a placeholder value.
+     * @param numToken operand token
+     * @param kind kind of the operand
+     * @return true if the operand has been deferred
+     */
+    bool defer_if_unresolved(const Token &numToken, const FixupKind kind) {
+        if (!is_forward_reference(numToken)) {
+            return false;
+        }
+
+        _pendingFixup = PendingFixup{kind, intern_symbol(numToken.get_string()), find_statement_token(numToken)};
+        return true;
+    }
+
+    /**
+     * Returns the position of @p token in the token vector.
+     * Only the tokens of the statement which is currently parsed are searched,
+     * since an instruction contains at most one symbolic operand.
+     * @param token a token of the current statement
+     * @return the position of @p token in the token vector
+     */
+    TokenVectorPosition find_statement_token(const Token &token) const {
+        for (TokenVectorPosition position = _statementStart; position < _currentTokenPosition; ++position) {
+            const Token &candidate = _tokenVector[position];
+            if (candidate.get_token_type() == token.get_token_type() && candidate.get_string() == token.get_string()) {
+                return position;
+            }
+        }
+        return _statementStart;
     }
 
     /**
@@ -163,6 +806,23 @@ private:
      */
     bool parse_assembler_specific_commands() {
         if (read_next().get_string() == "EQU") { parse_equ(); }
+        else if (to_upper(read_next().get_string()) == "MACRO") { parse_macro_definition(); return true; } // ends the statement itself
+        else if (to_upper(read_current().get_string()) == "IF") { parse_if(); return true; } // ends the statement itself
+        else if (to_upper(read_current().get_string()) == "ELSE") { parse_else(); return true; } // ends the statement itself
+        else if (to_upper(read_current().get_string()) == "ENDC") { parse_endc(); }
+        else if (to_upper(read_current().get_string()) == "REPT") { parse_rept(); return true; } // ends the statement itself
+        else if (to_upper(read_current().get_string()) == "ENDR") {
+            throw_logic_error_and_highlight(read_current(), "Parse error: ENDR without matching REPT");
+        }
+        else if (to_upper(read_current().get_string()) == "INCLUDE") { parse_include(); return true; } // ends the statement itself
+        else if (to_upper(read_current().get_string()) == "INCBIN") { parse_incbin(); }
+        else if (to_upper(read_current().get_string()) == "SECTION") { parse_section(); }
+        else if (to_upper(read_current().get_string()) == "ORG") { parse_org(); }
+        else if (to_upper(read_current().get_string()) == "DB") { parse_data(FixupKind::NUMBER_8_BIT); }
+        else if (to_upper(read_current().get_string()) == "DW") { parse_data(FixupKind::NUMBER_16_BIT); }
+        else if (to_upper(read_current().get_string()) == "DS") { parse_data_space(); }
+        else if (to_upper(read_current().get_string()) == "LOOPBOUND") { parse_loop_bound(); }
+        else if (_macros.count(read_current().get_string()) > 0) { expand_macro(); return true; } // ends the statement itself
         else { return false; }
 
         expect_end_of_context(fetch()); // each valid instruction must end with newline or end of file
@@ -172,6 +832,8 @@ private:
     /**
      * Checks whether the current token is a global or local label
      * and adds the corresponding symbol to the _symbolTable.
+     * A label which is already defined, e.g. one in the block of REPT or in a macro expanded twice, is an error,
+     * since every reference would silently refer to its first definition.
      * @throws std::logic_error containing an error message and highlighted code passage in case of parsing error.
      */
     bool update_label() {
@@ -180,7 +842,19 @@ private:
             || currentToken.get_token_type() == TokenType::LOCAL_LABEL) {
             // if current token is a label, update symbolic table and advance to next token
             _currentGlobalLabel = currentToken;
-            symbol_emplace(_currentAddress, currentToken);
+            const std::optional<SymbolId> symbolId = symbol_emplace(_currentAddress, currentToken);
+            if (!symbolId.has_value()) {
+                const std::string name = (currentToken.get_token_type() == TokenType::GLOBAL_LABEL) ? remove_last_character(currentToken.get_string())
+                                                                                                    : currentToken.get_string();
+                throw_logic_error_and_highlight_with_reference(currentToken, _symbols[_symbolIds.at(name)]->get_token(),
+                                                               "Parse error: Label \"" + name + "\" is already defined");
+            }
+            if (_isRelocatable && !_sections.back().address.has_value()) {
+                _relocatableSymbols.emplace(*symbolId, _sections.size() - 1);
+            }
+            if (currentToken.get_token_type() == TokenType::GLOBAL_LABEL) {
+                _exportedSymbols.push_back(*symbolId);
+            }
             increment_position();
         } else {
             return false;
@@ -194,352 +868,529 @@ private:
     }
 
     /**
-     * Checks if the next instruction is a GameBoy specific instruction, parses and returns it.
-     * @return TODO
+     * Checks if the next instruction is a GameBoy specific instruction, parses and emits it.
+     * @return true if a GameBoy instruction has been found
      */
-    std::optional<UnresolvedInstructionPtr> parse_gameboy_instruction() {
+    bool parse_gameboy_instruction() {
         const Token firstTokenOfInstruction = read_current();
         const std::string currStr = to_upper(firstTokenOfInstruction.get_string());
 
-        std::optional<UnresolvedInstructionPtr> instruction{};
-
-//        try {
-            if      (currStr == "ADD") { instruction = parse_add(); }
-            else if (currStr == "ADC") { instruction = parse_adc(); }
-
-            else if (currStr == "BIT") { instruction = parse_bit(); }
-
-            else if (currStr == "INC") { instruction = parse_inc(); }
-            else if (currStr == "DEC") { instruction = parse_dec(); }
-
-            else if (currStr == "JP")  { instruction = parse_jp();  }
-            else if (currStr == "JR")  { instruction = parse_jr();  }
-
-            else if (currStr == "LD")  { instruction = parse_ld();  }
-            else if (currStr == "LDI") { instruction = parse_ldi(); }
-            else if (currStr == "LDD") { instruction = parse_ldd(); }
-            else if (currStr == "LDH") { instruction = parse_ldh(); }
-            else if (currStr == "LDHL"){ instruction = parse_ldhl();}
-
-            else if (currStr == "AND") { instruction = parse_and(); }
-            else if (currStr == "OR")  { instruction = parse_or();  }
-            else if (currStr == "XOR") { instruction = parse_xor(); }
-            else if (currStr == "CP")  { instruction = parse_cp();  }
-            else if (currStr == "CPL") { instruction = parse_cpl(); }
-            else if (currStr == "DAA") { instruction = parse_daa(); }
-
-            else if (currStr == "NOP") { instruction = parse_nop(); }
-            else if (currStr == "STOP"){ instruction = parse_stop();}
-            else if (currStr == "HALT"){ instruction = parse_halt();}
-            else if (currStr == "SCF") { instruction = parse_scf(); }
-            else if (currStr == "CCF") { instruction = parse_ccf(); }
-            else if (currStr == "EI")  { instruction = parse_ei();  }
-            else if (currStr == "DI")  { instruction = parse_di();  }
-            else if (currStr == "EI")  { instruction = parse_ei();  }
-            else if (currStr == "DI")  { instruction = parse_di();  }
-
-            else if (currStr == "PUSH"){ instruction = parse_push();}
-            else if (currStr == "POP") { instruction = parse_pop(); }
-
-            else if (currStr == "RR")  { instruction = parse_rr();  }
-            else if (currStr == "RL")  { instruction = parse_rl();  }
-            else if (currStr == "RRC") { instruction = parse_rrc(); }
-            else if (currStr == "RLC") { instruction = parse_rlc(); }
-            else if (currStr == "RLA") { instruction = parse_rla(); }
-            else if (currStr == "RRA") { instruction = parse_rra(); }
-            else if (currStr == "RLCA"){ instruction = parse_rlca();}
-            else if (currStr == "RRCA"){ instruction = parse_rrca();}
-
-            else if (currStr == "SET") { instruction = parse_set(); }
-            else if (currStr == "RES") { instruction = parse_res(); }
-
-            else if (currStr == "SLA") { instruction = parse_sla(); }
-            else if (currStr == "SRA") { instruction = parse_sra(); }
-            else if (currStr == "SRL") { instruction = parse_srl(); }
-            else if (currStr == "SWAP"){ instruction = parse_swap();}
-
-            else if (currStr == "SUB") { instruction = parse_sub(); }
-            else if (currStr == "SBC") { instruction = parse_sbc(); }
-
-            else if (currStr == "UNU") { instruction = parse_unu(); }
-
-        if (instruction.has_value()) { // only check for end of context in case that an actual GameBoy instruction has been found
-            expect_end_of_context(fetch());
-        }
-
-        return instruction;
+            if      (currStr == "ADD") { parse_add(); }
+            else if (currStr == "ADC") { parse_adc(); }
+
+            else if (currStr == "BIT") { parse_bit(); }
+
+            else if (currStr == "INC") { parse_inc(); }
+            else if (currStr == "DEC") { parse_dec(); }
+
+            else if (currStr == "JP")  { parse_jp();  }
+            else if (currStr == "JR")  { parse_jr();  }
+            else if (currStr == "JMP") { parse_jmp(); }
+            else if (currStr == "CALL"){ parse_call();}
+            else if (currStr == "RET") { parse_ret(); }
+            else if (currStr == "RETI"){ parse_reti();}
+            else if (currStr == "RST") { parse_rst(); }
+
+            else if (currStr == "LD")  { parse_ld();  }
+            else if (currStr == "LDI") { parse_ldi(); }
+            else if (currStr == "LDD") { parse_ldd(); }
+            else if (currStr == "LDH") { parse_ldh(); }
+            else if (currStr == "LDHL"){ parse_ldhl();}
+
+            else if (currStr == "AND") { parse_and(); }
+            else if (currStr == "OR")  { parse_or();  }
+            else if (currStr == "XOR") { parse_xor(); }
+            else if (currStr == "CP")  { parse_cp();  }
+            else if (currStr == "CPL") { parse_cpl(); }
+            else if (currStr == "DAA") { parse_daa(); }
+
+            else if (currStr == "NOP") { parse_nop(); }
+            else if (currStr == "STOP"){ parse_stop();}
+            else if (currStr == "HALT"){ parse_halt();}
+            else if (currStr == "SCF") { parse_scf(); }
+            else if (currStr == "CCF") { parse_ccf(); }
+            else if (currStr == "EI")  { parse_ei();  }
+            else if (currStr == "DI")  { parse_di();  }
+            else if (currStr == "EI")  { parse_ei();  }
+            else if (currStr == "DI")  { parse_di();  }
+
+            else if (currStr == "PUSH"){ parse_push();}
+            else if (currStr == "POP") { parse_pop(); }
+
+            else if (currStr == "RR")  { parse_rr();  }
+            else if (currStr == "RL")  { parse_rl();  }
+            else if (currStr == "RRC") { parse_rrc(); }
+            else if (currStr == "RLC") { parse_rlc(); }
+            else if (currStr == "RLA") { parse_rla(); }
+            else if (currStr == "RRA") { parse_rra(); }
+            else if (currStr == "RLCA"){ parse_rlca();}
+            else if (currStr == "RRCA"){ parse_rrca();}
+
+            else if (currStr == "SET") { parse_set(); }
+            else if (currStr == "RES") { parse_res(); }
+
+            else if (currStr == "SLA") { parse_sla(); }
+            else if (currStr == "SRA") { parse_sra(); }
+            else if (currStr == "SRL") { parse_srl(); }
+            else if (currStr == "SWAP"){ parse_swap();}
+
+            else if (currStr == "SUB") { parse_sub(); }
+            else if (currStr == "SBC") { parse_sbc(); }
+
+            else if (currStr == "UNU") { parse_unu(); }
+
+            else { return false; }
+
+        // only check for end of context in case that an actual GameBoy instruction has been found
+        expect_end_of_context(fetch());
+        return true;
     }
 
     /**
      * Parses "ADD" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_add();
+    void parse_add();
 
     /**
      * Parses "ADC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_adc();
+    void parse_adc();
 
     /**
      * Parses "BIT" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_bit();
+    void parse_bit();
 
     /**
      * Parses "INC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_inc();
+    void parse_inc();
 
     /**
      * Parses "DEC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_dec();
+    void parse_dec();
 
     /**
      * Parses "JP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_jp();
+    void parse_jp();
 
     /**
      * Parses "JR" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_jr();
+    void parse_jr();
+
+    /**
+     * Parses "JMP" pseudo-instructions, i.e. JMP [condition,] target, which are assembled as JR if the target
+     * is in range of a relative jump and as JP otherwise.
+     */
+    void parse_jmp();
+
+    /**
+     * Parses "CALL" commands
+     */
+    void parse_call();
+
+    /**
+     * Parses "RET" commands
+     */
+    void parse_ret();
+
+    /**
+     * Parses "RETI" commands
+     */
+    void parse_reti();
+
+    /**
+     * Parses "RST address" commands, where the address is one of the restart vectors 0x00, 0x08, ..., 0x38.
+     */
+    void parse_rst();
 
     /**
      * Parses "LD" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ld();
+    void parse_ld();
 
     /**
      * Parses "LDI" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ldi();
+    void parse_ldi();
 
     /**
      * Parses "LDD" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ldd();
+    void parse_ldd();
 
     /**
      * Parses "LDH" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ldh();
+    void parse_ldh();
 
     /**
      * Parses "LDHL" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ldhl();
+    void parse_ldhl();
 
     /**
      * Parses "AND" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_and();
+    void parse_and();
 
     /**
      * Parses "OR" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_or();
+    void parse_or();
 
     /**
      * Parses "XOR" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_xor();
+    void parse_xor();
 
     /**
      * Parses "CP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_cp();
+    void parse_cp();
 
     /**
      * Parses "CPL" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_cpl();
+    void parse_cpl();
 
     /**
      * Parses "DAA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_daa();
+    void parse_daa();
 
     /**
      * Parses "NOP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_nop();
+    void parse_nop();
 
     /**
      * Parses "STOP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_stop();
+    void parse_stop();
 
     /**
      * Parses "HALT" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_halt();
+    void parse_halt();
 
     /**
      * Parses "SCF" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_scf();
+    void parse_scf();
 
     /**
      * Parses "CCF" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ccf();
+    void parse_ccf();
 
     /**
      * Parses "EI" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_ei();
+    void parse_ei();
 
     /**
      * Parses "DI" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_di();
+    void parse_di();
 
     /**
      * Parses "PUSH" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_push();
+    void parse_push();
 
     /**
      * Parses "POP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_pop();
+    void parse_pop();
 
     /**
      * Parses "RR" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rr();
+    void parse_rr();
 
     /**
      * Parses "RL" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rl();
+    void parse_rl();
 
     /**
      * Parses "RRC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rrc();
+    void parse_rrc();
 
     /**
      * Parses "RLC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rlc();
+    void parse_rlc();
 
     /**
      * Parses "RLA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rla();
+    void parse_rla();
 
     /**
      * Parses "RRA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rra();
+    void parse_rra();
 
     /**
      * Parses "RLCA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rlca();
+    void parse_rlca();
 
     /**
      * Parses "RRCA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_rrca();
+    void parse_rrca();
 
     /**
      * Parses "SET" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_set();
+    void parse_set();
 
     /**
      * Parses "RES" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_res();
+    void parse_res();
 
     /**
      * Parses "SLA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_sla();
+    void parse_sla();
 
     /**
      * Parses "SRA" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_sra();
+    void parse_sra();
 
     /**
      * Parses "SRL" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_srl();
+    void parse_srl();
 
     /**
      * Parses "SWAP" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_swap();
+    void parse_swap();
 
     /**
      * Parses "SUB" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_sub();
+    void parse_sub();
 
     /**
      * Parses "SBC" commands
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_sbc();
+    void parse_sbc();
 
     /**
      * Parses "UNU" commands (short for seemingly unused opcodes, where no mnemonic exists)
-     * @return pointer to parsed instruction
      */
-    UnresolvedInstructionPtr parse_unu();
+    void parse_unu();
 
     /**
      * Parses "EQU" commands specific to the assembler.
-     * @return pointer to parsed instruction
      */
     void parse_equ();
 
+    /**
+     * Parses "INCLUDE" commands specific to the assembler.
+     * The tokens of the included file are taken from the token cache and inserted
+     * right after the INCLUDE statement, so that they are parsed next.
+     */
+    void parse_include();
+
+    /**
+     * Parses "IF condition" commands specific to the assembler. The condition must only use symbols defined before.
+     * If it is zero, the following branch is skipped. Errors are reported directly, so that the branch is skipped
+     * as a whole instead of being parsed line by line.
+     */
+    void parse_if();
+
+    /**
+     * Parses "ELSE" commands specific to the assembler, which starts the branch assembled if the condition is zero.
+     */
+    void parse_else();
+
+    /**
+     * Parses "ENDC" commands specific to the assembler, which ends a conditional block.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     */
+    void parse_endc();
+
+    /**
+     * Continues with the branch following an IF or ELSE statement. The branch is either a CONDITIONAL_BLOCK token,
+     * which is tokenized only if the branch is taken, or, e.g. inside of macros, the branch's tokens.
+     * @param isTaken true if the branch is assembled
+     */
+    void enter_conditional_branch(const bool isTaken);
+
+    /**
+     * Skips the tokens of a branch up to the matching ELSE or ENDC statement.
+     */
+    void skip_conditional_tokens();
+
+    /**
+     * Tokenizes the lines represented by a CONDITIONAL_BLOCK token. Lexical errors are reported.
+     * @param blockToken CONDITIONAL_BLOCK token
+     * @return tokens of the block, ending with an END_OF_LINE token
+     */
+    TokenVector tokenize_conditional_block(const Token &blockToken);
+
+    /**
+     * Appends the tokens from @p first to @p last to @p destination, replacing CONDITIONAL_BLOCK tokens by their tokens.
+     * This is used for macro bodies, whose tokens must be complete for substituting the arguments.
+     * @param destination token vector to append to
+     * @param first first token to append
+     * @param last end of the tokens to append
+     */
+    void append_with_conditional_blocks(TokenVector &destination, TokenVector::const_iterator first, TokenVector::const_iterator last);
+
+    /**
+     * Parses "REPT count [, COUNTER]" commands specific to the assembler, which repeat the lines up to the matching "ENDR".
+     * The block's tokens are replayed count times right after ENDR, without tokenizing them again.
+     * In each repetition, the optional counter symbol is replaced by the repetition's index, starting at zero.
+     * Errors in the REPT line are reported directly and the block is skipped.
+     */
+    void parse_rept();
+
+    /**
+     * Parses the definition of a macro, i.e. "NAME MACRO" followed by the body's lines and "ENDM".
+     * The body is stored as tokens, in which the arguments \1, \2, ... are MACRO_ARGUMENT tokens.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     */
+    void parse_macro_definition();
+
+    /**
+     * Expands the invocation of a macro, i.e. "NAME argument1, argument2, ...", by substituting the arguments
+     * into the macro's body and inserting the resulting tokens right after the invocation, so that they are parsed next.
+     * Since operands are folded before, each argument is a single token. Expansions are built in a reused buffer,
+     * and the expansions of identical invocations are taken from a cache.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     */
+    void expand_macro();
+
+    /**
+     * Inserts @p tokens after the statement which ends with @p endToken and continues parsing with the inserted tokens.
+     * The tokens are inserted before the END_OF_FILE token if the statement is the last one.
+     * @param tokens tokens to insert
+     * @param endToken the token terminating the current statement, which has already been fetched
+     */
+    void insert_tokens_after_statement(const TokenVector &tokens, const Token &endToken);
+
+    /**
+     * Parses "SECTION" commands specific to the assembler, i.e. SECTION "name", ROM0 | ROMX [, bank] [, ALIGN bits],
+     * which start a new section. When assembling an object file, the code of the section is relocatable until ORG pins it.
+     * With ALIGN, the linker places the section at an address whose lowest @c bits bits are zero.
+     */
+    void parse_section();
+
+    /**
+     * Checks whether @p token is the keyword ALIGN of a SECTION command.
+     * @param token token following a comma
+     * @return true if the token starts the alignment of the section
+     */
+    static bool is_section_alignment(const Token &token) {
+        return token.get_token_type() == TokenType::IDENTIFIER && to_upper(token.get_string()) == "ALIGN";
+    }
+
+    /**
+     * Parses "ORG address" commands specific to the assembler, which set the address of the following code.
+     * When assembling an object file, ORG pins the current section to the address, thus it must precede the section's code.
+     */
+    void parse_org();
+
+    /**
+     * Parses "INCBIN" commands specific to the assembler, i.e. INCBIN "file" [, offset [, length]].
+     * The file is mapped into memory and the requested bytes are copied into the output buffer
+     * at the current address without being tokenized.
+     */
+    void parse_incbin();
+
+    /**
+     * Replaces every operand of the current statement which consists of several tokens, e.g. "CONSTANT * 2 + 1",
+     * by a single token. Constant expressions are folded to a NUMBER token, or to an ADDRESS token if they are enclosed
+     * by parentheses like "(BASE + 1)", so that they are memory operands like "(0xFF00)". Other expressions are represented by
+     * an IDENTIFIER token naming a symbol, whose value is the value of the expression, and which keeps the enclosing parentheses.
+     * The statement is compacted
+     * in place and the freed tokens at its end become END_OF_LINE tokens, i.e. empty statements.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     */
+    void fold_expressions();
+
+    /**
+     * Compiles the expression consisting of the tokens from @p begin to @p end (exclusive) to reverse polish notation
+     * using the shunting-yard algorithm. Defined symbols are replaced by their values, so that constant subexpressions
+     * are folded right away. Expressions depending on undefined symbols are deferred until all symbols are known.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     * @param begin position of the expression's first token
+     * @param end position after the expression's last token
+     * @return the token replacing the expression
+     */
+    Token compile_expression(const TokenVectorPosition begin, const TokenVectorPosition end);
+
+    /**
+     * Records @p expression as the value of the symbol @p symbolId, which is evaluated once all symbols are known.
+     * The first definition of a symbol is kept.
+     * @param symbolId ID of the symbol
+     * @param expression expression depending on undefined symbols
+     * @param token token used for error messages
+     * @param isEquate true if the symbol is an EQU constant
+     */
+    void defer_expression(const SymbolId symbolId, const Expression &expression, const Token &token, const bool isEquate);
+
+    /**
+     * Evaluates all deferred expressions and assigns their values to their symbols.
+     * Recursive definitions and EQU constants depending on undefined symbols are reported.
+     */
+    void evaluate_deferred_expressions();
+
+    /**
+     * Evaluates the deferred expression at @p index, evaluating the deferred expressions it depends on first.
+     * @throws SourceError containing an error message and highlighted code passage in case of evaluation error.
+     * @param index index of the deferred expression
+     * @param states evaluation state of every deferred expression
+     */
+    void evaluate_deferred_expression(const size_t index, std::vector<EvaluationState> &states);
+
+    /**
+     * Parses the data directives "DB" and "DW" specific to the assembler, i.e. DB value [, value]*.
+     * The values are appended straight to the output buffer. Only values referring to symbols
+     * which are not defined yet are recorded as fixups. DB additionally accepts strings, whose characters
+     * are emitted as bytes.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     * @param kind NUMBER_8_BIT for DB, NUMBER_16_BIT for DW
+     */
+    void parse_data(const FixupKind kind);
+
+    /**
+     * Parses the data directive "DS" specific to the assembler, i.e. DS count [, fill].
+     * Reserves count bytes filled with the 8-bit value fill, which defaults to zero.
+     * Both numbers must be known already since they determine the following addresses.
+     * @throws SourceError containing an error message and highlighted code passage in case of parsing error.
+     */
+    void parse_data_space();
+
+    /**
+     * Parses "LOOPBOUND count" commands specific to the assembler, which annotate the loop starting with the following
+     * instruction with the maximum number of times its first instruction is executed each time the loop is entered.
+     * The bounds do not change the bytecode, they are only applied by the WcetAnalyzer.
+     */
+    void parse_loop_bound();
+
+    /**
+     * Determines the path of the file referred to by @p pathToken, e.g. in INCLUDE or INCBIN commands.
+     * Relative paths are searched relative to the directory of the including file first,
+     * then relative to the working directory.
+     * @param pathToken STRING token containing the path
+     * @return the normalized path of the included file
+     */
+    std::string resolve_include_path(const Token &pathToken) const;
+
     /**
      * Checks whether all tokens have already been consumed
      * @return true if there are no tokens left to parse.
@@ -633,31 +1484,53 @@ private:
     const std::string& get_code() const noexcept;
 
     /**
-     * Throws a logic error exception containing a string, in which the token is highlighted.
-     * @throws std::logic_error
+     * Throws a SourceError containing a string, in which the token is highlighted.
+     * @throws SourceError
      * @param token the token to highlight
      * @param errorMessage an error message printed before the highlighted line
      */
     void throw_logic_error_and_highlight(const Token &token, const std::string &errorMessage) const;
 
     /**
-     * Throws a logic error exception containing a string, in which the token is highlighted.
+     * Throws a SourceError containing a string, in which the token is highlighted.
      * Additionally, the token @p referenceToken which is referenced by @p token is mentioned in the error message.
-     * @throws std::logic_error
+     * @throws SourceError
      * @param token the token to highlight
      * @param errorMessage an error message printed before the highlighted line
      */
     void throw_logic_error_and_highlight_with_reference(const Token &token, const Token &referenceToken, const std::string &errorMessage) const;
 
     /**
-     * Throws an invalid argument exception containing a string, in which the token is highlighted.
+     * Throws a SourceError containing a string, in which the token is highlighted.
      * This should be used for failed symbol resolution only.
-     * @throws std::invalid_argument
+     * @throws SourceError
      * @param token the token to highlight
      * @param errorMessage an error message printed before the highlighted line
      */
     void throw_invalid_argument_and_highlight(const Token &token, const std::string &errorMessage) const;
 
+    /**
+     * Reports an error in which @p token is highlighted, without interrupting parsing.
+     * @param token the token to highlight
+     * @param errorMessage an error message printed before the highlighted line
+     */
+    void report_and_highlight(const Token &token, const std::string &errorMessage);
+
+    /**
+     * Returns the @p errorMessage followed by the source line of @p token, in which the token is highlighted.
+     * @param token the token to highlight
+     * @param errorMessage an error message printed before the highlighted line
+     * @return string containing the error message and the highlighted line
+     */
+    std::string to_string_highlighted(const Token &token, const std::string &errorMessage) const;
+
+    /**
+     * Returns a line naming the file of @p token, if the token stems from an included file.
+     * @param token a token
+     * @return line naming the included file, or an empty string for tokens of the main file
+     */
+    std::string to_string_file_prefix(const Token &token) const;
+
     /**
      * Tries to convert a token @p numToken into a long number.
      * @throws std::logic_error containing an error message and highlighted code
@@ -674,13 +1547,35 @@ private:
      */
     long to_number_conditional(const Token &numToken, const std::function<bool(long)> &condition, const std::string &errorStr) const;
 
+    /**
+     * Checks whether the @p number retrieved from @p numToken fulfills a certain condition.
+     * @throws SourceError containing an error message and highlighted code
+     * @param numToken token from which @p number has been retrieved
+     * @param number the number to check
+     * @return @p number
+     */
+    long check_number_conditional(const Token &numToken, const long number, const std::function<bool(long)> &condition, const std::string &errorStr) const;
+
+    /**
+     * Checks whether @p value, which has been retrieved from @p token, is valid for an operand of kind @p kind
+     * and converts it into the operand's value. Only reads the symbol table, thus it is safe to be called
+     * concurrently once the symbol table is complete.
+     * @throws SourceError containing an error message and highlighted code
+     * @param token operand token
+     * @param value numeric value of @p token
+     * @param kind kind of the operand
+     * @param referenceAddress address of the instruction, only used for relative offsets
+     * @return the value of the operand
+     */
+    long check_value(const Token &token, const long value, const FixupKind kind, const size_t referenceAddress = 0) const;
+
     /**
      * Tries to convert a token @p numToken into an 8-bit number.
      * @throws std::logic_error containing an error message and highlighted code
      * @param numToken token
      * @return the 8-bit number retrieved from @p numToken
      */
-    byte to_number_8_bit(const Token &numToken) const;
+    byte to_number_8_bit(const Token &numToken);
 
     /**
      * Tries to convert a token @p numToken into an unsigned 8-bit number.
@@ -688,7 +1583,7 @@ private:
      * @param numToken token
      * @return the unsigned 8-bit number retrieved from @p numToken
      */
-    byte to_unsigned_number_8_bit(const Token &numToken) const;
+    byte to_unsigned_number_8_bit(const Token &numToken);
 
     /**
      * Tries to convert a token @p numToken into a signed 8-bit number.
@@ -696,7 +1591,7 @@ private:
      * @param numToken token
      * @return the signed 8-bit number retrieved from @p numToken
      */
-    byte to_signed_number_8_bit(const Token &numToken) const;
+    byte to_signed_number_8_bit(const Token &numToken);
 
     /**
      * Tries to convert a token @p numToken into a 16-bit number.
@@ -704,7 +1599,7 @@ private:
      * @param numToken token
      * @return the 16-bit number retrieved from @p numToken
      */
-    long to_number_16_bit(const Token &numToken) const;
+    long to_number_16_bit(const Token &numToken);
 
     /**
      * Tries to convert a token @p numToken into an unsigned 16-bit number.
@@ -712,17 +1607,37 @@ private:
      * @param numToken token
      * @return the unsigned 16-bit number retrieved from @p numToken
      */
-    long to_unsigned_number_16_bit(const Token &numToken) const;
+    long to_unsigned_number_16_bit(const Token &numToken);
 
     /**
      * Calculates the relative offset in bytes between the @p positionToken (e.g. a local or global label)
-     * and the @p referenceAddress. Then, this offset is tried to be converted to a signed 8-bit number.
+     * and the instruction following the jump at @p referenceAddress. Then, this offset is tried to be converted to a signed 8-bit number.
      * @throws std::logic_error containing an error message and highlighted code
      * @param positionToken token indicating the position
      * @param referenceAddress the reference address to which the offset is calculated
      * @return the signed 8-bit offset retrieved from the distance between the token and the reference address
      */
-    byte to_relative_offset(const Token &positionToken, const size_t referenceAddress) const;
+    byte to_relative_offset(const Token &positionToken, const size_t referenceAddress);
+
+    /**
+     * Calculates the relative offset between the position @p tokenValue of @p positionToken and the instruction
+     * following the jump at @p referenceAddress and checks whether it is a signed 8-bit number.
+     * @throws SourceError containing an error message and highlighted code
+     * @param positionToken token indicating the position
+     * @param tokenValue numeric value of @p positionToken
+     * @param referenceAddress the reference address to which the offset is calculated
+     * @return the relative offset
+     */
+    long check_relative_offset(const Token &positionToken, const long tokenValue, const size_t referenceAddress) const;
+
+    /**
+     * Calculates the offset of a relative jump at the current address to the address @p targetToken refers to,
+     * if both are already known and in the same address space, i.e. both absolute or both in the current relocatable section.
+     * Like the encoded offset, it is relative to the instruction following the jump.
+     * @param targetToken token indicating the target address
+     * @return the offset, or std::nullopt if it is only known later on
+     */
+    std::optional<long> known_jump_distance(const Token &targetToken) const;
 
     /**
      * Tries to convert a token @p indexToken into a bit index (i.e. a number between 0 and 7).
@@ -730,7 +1645,16 @@ private:
      * @param indexToken token
      * @return the bit index retrieved from @p numToken
      */
-    byte to_index(const Token &indexToken) const;
+    byte to_index(const Token &indexToken);
+
+    /**
+     * Checks whether @p number retrieved from @p indexToken is a bit index (i.e. a number between 0 and 7).
+     * @throws SourceError containing an error message and highlighted code
+     * @param indexToken token
+     * @param number numeric value of @p indexToken
+     * @return @p number
+     */
+    long check_index(const Token &indexToken, const long number) const;
 
     /**
      * Tries to convert a token @p conditionToken into a flag condition (i.e. NZ, Z, C, or NC)
@@ -821,14 +1745,75 @@ private:
      */
     void expect_end_of_context(const Token& token) const;
 
-    std::string _code{}; ///< the code which was used to generate the tokens
+    /**
+     * A source file whose tokens are parsed. Tokens refer to it by their file index.
+     */
+    struct SourceFile {
+        static constexpr size_t NO_PARENT = static_cast<size_t>(-1); ///< parent index of the main file
+
+        std::string path{};     ///< path of the file, empty for code which does not stem from a file
+        std::shared_ptr<const std::string> code{};  ///< content of the file, shared with tokenizers of conditional blocks
+        std::shared_ptr<const LineIndex> lineIndex{}; ///< line start offsets of code, used for highlighting errors
+        size_t parentIndex{NO_PARENT}; ///< index of the file which includes this file
+    };
+
+    /**
+     * What the first pass reads and builds besides the parser's state, which every further pass reuses.
+     */
+    struct PassInputs {
+        TokenVector tokens{}; ///< the tokens passed to the constructor, before parsing modified them
+        std::unordered_map<std::string, SourceFile> includedFiles{}; ///< each file read by INCLUDE by path
+        std::unordered_map<std::string, std::shared_ptr<const MappedFile>> binaryFiles{}; ///< each file mapped by INCBIN by path
+        std::unordered_map<std::string, MacroExpansion> macroExpansions{}; ///< expansions by macro definition and arguments
+    };
+
+    std::vector<SourceFile> _sources{}; ///< the main file (index 0) and all included files
+    std::shared_ptr<PassInputs> _passInputs{std::make_shared<PassInputs>()}; ///< inputs shared by all passes of an assembly
+    std::shared_ptr<TokenCache> _tokenCache{std::make_shared<TokenCache>()}; ///< cache of the tokens of included files
+    Diagnostics _diagnostics{}; ///< all errors found while parsing
+    size_t _numberOfThreads{0}; ///< maximum number of threads resolving the fixups, 0 for the number of hardware threads
+    size_t _minimumFixupsPerThread{DEFAULT_MINIMUM_FIXUPS_PER_THREAD}; ///< minimum number of fixups per resolving thread
     TokenVector _tokenVector{}; ///< the tokens which are parsed by the parser
 
     size_t _currentTokenPosition{}; ///< the position of the current token in _tokenVector
     Address _currentAddress{0}; ///< the bytecode address of the current instruction
     Token _currentGlobalLabel{}; ///< the currently active global label. Is used for resolving the local labels.
 
-    SymbolToNumeric _symbolicTable{}; ///< symbolic table, which contains all symbols, labels etc.
+    std::unordered_map<std::string, SymbolId> _symbolIds{}; ///< maps each symbol's name to its ID
+    std::vector<std::optional<NumericFromToken>> _symbols{}; ///< symbolic table indexed by SymbolId, which contains all symbols, labels etc.
+
+    Bytestring _output{}; ///< the assembled bytecode
+    std::vector<ObjectSection> _sections{ObjectSection{"", SectionType::ROM0, 0, 0, {}}}; ///< all sections, starting with the one of code preceding the first SECTION
+    std::vector<size_t> _sectionStarts{0}; ///< the offset of each section's first byte in _output
+    std::vector<OutputBlock> _outputBlocks{OutputBlock{}}; ///< the blocks of _output started by ORG, unless assembling an object file
+    std::unordered_map<SymbolId, size_t> _relocatableSymbols{}; ///< the section of each label in a relocatable section
+    std::vector<SymbolId> _exportedSymbols{}; ///< global labels and constants, which other object files may refer to
+    std::vector<Relocation> _relocations{}; ///< operands which are resolved by the linker, referring to symbols by SymbolId
+    std::vector<std::pair<std::string, uint64_t>> _binaryFiles{}; ///< path and content hash of each file included by INCBIN
+    std::vector<size_t> _instructionOffsets{}; ///< the offset of each emitted instruction in _output
+    std::vector<Address> _instructionAddresses{}; ///< the address of each emitted instruction
+    std::vector<std::pair<size_t, size_t>> _codeRanges{}; ///< offset and size of each run of consecutive instructions in _output
+    std::vector<Fixup> _fixups{}; ///< operands which are patched after all symbols are known
+    std::vector<DeferredExpression> _deferredExpressions{}; ///< expressions which are evaluated once all symbols are known
+    std::unordered_map<SymbolId, size_t> _deferredExpressionIndices{}; ///< index into _deferredExpressions by symbol ID
+    std::vector<ConditionalFrame> _conditionals{}; ///< nested IF statements whose ENDC has not been parsed yet
+    std::unordered_map<std::string, Macro> _macros{}; ///< all macros by name
+    TokenVector _expansionBuffer{}; ///< buffer in which macro expansions are built, reused for every expansion
+    size_t _numberOfMacroExpansions{0}; ///< number of macro invocations expanded so far
+    std::optional<PendingFixup> _pendingFixup{}; ///< unresolved operand of the instruction which is currently parsed
+    TokenVectorPosition _statementStart{}; ///< the position of the first token of the current statement
+    bool _isEmitting{false}; ///< true while instructions are emitted, i.e. while unresolved operands may be deferred
+    bool _isRelocatable{false}; ///< true while assembling an object file, whose sections are placed by the linker
+    bool _isRelaxingBranches{true}; ///< true if forward JMP instructions are assembled as JR until they turn out to be out of range
+    std::unordered_set<size_t> _longJumps{}; ///< the indices of the instructions of jumps which are assembled as JP
+    std::vector<RelaxableJump> _relaxableJumps{}; ///< forward jumps of the current pass which are assembled as JR
+    size_t _numberOfInstructions{0}; ///< number of instructions parsed so far in the current pass, including removed ones
+    bool _isOptimizing{false}; ///< true if the peephole rules are applied
+    std::unordered_map<size_t, PeepholeRewrite> _rewrites{}; ///< peephole rewrites found in the previous pass, by instruction index
+    size_t _replacedInstruction{static_cast<size_t>(-1)}; ///< index of the instruction which was replaced last, whose sequence may be removed
+    std::vector<PeepholeStatistics> _peepholeStatistics = std::vector<PeepholeStatistics>(PeepholeOptimizer::get_rules().size()); ///< savings per rule
+    size_t _numberOfPasses{1}; ///< number of passes over the source
+    LoopBounds _loopBounds{}; ///< iteration bounds given by LOOPBOUND, by the address of the loop's first instruction
 };
 
 
@@ -0,0 +1,272 @@
+#include "parser.h"
+
+#include <stdexcept>
+
+namespace {
+    /**
+     * Checks whether @p token is a global or local label.
+     * @param token token
+     * @return true if @p token is a label
+     */
+    bool is_label(const Token &token) {
+        return token.get_token_type() == TokenType::GLOBAL_LABEL || token.get_token_type() == TokenType::LOCAL_LABEL;
+    }
+
+    /**
+     * Returns the binary operation denoted by the OPERATOR token string @p operatorString.
+     * @param operatorString string of an OPERATOR token
+     * @return the binary operation, or std::nullopt if @p operatorString denotes none
+     */
+    std::optional<ExpressionOperation> to_binary_operation(const std::string &operatorString) {
+        if      (operatorString == "*")  { return ExpressionOperation::MULTIPLY; }
+        else if (operatorString == "/")  { return ExpressionOperation::DIVIDE; }
+        else if (operatorString == "+")  { return ExpressionOperation::ADD; }
+        else if (operatorString == "-")  { return ExpressionOperation::SUBTRACT; }
+        else if (operatorString == "<<") { return ExpressionOperation::SHIFT_LEFT; }
+        else if (operatorString == ">>") { return ExpressionOperation::SHIFT_RIGHT; }
+        else if (operatorString == "&")  { return ExpressionOperation::AND; }
+        else if (operatorString == "|")  { return ExpressionOperation::OR; }
+        return std::nullopt;
+    }
+}
+
+void Parser::fold_expressions() {
+    if (read_current().get_token_type() != TokenType::IDENTIFIER) { // labels end their statement on their own
+        return;
+    }
+
+    // operands start after the mnemonic or directive, and after "EQU" for "NAME EQU expression"
+    const TokenVectorPosition statementEnd = find_statement_end();
+    TokenVectorPosition operandBegin = _statementStart + 1;
+    if (operandBegin < statementEnd && _tokenVector[operandBegin].get_string() == "EQU") {
+        ++operandBegin;
+    }
+
+    // operands are compacted in place, since an expression is never shorter than its replacing token
+    TokenVectorPosition writePosition = operandBegin;
+    for (TokenVectorPosition position = operandBegin; position <= statementEnd; ++position) {
+        if (position < statementEnd && _tokenVector[position].get_token_type() != TokenType::COMMA) {
+            continue;
+        }
+
+        if (position - operandBegin > 1 && is_section_alignment(_tokenVector[operandBegin])) { // the keyword of "ALIGN bits"
+            _tokenVector[writePosition++] = _tokenVector[operandBegin++];
+        }
+        if (position - operandBegin > 1) {
+            _tokenVector[writePosition++] = compile_expression(operandBegin, position);
+        } else if (position - operandBegin == 1) {
+            _tokenVector[writePosition++] = _tokenVector[operandBegin];
+        }
+        if (position < statementEnd) {
+            _tokenVector[writePosition++] = _tokenVector[position]; // the comma
+        }
+        operandBegin = position + 1;
+    }
+
+    if (writePosition < statementEnd) {
+        const Token &endToken = _tokenVector[statementEnd];
+        Token emptyStatement(endToken.get_line(), endToken.get_column(), TokenType::END_OF_LINE, "\\n");
+        emptyStatement.set_file_index(endToken.get_file_index());
+        std::fill(_tokenVector.begin() + writePosition, _tokenVector.begin() + statementEnd, emptyStatement);
+    }
+}
+
+Token Parser::compile_expression(const TokenVectorPosition begin, const TokenVectorPosition end) {
+    struct PendingOperator {
+        ExpressionOperation operation;
+        bool isParenthesis;
+        Token token;
+    };
+
+    Expression expression{};
+    std::vector<PendingOperator> operators{};
+    std::optional<Token> labelReference{}; // labels make relative jumps to an expression relative
+    std::string name{};
+    bool isExpectingOperand = true;
+    size_t depth = 0;
+    // like (0xFF00), an expression enclosed by parentheses is the address of a memory operand
+    bool isParenthesized = read_token(begin).get_token_type() == TokenType::OPERATOR && read_token(begin).get_string() == "(";
+
+    const auto apply = [&](const PendingOperator &pendingOperator) {
+        try {
+            expression.apply(pendingOperator.operation);
+        } catch (const std::domain_error &error) {
+            throw_logic_error_and_highlight(pendingOperator.token, std::string("Parse error: ") + error.what());
+        }
+    };
+    const auto push_binary_operator = [&](const ExpressionOperation operation, const Token &token) {
+        while (!operators.empty() && !operators.back().isParenthesis
+            && precedence(operators.back().operation) >= precedence(operation)) {
+            apply(operators.back());
+            operators.pop_back();
+        }
+        operators.push_back(PendingOperator{operation, false, token});
+    };
+
+    for (TokenVectorPosition position = begin; position < end; ++position) {
+        const Token token = read_token(position);
+        const std::string tokenString = token.get_string();
+        const TokenType tokenType = token.get_token_type();
+        name += tokenString;
+
+        if (isExpectingOperand) {
+            if (tokenType == TokenType::OPERATOR && tokenString == "(") {
+                operators.push_back(PendingOperator{ExpressionOperation::ADD, true, token});
+                ++depth;
+            } else if (tokenType == TokenType::OPERATOR && tokenString == "-") {
+                operators.push_back(PendingOperator{ExpressionOperation::NEGATE, false, token});
+            } else if (tokenType == TokenType::OPERATOR && tokenString == "~") {
+                operators.push_back(PendingOperator{ExpressionOperation::COMPLEMENT, false, token});
+            } else if (tokenType == TokenType::OPERATOR && tokenString == "+") {
+                // unary plus does not change the operand
+            } else if (tokenType == TokenType::IDENTIFIER && (to_upper(tokenString) == "HIGH" || to_upper(tokenString) == "LOW")) {
+                operators.push_back(PendingOperator{(to_upper(tokenString) == "HIGH") ? ExpressionOperation::HIGH : ExpressionOperation::LOW, false, token});
+            } else if (tokenType == TokenType::NUMBER || tokenType == TokenType::ADDRESS) { // addresses are parenthesized numbers
+                expression.push_constant(token.get_numeric());
+                isExpectingOperand = false;
+            } else if (tokenType == TokenType::IDENTIFIER || tokenType == TokenType::LOCAL_LABEL) {
+                // parenthesized symbols like (CONSTANT) are tokenized as a single identifier
+                const std::string symbolName = (tokenString.front() == '(') ? tokenString.substr(1, tokenString.size() - 2) : tokenString;
+                const SymbolId symbolId = intern_symbol(symbolName);
+                const std::optional<NumericFromToken> &symbol = _symbols[symbolId];
+                if (symbol.has_value() && !is_relocatable_symbol(symbolId)) {
+                    expression.push_constant(symbol->get_numeric());
+                    if (is_label(symbol->get_token())) {
+                        labelReference = symbol->get_token();
+                    }
+                } else {
+                    expression.push_symbol(symbolId);
+                }
+                isExpectingOperand = false;
+            } else {
+                throw_logic_error_and_highlight(token, "Parse error: Expected an operand in expression, but found '" + tokenString + "'");
+            }
+        } else {
+            const std::optional<ExpressionOperation> binaryOperation = to_binary_operation(tokenString);
+            if (tokenType == TokenType::OPERATOR && tokenString == ")") {
+                while (!operators.empty() && !operators.back().isParenthesis) {
+                    apply(operators.back());
+                    operators.pop_back();
+                }
+                if (operators.empty()) {
+                    throw_logic_error_and_highlight(token, "Parse error: Found ')' without matching '(' in expression");
+                }
+                operators.pop_back();
+                if (--depth == 0 && position + 1 < end) { // e.g. (1+2)*3
+                    isParenthesized = false;
+                }
+            } else if (tokenType == TokenType::OPERATOR && binaryOperation.has_value()) {
+                push_binary_operator(*binaryOperation, token);
+                isExpectingOperand = true;
+            } else if (tokenType == TokenType::NUMBER && is_sign(tokenString.front())) {
+                // the tokenizer attaches the sign to the number, e.g. "CONSTANT-1" is "CONSTANT" followed by "-1"
+                push_binary_operator(ExpressionOperation::ADD, token);
+                expression.push_constant(token.get_numeric());
+            } else {
+                throw_logic_error_and_highlight(token, "Parse error: Expected an operator in expression, but found '" + tokenString + "'");
+            }
+        }
+    }
+
+    if (isExpectingOperand) {
+        throw_logic_error_and_highlight(read_token(end - 1), "Parse error: Expected an operand at the end of the expression");
+    }
+    while (!operators.empty()) {
+        if (operators.back().isParenthesis) {
+            throw_logic_error_and_highlight(operators.back().token, "Parse error: Found '(' without matching ')' in expression");
+        }
+        apply(operators.back());
+        operators.pop_back();
+    }
+
+    const Token &firstToken = _tokenVector[begin];
+    if (expression.is_constant() && !labelReference.has_value()) {
+        const std::string number = std::to_string(expression.get_constant());
+        Token numberToken = isParenthesized ? Token(firstToken.get_line(), firstToken.get_column(), TokenType::ADDRESS, "(" + number + ")")
+                                            : Token(firstToken.get_line(), firstToken.get_column(), TokenType::NUMBER, number);
+        numberToken.set_file_index(firstToken.get_file_index());
+        return numberToken;
+    }
+
+    // the expression is represented by a symbol named after the expression, which keeps the parentheses of a memory operand
+    Token symbolToken(firstToken.get_line(), firstToken.get_column(), TokenType::IDENTIFIER, name);
+    symbolToken.set_file_index(firstToken.get_file_index());
+    const SymbolId symbolId = intern_symbol(name);
+    if (expression.is_constant()) {
+        if (!_symbols[symbolId].has_value()) {
+            _symbols[symbolId] = NumericFromToken(expression.get_constant(), *labelReference);
+        }
+    } else {
+        defer_expression(symbolId, expression, symbolToken, false);
+    }
+    return symbolToken;
+}
+
+void Parser::defer_expression(const SymbolId symbolId, const Expression &expression, const Token &token, const bool isEquate) {
+    if (_symbols[symbolId].has_value() || _deferredExpressionIndices.count(symbolId) > 0) { // the first definition is kept
+        return;
+    }
+    _deferredExpressionIndices.emplace(symbolId, _deferredExpressions.size());
+    _deferredExpressions.push_back(DeferredExpression{symbolId, expression, token, isEquate});
+}
+
+void Parser::evaluate_deferred_expressions() {
+    std::vector<EvaluationState> states(_deferredExpressions.size(), EvaluationState::PENDING);
+    for (size_t index = 0; index < _deferredExpressions.size(); ++index) {
+        try {
+            evaluate_deferred_expression(index, states);
+        } catch (const SourceError &sourceError) {
+            _diagnostics.report(sourceError);
+        }
+    }
+}
+
+void Parser::evaluate_deferred_expression(const size_t index, std::vector<EvaluationState> &states) {
+    const DeferredExpression &deferred = _deferredExpressions[index];
+    if (states[index] == EvaluationState::DONE) {
+        return;
+    }
+    if (states[index] == EvaluationState::ACTIVE) {
+        throw_logic_error_and_highlight(deferred.token, "Parse error: Symbol " + deferred.token.get_string() + " is defined recursively");
+    }
+    states[index] = EvaluationState::ACTIVE;
+
+    std::optional<Token> labelReference{};
+    std::optional<long> value{};
+    try {
+        value = deferred.expression.evaluate([&](const SymbolId symbolId) -> std::optional<long> {
+            const auto iterator = _deferredExpressionIndices.find(symbolId);
+            if (!_symbols[symbolId].has_value() && iterator != _deferredExpressionIndices.cend()) {
+                evaluate_deferred_expression(iterator->second, states);
+            }
+
+            const std::optional<NumericFromToken> &symbol = _symbols[symbolId];
+            if (!symbol.has_value() || is_relocatable_symbol(symbolId)) { // relocatable labels are left to the linker
+                return std::nullopt;
+            }
+            if (is_label(symbol->get_token())) {
+                labelReference = symbol->get_token();
+            }
+            return symbol->get_numeric();
+        });
+    } catch (const std::domain_error &error) {
+        // assign a value anyway, so that the error is not reported again by every use of the symbol
+        states[index] = EvaluationState::DONE;
+        _symbols[deferred.symbolId] = NumericFromToken(0, deferred.token);
+        throw_logic_error_and_highlight(deferred.token, std::string("Parse error: ") + error.what());
+    } catch (const SourceError &) {
+        states[index] = EvaluationState::DONE;
+        _symbols[deferred.symbolId] = NumericFromToken(0, deferred.token);
+        throw;
+    }
+    states[index] = EvaluationState::DONE;
+
+    if (value.has_value()) {
+        _symbols[deferred.symbolId] = NumericFromToken(*value, labelReference.value_or(deferred.token));
+    } else if (deferred.isEquate && !_isRelocatable) { // object files leave unresolved symbols to the linker
+        _symbols[deferred.symbolId] = NumericFromToken(0, deferred.token);
+        throw_logic_error_and_highlight(deferred.token, "Parse error: The value of " + deferred.token.get_string() +
+                                                        " depends on a symbol which could not be resolved");
+    }
+    // otherwise, every operand using the expression reports the unresolved symbol
+}
@@ -1,9 +1,13 @@
 #include "parser.h"
 
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 /******************************/
 /******** ADD COMMANDS ********/
 /******************************/
-UnresolvedInstructionPtr Parser::parse_add() {
+void Parser::parse_add() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     if (read_next().get_token_type() ==
@@ -18,41 +22,29 @@ UnresolvedInstructionPtr Parser::parse_add() {
             to_register_expect(destinationToken, Register8Bit::A);
 
             if (is_register_8_bit(sourceToken)) {
-                return create_unresolved_instruction([this, sourceToken]() {
-                    return AddAAnd8BitRegister(to_register_8_bit(sourceToken));
-                });
+                emit(AddAAnd8BitRegister(to_register_8_bit(sourceToken)));
             } else { // is number or symbol
-                return create_unresolved_instruction([this, sourceToken]() {
-                    return AddAAndImmediate(to_number_8_bit(sourceToken));
-                });
+                emit(AddAAndImmediate(to_number_8_bit(sourceToken)));
             }
         } else if (is_register_16_bit(destinationToken)) { // Case 2: 16-bit (destinationToken is HL or SP)
             if (is_register_16_bit(sourceToken)) {
-                return create_unresolved_instruction([this, sourceToken]() {
-                    return AddHLAnd16BitRegister(to_register_16_bit(sourceToken));
-                });
+                emit(AddHLAnd16BitRegister(to_register_16_bit(sourceToken)));
             } else { // is number or symbol
-                return create_unresolved_instruction([this, sourceToken]() {
-                    return AddSPAndImmediate(to_signed_number_8_bit(sourceToken));
-                });
+                emit(AddSPAndImmediate(to_signed_number_8_bit(sourceToken)));
             }
         }
     } else { // short version, e.g. "ADD B", ONLY for 8-bit contexts
         const Token sourceToken = fetch();
 
         if (is_register_8_bit(sourceToken)) {
-            return create_unresolved_instruction([this, sourceToken]() {
-                return AddAAnd8BitRegister(to_register_8_bit(sourceToken));
-            });
+            emit(AddAAnd8BitRegister(to_register_8_bit(sourceToken)));
         } else { // is number or symbol
-            return create_unresolved_instruction([this, sourceToken]() {
-                return AddAAndImmediate(to_number_8_bit(sourceToken));
-            });
+            emit(AddAAndImmediate(to_number_8_bit(sourceToken)));
         }
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_adc() {
+void Parser::parse_adc() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. ADC A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -62,17 +54,9 @@ UnresolvedInstructionPtr Parser::parse_adc() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return AddWithCarryAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(AddWithCarryAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return AddWithCarryAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(AddWithCarryAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
@@ -80,7 +64,7 @@ UnresolvedInstructionPtr Parser::parse_adc() {
 /******** BIT COMPLEMENT COMMANDS ********/
 /*****************************************/
 
-UnresolvedInstructionPtr Parser::parse_bit() {
+void Parser::parse_bit() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     const Token indexToken = fetch();
@@ -91,41 +75,36 @@ UnresolvedInstructionPtr Parser::parse_bit() {
 
     expect_type(commaToken, TokenType::COMMA);
 
-    return create_unresolved_instruction([this, indexToken, registerToken]() {
-        return BitOf8BitRegisterComplementIntoZero(to_index(indexToken),
-                                                   to_register_8_bit(registerToken));
-    });
+    emit(BitOf8BitRegisterComplementIntoZero(to_index(indexToken), to_register_8_bit(registerToken)));
 }
 
 /**********************************/
 /******** INC/DEC COMMANDS ********/
 /**********************************/
 
-UnresolvedInstructionPtr Parser::parse_inc() {
+void Parser::parse_inc() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token registerToken = fetch();
     if (registerToken.get_string() == "AF") {
         throw_logic_error_and_highlight(registerToken, "Parser error: \"AF\" is forbidden in this context");
     }
-    return create_unresolved_instruction(
-            [this, registerToken]() { return IncrementRegister(to_register(registerToken)); });
+    emit(IncrementRegister(to_register(registerToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_dec() {
+void Parser::parse_dec() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token registerToken = fetch();
     if (registerToken.get_string() == "AF") {
         throw_logic_error_and_highlight(registerToken, "Parser error: \"AF\" is forbidden in this context");
     }
-    return create_unresolved_instruction(
-            [this, registerToken]() { return DecrementRegister(to_register(registerToken)); });
+    emit(DecrementRegister(to_register(registerToken)));
 }
 
 /*******************************/
 /******** JUMP COMMANDS ********/
 /*******************************/
 
-UnresolvedInstructionPtr Parser::parse_jp() {
+void Parser::parse_jp() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     if (read_next().get_token_type() == TokenType::COMMA) { // conditioned version, e.g. JP NZ, 0x1234
@@ -133,45 +112,127 @@ UnresolvedInstructionPtr Parser::parse_jp() {
         const Token commaToken = fetch();
         const Token addressToken = fetch();
 
-        return create_unresolved_instruction([this, conditionToken, addressToken]() {
-            return JumpConditional(to_flag_condition(conditionToken), to_unsigned_number_16_bit(addressToken));
-        });
+        emit(JumpConditional(to_flag_condition(conditionToken), to_unsigned_number_16_bit(addressToken)));
     } else { // short version
         const Token addressToken = fetch();
 
         if (is_register(addressToken)) { // JP HL
             to_register_expect(addressToken, Register16Bit::HL);
-            return create_unresolved_instruction([]() { return JumpToHL(); });
+            emit(JumpToHL());
         } else { // has to be numeric value
-            return create_unresolved_instruction(
-                    [this, addressToken]() { return Jump(to_unsigned_number_16_bit(addressToken)); });
+            emit(Jump(to_unsigned_number_16_bit(addressToken)));
         }
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_jr() { // JR s8
+void Parser::parse_jr() { // JR [condition,] s8
     increment_position(); // because instruction-specific token was already checked before calling the function
+
+    std::optional<FlagCondition> condition{};
+    if (read_next().get_token_type() == TokenType::COMMA) { // conditioned version, e.g. JR NZ, LOOP
+        condition = to_flag_condition(fetch());
+        increment_position(); // the comma
+    }
     const auto offsetToken = fetch();
 
+    byte offset;
     if (offsetToken.get_token_type() == TokenType::NUMBER) { // relative jump to fixed address
-        return create_unresolved_instruction([this, offsetToken]() {
-            return JumpRelative(to_signed_number_8_bit(offsetToken));
-        });
+        offset = to_signed_number_8_bit(offsetToken);
+    } else {
+        // else, it has to be label or constant. Please do not use signed 8-bit constants, as they will be treated like labels!
+        expect_type(offsetToken, {TokenType::IDENTIFIER, TokenType::LOCAL_LABEL});
+        offset = to_relative_offset(offsetToken, _currentAddress);
+    }
+    condition.has_value() ? emit(JumpRelativeConditional(*condition, offset)) : emit(JumpRelative(offset));
+}
+
+void Parser::parse_jmp() { // JMP [condition,] target
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    std::optional<FlagCondition> condition{};
+    if (read_next().get_token_type() == TokenType::COMMA) {
+        condition = to_flag_condition(fetch());
+        increment_position(); // the comma
+    }
+    const Token targetToken = fetch();
+    const size_t instructionIndex = _numberOfInstructions; // the index emit() assigns to the jump
+
+    const auto emit_absolute = [&]() {
+        const word address = static_cast<word>(to_unsigned_number_16_bit(targetToken));
+        condition.has_value() ? emit(JumpConditional(*condition, address)) : emit(Jump(address));
+    };
+    const auto emit_relative = [&](const byte offset) {
+        condition.has_value() ? emit(JumpRelativeConditional(*condition, offset)) : emit(JumpRelative(offset));
+    };
+
+    if (_longJumps.count(instructionIndex) > 0) { // lengthened in a previous pass
+        emit_absolute();
+        return;
+    }
+    const std::optional<long> offset = known_jump_distance(targetToken);
+    if (offset.has_value()) {
+        is_signed_8_bit(*offset) ? emit_relative(static_cast<byte>(*offset)) : emit_absolute();
+        return;
+    }
+    if (!_isRelaxingBranches || is_symbol_defined(targetToken) || targetToken.has_numeric_value()) { // the distance is only known once linked
+        emit_absolute();
+        return;
+    }
+
+    // forward jumps are assumed to be in range, the next pass lengthens them if they are not
+    expect_type(targetToken, {TokenType::IDENTIFIER, TokenType::LOCAL_LABEL});
+    emit_relative(to_relative_offset(targetToken, _currentAddress));
+    _relaxableJumps.push_back(RelaxableJump{_fixups.size() - 1, instructionIndex, _sections.size() - 1});
+}
+
+void Parser::parse_call() { // CALL [condition,] a16
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    if (read_next().get_token_type() == TokenType::COMMA) { // conditioned version, e.g. CALL NZ, 0x1234
+        const Token conditionToken = fetch();
+        increment_position(); // the comma
+        const Token addressToken = fetch();
+        emit(CallConditional(to_flag_condition(conditionToken), to_unsigned_number_16_bit(addressToken)));
+    } else {
+        emit(Call(to_unsigned_number_16_bit(fetch())));
     }
+}
+
+void Parser::parse_ret() { // RET [condition]
+    increment_position(); // because instruction-specific token was already checked before calling the function
 
-    // else, it has to be label or constant. Please do not use signed 8-bit constants, as they will be treated like labels!
-    expect_type(offsetToken, {TokenType::IDENTIFIER, TokenType::LOCAL_LABEL});
-    const size_t referenceAddress = _currentAddress;
-    return create_unresolved_instruction([this, offsetToken, referenceAddress]() {
-        return JumpRelative(to_relative_offset(offsetToken, referenceAddress));
-    });
+    const TokenType nextType = read_current().get_token_type();
+    if (nextType == TokenType::END_OF_LINE || nextType == TokenType::END_OF_FILE) {
+        emit(Return());
+    } else {
+        emit(ReturnConditional(to_flag_condition(fetch())));
+    }
+}
+
+void Parser::parse_reti() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+    emit(ReturnFromInterrupt());
+}
+
+void Parser::parse_rst() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token vectorToken = fetch();
+    if (is_forward_reference(vectorToken)) {
+        throw_logic_error_and_highlight(vectorToken, "Parse error: The address of RST may only use symbols which are defined before");
+    }
+    const long address = to_number(vectorToken);
+    if (address < 0 || address > 0x38 || (address % 8) != 0) {
+        throw_logic_error_and_highlight(vectorToken, "Parse error: Expected one of the restart addresses 0x00, 0x08, ..., 0x38");
+    }
+    emit(Restart(static_cast<uint8_t>(address / 8)));
 }
 
 /*******************************/
 /******** LOAD COMMANDS ********/
 /*******************************/
 
-UnresolvedInstructionPtr Parser::parse_ld() {
+void Parser::parse_ld() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     /* The order is very specific, since for determining each subcase no
      * token type check of the token containing an immediate value may be done.
@@ -209,24 +270,18 @@ UnresolvedInstructionPtr Parser::parse_ld() {
         // 1a) LD HL, SP+s8
         if (destination == Register16Bit::HL) {
             expect_type(sourceToken, TokenType::SP_SHIFTED);
-            return create_unresolved_instruction([this, sourceToken]() {
-                return LoadSPShiftedByImmediateIntoHL(to_signed_number_8_bit(sourceToken));
-            });
+            emit(LoadSPShiftedByImmediateIntoHL(to_signed_number_8_bit(sourceToken)));
         // 1b) LD r16, a16
         } else if (!is_register_16_bit(sourceToken)) { // this strange construction must be so that the immediate value can be resolved as a last step
             if (destination == Register16Bit::AF) {
                 throw_logic_error_and_highlight(destinationToken, "Parser error: \"AF\" is forbidden in this context");
             }
-            return create_unresolved_instruction([this, sourceToken, destination]() {
-                return LoadImmediateInto16BitRegister(destination, to_number_16_bit(sourceToken));
-            });
+            emit(LoadImmediateInto16BitRegister(destination, to_number_16_bit(sourceToken)));
         // 1c) LD SP, HL
         } else {
             to_register_expect(destinationToken, Register16Bit::SP);
             to_register_expect(sourceToken, Register16Bit::HL);
-            return create_unresolved_instruction([]() {
-                return LoadHLIntoSP();
-            });
+            emit(LoadHLIntoSP());
         }
     // 2: LD r8, XX
     } else if (is_register_8_bit(destinationToken)){
@@ -238,47 +293,34 @@ UnresolvedInstructionPtr Parser::parse_ld() {
             if (source == destination && destination == Register8Bit::ADDRESS_HL) { // LD (HL), (HL) is forbidden
                 throw_logic_error_and_highlight(destinationToken, "Parser error: \"LD (HL), (HL)\" is invalid command");
             }
-            return create_unresolved_instruction([this, source, destination]() {
-                return Load8BitRegisterInto8BitRegister(source, destination);
-            });
+            emit(Load8BitRegisterInto8BitRegister(source, destination));
         } else if (destination == Register8Bit::A) {
             // 2b) LD A, XX
             // [1]: i) LD A, (BC)
             const std::string source_str = to_upper(sourceToken.get_string());
             if (source_str == "(BC)") // 4b
-                return create_unresolved_instruction([](){
-                    return LoadAddress16BitRegisterIntoA(Register16Bit::BC);
-                });
+                emit(LoadAddress16BitRegisterIntoA(Register16Bit::BC));
             // [2]: ii) LD A, (DE)
             else if (source_str == "(DE)") // 4b
-                return create_unresolved_instruction([](){
-                    return LoadAddress16BitRegisterIntoA(Register16Bit::DE);
-                });
+                emit(LoadAddress16BitRegisterIntoA(Register16Bit::DE));
             // [2]: i) LD A, (HL+)
             else if (source_str == "(HL+)" || source_str == "(HLI)") // 4c
-                return create_unresolved_instruction([](){
-                    return LoadAddressHLIncrementIntoA();
-                });
+                emit(LoadAddressHLIncrementIntoA());
             // [2]: ii) LD A, (HL-)
             else if (source_str == "(HL-)" || source_str == "(HLD)") // 4c
-                return create_unresolved_instruction([](){
-                    return LoadAddressHLDecrementIntoA();
-                });
+                emit(LoadAddressHLDecrementIntoA());
             // [3]: LD A, (C)
             else if (source_str == "(C)")
-                return create_unresolved_instruction([](){
-                    return LoadPortAddressCIntoA();
-                });
+                emit(LoadPortAddressCIntoA());
+            // [4]: LD A, (a16)
+            else if (is_address_operand(sourceToken))
+                emit(LoadAddressImmediateIntoA(to_number_16_bit(sourceToken)));
+            // [5]: LD A, d8
             else
-                // [4]: LD A, (a16)
-                return create_unresolved_instruction([this, sourceToken]() {
-                    return LoadAddressImmediateIntoA(to_number_16_bit(sourceToken));
-                });
+                emit(LoadImmediateInto8BitRegister(destination, to_number_8_bit(sourceToken)));
         } else {
             // 2c) LD r8, a8
-            return create_unresolved_instruction([this, sourceToken, destination]() {
-                return LoadImmediateInto8BitRegister(destination, to_number_8_bit(sourceToken));
-            });
+            emit(LoadImmediateInto8BitRegister(destination, to_number_8_bit(sourceToken)));
         }
     // 3 LD XX, A
     } else if (is_register_8_bit(sourceToken)) {
@@ -287,44 +329,30 @@ UnresolvedInstructionPtr Parser::parse_ld() {
 
         // 3a) [1] LD (BC), A
         if (destination_str == "(BC)")
-            return create_unresolved_instruction([](){
-                return LoadAIntoAddress16BitRegister(Register16Bit::BC);
-            });
+            emit(LoadAIntoAddress16BitRegister(Register16Bit::BC));
         // 3a) [2] LD (DE), A
         else if (destination_str == "(DE)")
-            return create_unresolved_instruction([](){
-                return LoadAIntoAddress16BitRegister(Register16Bit::DE);
-            });
+            emit(LoadAIntoAddress16BitRegister(Register16Bit::DE));
         // 3b) [1] LD (HL+), A
         else if (destination_str == "(HL+)" || destination_str == "(HLI)") // 2b (3)
-            return create_unresolved_instruction([](){
-                return LoadAIntoAddressHLIncrement();
-            });
+            emit(LoadAIntoAddressHLIncrement());
         // 3b) [4] LD (HL-), A
         else if (destination_str == "(HL-)" || destination_str == "(HLD)") // 2b (3)
-            return create_unresolved_instruction([](){
-                return LoadAIntoAddressHLDecrement();
-            });
+            emit(LoadAIntoAddressHLDecrement());
         // 3c)
         else if (destination_str == "(C)")
-            return create_unresolved_instruction([](){
-                return LoadAIntoPortAddressC();
-            });
+            emit(LoadAIntoPortAddressC());
         // 3d)
         else
-            return create_unresolved_instruction([this, destinationToken]() {
-                return LoadAIntoAddressImmediate(to_number_16_bit(destinationToken));
-            });
+            emit(LoadAIntoAddressImmediate(to_number_16_bit(destinationToken)));
     // 4: LD HL, SP+s8
     } else {
         to_register_expect(sourceToken, Register16Bit::SP);
-            return create_unresolved_instruction([this, destinationToken]() {
-                return LoadSPIntoAddressImmediate(to_number_16_bit(destinationToken));
-            });
+            emit(LoadSPIntoAddressImmediate(to_number_16_bit(destinationToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_ldi() {
+void Parser::parse_ldi() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token destinationToken = fetch();
     const Token commaToken = fetch_and_expect({TokenType::COMMA});
@@ -332,19 +360,15 @@ UnresolvedInstructionPtr Parser::parse_ldi() {
 
     if (to_register_8_bit(destinationToken) == Register8Bit::ADDRESS_HL) { // LDI (HL), A
         to_register_expect(sourceToken, Register8Bit::A);
-        return create_unresolved_instruction([](){
-            return LoadAIntoAddressHLIncrement();
-        });
+        emit(LoadAIntoAddressHLIncrement());
     } else { // LDI A, (HL)
         to_register_expect(destinationToken, Register8Bit::A);
         to_register_expect(sourceToken, Register8Bit::ADDRESS_HL);
-        return create_unresolved_instruction([](){
-            return LoadAddressHLIncrementIntoA();
-        });
+        emit(LoadAddressHLIncrementIntoA());
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_ldd() {
+void Parser::parse_ldd() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token destinationToken = fetch();
     const Token commaToken = fetch_and_expect({TokenType::COMMA});
@@ -352,19 +376,15 @@ UnresolvedInstructionPtr Parser::parse_ldd() {
 
     if (to_register_8_bit(destinationToken) == Register8Bit::ADDRESS_HL) { // LDD (HL), A
         to_register_expect(sourceToken, Register8Bit::A);
-        return create_unresolved_instruction([](){
-            return LoadAIntoAddressHLDecrement();
-        });
+        emit(LoadAIntoAddressHLDecrement());
     } else { // LDD A, (HL)
         to_register_expect(destinationToken, Register8Bit::A);
         to_register_expect(sourceToken, Register8Bit::ADDRESS_HL);
-        return create_unresolved_instruction([](){
-            return LoadAddressHLDecrementIntoA();
-        });
+        emit(LoadAddressHLDecrementIntoA());
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_ldh() {
+void Parser::parse_ldh() {
 //    LDH (A8), A <-> TODO: SUPPORT LD (a8), A ???
 //    LDH A, (A8) <-> TODO: SUPPORT LD A, (a8) ???
     increment_position(); // because instruction-specific token was already checked before calling the function
@@ -373,19 +393,15 @@ UnresolvedInstructionPtr Parser::parse_ldh() {
     const Token commaToken = fetch_and_expect({TokenType::COMMA});
     const Token sourceToken = fetch();
 
-    if (destinationToken.get_token_type() == TokenType::ADDRESS) { // LD (a8), A
-        return create_unresolved_instruction([this, destinationToken]() {
-            return LoadAIntoPortAddressImmediate(to_number_8_bit(destinationToken));
-        });
+    if (is_address_operand(destinationToken)) { // LD (a8), A
+        emit(LoadAIntoPortAddressImmediate(to_number_8_bit(destinationToken)));
     } else { // LD A, (a8)
         to_register_expect(destinationToken, Register8Bit::A);
-        return create_unresolved_instruction([this, sourceToken]() {
-            return LoadPortAddressImmediateIntoA(to_number_8_bit(sourceToken));
-        });
+        emit(LoadPortAddressImmediateIntoA(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_ldhl() {
+void Parser::parse_ldhl() {
     //    LDHL SP, s8 <-> LD HL, SP+s8
     increment_position(); // because instruction-specific token was already checked before calling the function
 
@@ -394,16 +410,14 @@ UnresolvedInstructionPtr Parser::parse_ldhl() {
     const Token sourceToken = fetch();
 
     to_register_expect(destinationToken, Register16Bit::SP);
-    return create_unresolved_instruction([this, sourceToken]() {
-        return LoadSPShiftedByImmediateIntoHL(to_signed_number_8_bit(sourceToken));
-    });
+    emit(LoadSPShiftedByImmediateIntoHL(to_signed_number_8_bit(sourceToken)));
 }
 
 /**********************************/
 /******** LOGICAL COMMANDS ********/
 /**********************************/
 
-UnresolvedInstructionPtr Parser::parse_and() {
+void Parser::parse_and() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. AND A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -413,21 +427,13 @@ UnresolvedInstructionPtr Parser::parse_and() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return AndAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(AndAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return AndAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(AndAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_or() {
+void Parser::parse_or() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. AND A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -437,21 +443,13 @@ UnresolvedInstructionPtr Parser::parse_or() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return OrAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(OrAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return OrAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(OrAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_xor() {
+void Parser::parse_xor() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. AND A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -461,21 +459,13 @@ UnresolvedInstructionPtr Parser::parse_xor() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return XorAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(XorAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return XorAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(XorAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_cp() {
+void Parser::parse_cp() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. AND A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -485,194 +475,130 @@ UnresolvedInstructionPtr Parser::parse_cp() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return CompareAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(CompareAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return CompareAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(CompareAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_cpl() {
+void Parser::parse_cpl() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return ComplementA();
-            }
-    );
+    emit(ComplementA());
 }
 
-UnresolvedInstructionPtr Parser::parse_daa() {
+void Parser::parse_daa() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return DecimalAdjustA();
-            }
-    );
+    emit(DecimalAdjustA());
 }
 
 /**********************************/
 /******** MACHINE COMMANDS ********/
 /**********************************/
 
-UnresolvedInstructionPtr Parser::parse_nop() {
+void Parser::parse_nop() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return Nop();
-            }
-    );
+    emit(Nop());
 }
 
-UnresolvedInstructionPtr Parser::parse_stop(){
+void Parser::parse_stop(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return Stop();
-            }
-    );
+    emit(Stop());
 }
 
-UnresolvedInstructionPtr Parser::parse_halt(){
+void Parser::parse_halt(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return Halt();
-            }
-    );
+    emit(Halt());
 }
 
-UnresolvedInstructionPtr Parser::parse_scf(){
+void Parser::parse_scf(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return SetCarry();
-            }
-    );
+    emit(SetCarry());
 }
 
-UnresolvedInstructionPtr Parser::parse_ccf(){
+void Parser::parse_ccf(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return FlipCarry();
-            }
-    );
+    emit(FlipCarry());
 }
 
-UnresolvedInstructionPtr Parser::parse_ei(){
+void Parser::parse_ei(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return EnableInterrupts();
-            }
-    );
+    emit(EnableInterrupts());
 }
 
-UnresolvedInstructionPtr Parser::parse_di(){
+void Parser::parse_di(){
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction(
-            []() {
-                return DisableInterrupts();
-            }
-    );
+    emit(DisableInterrupts());
 }
 
 /***********************************/
 /******** PUSH/POP COMMANDS ********/
 /***********************************/
 
-UnresolvedInstructionPtr Parser::parse_push() {
+void Parser::parse_push() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return Push16BitRegister(to_register_16_bit(operandToken));
-    });
+    emit(Push16BitRegister(to_register_16_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_pop() {
+void Parser::parse_pop() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return Pop16BitRegister(to_register_16_bit(operandToken));
-    });
+    emit(Pop16BitRegister(to_register_16_bit(operandToken)));
 }
 
 /***********************************/
 /******** ROTATION COMMANDS ********/
 /***********************************/
 
-UnresolvedInstructionPtr Parser::parse_rr() {
+void Parser::parse_rr() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return RotateRight8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(RotateRight8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_rl() {
+void Parser::parse_rl() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return RotateLeft8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(RotateLeft8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_rrc() {
+void Parser::parse_rrc() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return RotateRightCircular8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(RotateRightCircular8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_rlc() {
+void Parser::parse_rlc() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return RotateLeftCircular8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(RotateLeftCircular8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_rla() {
+void Parser::parse_rla() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction([]() {
-        return RotateLeftAAndClearZero();
-    });
+    emit(RotateLeftAAndClearZero());
 }
 
-UnresolvedInstructionPtr Parser::parse_rra() {
+void Parser::parse_rra() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction([]() {
-        return RotateRightAAndClearZero();
-    });
+    emit(RotateRightAAndClearZero());
 }
 
-UnresolvedInstructionPtr Parser::parse_rlca() {
+void Parser::parse_rlca() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction([]() {
-        return RotateLeftCircularAAndClearZero();
-    });
+    emit(RotateLeftCircularAAndClearZero());
 }
 
-UnresolvedInstructionPtr Parser::parse_rrca() {
+void Parser::parse_rrca() {
     increment_position(); // because instruction-specific token was already checked before calling the function
-    return create_unresolved_instruction([]() {
-        return RotateRightCircularAAndClearZero();
-    });
+    emit(RotateRightCircularAAndClearZero());
 }
 
 /************************************/
 /******** SET/RESET COMMANDS ********/
 /************************************/
 
-UnresolvedInstructionPtr Parser::parse_set() {
+void Parser::parse_set() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     const Token indexToken = fetch();
@@ -681,12 +607,10 @@ UnresolvedInstructionPtr Parser::parse_set() {
 
     // SET INDEX, 8BitRegister
 
-    return create_unresolved_instruction([this, indexToken, registerToken]() {
-        return SetBitOf8BitRegister(to_index(indexToken),to_register_8_bit(registerToken));
-    });
+    emit(SetBitOf8BitRegister(to_index(indexToken),to_register_8_bit(registerToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_res() {
+void Parser::parse_res() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     const Token indexToken = fetch();
@@ -695,52 +619,42 @@ UnresolvedInstructionPtr Parser::parse_res() {
 
     // SET INDEX, 8BitRegister
 
-    return create_unresolved_instruction([this, indexToken, registerToken]() {
-        return ResetBitOf8BitRegister(to_index(indexToken),to_register_8_bit(registerToken));
-    });
+    emit(ResetBitOf8BitRegister(to_index(indexToken),to_register_8_bit(registerToken)));
 }
 
 /*************************************/
 /******** SHIFT/SWAP COMMANDS ********/
 /*************************************/
 
-UnresolvedInstructionPtr Parser::parse_sla() {
+void Parser::parse_sla() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return ShiftLeftArithmetical8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(ShiftLeftArithmetical8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_sra() {
+void Parser::parse_sra() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return ShiftRightArithmetical8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(ShiftRightArithmetical8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_srl() {
+void Parser::parse_srl() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return ShiftRightLogical8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(ShiftRightLogical8BitRegister(to_register_8_bit(operandToken)));
 }
 
-UnresolvedInstructionPtr Parser::parse_swap() {
+void Parser::parse_swap() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     const Token operandToken = fetch();
-    return create_unresolved_instruction([this, operandToken]() {
-        return Swap8BitRegister(to_register_8_bit(operandToken));
-    });
+    emit(Swap8BitRegister(to_register_8_bit(operandToken)));
 }
 
 /***********************************/
 /******** SUBTRACT COMMANDS ********/
 /***********************************/
 
-UnresolvedInstructionPtr Parser::parse_sub() {
+void Parser::parse_sub() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. ADC A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -750,21 +664,13 @@ UnresolvedInstructionPtr Parser::parse_sub() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return SubtractAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(SubtractAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return SubtractAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(SubtractAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
-UnresolvedInstructionPtr Parser::parse_sbc() {
+void Parser::parse_sbc() {
     increment_position(); // because instruction-specific token was already checked before calling the function
     if (read_next().get_token_type() == TokenType::COMMA) { // long version, e.g. ADC A, B
         to_register_expect(fetch(), Register8Bit::A);
@@ -774,17 +680,9 @@ UnresolvedInstructionPtr Parser::parse_sbc() {
     const Token sourceToken = fetch();
 
     if (is_register_8_bit(sourceToken)) {
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return SubtractWithCarryAAnd8BitRegister(to_register_8_bit(sourceToken));
-                }
-        );
+        emit(SubtractWithCarryAAnd8BitRegister(to_register_8_bit(sourceToken)));
     } else { // number or symbol
-        return create_unresolved_instruction(
-                [this, sourceToken]() {
-                    return SubtractWithCarryAAndImmediate(to_number_8_bit(sourceToken));
-                }
-        );
+        emit(SubtractWithCarryAAndImmediate(to_number_8_bit(sourceToken)));
     }
 }
 
@@ -792,17 +690,14 @@ UnresolvedInstructionPtr Parser::parse_sbc() {
 /******** UNUSED COMMANDS ********/
 /*********************************/
 
-UnresolvedInstructionPtr Parser::parse_unu() {
+void Parser::parse_unu() {
     increment_position(); // because instruction-specific token was already checked before calling the function
 
     const Token indexToken = fetch_and_expect({TokenType::NUMBER});
 
-    return create_unresolved_instruction([this, indexToken]() {
-        return Unused(
-                to_number_conditional(indexToken, [](const uint8_t index) { return (0 <= index) && (index <= 11); },
+    emit(Unused(to_number_conditional(indexToken, [](const uint8_t index) { return index <= 11; },
                                       "Parse error: Found " + indexToken.get_string() +
-                                      ", but index for unused commands (UNU) is expected to be between 0 and 11"));
-    });
+                                      ", but index for unused commands (UNU) is expected to be between 0 and 11")));
 }
 
 /***********************************/
@@ -820,7 +715,586 @@ void Parser::parse_equ() {
     }
 
     expect_string(equToken, "EQU");
-    symbol_emplace(to_number(numericToken), symbolicName);
+    if (is_forward_reference(numericToken)) { // the value is known once all symbols are defined
+        Expression expression{};
+        expression.push_symbol(intern_symbol(numericToken.get_string()));
+        const SymbolId symbolId = intern_symbol(symbolicName.get_string());
+        defer_expression(symbolId, expression, symbolicName, true);
+        _exportedSymbols.push_back(symbolId);
+    } else if (const std::optional<SymbolId> symbolId = symbol_emplace(to_number(numericToken), symbolicName)) {
+        _exportedSymbols.push_back(*symbolId);
+    }
+}
+
+void Parser::parse_include() {
+    const Token includeToken = fetch();
+    const Token pathToken = fetch_and_expect({TokenType::STRING});
+    const Token endToken = fetch();
+    expect_end_of_context(endToken);
+
+    const std::string path = resolve_include_path(pathToken);
+
+    // an included file may not include itself, neither directly nor indirectly
+    for (size_t fileIndex = includeToken.get_file_index(); fileIndex != SourceFile::NO_PARENT; fileIndex = _sources[fileIndex].parentIndex) {
+        if (_sources[fileIndex].path == path) {
+            throw_logic_error_and_highlight(pathToken, "Parse error: File \"" + path + "\" is included recursively");
+        }
+    }
+
+    // further passes take the file read by the first one
+    auto iterator = _passInputs->includedFiles.find(path);
+    if (iterator == _passInputs->includedFiles.end()) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw_logic_error_and_highlight(pathToken, "Parse error: Cannot open included file \"" + path + "\"");
+        }
+        std::ostringstream contentStream;
+        contentStream << file.rdbuf();
+        auto code = std::make_shared<const std::string>(contentStream.str());
+        auto lineIndex = std::make_shared<const LineIndex>(*code);
+        iterator = _passInputs->includedFiles.emplace(path, SourceFile{path, std::move(code), std::move(lineIndex), SourceFile::NO_PARENT}).first;
+    }
+    SourceFile source = iterator->second;
+    source.parentIndex = includeToken.get_file_index();
+
+    const std::shared_ptr<const CachedTokens> cachedTokens = _tokenCache->get_tokens(path, *source.code);
+    const size_t fileIndex = _sources.size();
+    _sources.push_back(std::move(source));
+
+    for (const Diagnostic &diagnostic : cachedTokens->diagnostics) {
+        _diagnostics.report(Diagnostic{diagnostic.span, "In file \"" + path + "\":\n" + diagnostic.message});
+    }
+
+    TokenVector includedTokens = cachedTokens->tokens;
+    for (Token &token : includedTokens) {
+        token.set_file_index(fileIndex);
+    }
+    // the included file ends with the INCLUDE statement's line, not with the end of the file
+    includedTokens.back() = Token(includedTokens.back().get_line(), includedTokens.back().get_column(), TokenType::END_OF_LINE, "\\n");
+    includedTokens.back().set_file_index(fileIndex);
+
+    insert_tokens_after_statement(includedTokens, endToken);
+}
+
+void Parser::parse_if() {
+    const Token ifToken = fetch();
+    bool isTaken = false;
+    try {
+        const Token conditionToken = fetch();
+        if (is_forward_reference(conditionToken)) {
+            throw_logic_error_and_highlight(conditionToken, "Parse error: The condition of IF may only use symbols which are defined before");
+        }
+        isTaken = (to_number(conditionToken) != 0);
+        expect_end_of_context(read_current());
+    } catch (const SourceError &sourceError) {
+        if (!statement_has_invalid_token()) {
+            _diagnostics.report(sourceError);
+        }
+    }
+
+    skip_statement();
+    _conditionals.push_back(ConditionalFrame{ifToken, isTaken, false});
+    enter_conditional_branch(isTaken);
+}
+
+void Parser::parse_else() {
+    const Token elseToken = fetch();
+    if (read_current().get_token_type() != TokenType::END_OF_LINE && read_current().get_token_type() != TokenType::END_OF_FILE) {
+        report_and_highlight(read_current(), "Parse error: Expected end of line after ELSE");
+    }
+    skip_statement();
+
+    if (_conditionals.empty() || _conditionals.back().hasElse) {
+        report_and_highlight(elseToken, "Parse error: ELSE without matching IF");
+        enter_conditional_branch(false);
+        return;
+    }
+    _conditionals.back().hasElse = true;
+    enter_conditional_branch(!_conditionals.back().isBranchTaken);
+}
+
+void Parser::parse_endc() {
+    const Token endcToken = fetch();
+    if (_conditionals.empty()) {
+        throw_logic_error_and_highlight(endcToken, "Parse error: ENDC without matching IF");
+    }
+    _conditionals.pop_back();
+}
+
+void Parser::enter_conditional_branch(const bool isTaken) {
+    if (is_finished() || _tokenVector[_currentTokenPosition].get_token_type() != TokenType::CONDITIONAL_BLOCK) {
+        if (!isTaken) { // the branch has already been tokenized, e.g. inside of a macro
+            skip_conditional_tokens();
+        }
+        return;
+    }
+
+    const Token blockToken = fetch();
+    if (isTaken) {
+        const TokenVector blockTokens = tokenize_conditional_block(blockToken);
+        _tokenVector.insert(_tokenVector.begin() + _currentTokenPosition, blockTokens.begin(), blockTokens.end());
+    }
+}
+
+void Parser::skip_conditional_tokens() {
+    size_t depth = 0;
+    bool isStatementStart = true;
+    for (; _currentTokenPosition < _tokenVector.size(); ++_currentTokenPosition) {
+        const Token &token = _tokenVector[_currentTokenPosition];
+        if (token.get_token_type() == TokenType::END_OF_FILE) {
+            return;
+        }
+        if (isStatementStart && token.get_token_type() == TokenType::IDENTIFIER) {
+            const std::string directive = to_upper(token.get_string());
+            if (depth == 0 && (directive == "ELSE" || directive == "ENDC")) {
+                return;
+            }
+            if (directive == "IF") {
+                ++depth;
+            } else if (directive == "ENDC") {
+                --depth;
+            }
+        }
+        isStatementStart = (token.get_token_type() == TokenType::END_OF_LINE || token.get_token_type() == TokenType::CONDITIONAL_BLOCK);
+    }
+}
+
+TokenVector Parser::tokenize_conditional_block(const Token &blockToken) {
+    const SourceFile &source = _sources[blockToken.get_file_index()];
+    const size_t blockStart = source.lineIndex->line_start(blockToken.get_line()) + blockToken.get_column() - 1;
+
+    Diagnostics diagnostics{};
+    TokenVector blockTokens = Tokenizer(source.code, source.lineIndex, blockStart, blockStart + blockToken.get_numeric()).tokenize(diagnostics);
+    for (const Diagnostic &diagnostic : diagnostics.get_diagnostics()) {
+        _diagnostics.report(Diagnostic{diagnostic.span, to_string_file_prefix(blockToken) + diagnostic.message});
+    }
+
+    for (Token &token : blockTokens) {
+        token.set_file_index(blockToken.get_file_index());
+    }
+    // the block ends with the line in front of ELSE or ENDC, not with the end of the file
+    blockTokens.back() = Token(blockTokens.back().get_line(), blockTokens.back().get_column(), TokenType::END_OF_LINE, "\\n");
+    blockTokens.back().set_file_index(blockToken.get_file_index());
+    return blockTokens;
+}
+
+void Parser::append_with_conditional_blocks(TokenVector &destination, TokenVector::const_iterator first, TokenVector::const_iterator last) {
+    for (; first != last; ++first) {
+        if (first->get_token_type() == TokenType::CONDITIONAL_BLOCK) {
+            const TokenVector blockTokens = tokenize_conditional_block(*first);
+            append_with_conditional_blocks(destination, blockTokens.begin(), blockTokens.end());
+        } else {
+            destination.push_back(*first);
+        }
+    }
+}
+
+void Parser::parse_rept() {
+    const Token reptToken = fetch();
+    long count = 0;
+    std::optional<Token> counterToken{};
+    try {
+        const Token countToken = fetch();
+        if (is_forward_reference(countToken)) {
+            throw_logic_error_and_highlight(countToken, "Parse error: The count of REPT may only use symbols which are defined before");
+        }
+        count = to_number_conditional(countToken, [](const long number) { return number >= 0 && number <= MAXIMUM_REPETITIONS; },
+                                      "a repetition count of at most " + std::to_string(MAXIMUM_REPETITIONS));
+        if (read_current().get_token_type() == TokenType::COMMA) {
+            increment_position();
+            counterToken = fetch_and_expect({TokenType::IDENTIFIER});
+        }
+        expect_end_of_context(read_current());
+    } catch (const SourceError &sourceError) {
+        if (!statement_has_invalid_token()) {
+            _diagnostics.report(sourceError);
+        }
+        count = 0;
+    }
+    skip_statement();
+
+    // the block ends at the matching ENDR, nested blocks are repeated when they are parsed
+    const TokenVectorPosition blockBegin = get_current_token_position();
+    TokenVectorPosition blockEnd = blockBegin;
+    size_t depth = 0;
+    bool isStatementStart = true;
+    for (; blockEnd < _tokenVector.size(); ++blockEnd) {
+        const Token &token = _tokenVector[blockEnd];
+        if (isStatementStart && token.get_token_type() == TokenType::IDENTIFIER) {
+            const std::string directive = to_upper(token.get_string());
+            if (directive == "ENDR" && depth == 0) {
+                break;
+            }
+            if (directive == "REPT") {
+                ++depth;
+            } else if (directive == "ENDR") {
+                --depth;
+            }
+        }
+        isStatementStart = (token.get_token_type() == TokenType::END_OF_LINE || token.get_token_type() == TokenType::CONDITIONAL_BLOCK);
+    }
+    if (blockEnd == _tokenVector.size()) {
+        report_and_highlight(reptToken, "Parse error: REPT is not terminated by ENDR");
+        _currentTokenPosition = _tokenVector.size();
+        return;
+    }
+
+    _currentTokenPosition = blockEnd + 1;
+    const Token endToken = fetch();
+    if (endToken.get_token_type() != TokenType::END_OF_LINE && endToken.get_token_type() != TokenType::END_OF_FILE) {
+        report_and_highlight(endToken, "Parse error: Expected end of line after ENDR");
+    }
+
+    TokenVector block{};
+    append_with_conditional_blocks(block, _tokenVector.begin() + blockBegin, _tokenVector.begin() + blockEnd);
+
+    std::vector<size_t> counterPositions{};
+    if (counterToken.has_value()) {
+        for (size_t position = 0; position < block.size(); ++position) {
+            if (block[position].get_token_type() == TokenType::IDENTIFIER && block[position].get_string() == counterToken->get_string()) {
+                counterPositions.push_back(position);
+            }
+        }
+    }
+
+    // the number of tokens serves as estimate of the number of bytes, e.g. for DB tables
+    const size_t repetitions = static_cast<size_t>(count);
+    _output.reserve(_output.size() + repetitions * block.size());
+    _expansionBuffer.clear();
+    _expansionBuffer.reserve(repetitions * block.size());
+    for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+        const size_t repetitionStart = _expansionBuffer.size();
+        _expansionBuffer.insert(_expansionBuffer.end(), block.begin(), block.end());
+        for (const size_t position : counterPositions) {
+            Token &counter = _expansionBuffer[repetitionStart + position];
+            const size_t fileIndex = counter.get_file_index();
+            counter = Token(counter.get_line(), counter.get_column(), TokenType::NUMBER, std::to_string(repetition));
+            counter.set_file_index(fileIndex);
+        }
+    }
+    insert_tokens_after_statement(_expansionBuffer, endToken);
+}
+
+void Parser::parse_macro_definition() {
+    const Token nameToken = fetch_and_expect({TokenType::IDENTIFIER});
+    increment_position(); // "MACRO" was already checked before calling the function
+    expect_end_of_context(fetch());
+
+    if (_macros.count(nameToken.get_string()) > 0) {
+        throw_logic_error_and_highlight(nameToken, "Parse error: Macro " + nameToken.get_string() + " is already defined");
+    }
+
+    // the body ends at the first "ENDM"
+    const TokenVectorPosition bodyBegin = get_current_token_position();
+    TokenVectorPosition bodyEnd = bodyBegin;
+    while (bodyEnd < _tokenVector.size() && to_upper(_tokenVector[bodyEnd].get_string()) != "ENDM") {
+        ++bodyEnd;
+    }
+    if (bodyEnd == _tokenVector.size()) {
+        throw_logic_error_and_highlight(nameToken, "Parse error: Macro " + nameToken.get_string() + " is not terminated by ENDM");
+    }
+
+    TokenVector body{};
+    append_with_conditional_blocks(body, _tokenVector.begin() + bodyBegin, _tokenVector.begin() + bodyEnd);
+    _macros.emplace(nameToken.get_string(), Macro{nameToken, std::move(body)});
+    _currentTokenPosition = bodyEnd + 1;
+    expect_end_of_context(fetch());
+}
+
+void Parser::expand_macro() {
+    const Token nameToken = fetch();
+    const Macro &macro = _macros.at(nameToken.get_string());
+
+    if (++_numberOfMacroExpansions > MAXIMUM_MACRO_EXPANSIONS) {
+        throw_logic_error_and_highlight(nameToken, "Parse error: More than " + std::to_string(MAXIMUM_MACRO_EXPANSIONS) +
+                                                   " macro expansions, " + nameToken.get_string() + " is probably recursive");
+    }
+
+    // each argument is a single token, as operands consisting of several tokens have been folded
+    TokenVector arguments{};
+    std::string key = nameToken.get_string();
+    while (read_current().get_token_type() != TokenType::END_OF_LINE && read_current().get_token_type() != TokenType::END_OF_FILE) {
+        if (!arguments.empty()) {
+            fetch_and_expect({TokenType::COMMA});
+        }
+        const Token argumentToken = fetch();
+        expect_type(argumentToken, {TokenType::IDENTIFIER, TokenType::NUMBER, TokenType::ADDRESS, TokenType::LOCAL_LABEL,
+                                    TokenType::SP_SHIFTED, TokenType::STRING});
+        arguments.push_back(argumentToken);
+        key += '\x1F' + to_string(argumentToken.get_token_type()) + ':' + argumentToken.get_string();
+    }
+    const Token endToken = fetch();
+
+    // the definition's position tells apart macros of the same name defined by different passes
+    const Token &definitionToken = macro.nameToken;
+    key += '\x1F' + std::to_string(definitionToken.get_file_index()) + ':' + std::to_string(definitionToken.get_line()) + ':'
+         + std::to_string(definitionToken.get_column());
+    auto iterator = _passInputs->macroExpansions.find(key);
+    if (iterator == _passInputs->macroExpansions.end()) {
+        MacroExpansion expansion{};
+        expansion.tokens.reserve(macro.body.size());
+        for (const Token &token : macro.body) {
+            if (token.get_token_type() != TokenType::MACRO_ARGUMENT) {
+                expansion.tokens.push_back(token);
+                continue;
+            }
+
+            const size_t argumentIndex = static_cast<size_t>(token.get_string().back() - '1');
+            if (argumentIndex >= arguments.size()) { // also catches \0, for which the index wraps around
+                throw_logic_error_and_highlight_with_reference(nameToken, token, "Parse error: Macro " + nameToken.get_string() +
+                                                                                 " uses argument " + token.get_string() + ", but only " +
+                                                                                 std::to_string(arguments.size()) + " arguments are given");
+            }
+            expansion.argumentSlots.emplace_back(expansion.tokens.size(), argumentIndex);
+            expansion.tokens.push_back(arguments[argumentIndex]);
+        }
+        iterator = _passInputs->macroExpansions.emplace(std::move(key), std::move(expansion)).first;
+    }
+
+    // the cached arguments are equal to the given ones except for their positions in the source code
+    const MacroExpansion &expansion = iterator->second;
+    _expansionBuffer.assign(expansion.tokens.begin(), expansion.tokens.end());
+    for (const auto &[position, argumentIndex] : expansion.argumentSlots) {
+        _expansionBuffer[position] = arguments[argumentIndex];
+    }
+    insert_tokens_after_statement(_expansionBuffer, endToken);
+}
+
+void Parser::insert_tokens_after_statement(const TokenVector &tokens, const Token &endToken) {
+    // insert the tokens after the statement, but before the end of the file
+    const size_t insertPosition = (endToken.get_token_type() == TokenType::END_OF_FILE) ? get_current_token_position() - 1
+                                                                                       : get_current_token_position();
+    _tokenVector.insert(_tokenVector.begin() + insertPosition, tokens.begin(), tokens.end());
+    _currentTokenPosition = insertPosition;
+}
+
+void Parser::parse_section() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token nameToken = fetch_and_expect({TokenType::STRING});
+    expect_type(fetch(), TokenType::COMMA);
+    const Token typeToken = fetch_and_expect({TokenType::IDENTIFIER});
+    const std::string typeString = to_upper(typeToken.get_string());
+    if (typeString != "ROM0" && typeString != "ROMX") {
+        throw_logic_error_and_highlight(typeToken, "Parse error: Found expression \"" + typeToken.get_string() +
+                                                   "\" but expected section type, i.e. ROM0 or ROMX");
+    }
+
+    const std::string &nameString = nameToken.get_string();
+    ObjectSection section{nameString.substr(1, nameString.size() - 2), SectionType::ROM0, 0, std::nullopt, {}}; // strip the quotes
+    if (typeString == "ROMX") {
+        section.type = SectionType::ROMX;
+        section.bank.reset();
+    }
+
+    if (read_current().get_token_type() == TokenType::COMMA && !is_section_alignment(read_next())) {
+        increment_position();
+        const Token bankToken = fetch();
+        if (section.type == SectionType::ROM0) {
+            throw_logic_error_and_highlight(bankToken, "Parse error: ROM0 sections are always placed in bank 0");
+        }
+        if (is_forward_reference(bankToken)) {
+            throw_logic_error_and_highlight(bankToken, "Parse error: The bank of SECTION may only use symbols which are defined before");
+        }
+        section.bank = static_cast<uint32_t>(to_number_conditional(bankToken, [](const long number) {
+            return number >= 1 && number < static_cast<long>(RomImage::MAXIMUM_BANKS);
+        }, "a bank between 1 and " + std::to_string(RomImage::MAXIMUM_BANKS - 1)));
+    }
+
+    if (read_current().get_token_type() == TokenType::COMMA && is_section_alignment(read_next())) {
+        increment_position();
+        increment_position();
+        const Token alignmentToken = fetch();
+        if (is_forward_reference(alignmentToken)) {
+            throw_logic_error_and_highlight(alignmentToken, "Parse error: The alignment of SECTION may only use symbols which are defined before");
+        }
+        section.alignment = static_cast<uint8_t>(to_number_conditional(alignmentToken, [](const long number) {
+            return number >= 0 && number <= ObjectSection::MAXIMUM_ALIGNMENT;
+        }, "a number of bits between 0 and " + std::to_string(ObjectSection::MAXIMUM_ALIGNMENT)));
+    }
+
+    _sections.push_back(std::move(section));
+    _sectionStarts.push_back(_output.size());
+    if (_isRelocatable) { // labels are offsets within the section, until ORG pins it to an address
+        _currentAddress = 0;
+    }
+}
+
+void Parser::parse_org() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token addressToken = fetch();
+    if (is_forward_reference(addressToken)) {
+        throw_logic_error_and_highlight(addressToken, "Parse error: The address of ORG may only use symbols which are defined before");
+    }
+    const long address = to_number_conditional(addressToken, is_unsigned_16_bit<long>, "an unsigned 16-bit address");
+    if (!_isRelocatable) {
+        _currentAddress = static_cast<Address>(address);
+        _outputBlocks.push_back(OutputBlock{_output.size(), _currentAddress, addressToken});
+        return;
+    }
+
+    const size_t sectionIndex = _sections.size() - 1;
+    ObjectSection &section = _sections.back();
+    if (_output.size() > _sectionStarts.back()) {
+        throw_logic_error_and_highlight(addressToken, "Parse error: ORG must precede the code of its section");
+    }
+    if (sectionIndex == 0 && address >= static_cast<long>(RomImage::BANK_SIZE)) { // code preceding the first SECTION
+        section.type = SectionType::ROMX;
+        section.bank = 1;
+    }
+    const bool isInBank0 = (address < static_cast<long>(RomImage::BANK_SIZE));
+    if (section.type == SectionType::ROM0 && !isInBank0) {
+        throw_logic_error_and_highlight(addressToken, "Parse error: Address " + to_string_hex_prefixed(static_cast<word>(address)) +
+                                                      " is not in bank 0, i.e. in 0x0000 - 0x3FFF");
+    }
+    if (section.type == SectionType::ROMX && (isInBank0 || address >= static_cast<long>(2 * RomImage::BANK_SIZE))) {
+        throw_logic_error_and_highlight(addressToken, "Parse error: Address " + to_string_hex_prefixed(static_cast<word>(address)) +
+                                                      " is not in a switchable bank, i.e. in 0x4000 - 0x7FFF");
+    }
+
+    if (address & ((1L << section.alignment) - 1)) {
+        throw_logic_error_and_highlight(addressToken, "Parse error: Address " + to_string_hex_prefixed(static_cast<word>(address)) +
+                                                      " is not aligned to " + std::to_string(1L << section.alignment) + " bytes");
+    }
+
+    // labels defined in the section so far become absolute
+    for (auto iterator = _relocatableSymbols.begin(); iterator != _relocatableSymbols.end();) {
+        if (iterator->second == sectionIndex) {
+            const NumericFromToken &symbol = *_symbols[iterator->first];
+            _symbols[iterator->first] = NumericFromToken(address + symbol.get_numeric(), symbol.get_token());
+            iterator = _relocatableSymbols.erase(iterator);
+        } else {
+            ++iterator;
+        }
+    }
+    section.address = static_cast<word>(address);
+    _currentAddress = static_cast<Address>(address);
+}
+
+void Parser::parse_incbin() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token pathToken = fetch_and_expect({TokenType::STRING});
+    const std::string path = resolve_include_path(pathToken);
+
+    // further passes take the file mapped by the first one
+    std::shared_ptr<const MappedFile> &file = _passInputs->binaryFiles[path];
+    if (!file) {
+        try {
+            file = std::make_shared<const MappedFile>(path);
+        } catch (const std::runtime_error &) {
+            _passInputs->binaryFiles.erase(path);
+            throw_logic_error_and_highlight(pathToken, "Parse error: Cannot open binary file \"" + path + "\"");
+        }
+    }
+
+    // optional offset and length, which must be known already since they determine the following addresses
+    size_t offset = 0;
+    size_t length = file->size();
+    if (read_current().get_token_type() == TokenType::COMMA) {
+        increment_position();
+        const Token offsetToken = fetch();
+        offset = to_number_conditional(offsetToken, [&](const long number) { return number >= 0 && static_cast<size_t>(number) <= file->size(); },
+                                       "an offset inside of the file of size " + std::to_string(file->size()));
+        length = file->size() - offset;
+
+        if (read_current().get_token_type() == TokenType::COMMA) {
+            increment_position();
+            const Token lengthToken = fetch();
+            length = to_number_conditional(lengthToken, [&](const long number) { return number >= 0 && static_cast<size_t>(number) <= file->size() - offset; },
+                                           "a length of at most " + std::to_string(file->size() - offset));
+        }
+    }
+
+    _output.insert(_output.end(), file->data() + offset, file->data() + offset + length);
+    _currentAddress += length;
+    if (_isRelocatable) { // object files are reassembled whenever one of their inputs changes
+        _binaryFiles.emplace_back(path, fnv1a_hash(std::string_view(reinterpret_cast<const char*>(file->data()), file->size())));
+    }
+}
+
+void Parser::parse_data(const FixupKind kind) {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const uint8_t width = fixup_width(kind);
+    while (true) {
+        const TokenVectorPosition tokenIndex = get_current_token_position();
+        const Token elementToken = fetch();
+
+        if (kind == FixupKind::NUMBER_8_BIT && elementToken.get_token_type() == TokenType::STRING) {
+            const std::string &string = elementToken.get_string();
+            _output.insert(_output.end(), string.begin() + 1, string.end() - 1); // strip the quotes
+            _currentAddress += string.size() - 2;
+        } else {
+            long value = 0;
+            if (is_forward_reference(elementToken)) {
+                _fixups.push_back(Fixup{static_cast<uint32_t>(_output.size()),
+                                        static_cast<uint32_t>(tokenIndex),
+                                        intern_symbol(elementToken.get_string()),
+                                        _currentAddress,
+                                        width,
+                                        kind});
+            } else {
+                value = check_value(elementToken, to_number(elementToken), kind);
+            }
+
+            for (size_t i = 0; i < width; ++i) { // little endian
+                _output.push_back(static_cast<byte>(value >> (8 * i)));
+            }
+            _currentAddress += width;
+        }
+
+        if (read_current().get_token_type() != TokenType::COMMA) {
+            break;
+        }
+        increment_position();
+    }
+}
+
+void Parser::parse_data_space() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token countToken = fetch();
+    const long count = to_number_conditional(countToken, is_unsigned_16_bit<long>, "an unsigned 16-bit count");
+
+    byte fill = 0;
+    if (read_current().get_token_type() == TokenType::COMMA) {
+        increment_position();
+        const Token fillToken = fetch();
+        fill = static_cast<byte>(check_value(fillToken, to_number(fillToken), FixupKind::NUMBER_8_BIT));
+    }
+
+    _output.insert(_output.end(), static_cast<size_t>(count), fill);
+    _currentAddress += count;
+}
+
+void Parser::parse_loop_bound() {
+    increment_position(); // because instruction-specific token was already checked before calling the function
+
+    const Token boundToken = fetch();
+    if (is_forward_reference(boundToken)) {
+        throw_logic_error_and_highlight(boundToken, "Parse error: The bound of LOOPBOUND may only use symbols which are defined before");
+    }
+    const long bound = to_number_conditional(boundToken, is_unsigned_16_bit<long>, "an unsigned 16-bit count");
+    if (bound == 0) {
+        throw_logic_error_and_highlight(boundToken, "Parse error: The first instruction of a loop is executed at least once");
+    }
+    _loopBounds[_currentAddress] = static_cast<size_t>(bound);
+}
+
+std::string Parser::resolve_include_path(const Token &pathToken) const {
+    const std::string pathString = pathToken.get_string();
+    const std::filesystem::path includePath(pathString.substr(1, pathString.size() - 2)); // strip the quotes
+
+    if (includePath.is_relative()) {
+        const std::filesystem::path includingPath(_sources[pathToken.get_file_index()].path);
+        const std::filesystem::path candidate = includingPath.parent_path() / includePath;
+        if (std::filesystem::exists(candidate)) {
+            return candidate.lexically_normal().string();
+        }
+    }
+    return includePath.lexically_normal().string();
 }
 
 
@@ -0,0 +1,166 @@
+#include "peephole.h"
+#include "fixup.h"
+#include "../instructions/auxiliary_and_conversions.h"
+#include "../instructions/cycles.h"
+#include "../instructions/effects.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+    /**
+     * The flags an instruction reads and writes, and whether it may branch.
+     */
+    struct FlagEffects {
+        byte reads{0};
+        byte writes{0};
+        bool isBranch{false};
+    };
+
+    /**
+     * Returns the flags read and written by the instruction @p bytes, as masks of the flags register F.
+     * @param bytes the instruction's bytecode
+     * @return the instruction's effects on the flags
+     */
+    FlagEffects flag_effects(const Bytestring &bytes) noexcept {
+        const byte firstByte = bytes[0];
+        const Opcode opcode = (firstByte == 0xCB && bytes.size() > 1) ? static_cast<Opcode>(0xCB00 | bytes[1]) : firstByte;
+        const InstructionEffects effects = instruction_effects(opcode);
+
+        bool isBranch = ((firstByte & 0xC7) == 0xC7); // RST
+        switch (firstByte) {
+            case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:             // JR
+            case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA: case 0xE9: // JP
+            case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:             // CALL
+            case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8: case 0xD9: // RET, RETI
+                isBranch = true;
+                break;
+            default:
+                break;
+        }
+        return {to_flags_register(effects.reads), to_flags_register(effects.writes), isBranch};
+    }
+}
+
+PeepholeOptimizer::PeepholeOptimizer(const Bytestring &bytecode, const std::vector<PeepholeInstruction> &instructions, const bool isWholeProgram)
+: _bytecode(bytecode), _instructions(instructions)
+{
+    const bool readsSubtractOrHalfCarry = std::any_of(instructions.cbegin(), instructions.cend(), [&](const PeepholeInstruction &instruction) {
+        return bytecode[instruction.offset] == 0x27 || bytecode[instruction.offset] == 0xF5; // DAA, PUSH AF
+    });
+    if (isWholeProgram && !readsSubtractOrHalfCarry) {
+        _unreadFlags = flags::SUBTRACT | flags::HALF_CARRY;
+    }
+}
+
+const std::vector<PeepholeRule>& PeepholeOptimizer::get_rules() {
+    static const std::vector<PeepholeRule> rules{
+        {"LD A, 0 -> XOR A", {{0x3E, 0x00}}, flags::ALL, 0xAF, PeepholeOperand::DROPPED, 1, 4},
+        {"CP 0 -> OR A", {{0xFE, 0x00}}, flags::SUBTRACT, 0xB7, PeepholeOperand::DROPPED, 1, 4}, // both set Z alike and clear H and C
+        {"CALL x; RET -> JP x", {{0xCD}, {0xC9}}, 0, 0xC3, PeepholeOperand::KEPT, 1, 24},
+        {"JP x -> JR x", {{0xC3}}, 0, 0x18, PeepholeOperand::RELATIVE, 1, 4},
+        {"JP NZ, x -> JR NZ, x", {{0xC2}}, 0, 0x20, PeepholeOperand::RELATIVE, 1, 4},
+        {"JP Z, x -> JR Z, x", {{0xCA}}, 0, 0x28, PeepholeOperand::RELATIVE, 1, 4},
+        {"JP NC, x -> JR NC, x", {{0xD2}}, 0, 0x30, PeepholeOperand::RELATIVE, 1, 4},
+        {"JP C, x -> JR C, x", {{0xDA}}, 0, 0x38, PeepholeOperand::RELATIVE, 1, 4}
+    };
+    return rules;
+}
+
+bool PeepholeOptimizer::matches(const PeepholePattern &pattern, const Bytestring &bytes) noexcept {
+    return !bytes.empty() && bytes[0] == pattern.opcode
+        && (!pattern.immediate.has_value() || (bytes.size() > 1 && bytes[1] == *pattern.immediate));
+}
+
+std::unordered_map<size_t, PeepholeRewrite> PeepholeOptimizer::find_rewrites() const {
+    // the rules starting with each opcode, so that every instruction is only compared with rules it may match
+    static const std::array<std::vector<size_t>, 256> rulesByOpcode = []() {
+        std::array<std::vector<size_t>, 256> table{};
+        for (size_t rule = 0; rule < get_rules().size(); ++rule) {
+            table[get_rules()[rule].patterns.front().opcode].push_back(rule);
+        }
+        return table;
+    }();
+
+    std::unordered_map<size_t, PeepholeRewrite> rewrites{};
+    size_t index = 0;
+    while (index < _instructions.size()) {
+        size_t matchLength = 1;
+        for (const size_t rule : rulesByOpcode[_bytecode[_instructions[index].offset]]) {
+            if (is_applicable(get_rules()[rule], index)) {
+                matchLength = get_rules()[rule].patterns.size();
+                for (size_t position = 0; position < matchLength; ++position) {
+                    rewrites.emplace(index + position, PeepholeRewrite{rule, position});
+                }
+                break;
+            }
+        }
+        index += matchLength;
+    }
+    return rewrites;
+}
+
+bool PeepholeOptimizer::is_applicable(const PeepholeRule &rule, const size_t index) const {
+    for (size_t position = 0; position < rule.patterns.size(); ++position) {
+        const size_t current = index + position;
+        if (current >= _instructions.size()) {
+            return false;
+        }
+        // removed instructions must not be reached from elsewhere, and immediates of relocations are placeholders
+        if (position > 0 && (!follows_previous(current) || _instructions[current].isBranchTarget)) {
+            return false;
+        }
+        const PeepholePattern &pattern = rule.patterns[position];
+        if (!matches(pattern, instruction_bytes(current)) || (pattern.immediate.has_value() && _instructions[current].hasRelocation)) {
+            return false;
+        }
+    }
+
+    if (rule.operand == PeepholeOperand::RELATIVE) {
+        const PeepholeInstruction &jump = _instructions[index];
+        if (jump.isRelocatable || jump.hasRelocation) {
+            return false;
+        }
+        const Bytestring bytes = instruction_bytes(index);
+        const long target = bytes[1] | (bytes[2] << 8);
+        if (!is_signed_8_bit(relative_jump_offset(target, jump.address))) {
+            return false;
+        }
+    }
+    return rule.deadFlags == 0 || are_flags_dead(index + rule.patterns.size(), rule.deadFlags);
+}
+
+bool PeepholeOptimizer::are_flags_dead(size_t index, byte flagMask) const {
+    flagMask &= static_cast<byte>(~_unreadFlags);
+    if (flagMask == 0) {
+        return true;
+    }
+    for (size_t distance = 0; distance < MAXIMUM_LIVENESS_DISTANCE; ++distance, ++index) {
+        if (index >= _instructions.size() || !follows_previous(index)) { // the following code is unknown
+            return false;
+        }
+        const FlagEffects effects = flag_effects(instruction_bytes(index));
+        if ((effects.reads & flagMask) != 0 || effects.isBranch) {
+            return false;
+        }
+        flagMask &= static_cast<byte>(~effects.writes);
+        if (flagMask == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PeepholeOptimizer::follows_previous(const size_t index) const {
+    const PeepholeInstruction &previous = _instructions[index - 1];
+    const size_t length = instruction_length(_bytecode[previous.offset]);
+    return _instructions[index].offset == previous.offset + length
+        && _instructions[index].address == static_cast<word>(previous.address + length)
+        && _instructions[index].isRelocatable == previous.isRelocatable;
+}
+
+Bytestring PeepholeOptimizer::instruction_bytes(const size_t index) const {
+    const size_t offset = _instructions[index].offset;
+    const size_t end = std::min(offset + instruction_length(_bytecode[offset]), _bytecode.size());
+    return Bytestring(_bytecode.begin() + static_cast<long>(offset), _bytecode.begin() + static_cast<long>(end));
+}
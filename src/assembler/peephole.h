@@ -0,0 +1,161 @@
+#ifndef GAMEBOY_DISASSEMBLE_PEEPHOLE_H
+#define GAMEBOY_DISASSEMBLE_PEEPHOLE_H
+
+#include "../instructions/constants.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Bits of the flags register F, used as masks of the flags an instruction reads or writes.
+ */
+namespace flags {
+    constexpr byte ZERO       = 0x80;
+    constexpr byte SUBTRACT   = 0x40;
+    constexpr byte HALF_CARRY = 0x20;
+    constexpr byte CARRY      = 0x10;
+    constexpr byte ALL        = ZERO | SUBTRACT | HALF_CARRY | CARRY;
+}
+
+/**
+ * Enumerator for what becomes of the operand of the first matched instruction when a peephole rule is applied.
+ */
+enum class PeepholeOperand : uint8_t {
+    DROPPED, ///< the replacement has no operand
+    KEPT,    ///< the replacement has the same 16-bit operand
+    RELATIVE ///< the 16-bit address becomes the offset of a relative jump
+};
+
+/**
+ * An instruction of a matched sequence, given by its opcode and optionally by the value of its 8-bit immediate.
+ */
+struct PeepholePattern {
+    byte opcode;
+    std::optional<byte> immediate{};
+};
+
+/**
+ * A rewrite of a short instruction sequence into a shorter or faster one with the same effect.
+ * The replacement consists of one instruction, all further instructions of the sequence are removed.
+ */
+struct PeepholeRule {
+    std::string_view name{};
+    std::vector<PeepholePattern> patterns{}; ///< the matched sequence
+    byte deadFlags{0};    ///< flags which must not be read after the sequence, since the replacement changes them
+    byte opcode{0};       ///< opcode of the replacement
+    PeepholeOperand operand{PeepholeOperand::DROPPED};
+    size_t bytesSaved{0};
+    size_t cyclesSaved{0}; ///< clock cycles saved per execution, for conditional jumps in either case
+};
+
+/**
+ * An instruction of the assembled code which the peephole optimizer may rewrite.
+ */
+struct PeepholeInstruction {
+    size_t offset;       ///< position of the instruction in the bytecode
+    word address;        ///< address of the instruction
+    bool isBranchTarget; ///< true if a label refers to the instruction, i.e. it may be reached from elsewhere
+    bool isRelocatable;  ///< true if the instruction's address is only known once linked
+    bool hasRelocation;  ///< true if the instruction's operand is only known once linked
+};
+
+/**
+ * A rule applied to an instruction. The first instruction of a sequence is replaced, the further ones are removed.
+ */
+struct PeepholeRewrite {
+    size_t rule;     ///< index into PeepholeOptimizer::get_rules()
+    size_t position; ///< position of the instruction in the matched sequence
+};
+
+/**
+ * How often a peephole rule has been applied and what it saved.
+ */
+struct PeepholeStatistics {
+    size_t applications{0};
+    size_t bytesSaved{0};
+    size_t cyclesSaved{0};
+};
+
+/**
+ * Class PeepholeOptimizer. Finds the instruction sequences of assembled code which are rewritten
+ * into shorter or faster ones, e.g. LD A, 0 into XOR A, by matching a table of rules in one linear pass.
+ *
+ * Rules which change flags only apply if the flags are written again before they are read,
+ * which is checked by scanning the following straight-line code. Any branch ends the scan,
+ * after which the flags are assumed to be read. The flags N and H are only read by DAA, and may be inspected
+ * after PUSH AF, so in a whole program without either of them they are never read. Since rewrites shrink the code, the Parser
+ * applies them while parsing the source again, so that all addresses are assigned anew.
+ */
+class PeepholeOptimizer {
+public:
+    static constexpr size_t MAXIMUM_LIVENESS_DISTANCE = 16; ///< number of instructions scanned for reads of changed flags
+
+    /**
+     * Constructor.
+     * @param bytecode the assembled code
+     * @param instructions the instructions of @p bytecode in ascending order of their offsets
+     * @param isWholeProgram true if @p instructions are all instructions of the program, i.e. it is not linked with other code
+     */
+    PeepholeOptimizer(const Bytestring &bytecode, const std::vector<PeepholeInstruction> &instructions, const bool isWholeProgram);
+
+    /**
+     * Returns the table of all rules.
+     * @return the rules
+     */
+    static const std::vector<PeepholeRule>& get_rules();
+
+    /**
+     * Checks whether the instruction @p bytes matches @p pattern.
+     * @param pattern the pattern
+     * @param bytes the instruction's bytecode
+     * @return true if the opcode and, if required, the immediate match
+     */
+    static bool matches(const PeepholePattern &pattern, const Bytestring &bytes) noexcept;
+
+    /**
+     * Matches the rules against all instructions in one pass. Matched sequences do not overlap.
+     * @return the rewrite of each instruction which is replaced or removed, by the index of the instruction
+     */
+    std::unordered_map<size_t, PeepholeRewrite> find_rewrites() const;
+
+private:
+
+    /**
+     * Checks whether @p rule matches the sequence starting with instruction @p index and its conditions are met.
+     * @param rule the rule
+     * @param index index of the first instruction
+     * @return true if the rule may be applied
+     */
+    bool is_applicable(const PeepholeRule &rule, const size_t index) const;
+
+    /**
+     * Checks whether none of @p flagMask is read before it is written by the code starting with instruction @p index.
+     * @param index index of the first instruction following the rewritten sequence
+     * @param flagMask the flags which are changed
+     * @return true if the flags are dead
+     */
+    bool are_flags_dead(size_t index, byte flagMask) const;
+
+    /**
+     * Checks whether instruction @p index directly follows instruction @p index - 1 in the bytecode and in the address space.
+     * @param index index of the instruction
+     * @return true if control flows from the previous instruction into this one
+     */
+    bool follows_previous(const size_t index) const;
+
+    /**
+     * Returns the bytes of instruction @p index, which are at most three.
+     * @param index index of the instruction
+     * @return the instruction's bytecode
+     */
+    Bytestring instruction_bytes(const size_t index) const;
+
+    const Bytestring &_bytecode;
+    const std::vector<PeepholeInstruction> &_instructions;
+    byte _unreadFlags{0}; ///< flags which no instruction of the program reads
+};
+
+#endif //GAMEBOY_DISASSEMBLE_PEEPHOLE_H
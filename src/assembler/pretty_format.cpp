@@ -1,5 +1,6 @@
 #include "pretty_format.h"
 
+#include <algorithm>
 #include <iomanip>
 
 std::string to_pretty_string(const Token& token) noexcept {
@@ -18,48 +19,79 @@ std::string get_position_string(const size_t lineNumber, const size_t columnNumb
     return std::to_string(lineNumber) + ":" + std::to_string(columnNumber);
 }
 
-std::string separated_line(const std::string &left, const std::string &right) {
+LineIndex::LineIndex(std::string_view code)
+        : _codeSize(code.size()) {
+    _lineStarts.push_back(0);
+    for (size_t position = code.find('\n'); position != std::string_view::npos; position = code.find('\n', position + 1)) {
+        _lineStarts.push_back(position + 1);
+    }
+}
+
+size_t LineIndex::number_of_lines() const noexcept {
+    if (_codeSize == 0) {
+        return 0;
+    }
+    // a newline at the very end does not begin a new line
+    return (_lineStarts.back() == _codeSize) ? _lineStarts.size() - 1 : _lineStarts.size();
+}
+
+std::string_view LineIndex::line(std::string_view code, const size_t lineNumber) const noexcept {
+    if (lineNumber == 0 || lineNumber > _lineStarts.size()) {
+        return {};
+    }
+    const size_t start = _lineStarts[lineNumber - 1];
+    const size_t end = (lineNumber < _lineStarts.size()) ? _lineStarts[lineNumber] - 1 : code.size();
+    return code.substr(start, end - start);
+}
+
+size_t LineIndex::line_start(const size_t lineNumber) const noexcept {
+    return (lineNumber == 0 || lineNumber > _lineStarts.size()) ? _codeSize : _lineStarts[lineNumber - 1];
+}
+
+size_t LineIndex::line_number_at(const size_t offset) const noexcept {
+    // the first line start which is greater than offset belongs to the line after the searched one
+    return std::upper_bound(_lineStarts.begin(), _lineStarts.end(), offset) - _lineStarts.begin();
+}
+
+std::string separated_line(std::string_view left, std::string_view right) {
     std::ostringstream ostr;
     ostr << std::setw(6) << left << " |    " << right << '\n';
     return ostr.str();
 }
 
 std::string to_string_with_line_numbers(const std::string &code) {
-    std::ostringstream ostr;
-    std::istringstream iss(code);
-    std::string line;
+    return to_string_with_line_numbers(code, LineIndex(code));
+}
 
-    size_t lineNumber = 1;
+std::string to_string_with_line_numbers(const std::string &code, const LineIndex &lineIndex) {
+    std::ostringstream ostr;
 
-    while (std::getline(iss, line))
+    for (size_t lineNumber = 1; lineNumber <= lineIndex.number_of_lines(); ++lineNumber)
     {
-        ostr << separated_line(std::to_string(lineNumber), line) << '\n';
-        ++lineNumber;
+        ostr << separated_line(std::to_string(lineNumber), lineIndex.line(code, lineNumber)) << '\n';
     }
 
     return ostr.str();
 }
 
 std::string to_string_single_line(const std::string &code, const size_t lineNumber) {
-    std::istringstream iss(code);
-    std::string line;
-
-    for (size_t i = 0; i < lineNumber; ++i)
-    {
-        std::getline(iss, line);
-    }
+    return to_string_single_line(code, LineIndex(code), lineNumber);
+}
 
-    return separated_line(std::to_string(lineNumber), line);
+std::string to_string_single_line(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber) {
+    return separated_line(std::to_string(lineNumber), lineIndex.line(code, lineNumber));
 }
 
 std::string to_string_line_and_highlight(const std::string &code, const size_t lineNumber, const size_t columnNumber, const size_t highlightWidth) {
-    std::ostringstream ostr;
+    return to_string_line_and_highlight(code, LineIndex(code), lineNumber, columnNumber, highlightWidth);
+}
 
-    const std::string highlighter{ "^" + std::string(std::max(highlightWidth-1, 0UL), '~')};
+std::string to_string_line_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber, const size_t columnNumber, const size_t highlightWidth) {
+    const std::string highlighter{ "^" + std::string(std::max(highlightWidth, 1UL) - 1, '~')};
 
     const size_t repetitions = std::max(columnNumber, 1UL) - 1;
-    const std::string returnString = to_string_single_line(code, lineNumber)
+    const std::string returnString = to_string_single_line(code, lineIndex, lineNumber)
                                    + separated_line(" ", std::string(repetitions, ' ') + highlighter);
 
     return returnString;
-}
\ No newline at end of file
+}
@@ -5,7 +5,58 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <vector>
+
+/**
+ * Class LineIndex. Stores the start offset of every line of a source code buffer,
+ * so that single lines can be sliced out of the buffer in constant time
+ * instead of reading the code from the beginning for every access.
+ * The index only stores offsets, thus the code itself has to be passed when slicing.
+ */
+class LineIndex {
+public:
+    LineIndex() = default;
+
+    /**
+     * Constructor. Scans @p code once and records where each line starts.
+     * @param code source code to index
+     */
+    explicit LineIndex(std::string_view code);
+
+    /**
+     * Returns the number of lines, where a trailing newline does not start another line.
+     * @return number of lines
+     */
+    size_t number_of_lines() const noexcept;
+
+    /**
+     * Returns the @p lineNumber-th line of @p code without its newline character.
+     * @param code the source code the index was built from
+     * @param lineNumber line number, starting at 1
+     * @return view of the line inside of @p code, or an empty view if the line does not exist
+     */
+    std::string_view line(std::string_view code, const size_t lineNumber) const noexcept;
+
+    /**
+     * Returns the offset of the first character of line @p lineNumber.
+     * @param lineNumber line number, starting at 1
+     * @return offset of the line start, or the size of the code if the line does not exist
+     */
+    size_t line_start(const size_t lineNumber) const noexcept;
+
+    /**
+     * Returns the number of the line containing the character at @p offset.
+     * @param offset offset in the code
+     * @return line number, starting at 1
+     */
+    size_t line_number_at(const size_t offset) const noexcept;
+
+private:
+    std::vector<size_t> _lineStarts{}; ///< offset of the first character of each line
+    size_t _codeSize{0};               ///< size of the indexed code
+};
 
 /**
  * Returns a string containing all token data in pretty form.
@@ -32,7 +83,7 @@ std::string get_position_string(const size_t lineNumber, const size_t columnNumb
  * @param right string displayed on the right side
  * @return string containing the line
  */
-std::string separated_line(const std::string &left, const std::string &right);
+std::string separated_line(std::string_view left, std::string_view right);
 
 /**
  * Returns a string, which is essentially the source code contained in @p code
@@ -43,6 +94,16 @@ std::string separated_line(const std::string &left, const std::string &right);
  */
 std::string to_string_with_line_numbers(const std::string &code);
 
+/**
+ * Returns a string, which is essentially the source code contained in @p code
+ * but with line numbers on the left side
+ *
+ * @param code source code to display
+ * @param lineIndex line index built from @p code
+ * @return string containing the code with line numbers
+ */
+std::string to_string_with_line_numbers(const std::string &code, const LineIndex &lineIndex);
+
 /**
  * Returns the @p lineNumber-th line of @p code with the line number on the left side
  * @param code source code to display
@@ -51,6 +112,15 @@ std::string to_string_with_line_numbers(const std::string &code);
  */
 std::string to_string_single_line(const std::string &code, const size_t lineNumber);
 
+/**
+ * Returns the @p lineNumber-th line of @p code with the line number on the left side
+ * @param code source code to display
+ * @param lineIndex line index built from @p code
+ * @param lineNumber line to print of @p code
+ * @return string containing the single line
+ */
+std::string to_string_single_line(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber);
+
 /**
  * Returns the @p lineNumber-th line of @p code with the line number on the left side
  * and additionally a highlighted area under the printed line.
@@ -63,4 +133,17 @@ std::string to_string_single_line(const std::string &code, const size_t lineNumb
  */
 std::string to_string_line_and_highlight(const std::string &code, const size_t lineNumber, const size_t columnNumber, const size_t highlightWidth = 1);
 
+/**
+ * Returns the @p lineNumber-th line of @p code with the line number on the left side
+ * and additionally a highlighted area under the printed line.
+ *
+ * @param code source code to display
+ * @param lineIndex line index built from @p code
+ * @param lineNumber line to print of @p code
+ * @param columnNumber starting position for the highlighting
+ * @param highlightWidth width of highlighted area starting from columnNumber
+ * @return string containing the highlighted line
+ */
+std::string to_string_line_and_highlight(const std::string &code, const LineIndex &lineIndex, const size_t lineNumber, const size_t columnNumber, const size_t highlightWidth = 1);
+
 #endif //GAMEBOY_DISASSEMBLE_PRETTY_FORMAT_H
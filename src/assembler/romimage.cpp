@@ -0,0 +1,86 @@
+#include "romimage.h"
+#include "../disassembler/cartridge.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+RomImage::RomImage(const size_t numberOfBanks, const byte fillByte)
+        : _image(std::max(numberOfBanks, MINIMUM_BANKS) * BANK_SIZE, fillByte),
+          _fillByte(fillByte) {}
+
+void RomImage::write(const size_t address, const Bytestring &bytes) {
+    reserve_banks_for(address + bytes.size());
+    std::copy(bytes.begin(), bytes.end(), _image.begin() + address);
+}
+
+void RomImage::mark_code(const size_t address, const size_t size) {
+    if (size > 0) {
+        _codeRanges.emplace_back(address, address + size);
+    }
+}
+
+std::optional<std::pair<size_t, size_t>> RomImage::find_code(const size_t begin, const size_t end) const {
+    std::optional<std::pair<size_t, size_t>> code{};
+    for (const auto &[codeBegin, codeEnd] : _codeRanges) {
+        if (codeBegin < end && begin < codeEnd) {
+            const size_t overlapBegin = std::max(begin, codeBegin);
+            const size_t overlapEnd = std::min(end, codeEnd);
+            code = code.has_value() ? std::make_pair(std::min(code->first, overlapBegin), std::max(code->second, overlapEnd))
+                                    : std::make_pair(overlapBegin, overlapEnd);
+        }
+    }
+    return code;
+}
+
+bool RomImage::has_header_region() const {
+    return !find_code(cartridge::HEADER_CHECKSUM, cartridge::HEADER_END).has_value();
+}
+
+bool RomImage::update_checksums() {
+    if (!has_header_region()) {
+        return false;
+    }
+    _image[cartridge::HEADER_CHECKSUM] = compute_header_checksum(_image);
+    const word globalChecksum = compute_global_checksum(_image);
+    _image[cartridge::GLOBAL_CHECKSUM] = get_most_significant_byte(globalChecksum);
+    _image[cartridge::GLOBAL_CHECKSUM + 1] = get_least_significant_byte(globalChecksum);
+    return true;
+}
+
+void RomImage::save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open output file '" + path + "'.");
+    }
+
+    file.write(reinterpret_cast<const char*>(_image.data()), static_cast<std::streamsize>(_image.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot write output file '" + path + "'.");
+    }
+}
+
+const Bytestring& RomImage::bytes() const {
+    return _image;
+}
+
+size_t RomImage::size() const {
+    return _image.size();
+}
+
+size_t RomImage::number_of_banks() const {
+    return _image.size() / BANK_SIZE;
+}
+
+byte RomImage::fill_byte() const {
+    return _fillByte;
+}
+
+void RomImage::reserve_banks_for(const size_t size) {
+    if (size <= _image.size()) {
+        return;
+    }
+    const size_t numberOfBanks = (size + BANK_SIZE - 1) / BANK_SIZE;
+    _image.resize(numberOfBanks * BANK_SIZE, _fillByte);
+}
@@ -0,0 +1,95 @@
+#ifndef GAMEBOY_DISASSEMBLE_ROMIMAGE_H
+#define GAMEBOY_DISASSEMBLE_ROMIMAGE_H
+
+#include "../instructions/constants.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Class RomImage. A contiguous GameBoy ROM image into which assembled machine code is written.
+ * The image is preallocated in whole ROM banks and every byte which is not written
+ * keeps the fill byte, so gaps between pieces of code need no further treatment.
+ */
+class RomImage {
+public:
+    static constexpr size_t BANK_SIZE = 0x4000; ///< size of one ROM bank in bytes
+    static constexpr size_t MINIMUM_BANKS = 2;  ///< the smallest cartridge holds two banks (32 KiB)
+    static constexpr size_t MAXIMUM_BANKS = 512; ///< the largest cartridge (MBC5) holds 512 banks (8 MiB)
+
+    /**
+     * Constructor. Preallocates the image with @p numberOfBanks banks filled with @p fillByte.
+     * @param numberOfBanks number of preallocated banks, at least MINIMUM_BANKS are used
+     * @param fillByte byte with which unwritten areas of the image are filled
+     */
+    explicit RomImage(const size_t numberOfBanks = MINIMUM_BANKS, const byte fillByte = 0xFF);
+
+    /**
+     * Copies @p bytes into the image starting at @p address.
+     * The image grows by whole banks if the bytes do not fit into it.
+     * @param address the position in the image of the first byte
+     * @param bytes bytes to write
+     */
+    void write(const size_t address, const Bytestring &bytes);
+
+    /**
+     * Records that the @p size bytes at @p address hold instructions, as opposed to data like DB or DS.
+     * @param address the position in the image of the first byte
+     * @param size number of bytes
+     */
+    void mark_code(const size_t address, const size_t size);
+
+    /**
+     * Returns the part of [@p begin, @p end) which holds instructions.
+     * @param begin position of the first byte
+     * @param end position after the last byte
+     * @return the first position and the position after the last one of the instructions' bytes in the range, if there are any
+     */
+    std::optional<std::pair<size_t, size_t>> find_code(const size_t begin, const size_t end) const;
+
+    /**
+     * Checks whether the image has a header region, i.e. whether no instructions are emitted at the checksum bytes 0x014D-0x014F.
+     * Data written there, e.g. by "DB 0" or "DS 3", reserves the bytes for the checksums.
+     * @return true if the checksums can be written without modifying instructions
+     */
+    bool has_header_region() const;
+
+    /**
+     * Computes the header checksum and the global checksum of the image and writes them to 0x014D and 0x014E-0x014F,
+     * so that the image passes the boot ROM's header check and checksum verification tools.
+     * The header checksum is written first, since the global checksum includes it.
+     * Nothing is written if the image has no header region.
+     * @return true if the checksums were written
+     */
+    bool update_checksums();
+
+    /**
+     * Writes the whole image to the file @p path using a single write call.
+     * @throws std::runtime_error if the file cannot be opened or written
+     * @param path path of the output file
+     */
+    void save(const std::string &path) const;
+
+    const Bytestring& bytes() const;
+
+    size_t size() const;
+
+    size_t number_of_banks() const;
+
+    byte fill_byte() const;
+
+private:
+    /**
+     * Grows the image so that it holds at least @p size bytes, rounded up to whole banks.
+     * @param size the minimum size of the image in bytes
+     */
+    void reserve_banks_for(const size_t size);
+
+    Bytestring _image{};   ///< the image data, always a multiple of BANK_SIZE
+    std::vector<std::pair<size_t, size_t>> _codeRanges{}; ///< the ranges [begin, end) holding instructions
+    const byte _fillByte;  ///< byte with which unwritten areas are filled
+};
+
+#endif //GAMEBOY_DISASSEMBLE_ROMIMAGE_H
@@ -14,6 +14,11 @@ std::string to_string(const TokenType tokenType) {
         case TokenType::END_OF_FILE:  return "END_OF_FILE";
         case TokenType::GLOBAL_LABEL: return "GLOBAL_LABEL";
         case TokenType::LOCAL_LABEL:  return "LOCAL_LABEL";
+        case TokenType::SP_SHIFTED:   return "SP_SHIFTED";
+        case TokenType::STRING:       return "STRING";
+        case TokenType::OPERATOR:     return "OPERATOR";
+        case TokenType::MACRO_ARGUMENT: return "MACRO_ARGUMENT";
+        case TokenType::CONDITIONAL_BLOCK: return "CONDITIONAL_BLOCK";
         default: return "INVALID";
     }
 }
@@ -38,6 +43,8 @@ Token::Token(const size_t lineNumber, const size_t columnNumber, const TokenType
     } else if (_tokenType == TokenType::ADDRESS) {
         // convert string without the enclosing brackets (e.g. "(0x1234)") to the right long number
         _numericValue = (stol(_tokenString.substr(1, _tokenString.size()-2), nullptr, 0));
+    } else if (_tokenType == TokenType::CONDITIONAL_BLOCK) { // the length of the block in characters
+        _numericValue = (stol(_tokenString, nullptr, 10));
     } else if (_tokenType == TokenType::SP_SHIFTED) { // cut away leading "SP"
         _numericValue = (stol(_tokenString.substr(2, _tokenString.size()-1), nullptr, 0));
     }
@@ -72,6 +79,14 @@ std::string Token::get_position_string() const {
     return ::get_position_string(get_line(), get_column());
 }
 
+size_t Token::get_file_index() const {
+    return _fileIndex;
+}
+
+void Token::set_file_index(const size_t fileIndex) {
+    _fileIndex = fileIndex;
+}
+
 bool Token::is_invalid() const {
     return get_token_type() == TokenType::INVALID;
 }
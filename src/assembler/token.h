@@ -21,6 +21,10 @@ enum class TokenType {
     GLOBAL_LABEL,
     LOCAL_LABEL,
     SP_SHIFTED,
+    STRING,
+    OPERATOR,
+    MACRO_ARGUMENT,
+    CONDITIONAL_BLOCK, ///< lines of an IF or ELSE branch which have not been tokenized, the numeric value is their length
     INVALID
 };
 
@@ -104,6 +108,18 @@ public:
      */
     std::string get_position_string() const;
 
+    /**
+     * Returns the index of the source file the token stems from. The main file has index 0.
+     * @return file index
+     */
+    size_t get_file_index() const;
+
+    /**
+     * Sets the index of the source file the token stems from.
+     * @param fileIndex file index
+     */
+    void set_file_index(const size_t fileIndex);
+
     /**
      * Checks whether the token is of type TokenType::INVALID and returns it.
      * @return true when the token is of TokenType::INVALID
@@ -116,6 +132,7 @@ private:
     TokenType _tokenType{TokenType::INVALID}; ///< token type
     std::string _tokenString{}; ///< the string from which the token has been constructed
     std::optional<long> _numericValue{}; ///< the token's numeric value, if it exists
+    size_t _fileIndex{0}; ///< index of the source file the token stems from
 };
 
 #endif //GAMEBOY_DISASSEMBLE_TOKEN_H
@@ -0,0 +1,45 @@
+#include "tokencache.h"
+#include "tokenizer.h"
+
+uint64_t fnv1a_hash(std::string_view data) noexcept {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (const char character : data) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 0x100000001B3;
+    }
+    return hash;
+}
+
+std::shared_ptr<const CachedTokens> TokenCache::get_tokens(const std::string &path, const std::string &code) {
+    const uint64_t contentHash = fnv1a_hash(code);
+
+    Entry *entry = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(_entriesMutex);
+        std::unique_ptr<Entry> &slot = _entries[path];
+        if (slot == nullptr) {
+            slot = std::make_unique<Entry>();
+        }
+        entry = slot.get(); // entries are never removed, so the pointer stays valid
+    }
+
+    const std::lock_guard<std::mutex> lock(entry->mutex);
+    if (entry->cachedTokens != nullptr && entry->cachedTokens->contentHash == contentHash) {
+        ++_hits;
+        return entry->cachedTokens;
+    }
+
+    ++_misses;
+    Diagnostics diagnostics{};
+    entry->cachedTokens = std::make_shared<const CachedTokens>(
+            CachedTokens{contentHash, Tokenizer(code).tokenize_parallel(diagnostics), diagnostics.get_diagnostics()});
+    return entry->cachedTokens;
+}
+
+size_t TokenCache::get_hits() const noexcept {
+    return _hits;
+}
+
+size_t TokenCache::get_misses() const noexcept {
+    return _misses;
+}
@@ -0,0 +1,71 @@
+#ifndef GAMEBOY_DISASSEMBLE_TOKENCACHE_H
+#define GAMEBOY_DISASSEMBLE_TOKENCACHE_H
+
+#include "diagnostics.h"
+#include "token.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Computes the 64-bit FNV-1a hash of @p data.
+ * @param data data to hash
+ * @return hash value
+ */
+uint64_t fnv1a_hash(std::string_view data) noexcept;
+
+/**
+ * The tokens of a source file together with the lexical errors found while tokenizing it.
+ */
+struct CachedTokens {
+    uint64_t contentHash{0};               ///< FNV-1a hash of the tokenized source code
+    TokenVector tokens{};                  ///< the tokens, ending with an END_OF_FILE token
+    std::vector<Diagnostic> diagnostics{}; ///< lexical errors of the source code
+};
+
+/**
+ * Class TokenCache. Stores the tokens of source files keyed by file path and content hash,
+ * so that files which are included several times, or which are unchanged since the last assembly
+ * with the same cache, are tokenized only once.
+ *
+ * The cache may be shared by parsers running on several threads. Each file path has its own entry,
+ * so that a file requested by several threads at once is tokenized by the first of them, while
+ * different files are tokenized in parallel.
+ */
+class TokenCache {
+public:
+    /**
+     * Returns the tokens of the source file @p path with the content @p code.
+     * If the cache holds no tokens for @p path or the content has changed, @p code is tokenized.
+     * @param path path of the source file
+     * @param code content of the source file
+     * @return the cached tokens, which stay valid when the entry of @p path is replaced
+     */
+    std::shared_ptr<const CachedTokens> get_tokens(const std::string &path, const std::string &code);
+
+    size_t get_hits() const noexcept;
+
+    size_t get_misses() const noexcept;
+
+private:
+    /**
+     * The tokens of one file path, locked while they are looked up or tokenized.
+     */
+    struct Entry {
+        std::mutex mutex{};
+        std::shared_ptr<const CachedTokens> cachedTokens{};
+    };
+
+    std::mutex _entriesMutex{}; ///< guards _entries, but not the entries themselves
+    std::unordered_map<std::string, std::unique_ptr<Entry>> _entries{}; ///< cached tokens by file path
+    std::atomic<size_t> _hits{0};   ///< number of requests served from the cache
+    std::atomic<size_t> _misses{0}; ///< number of requests which required tokenizing
+};
+
+#endif //GAMEBOY_DISASSEMBLE_TOKENCACHE_H
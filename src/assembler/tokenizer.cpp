@@ -1,26 +1,192 @@
 #include "tokenizer.h"
 #include "pretty_format.h"
 
+#include <algorithm>
+#include <thread>
+
 Tokenizer::Tokenizer(const std::string& code, const size_t startingPosition)
+        : _code(std::make_shared<const std::string>(code)),
+          _lineIndex(std::make_shared<const LineIndex>(code)),
+          _currentPosition(startingPosition),
+          _endPosition(code.size())
+{}
+
+Tokenizer::Tokenizer(const std::shared_ptr<const std::string> &code, const std::shared_ptr<const LineIndex> &lineIndex,
+                     const size_t startingPosition, const size_t endPosition)
         : _code(code),
-          _currentPosition(startingPosition)
+          _lineIndex(lineIndex),
+          _currentPosition(startingPosition),
+          _endPosition(std::min(endPosition, code->size())),
+          _lineCount(lineIndex->line_number_at(startingPosition) - 1),
+          _currentLineStart(lineIndex->line_start(lineIndex->line_number_at(startingPosition)))
 {}
 
 TokenVector Tokenizer::tokenize() {
+    Diagnostics diagnostics{};
+    TokenVector tokenVector = tokenize(diagnostics);
+    diagnostics.throw_if_errors();
+    return tokenVector;
+}
+
+TokenVector Tokenizer::tokenize(Diagnostics &diagnostics) {
     TokenVector tokenVector{};
     Token currentToken{};
+    size_t lineStartIndex = 0; // index of the first token of the current line
 
     do {
-        currentToken = get_next_token();
+        try {
+            currentToken = get_next_token();
+        } catch (const SourceError &sourceError) {
+            // mark the erroneous passage and resume at the end of the line
+            diagnostics.report(sourceError);
+            currentToken = Token(sourceError.get_span().lineNumber, sourceError.get_span().columnNumber, TokenType::INVALID, "");
+            ignore_until_end_of_line();
+        }
         tokenVector.push_back(currentToken);
+
+        if (currentToken.get_token_type() == TokenType::END_OF_LINE) {
+            // the branches of IF and ELSE are only tokenized by the parser if they are assembled
+            const std::string firstString = to_upper(tokenVector[lineStartIndex].get_string());
+            if (tokenVector[lineStartIndex].get_token_type() == TokenType::IDENTIFIER && (firstString == "IF" || firstString == "ELSE")) {
+                tokenVector.push_back(skip_conditional_block());
+            }
+            lineStartIndex = tokenVector.size();
+        }
     }
     while (currentToken.get_token_type() != TokenType::END_OF_FILE);
 
     return tokenVector;
 }
 
+TokenVector Tokenizer::tokenize_parallel(const size_t numberOfThreads, const size_t minimumChunkSize) {
+    Diagnostics diagnostics{};
+    TokenVector tokenVector = tokenize_parallel(diagnostics, numberOfThreads, minimumChunkSize);
+    diagnostics.throw_if_errors();
+    return tokenVector;
+}
+
+TokenVector Tokenizer::tokenize_parallel(Diagnostics &diagnostics, const size_t numberOfThreads, const size_t minimumChunkSize) {
+    const size_t codeSize = _endPosition - std::min(_currentPosition, _endPosition);
+    const size_t maximumChunks = std::max<size_t>(codeSize / std::max<size_t>(minimumChunkSize, 1), 1);
+    const size_t hardwareThreads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    const size_t numberOfChunks = std::min((numberOfThreads == 0) ? hardwareThreads : numberOfThreads, maximumChunks);
+
+    // split at line starts, so that no token crosses a chunk boundary
+    std::vector<size_t> chunkStarts{_currentPosition};
+    for (size_t chunk = 1; chunk < numberOfChunks; ++chunk) {
+        const size_t targetPosition = _currentPosition + chunk * (codeSize / numberOfChunks);
+        size_t lineNumber = _lineIndex->line_number_at(targetPosition);
+        if (_lineIndex->line_start(lineNumber) < targetPosition) {
+            ++lineNumber;
+        }
+        const size_t chunkStart = _lineIndex->line_start(lineNumber);
+        if (chunkStart > chunkStarts.back() && chunkStart < _endPosition) {
+            chunkStarts.push_back(chunkStart);
+        }
+    }
+    chunkStarts.push_back(_endPosition);
+    chunkStarts = move_chunk_starts_out_of_conditional_blocks(chunkStarts);
+
+    if (chunkStarts.size() <= 2) {
+        return tokenize(diagnostics);
+    }
+
+    std::vector<Tokenizer> chunkTokenizers{*this};
+    chunkTokenizers.front()._endPosition = chunkStarts[1];
+    for (size_t chunk = 1; chunk + 1 < chunkStarts.size(); ++chunk) {
+        Tokenizer chunkTokenizer = create_chunk_tokenizer(chunkStarts[chunk], chunkStarts[chunk + 1]);
+        if (chunkTokenizer.is_out_of_range()) {
+            // whitespace only: belongs to the END_OF_LINE token of the preceding chunk
+            chunkTokenizers.back()._endPosition = chunkTokenizer._endPosition;
+        } else {
+            chunkTokenizers.push_back(std::move(chunkTokenizer));
+        }
+    }
+
+    std::vector<TokenVector> chunkTokens(chunkTokenizers.size());
+    std::vector<Diagnostics> chunkDiagnostics(chunkTokenizers.size());
+    std::vector<std::thread> workers{};
+    workers.reserve(chunkTokenizers.size());
+    for (size_t chunk = 0; chunk < chunkTokenizers.size(); ++chunk) {
+        workers.emplace_back([&, chunk]() {
+            chunkTokens[chunk] = chunkTokenizers[chunk].tokenize(chunkDiagnostics[chunk]);
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    size_t numberOfTokens = 0;
+    for (const TokenVector &tokens : chunkTokens) {
+        numberOfTokens += tokens.size();
+    }
+
+    TokenVector tokenVector{};
+    tokenVector.reserve(numberOfTokens);
+    for (size_t chunk = 0; chunk < chunkTokens.size(); ++chunk) {
+        TokenVector &tokens = chunkTokens[chunk];
+        // only the last chunk really ends the file, the others end at a line break
+        const bool isLastChunk = (chunk + 1 == chunkTokens.size());
+        if (!isLastChunk && tokens.back().get_token_type() == TokenType::END_OF_FILE) {
+            const Token &endOfChunk = tokens.back();
+            tokens.back() = Token(endOfChunk.get_line(), endOfChunk.get_column(), TokenType::END_OF_LINE, "\\n");
+        }
+        std::move(tokens.begin(), tokens.end(), std::back_inserter(tokenVector));
+        for (const Diagnostic &diagnostic : chunkDiagnostics[chunk].get_diagnostics()) {
+            diagnostics.report(diagnostic);
+        }
+    }
+
+    // tokenize the remaining code at the current state
+    _currentPosition = chunkTokenizers.back()._currentPosition;
+    _lineCount = chunkTokenizers.back()._lineCount;
+    _currentLineStart = chunkTokenizers.back()._currentLineStart;
+
+    return tokenVector;
+}
+
+std::vector<size_t> Tokenizer::move_chunk_starts_out_of_conditional_blocks(const std::vector<size_t> &chunkStarts) const {
+    std::vector<size_t> movedChunkStarts{chunkStarts.front()};
+    size_t nextChunk = 1;
+    size_t depth = 0;
+
+    for (size_t lineStart = chunkStarts.front(); lineStart < _endPosition && nextChunk + 1 < chunkStarts.size(); lineStart = next_line_start(lineStart)) {
+        if (depth == 0 && lineStart >= chunkStarts[nextChunk]) {
+            if (lineStart > movedChunkStarts.back()) {
+                movedChunkStarts.push_back(lineStart);
+            }
+            while (nextChunk + 1 < chunkStarts.size() && chunkStarts[nextChunk] <= lineStart) {
+                ++nextChunk;
+            }
+        }
+
+        const ConditionalDirective directive = conditional_directive_at(lineStart);
+        if (directive == ConditionalDirective::IF) {
+            ++depth;
+        } else if (directive == ConditionalDirective::ENDC && depth > 0) {
+            --depth;
+        }
+    }
+
+    movedChunkStarts.push_back(chunkStarts.back());
+    return movedChunkStarts;
+}
+
+Tokenizer Tokenizer::create_chunk_tokenizer(const size_t chunkStart, const size_t chunkEnd) const {
+    Tokenizer chunkTokenizer(*this);
+    chunkTokenizer._currentPosition = chunkStart;
+    chunkTokenizer._endPosition = chunkEnd;
+    chunkTokenizer._lineCount = _lineIndex->line_number_at(chunkStart) - 1;
+    chunkTokenizer._currentLineStart = chunkStart;
+
+    while (isspace(chunkTokenizer.read_current())) {
+        chunkTokenizer.increment_position();
+    }
+    return chunkTokenizer;
+}
+
 const std::string& Tokenizer::get_code() const noexcept{
-    return _code;
+    return *_code;
 }
 
 Token Tokenizer::get_next_token() {
@@ -32,7 +198,11 @@ Token Tokenizer::get_next_token() {
         ignore_until_end_of_line();
     }
 
-    if (read_current() == '(' || read_current() == '[')
+    if (read_current() == '(' && !is_parenthesized_operand())
+    {
+        currentToken = tokenize_operator(); // parenthesis of an expression
+    }
+    else if (read_current() == '(' || read_current() == '[')
     {
         if (isalpha(read_next()))
         {
@@ -42,16 +212,24 @@ Token Tokenizer::get_next_token() {
         {
             currentToken = tokenize_address();
         }
+        else
+        {
+            throw_logic_error_and_highlight(get_line(), get_column(), std::string("Lexical error: Expected identifier or number after '") + read_current() + "'");
+        }
     }
     else if (read_current() == ',')
     {
         currentToken = Token(get_line(), get_column(), TokenType::COMMA, ",");
         increment_position();
     }
-    else if (isdigit(read_current()) || is_sign(read_current()))
+    else if (isdigit(read_current()) || (is_sign(read_current()) && isdigit(read_next())))
     {
         currentToken = tokenize_number();
     }
+    else if (is_operator_start(read_current()))
+    {
+        currentToken = tokenize_operator();
+    }
     else if (isalpha(read_current()))
     {
         if (toupper(read_current()) == 'S'
@@ -66,6 +244,17 @@ Token Tokenizer::get_next_token() {
     {
         currentToken = tokenize_local_label();
     }
+    else if (read_current() == '"')
+    {
+        currentToken = tokenize_string();
+    }
+    else if (read_current() == '\\' && isdigit(read_next()))
+    {
+        // argument of a macro body, e.g. \1
+        const size_t columnPosition = get_column();
+        const std::string str{fetch(), fetch()};
+        currentToken = Token(get_line(), columnPosition, TokenType::MACRO_ARGUMENT, str);
+    }
     else if (read_current() == '\n')
     {
         currentToken = tokenize_end_of_line();
@@ -88,7 +277,7 @@ Token Tokenizer::get_next_token() {
 }
 
 bool Tokenizer::is_out_of_range() const noexcept {
-    return (_currentPosition >= get_code().size());
+    return (_currentPosition >= _endPosition);
 }
 
 Token Tokenizer::tokenize_identifier_or_global_label() {
@@ -212,6 +401,114 @@ Token Tokenizer::tokenize_local_label() {
     return Token(get_line(), columnPosition, TokenType::LOCAL_LABEL, str);
 }
 
+Token Tokenizer::tokenize_string() {
+    std::string str{};
+    const size_t lineNumber = get_line();
+    const size_t columnPosition = get_column();
+
+    // string must start with '"'
+    str += fetch_and_expect('"');
+
+    while (read_current() != '"')
+    {
+        if (read_current() == '\n' || read_current() == CHAR_EOF)
+        {
+            throw_logic_error_and_highlight(lineNumber, columnPosition, "Lexical error: Missing closing '\"' of string");
+        }
+        str += fetch();
+    }
+    str += fetch();
+
+    return Token(lineNumber, columnPosition, TokenType::STRING, str);
+}
+
+Token Tokenizer::tokenize_operator() {
+    const size_t columnPosition = get_column();
+    std::string str(1, fetch());
+
+    // shift operators consist of two characters
+    if (str == "<" || str == ">") {
+        if (read_current() != str.front()) {
+            throw_logic_error_and_highlight(get_line(), columnPosition, "Lexical error: Expected '" + str + str + "' at " + get_position_string());
+        }
+        str += fetch();
+    }
+
+    return Token(get_line(), columnPosition, TokenType::OPERATOR, str);
+}
+
+bool Tokenizer::is_parenthesized_operand() const noexcept {
+    size_t position = _currentPosition + 1;
+    const bool isAddress = isdigit(read_char(position));
+
+    // special case: (SP+a8)
+    if (!isAddress && read_char(position) == 'S' && read_char(position + 1) == 'P' && read_char(position + 2) == '+') {
+        position += 3;
+    } else if (!isalnum(read_char(position))) {
+        return false;
+    }
+
+    while (isalnum(read_char(position))) {
+        ++position;
+    }
+    // registers may be followed by + or -, e.g. (HL+)
+    if (!isAddress && is_sign(read_char(position))) {
+        ++position;
+    }
+    return read_char(position) == ')';
+}
+
+Token Tokenizer::skip_conditional_block() {
+    const size_t lineNumber = get_line();
+    const size_t columnPosition = get_column();
+    const size_t blockStart = _currentPosition;
+
+    // only the first word of each line is examined, nested blocks are skipped as a whole
+    size_t depth = 0;
+    while (!is_out_of_range()) {
+        const ConditionalDirective directive = conditional_directive_at(_currentPosition);
+        if (depth == 0 && (directive == ConditionalDirective::ELSE || directive == ConditionalDirective::ENDC)) {
+            break;
+        }
+        if (directive == ConditionalDirective::IF) {
+            ++depth;
+        } else if (directive == ConditionalDirective::ENDC) {
+            --depth;
+        }
+
+        _currentPosition = next_line_start(_currentPosition);
+        _currentLineStart = _currentPosition;
+        increment_linecount();
+    }
+
+    return Token(lineNumber, columnPosition, TokenType::CONDITIONAL_BLOCK, std::to_string(_currentPosition - blockStart));
+}
+
+Tokenizer::ConditionalDirective Tokenizer::conditional_directive_at(const size_t position) const noexcept {
+    size_t wordStart = position;
+    while (read_char(wordStart) == ' ' || read_char(wordStart) == '\t') {
+        ++wordStart;
+    }
+    size_t wordEnd = wordStart;
+    while (isalnum(read_char(wordEnd))) {
+        ++wordEnd;
+    }
+    if (wordEnd - wordStart != 2 && wordEnd - wordStart != 4) { // neither IF nor ELSE or ENDC
+        return ConditionalDirective::NONE;
+    }
+
+    const std::string word = to_upper(_code->substr(wordStart, wordEnd - wordStart));
+    if (word == "IF")   { return ConditionalDirective::IF; }
+    if (word == "ELSE") { return ConditionalDirective::ELSE; }
+    if (word == "ENDC") { return ConditionalDirective::ENDC; }
+    return ConditionalDirective::NONE;
+}
+
+size_t Tokenizer::next_line_start(const size_t position) const noexcept {
+    const size_t newlinePosition = _code->find('\n', position);
+    return (newlinePosition == std::string::npos || newlinePosition >= _endPosition) ? _endPosition : newlinePosition + 1;
+}
+
 Token Tokenizer::tokenize_sp_shifted() {
     std::string str{};
     const size_t columnPosition = get_column();
@@ -270,7 +567,7 @@ void Tokenizer::increment_linecount() noexcept {
 }
 
 char Tokenizer::read_char(const size_t index) const noexcept {
-    return (index >= get_code().size()) ? CHAR_EOF : get_code().at(index);
+    return (index >= _endPosition) ? CHAR_EOF : (*_code)[index];
 }
 
 char Tokenizer::read_current() const noexcept {
@@ -304,7 +601,7 @@ void Tokenizer::ignore_whitespace() noexcept {
 }
 
 void Tokenizer::ignore_until_end_of_line() {
-    while(read_current() != '\n')
+    while(read_current() != '\n' && read_current() != CHAR_EOF)
     {
         fetch();
     }
@@ -325,7 +622,8 @@ std::string Tokenizer::get_position_string() {
 }
 
 void Tokenizer::throw_logic_error_and_highlight(const size_t lineNumber, const size_t columnNumber, const std::string &errorMessage) {
-    ::throw_exception_and_highlight(get_code(), lineNumber, columnNumber, errorMessage);
+    throw SourceError(to_string_error_and_highlight(get_code(), *_lineIndex, lineNumber, columnNumber, errorMessage),
+                      SourceSpan{lineNumber, columnNumber, 1});
 }
 
 Token Tokenizer::try_to_create_token(const size_t lineNumber, const size_t columnNumber, const TokenType tokenType, const std::string &tokenString) {
@@ -2,10 +2,12 @@
 #define GAMEBOY_DISASSEMBLE_TOKENIZER_H
 
 #include "auxiliary.h"
+#include "diagnostics.h"
 #include "pretty_format.h"
 #include "token.h"
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,8 +16,16 @@ const char CHAR_EOF = 0x04;
 /** Class Tokenizer. Takes GameBoy assembly source code and returns
  *  tokens one by one.
  *
- *  In case of a lexical error, a std::logic_error containing a string with
- *  the highlighted source code and an error message is thrown.
+ *  Lexical errors are collected, and the tokenizer resumes at the end of the erroneous line.
+ *  Either all of them are thrown at once as a std::logic_error containing the
+ *  highlighted source code and the error messages, or they are reported to a Diagnostics sink.
+ *
+ *  Since lines are lexically independent, large sources may be tokenized in parallel,
+ *  each worker thread handling a chunk of whole lines.
+ *
+ *  The lines following IF and ELSE directives are not tokenized. Only the first word of each line
+ *  is examined for finding the matching ELSE or ENDC, and the skipped lines are represented by
+ *  a single CONDITIONAL_BLOCK token, which the parser tokenizes only if the branch is assembled.
  */
 class Tokenizer
 {
@@ -28,6 +38,16 @@ public:
      */
     Tokenizer(const std::string &code, const size_t startingPosition = 0);
 
+    /**
+     * Constructor. Tokenizes a part of source code which is shared with the caller, e.g. a conditional block.
+     * @param code Source code which should be tokenized / lexically analyzed.
+     * @param lineIndex line start offsets of @p code
+     * @param startingPosition starting position in the code.
+     * @param endPosition position at which tokenizing ends.
+     */
+    Tokenizer(const std::shared_ptr<const std::string> &code, const std::shared_ptr<const LineIndex> &lineIndex,
+              const size_t startingPosition, const size_t endPosition);
+
     Tokenizer(const Tokenizer&) = default;
     Tokenizer(Tokenizer&&) = default;
     Tokenizer& operator=(const Tokenizer&) = default;
@@ -35,10 +55,44 @@ public:
 
     /**
      * Tokenize the source code from @p _startingPosition to the end.
+     * @throws std::logic_error containing all lexical error messages and the highlighted code passages
      * @return Vector of all tokens
      */
     TokenVector tokenize();
 
+    /**
+     * Tokenize the source code from @p _startingPosition to the end.
+     * Lexical errors are reported to @p diagnostics instead of being thrown. The erroneous passage is
+     * replaced by an INVALID token and tokenizing resumes at the end of the line.
+     * @param diagnostics sink to which all lexical errors are reported
+     * @return Vector of all tokens
+     */
+    TokenVector tokenize(Diagnostics &diagnostics);
+
+    /**
+     * Tokenize the source code from @p _startingPosition to the end using multiple threads.
+     * The code is split into chunks at line boundaries, each chunk is tokenized on its own thread
+     * and the per-chunk tokens are concatenated. The result equals the one of tokenize().
+     * @throws std::logic_error containing all lexical error messages and the highlighted code passages
+     * @param numberOfThreads maximum number of worker threads, 0 selects the number of hardware threads
+     * @param minimumChunkSize minimum number of characters per chunk, smaller sources are tokenized serially
+     * @return Vector of all tokens
+     */
+    TokenVector tokenize_parallel(const size_t numberOfThreads = 0, const size_t minimumChunkSize = DEFAULT_MINIMUM_CHUNK_SIZE);
+
+    /**
+     * Tokenize the source code from @p _startingPosition to the end using multiple threads.
+     * Lexical errors are reported to @p diagnostics in source order instead of being thrown.
+     * @param diagnostics sink to which all lexical errors are reported
+     * @param numberOfThreads maximum number of worker threads, 0 selects the number of hardware threads
+     * @param minimumChunkSize minimum number of characters per chunk, smaller sources are tokenized serially
+     * @return Vector of all tokens
+     */
+    TokenVector tokenize_parallel(Diagnostics &diagnostics, const size_t numberOfThreads = 0,
+                                  const size_t minimumChunkSize = DEFAULT_MINIMUM_CHUNK_SIZE);
+
+    static constexpr size_t DEFAULT_MINIMUM_CHUNK_SIZE = 0x10000; ///< 64 KiB of source code per worker thread
+
     /**
      * Returns a const reference to the source code.
      * @return const reference to source code.
@@ -46,10 +100,20 @@ public:
     const std::string& get_code() const noexcept;
 
 private:
+    /**
+     * Directives which start or end a conditional block.
+     */
+    enum class ConditionalDirective {
+        NONE,
+        IF,
+        ELSE,
+        ENDC
+    };
+
     /**
      * Returns next token from source code.
      *
-     * @throws std::logic_error containing an error message and the
+     * @throws SourceError containing an error message and the
      * highlighted code passage in case of lexical error.
      * @return next token
      */
@@ -85,6 +149,55 @@ private:
      */
     Token tokenize_local_label();
 
+    /**
+     * Tokenizes characters enclosed in double quotes to a STRING token.
+     * The token string contains the enclosing quotes.
+     * @return STRING token
+     */
+    Token tokenize_string();
+
+    /**
+     * Tokenizes characters to an OPERATOR token of an expression, i.e. one of + - * / << >> & | ~ ( ).
+     * @return OPERATOR token
+     */
+    Token tokenize_operator();
+
+    /**
+     * Checks whether the parenthesis at the current position encloses a single operand, e.g. (HL+) or (0xFF00),
+     * rather than starting a parenthesized expression like (CONSTANT + 1).
+     * @return true if the parenthesis starts an IDENTIFIER or ADDRESS token
+     */
+    bool is_parenthesized_operand() const noexcept;
+
+    /**
+     * Skips the lines from the current position up to the line containing the matching ELSE or ENDC directive,
+     * or up to the end of the code, without tokenizing them.
+     * @return CONDITIONAL_BLOCK token, whose position is the start of the skipped lines and whose numeric value is their length
+     */
+    Token skip_conditional_block();
+
+    /**
+     * Determines whether the first word of the line at @p position is a directive for conditional blocks.
+     * @param position position of a line start, or of whitespace in front of the first word
+     * @return the directive, or ConditionalDirective::NONE
+     */
+    ConditionalDirective conditional_directive_at(const size_t position) const noexcept;
+
+    /**
+     * Returns the position of the line start following @p position.
+     * @param position position in the code
+     * @return position after the next newline character, or the end position if there is none
+     */
+    size_t next_line_start(const size_t position) const noexcept;
+
+    /**
+     * Moves the chunk starts of parallel tokenizing behind conditional blocks,
+     * since the tokenizer of a chunk must see the whole block.
+     * @param chunkStarts line starts at which chunks start, followed by the end position
+     * @return chunk starts outside of conditional blocks, followed by the end position
+     */
+    std::vector<size_t> move_chunk_starts_out_of_conditional_blocks(const std::vector<size_t> &chunkStarts) const;
+
     /**
      * Tokenizes characters to an SP_SHIFTED token.
      * @return SP_SHIFTED token
@@ -190,8 +303,20 @@ private:
      */
     Token try_to_create_token(const size_t lineNumber, const size_t columnNumber, const TokenType tokenType, const std::string &tokenString);
 
-    std::string _code{}; ///< source code used for lexical analysis
+    /**
+     * Creates a tokenizer for the chunk of whole lines starting at the line start @p chunkStart
+     * and ending before @p chunkEnd. The chunk start is advanced past leading whitespace and blank lines,
+     * since the tokenizer of the preceding chunk consumes those when creating its END_OF_LINE token.
+     * @param chunkStart offset of the first character of a line
+     * @param chunkEnd offset at which the chunk ends
+     * @return tokenizer sharing the source code of this tokenizer
+     */
+    Tokenizer create_chunk_tokenizer(const size_t chunkStart, const size_t chunkEnd) const;
+
+    std::shared_ptr<const std::string> _code{}; ///< source code used for lexical analysis, shared between chunk tokenizers
+    std::shared_ptr<const LineIndex> _lineIndex{}; ///< line start offsets of _code, used for highlighting errors
     size_t _currentPosition{0}; ///< current position in source code
+    size_t _endPosition{0}; ///< position at which the tokenized code ends, i.e. the end of the code or of the chunk
     size_t _lineCount{0}; ///< line counter, i.e. the line the tokenizer currently operates in
     size_t _currentLineStart{0}; ///< the position of the character starting the current line
 };
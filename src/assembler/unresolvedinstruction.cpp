@@ -1,5 +0,0 @@
-//
-// Created by tristan on 23.07.21.
-//
-
-#include "unresolvedinstruction.h"
@@ -0,0 +1,200 @@
+#include "cartridge.h"
+#include "../instructions/auxiliary_and_conversions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr size_t TITLE_LENGTH = 16;
+    constexpr size_t VECTOR_SIZE = 8;        ///< bytes between two restart or interrupt vectors
+    constexpr word LAST_VECTOR = 0x0060;     ///< the joypad interrupt vector
+
+    /**
+     * Checks whether @p rom is large enough to hold a cartridge header.
+     * @throws std::runtime_error if it is not
+     * @param rom the ROM image
+     */
+    void check_header_size(const Bytestring &rom) {
+        if (rom.size() < cartridge::HEADER_END) {
+            throw std::runtime_error("The ROM of " + std::to_string(rom.size()) + " bytes is too small to hold a cartridge header.");
+        }
+    }
+
+    /**
+     * Decodes the ROM size code @p code of the header.
+     * @throws std::runtime_error if the code is unknown
+     * @param code the byte at 0x0148
+     * @return number of ROM banks
+     */
+    size_t decode_rom_banks(const byte code) {
+        constexpr byte LARGEST_POWER_OF_TWO = 0x08; // 8 MiB
+        if (code <= LARGEST_POWER_OF_TWO) {
+            return size_t{2} << code;
+        }
+        switch (code) {
+            case 0x52: return 72;
+            case 0x53: return 80;
+            case 0x54: return 96;
+            default:
+                throw std::runtime_error("Unknown ROM size code " + to_string_hex_prefixed(code) + " in the cartridge header.");
+        }
+    }
+
+    /**
+     * Decodes the RAM size code @p code of the header.
+     * @throws std::runtime_error if the code is unknown
+     * @param code the byte at 0x0149
+     * @return size of the external RAM in bytes
+     */
+    size_t decode_ram_size(const byte code) {
+        constexpr size_t KIB = 1024;
+        switch (code) {
+            case 0x00: return 0;
+            case 0x01: return 2 * KIB;
+            case 0x02: return 8 * KIB;
+            case 0x03: return 32 * KIB;
+            case 0x04: return 128 * KIB;
+            case 0x05: return 64 * KIB;
+            default:
+                throw std::runtime_error("Unknown RAM size code " + to_string_hex_prefixed(code) + " in the cartridge header.");
+        }
+    }
+}
+
+size_t sum_bytes(const byte *data, const size_t size) noexcept {
+    size_t sum = 0;
+    size_t index = 0;
+#ifdef __SSE2__
+    // the sum of absolute differences to zero adds eight bytes into each 64-bit half
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = zero;
+    for (; index + sizeof(__m128i) <= size; index += sizeof(__m128i)) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, zero));
+    }
+    alignas(16) uint64_t halves[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(halves), sums);
+    sum = static_cast<size_t>(halves[0] + halves[1]);
+#endif
+    for (; index < size; ++index) {
+        sum += data[index];
+    }
+    return sum;
+}
+
+byte compute_header_checksum(const Bytestring &rom) {
+    check_header_size(rom);
+    byte checksum = 0;
+    for (size_t address = cartridge::TITLE_BEGIN; address < cartridge::HEADER_CHECKSUM; ++address) {
+        checksum = static_cast<byte>(checksum - rom[address] - 1);
+    }
+    return checksum;
+}
+
+word compute_global_checksum(const Bytestring &rom) {
+    check_header_size(rom);
+    const size_t sum = sum_bytes(rom.data(), rom.size()) - rom[cartridge::GLOBAL_CHECKSUM] - rom[cartridge::GLOBAL_CHECKSUM + 1];
+    return static_cast<word>(sum);
+}
+
+std::string cartridge_type_name(const byte cartridgeType) {
+    switch (cartridgeType) {
+        case 0x00: return "ROM ONLY";
+        case 0x01: return "MBC1";
+        case 0x02: return "MBC1+RAM";
+        case 0x03: return "MBC1+RAM+BATTERY";
+        case 0x05: return "MBC2";
+        case 0x06: return "MBC2+BATTERY";
+        case 0x08: return "ROM+RAM";
+        case 0x09: return "ROM+RAM+BATTERY";
+        case 0x0B: return "MMM01";
+        case 0x0C: return "MMM01+RAM";
+        case 0x0D: return "MMM01+RAM+BATTERY";
+        case 0x0F: return "MBC3+TIMER+BATTERY";
+        case 0x10: return "MBC3+TIMER+RAM+BATTERY";
+        case 0x11: return "MBC3";
+        case 0x12: return "MBC3+RAM";
+        case 0x13: return "MBC3+RAM+BATTERY";
+        case 0x19: return "MBC5";
+        case 0x1A: return "MBC5+RAM";
+        case 0x1B: return "MBC5+RAM+BATTERY";
+        case 0x1C: return "MBC5+RUMBLE";
+        case 0x1D: return "MBC5+RUMBLE+RAM";
+        case 0x1E: return "MBC5+RUMBLE+RAM+BATTERY";
+        case 0x20: return "MBC6";
+        case 0x22: return "MBC7+SENSOR+RUMBLE+RAM+BATTERY";
+        case 0xFC: return "POCKET CAMERA";
+        case 0xFD: return "BANDAI TAMA5";
+        case 0xFE: return "HuC3";
+        case 0xFF: return "HuC1+RAM+BATTERY";
+        default:   return "unknown " + to_string_hex_prefixed(cartridgeType);
+    }
+}
+
+Cartridge::Cartridge(const Bytestring &rom)
+: _rom(rom)
+{
+    check_header_size(rom);
+
+    // the last title byte is the Color GameBoy flag on newer cartridges, which is never printable ASCII
+    const auto titleBegin = rom.cbegin() + cartridge::TITLE_BEGIN;
+    const auto titleEnd = std::find_if(titleBegin, titleBegin + TITLE_LENGTH, [](const byte character) {
+        return character < 0x20 || character >= 0x7F;
+    });
+    _header.title.assign(titleBegin, titleEnd);
+    _header.cartridgeType = rom[cartridge::CARTRIDGE_TYPE];
+    _header.romBanks = decode_rom_banks(rom[cartridge::ROM_SIZE]);
+    _header.ramSize = decode_ram_size(rom[cartridge::RAM_SIZE]);
+    _header.headerChecksum = rom[cartridge::HEADER_CHECKSUM];
+    _header.globalChecksum = big_endian_to_number(rom[cartridge::GLOBAL_CHECKSUM], rom[cartridge::GLOBAL_CHECKSUM + 1]);
+
+    if (rom.size() < _header.romBanks * cartridge::BANK_SIZE) {
+        throw std::runtime_error("The cartridge header declares " + std::to_string(_header.romBanks) + " ROM banks, but the ROM holds only "
+                                 + std::to_string(rom.size()) + " bytes.");
+    }
+}
+
+const CartridgeHeader& Cartridge::get_header() const noexcept {
+    return _header;
+}
+
+size_t Cartridge::number_of_banks() const noexcept {
+    return _header.romBanks;
+}
+
+Bytestring Cartridge::bank_memory(const size_t bank) const {
+    if (bank == 0 || bank >= _header.romBanks) {
+        throw std::out_of_range("Error: Bank " + std::to_string(bank) + " cannot be mapped at "
+                                + to_string_hex_prefixed(cartridge::SWITCHABLE_BANK_BEGIN) + ".");
+    }
+    Bytestring memory(2 * cartridge::BANK_SIZE);
+    std::copy_n(_rom.cbegin(), cartridge::BANK_SIZE, memory.begin());
+    std::copy_n(_rom.cbegin() + static_cast<std::ptrdiff_t>(bank * cartridge::BANK_SIZE), cartridge::BANK_SIZE,
+                memory.begin() + cartridge::SWITCHABLE_BANK_BEGIN);
+    return memory;
+}
+
+std::vector<word> Cartridge::entry_points() const {
+    std::vector<word> entryPoints{cartridge::ENTRY_POINT};
+    for (word vector = 0x0000; vector <= LAST_VECTOR; vector += VECTOR_SIZE) {
+        const auto begin = _rom.cbegin() + vector;
+        const bool isPadding = std::all_of(begin, begin + VECTOR_SIZE, [](const byte value) { return value == 0x00; })
+                            || std::all_of(begin, begin + VECTOR_SIZE, [](const byte value) { return value == 0xFF; });
+        if (!isPadding) {
+            entryPoints.push_back(vector);
+        }
+    }
+    return entryPoints;
+}
+
+bool Cartridge::is_header_checksum_valid() const {
+    return compute_header_checksum(_rom) == _header.headerChecksum;
+}
+
+bool Cartridge::is_global_checksum_valid() const {
+    return compute_global_checksum(_rom) == _header.globalChecksum;
+}
@@ -0,0 +1,125 @@
+#ifndef GAMEBOY_DISASSEMBLE_CARTRIDGE_H
+#define GAMEBOY_DISASSEMBLE_CARTRIDGE_H
+
+#include "../instructions/constants.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * The fields of the cartridge header at 0x0100-0x014F.
+ */
+struct CartridgeHeader {
+    std::string title{};      ///< title in upper case ASCII, without the trailing zeros
+    byte cartridgeType{0};    ///< memory bank controller and further hardware of the cartridge
+    size_t romBanks{0};       ///< number of ROM banks of 16 KiB, decoded from the ROM size code
+    size_t ramSize{0};        ///< size of the external RAM in bytes, decoded from the RAM size code
+    byte headerChecksum{0};   ///< checksum of 0x0134-0x014C stored at 0x014D
+    word globalChecksum{0};   ///< sum of all other bytes of the ROM stored big endian at 0x014E-0x014F
+};
+
+namespace cartridge {
+    constexpr word ENTRY_POINT = 0x0100;           ///< address at which the boot ROM hands over to the cartridge
+    constexpr word LOGO_BEGIN = 0x0104;            ///< first byte of the Nintendo logo, at which the header data begins
+    constexpr word TITLE_BEGIN = 0x0134;
+    constexpr word CARTRIDGE_TYPE = 0x0147;
+    constexpr word ROM_SIZE = 0x0148;
+    constexpr word RAM_SIZE = 0x0149;
+    constexpr word HEADER_CHECKSUM = 0x014D;
+    constexpr word GLOBAL_CHECKSUM = 0x014E;
+    constexpr word HEADER_END = 0x0150;            ///< first byte after the header, where the code usually continues
+    constexpr size_t BANK_SIZE = 0x4000;           ///< size of one ROM bank in bytes
+    constexpr word SWITCHABLE_BANK_BEGIN = 0x4000; ///< address at which banks 1 and above are mapped
+}
+
+/**
+ * Returns the sum of @p size bytes starting at @p data.
+ * With SSE2, 16 bytes are summed at a time with _mm_sad_epu8, otherwise the bytes are summed one by one.
+ * @param data first byte
+ * @param size number of bytes
+ * @return the sum of the bytes
+ */
+size_t sum_bytes(const byte *data, const size_t size) noexcept;
+
+/**
+ * Computes the header checksum of the ROM @p rom, i.e. x = x - byte - 1 over the bytes 0x0134-0x014C.
+ * @throws std::runtime_error if @p rom is too small to hold a header
+ * @param rom the ROM image
+ * @return the header checksum
+ */
+byte compute_header_checksum(const Bytestring &rom);
+
+/**
+ * Computes the global checksum of the ROM @p rom, i.e. the sum of all bytes except the two bytes of the global checksum.
+ * @throws std::runtime_error if @p rom is too small to hold a header
+ * @param rom the ROM image
+ * @return the lower 16 bits of the sum
+ */
+word compute_global_checksum(const Bytestring &rom);
+
+/**
+ * Returns the name of the cartridge type @p cartridgeType, e.g. "MBC1+RAM+BATTERY".
+ * @param cartridgeType the cartridge type byte of the header
+ * @return the name, or "unknown" followed by the byte
+ */
+std::string cartridge_type_name(const byte cartridgeType);
+
+/**
+ * Class Cartridge. A ROM image described by its cartridge header.
+ *
+ * The header determines how many banks are decoded. Bank 0 is always mapped at 0x0000-0x3FFF,
+ * the other banks are decoded one at a time as mapped at 0x4000-0x7FFF. The logo and the header data
+ * at 0x0104-0x014F are no code and are skipped, and the traversal of the code starts at the entry point
+ * and at the restart and interrupt vectors which hold code.
+ */
+class Cartridge {
+public:
+    /**
+     * Constructor. Parses the header of @p rom.
+     * @throws std::runtime_error if @p rom is too small to hold a header or the banks declared by it, or a size code is unknown
+     * @param rom the ROM image, which must outlive the object
+     */
+    explicit Cartridge(const Bytestring &rom);
+
+    const CartridgeHeader& get_header() const noexcept;
+
+    /**
+     * Returns the number of ROM banks declared by the header.
+     * @return number of banks, at least 2
+     */
+    size_t number_of_banks() const noexcept;
+
+    /**
+     * Returns the memory seen by the CPU while bank @p bank is mapped, i.e. 0x0000-0x7FFF with bank 0 followed by bank @p bank.
+     * @throws std::out_of_range if @p bank is 0 or not declared by the header
+     * @param bank number of the switchable bank
+     * @return the memory, indexed by address
+     */
+    Bytestring bank_memory(const size_t bank) const;
+
+    /**
+     * Returns the addresses at which the traversal of the code starts: the entry point at 0x0100,
+     * followed by the restart vectors 0x0000-0x0038 and the interrupt vectors 0x0040-0x0060 which hold code.
+     * A vector whose 8 bytes are all 0x00 or all 0xFF is padding and left out.
+     * @return the entry addresses
+     */
+    std::vector<word> entry_points() const;
+
+    /**
+     * Checks whether the header checksum stored at 0x014D matches the header.
+     * @return true if valid
+     */
+    bool is_header_checksum_valid() const;
+
+    /**
+     * Checks whether the global checksum stored at 0x014E-0x014F matches the ROM.
+     * @return true if valid
+     */
+    bool is_global_checksum_valid() const;
+
+private:
+    const Bytestring &_rom;
+    CartridgeHeader _header{};
+};
+
+#endif //GAMEBOY_DISASSEMBLE_CARTRIDGE_H
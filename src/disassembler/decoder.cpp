@@ -22,10 +22,10 @@ bool Decoder::is_out_of_range() const noexcept {
 
 }
 
-std::pair<word, InstructionPtr> Decoder::decode() {
+DecodedInstruction Decoder::decode() {
     word opcodePosition = get_current_position();
     const Opcode opcode = fetch_opcode();
-    return std::make_pair(opcodePosition, decode_opcode(opcode));
+    return DecodedInstruction{opcodePosition, decode_opcode(opcode), instruction_cycles(opcode)};
 }
 
 void Decoder::increment_program_counter() noexcept {
@@ -316,7 +316,7 @@ InstructionPtr Decoder::decode_opcode(const Opcode opcode) {
         case opcodes::PUSH_HL                                    : return create_instruction<Push16BitRegister>(Register16Bit::HL);
         case opcodes::AND_A_AND_IMMEDIATE                        : return create_instruction<AndAAndImmediate>(fetch_byte());
         case opcodes::RESTART_4                                  : return create_instruction<Restart>(4);
-        case opcodes::ADD_SP_AND_IMMEDIATE                       : return create_instruction<AddSPAndImmediate>(fetch_word());
+        case opcodes::ADD_SP_AND_IMMEDIATE                       : return create_instruction<AddSPAndImmediate>(fetch_byte());
         case opcodes::JUMP_TO_HL                                 : return create_instruction<JumpToHL>();
         case opcodes::LOAD_A_INTO_ADDRESS_IMMEDIATE              : return create_instruction<LoadAIntoAddressImmediate>(fetch_word());
         case opcodes::UNUSED_6                                   : return create_instruction<Unused>(6);
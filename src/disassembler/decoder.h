@@ -6,6 +6,15 @@
 
 #include "../instructions/instructions.h"
 
+/**
+ * An instruction decoded from bytecode, together with its address and its execution time.
+ */
+struct DecodedInstruction {
+    word address{0};
+    InstructionPtr instruction{};
+    InstructionCycles cycles{}; ///< clock cycles of the instruction, taken from the cycle table of its opcode
+};
+
 /**
  * Class Decoder. Given a bytestring, it decodes it and returns the instructions one by one.
  */
@@ -39,10 +48,10 @@ public:
 
     // throws std::out_of_range if program counter is out of range.
     /**
-     * Decodes an instruction and returns the address and the pointer to the instruction as a std::pair.
-     * @return address/instruction
+     * Decodes an instruction and returns it with its address and its clock cycles.
+     * @return the decoded instruction
      */
-    std::pair<word, InstructionPtr> decode();
+    DecodedInstruction decode();
 
 private:
 
@@ -1,4 +1,35 @@
 #include "disassemble.h"
+#include "../analysis/callgraph.h"
+#include "../assembler/mappedfile.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+    /**
+     * Disassembles the instructions of @p memory beginning at @p begin up to the first instruction at or after @p end,
+     * preceding each routine in @p routines with a marker.
+     * @param memory the memory, indexed by address
+     * @param begin address of the first instruction
+     * @param end address at which the decoding stops
+     * @param routines addresses of the routines to mark
+     * @param ostr output stream
+     */
+    void disassemble_range(const Bytestring &memory, const word begin, const size_t end, const std::unordered_set<word> &routines,
+                           std::ostream &ostr) {
+        Decoder decoder(memory, begin);
+        while (!decoder.is_out_of_range() && decoder.get_current_position() < end) {
+            if (routines.count(decoder.get_current_position()) > 0) {
+                ostr << "; routine " << to_string_hex_prefixed(decoder.get_current_position()) << '\n';
+            }
+            try {
+                ostr << disassemble_instruction(decoder.decode()) << '\n';
+            } catch (const std::out_of_range &) {
+                return; // the last instruction is cut off by the end of the memory
+            }
+        }
+    }
+}
 
 unsigned decode_length(const Opcode opcode) {
     constexpr size_t maxInstructionLength = 4;
@@ -10,21 +41,27 @@ unsigned decode_length(const Opcode opcode) {
     Decoder decoder(bytecode);
 
     // calculate number of bytes read_current
-    const auto [address, decodedInstruction] = decoder.decode();
-
-    return decodedInstruction->length();
+    return decoder.decode().instruction->length();
 }
 
-void disassemble(const Bytestring &bytecode, std::ostream &ostr) {
+void disassemble(const Bytestring &bytecode, std::ostream &ostr, const bool showCycles) {
     Decoder decoder(bytecode);
+    InstructionCycles total{};
 
-    while (!decoder.is_out_of_range())
-        ostr << disassemble_instruction(decoder.decode()) << std::endl;
+    while (!decoder.is_out_of_range()) {
+        const DecodedInstruction decodedInstruction = decoder.decode();
+        if (showCycles) {
+            total += decodedInstruction.cycles;
+            ostr << annotate_cycles(disassemble_instruction(decodedInstruction), decodedInstruction.cycles, total) << std::endl;
+        } else {
+            ostr << disassemble_instruction(decodedInstruction) << std::endl;
+        }
+    }
 }
 
-std::string disassemble_instruction(const std::pair<word, InstructionPtr> &decoderOutput) {
-    const word opcodePosition = decoderOutput.first;
-    const BaseInstruction instruction = *decoderOutput.second;
+std::string disassemble_instruction(const DecodedInstruction &decoderOutput) {
+    const word opcodePosition = decoderOutput.address;
+    const BaseInstruction instruction = *decoderOutput.instruction;
     const Opcode opcode = instruction.opcode();
 
     std::string displayedText;
@@ -36,3 +73,64 @@ std::string disassemble_instruction(const std::pair<word, InstructionPtr> &decod
 
     return displayedText;
 }
+
+std::string annotate_cycles(const std::string &line, const InstructionCycles &cycles, const InstructionCycles &total) {
+    constexpr size_t cyclesColumn = 40; // the annotations of all lines are aligned unless the line is longer
+    std::string annotatedLine = line;
+    annotatedLine.resize(std::max(line.size() + 1, cyclesColumn), ' ');
+    return annotatedLine + "; " + to_string_cycles(cycles) + " cycles, total " + to_string_cycles(total);
+}
+
+void print_listing(const std::vector<DecodedInstruction> &instructions, std::ostream &ostr) {
+    InstructionCycles total{};
+    for (const DecodedInstruction &decodedInstruction : instructions) {
+        total += decodedInstruction.cycles;
+        ostr << annotate_cycles(disassemble_instruction(decodedInstruction), decodedInstruction.cycles, total) << '\n';
+    }
+}
+
+Bytestring read_rom_file(const std::string &romPath) {
+    const MappedFile file(romPath);
+    return Bytestring(file.data(), file.data() + file.size());
+}
+
+bool print_cartridge_header(const Cartridge &cartridge, std::ostream &ostr) {
+    const CartridgeHeader &header = cartridge.get_header();
+    const bool isHeaderChecksumValid = cartridge.is_header_checksum_valid();
+    const bool isGlobalChecksumValid = cartridge.is_global_checksum_valid();
+
+    ostr << "Title: " << header.title << '\n';
+    ostr << "Cartridge type: " << to_string_hex_prefixed(header.cartridgeType) << ' ' << cartridge_type_name(header.cartridgeType) << '\n';
+    ostr << "ROM size: " << header.romBanks << " banks (" << header.romBanks * cartridge::BANK_SIZE / 1024 << " KiB)\n";
+    ostr << "RAM size: " << header.ramSize / 1024 << " KiB\n";
+    ostr << "Header checksum: " << to_string_hex_prefixed(header.headerChecksum) << (isHeaderChecksumValid ? " (valid)" : " (invalid)") << '\n';
+    ostr << "Global checksum: " << to_string_hex_prefixed(header.globalChecksum) << (isGlobalChecksumValid ? " (valid)" : " (invalid)") << '\n';
+    ostr << "Entry points:";
+    for (const word address : cartridge.entry_points()) {
+        ostr << ' ' << to_string_hex_prefixed(address);
+    }
+    ostr << '\n';
+    return isHeaderChecksumValid && isGlobalChecksumValid;
+}
+
+void disassemble_cartridge(const Cartridge &cartridge, std::ostream &ostr) {
+    const Bytestring firstBanks = cartridge.bank_memory(1);
+    const CallGraph callGraph(firstBanks, cartridge.entry_points());
+    std::unordered_set<word> routines{};
+    for (const CallGraphRoutine &routine : callGraph.get_routines()) {
+        routines.insert(routine.address);
+    }
+
+    ostr << "; bank 0\n";
+    disassemble_range(firstBanks, 0x0000, cartridge::ENTRY_POINT, routines, ostr);
+    disassemble_range(firstBanks, cartridge::ENTRY_POINT, cartridge::LOGO_BEGIN, routines, ostr);
+    ostr << "; " << to_string_hex_prefixed(cartridge::LOGO_BEGIN) << " - " << to_string_hex_prefixed(static_cast<word>(cartridge::HEADER_END - 1))
+         << " : cartridge header\n";
+    disassemble_range(firstBanks, cartridge::HEADER_END, cartridge::SWITCHABLE_BANK_BEGIN, routines, ostr);
+
+    for (size_t bank = 1; bank < cartridge.number_of_banks(); ++bank) {
+        ostr << "; bank " << bank << '\n';
+        const Bytestring memory = (bank == 1) ? firstBanks : cartridge.bank_memory(bank);
+        disassemble_range(memory, cartridge::SWITCHABLE_BANK_BEGIN, memory.size(), (bank == 1) ? routines : std::unordered_set<word>{}, ostr);
+    }
+}
@@ -2,8 +2,11 @@
 #define GAMEBOY_DISASSEMBLE_DISASSEMBLE_H
 
 #include "../instructions/instructions.h"
+#include "cartridge.h"
 #include "decoder.h"
 
+#include <string>
+#include <vector>
 
 /**
  * Given an opcode @p opcode, decode the number of bytes (including the opcode) the whole instruction has.
@@ -16,16 +19,57 @@ unsigned decode_length(const Opcode opcode);
  * Disassembles bytecode and prints it to @p ostr
  * @param bytecode bytecode
  * @param ostr output stream
+ * @param showCycles if true, the clock cycles of each instruction and their running total are appended to its line
  */
-void disassemble(const Bytestring& bytecode, std::ostream &ostr = std::cout);
+void disassemble(const Bytestring& bytecode, std::ostream &ostr = std::cout, const bool showCycles = false);
 
 /**
  * Disassembles single instruction and returns it as string
- * @param decoderOutput output of decoder, consisting of a word containing the address and the pointer to the
- *        disassembled instruction.
+ * @param decoderOutput output of decoder, consisting of the address and the pointer to the disassembled instruction
  * @return disassembled instruction
  */
-std::string disassemble_instruction(const std::pair<word, InstructionPtr> &decoderOutput);
+std::string disassemble_instruction(const DecodedInstruction &decoderOutput);
 
+/**
+ * Appends the clock cycles of an instruction and the running total to its disassembled @p line,
+ * e.g. "0x0003 : [0x20] JR NZ, 0xFD    ; 12/8 cycles, total 20/16".
+ * @param line disassembled instruction
+ * @param cycles clock cycles of the instruction
+ * @param total running total including the instruction
+ * @return the annotated line
+ */
+std::string annotate_cycles(const std::string &line, const InstructionCycles &cycles, const InstructionCycles &total);
+
+/**
+ * Prints a listing of assembled instructions, one line per instruction with its address, opcode and mnemonic,
+ * followed by its clock cycles and the running total.
+ * @param instructions the instructions, e.g. returned by Parser::parse_decoded()
+ * @param ostr output stream
+ */
+void print_listing(const std::vector<DecodedInstruction> &instructions, std::ostream &ostr = std::cout);
+/**
+ * Reads the ROM file at @p romPath.
+ * @throws std::runtime_error if the file cannot be read
+ * @param romPath path of the ROM file
+ * @return the ROM image
+ */
+Bytestring read_rom_file(const std::string &romPath);
+
+/**
+ * Prints the cartridge header of @p cartridge, whether its checksums are valid and the entry points of its code.
+ * @param cartridge the cartridge
+ * @param ostr output stream
+ * @return true if both checksums are valid
+ */
+bool print_cartridge_header(const Cartridge &cartridge, std::ostream &ostr = std::cout);
+
+/**
+ * Disassembles every ROM bank declared by the header of @p cartridge, bank 0 as mapped at 0x0000 and the others at 0x4000.
+ * The logo and header data at 0x0104-0x014F are skipped. The routines reached from the entry points,
+ * with bank 1 mapped, are marked in banks 0 and 1, since the bank mapped by the other banks' callers is unknown.
+ * @param cartridge the cartridge
+ * @param ostr output stream
+ */
+void disassemble_cartridge(const Cartridge &cartridge, std::ostream &ostr = std::cout);
 
 #endif //GAMEBOY_DISASSEMBLE_DISASSEMBLE_H
@@ -22,6 +22,10 @@ int16_t extend_sign(const int8_t number) {
     return is_negative(number) ? (0xFF00 | number) : (0x0000 | number);
 }
 
+long relative_jump_offset(const long target, const long jumpAddress) {
+    return target - (jumpAddress + 2);
+}
+
 Bytestring to_bytestring_little_endian(const word wrd) {
     return Bytestring{get_least_significant_byte(wrd), get_most_significant_byte(wrd)};
 }
@@ -183,6 +183,18 @@ word big_endian_to_number(const byte msb, const byte lsb);
  */
 int16_t extend_sign(const int8_t number);
 
+/**
+ * Calculates the offset of a relative jump (JR) at @p jumpAddress to @p target.
+ *
+ * Like the CPU, which has already advanced the program counter past the two-byte instruction,
+ * the offset counts from the address of the instruction following the jump.
+ *
+ * @param target address of the jump's goal
+ * @param jumpAddress address of the jump
+ * @return the offset, which is only encodable if it is a signed 8-bit number
+ */
+long relative_jump_offset(const long target, const long jumpAddress);
+
 /**
  * Converts a 16-bit word into a bytestring of little endian format,
  * i.e. [LSB, MSB]
@@ -30,8 +30,25 @@ Bytestring BaseInstruction::bytestr() const {
     return merge_to_bytestring(opcode(), _arguments);
 }
 
+void BaseInstruction::append_bytestr_to(Bytestring &bytestring) const {
+    if (opcode() > 0x00FF) { // prefixed opcode
+        bytestring.push_back(get_most_significant_byte(opcode()));
+    }
+    bytestring.push_back(get_least_significant_byte(opcode()));
+    append_to_bytestring(bytestring, _arguments);
+}
+
 size_t BaseInstruction::length() const {
-    return bytestr().size();
+    const size_t opcodeLength = (opcode() > 0x00FF) ? 2 : 1; // prefixed opcodes take two bytes
+    return opcodeLength + _arguments.size();
+}
+
+InstructionCycles BaseInstruction::cycles() const {
+    return instruction_cycles(opcode());
+}
+
+InstructionEffects BaseInstruction::effects() const {
+    return instruction_effects(opcode());
 }
 
 bool BaseInstruction::is_valid() const {
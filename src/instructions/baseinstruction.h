@@ -3,6 +3,8 @@
 
 #include "constants.h"
 #include "auxiliary_and_conversions.h"
+#include "cycles.h"
+#include "effects.h"
 
 #include <functional>
 #include <ostream>
@@ -36,9 +38,11 @@ std::ostream& operator<<(std::ostream& os, const InstructionPtr& instructionPtr)
 
 /**
  * Class BaseInstruction. All GameBoy instructions are supposed to be derived from this class.
- * Note that all possible realizations of the same child class must have the same bytecode length each,
- * and they must be default constructible.
- * Otherwise, when assembling, label resolution cannot work properly.
+ * Note that all possible realizations of the same child class must have the same bytecode length each.
+ * This length is exposed as the compile-time constant LENGTH of every child class,
+ * so that the assembler can advance its address without encoding anything.
+ * The execution time of every instruction is given by the cycle table of its opcode, and the registers
+ * and flags it reads and writes by the effects table.
  */
 class BaseInstruction {
 public:
@@ -53,8 +57,26 @@ public:
 
     Bytestring bytestr() const;
 
+    /**
+     * Appends the instruction's bytecode to @p bytestring without creating an intermediate bytestring.
+     * @param bytestring bytestring to which is appended
+     */
+    void append_bytestr_to(Bytestring &bytestring) const;
+
     size_t length() const;
 
+    /**
+     * Returns the execution time of the instruction, which for conditional branches depends on whether the branch is taken.
+     * @return clock cycles
+     */
+    InstructionCycles cycles() const;
+
+    /**
+     * Returns the registers, flags and memory which the instruction reads and writes.
+     * @return the instruction's effects
+     */
+    InstructionEffects effects() const;
+
     bool is_valid() const;
 
     //virtual void emulate(VirtualGameboy& gameboy) = 0;
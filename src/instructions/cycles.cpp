@@ -0,0 +1,75 @@
+#include "cycles.h"
+
+#include <array>
+
+namespace {
+    // clock cycles of the unprefixed opcodes, for conditional branches if taken
+    constexpr std::array<uint8_t, 256> UNPREFIXED_CYCLES {
+    //   x0  x1  x2  x3  x4  x5  x6  x7  x8  x9  xA  xB  xC  xD  xE  xF
+         4, 12,  8,  8,  4,  4,  8,  4, 20,  8,  8,  8,  4,  4,  8,  4, // 0x
+         4, 12,  8,  8,  4,  4,  8,  4, 12,  8,  8,  8,  4,  4,  8,  4, // 1x
+        12, 12,  8,  8,  4,  4,  8,  4, 12,  8,  8,  8,  4,  4,  8,  4, // 2x
+        12, 12,  8,  8, 12, 12, 12,  4, 12,  8,  8,  8,  4,  4,  8,  4, // 3x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 4x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 5x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 6x
+         8,  8,  8,  8,  8,  8,  4,  8,  4,  4,  4,  4,  4,  4,  8,  4, // 7x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 8x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // 9x
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // Ax
+         4,  4,  4,  4,  4,  4,  8,  4,  4,  4,  4,  4,  4,  4,  8,  4, // Bx
+        20, 12, 16, 16, 24, 16,  8, 16, 20, 16, 16,  4, 24, 24,  8, 16, // Cx
+        20, 12, 16,  0, 24, 16,  8, 16, 20, 16, 16,  0, 24,  0,  8, 16, // Dx
+        12, 12,  8,  0,  0, 16,  8, 16, 16,  4, 16,  0,  0,  0,  8, 16, // Ex
+        12, 12,  8,  4,  0, 16,  8, 16, 12,  8, 16,  4,  0,  0,  8, 16  // Fx
+    };
+
+    /**
+     * Returns the clock cycles of the unprefixed conditional branch @p opcode if the branch is not taken.
+     * @param opcode unprefixed opcode
+     * @return clock cycles, or 0 if @p opcode is no conditional branch
+     */
+    constexpr uint8_t not_taken_cycles(const byte opcode) noexcept {
+        switch (opcode) {
+            case 0x20: case 0x28: case 0x30: case 0x38: return 8;  // JR cc
+            case 0xC2: case 0xCA: case 0xD2: case 0xDA: return 12; // JP cc
+            case 0xC4: case 0xCC: case 0xD4: case 0xDC: return 12; // CALL cc
+            case 0xC0: case 0xC8: case 0xD0: case 0xD8: return 8;  // RET cc
+            default:                                    return 0;
+        }
+    }
+}
+
+InstructionCycles instruction_cycles(const Opcode opcode) noexcept {
+    if (opcode > 0x00FF) { // prefixed opcode, whose operand is (HL) if the lowest three bits are 6
+        const byte operation = static_cast<byte>(opcode);
+        const bool isBitTest = (operation >= 0x40 && operation < 0x80);
+        const unsigned cycles = ((operation & 0x07) != 0x06) ? 8 : (isBitTest ? 12 : 16);
+        return InstructionCycles{cycles, cycles};
+    }
+
+    const unsigned taken = UNPREFIXED_CYCLES[opcode];
+    const unsigned notTaken = not_taken_cycles(static_cast<byte>(opcode));
+    return InstructionCycles{taken, (notTaken != 0) ? notTaken : taken};
+}
+
+size_t instruction_length(const byte firstByte) noexcept {
+    switch (firstByte) {
+        case 0x01: case 0x08: case 0x11: case 0x21: case 0x31:
+        case 0xC2: case 0xC3: case 0xC4: case 0xCA: case 0xCC: case 0xCD:
+        case 0xD2: case 0xD4: case 0xDA: case 0xDC: case 0xEA: case 0xFA:
+            return 3;
+        case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x36: case 0x3E:
+        case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+        case 0xCB: case 0xE0: case 0xE8: case 0xF0: case 0xF8:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+std::string to_string_cycles(const InstructionCycles &cycles) {
+    return cycles.is_conditional() ? std::to_string(cycles.taken) + "/" + std::to_string(cycles.notTaken)
+                                   : std::to_string(cycles.taken);
+}
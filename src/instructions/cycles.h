@@ -0,0 +1,54 @@
+#ifndef GAMEBOY_DISASSEMBLE_CYCLES_H
+#define GAMEBOY_DISASSEMBLE_CYCLES_H
+
+#include "constants.h"
+
+#include <string>
+
+/**
+ * Execution time of an instruction in clock cycles of the 4.19 MHz clock, i.e. four times the number of machine cycles.
+ * Conditional branches take longer if the branch is taken, for all other instructions both numbers are equal.
+ * Sums of InstructionCycles are running totals, whose numbers are the times if all or none of the branches are taken.
+ */
+struct InstructionCycles {
+    unsigned taken{0};    ///< clock cycles if the branch is taken, i.e. the longest execution time
+    unsigned notTaken{0}; ///< clock cycles if the branch is not taken, i.e. the shortest execution time
+
+    bool is_conditional() const noexcept {
+        return taken != notTaken;
+    }
+
+    bool operator==(const InstructionCycles &other) const noexcept {
+        return taken == other.taken && notTaken == other.notTaken;
+    }
+
+    InstructionCycles& operator+=(const InstructionCycles &other) noexcept {
+        taken += other.taken;
+        notTaken += other.notTaken;
+        return *this;
+    }
+};
+
+/**
+ * Returns the execution time of the instruction with opcode @p opcode.
+ * Unused opcodes, which stop the CPU, take zero cycles.
+ * @param opcode opcode, where prefixed opcodes are 0xCB00 - 0xCBFF
+ * @return clock cycles
+ */
+InstructionCycles instruction_cycles(const Opcode opcode) noexcept;
+
+/**
+ * Returns the length of the instruction starting with @p firstByte without decoding it.
+ * @param firstByte the first byte of the instruction, i.e. its opcode or the prefix 0xCB
+ * @return length in bytes
+ */
+size_t instruction_length(const byte firstByte) noexcept;
+
+/**
+ * Converts @p cycles into a string, e.g. "12/8" for a conditional branch and "4" otherwise.
+ * @param cycles clock cycles
+ * @return the taken and not-taken cycles, separated by '/' if they differ
+ */
+std::string to_string_cycles(const InstructionCycles &cycles);
+
+#endif //GAMEBOY_DISASSEMBLE_CYCLES_H
@@ -0,0 +1,179 @@
+#include "effects.h"
+
+#include <array>
+
+namespace {
+    using namespace resources;
+
+    // the registers of the 3-bit operand fields B, C, D, E, H, L, (HL), A, and of the 2-bit fields BC, DE, HL, SP and BC, DE, HL, AF
+    constexpr std::array<ResourceSet, 8> REGISTERS_8_BIT{B, C, D, E, H, L, 0, A};
+    constexpr std::array<ResourceSet, 4> REGISTERS_16_BIT{B | C, D | E, H | L, SP};
+    constexpr std::array<ResourceSet, 4> REGISTERS_PUSH_POP{B | C, D | E, H | L, A | FLAGS};
+    constexpr size_t ADDRESS_HL = 6;
+
+    /**
+     * Returns the resources read by reading the 8-bit operand @p operand, which is the byte at HL for (HL).
+     * @param operand 3-bit operand field
+     * @return resources read
+     */
+    constexpr ResourceSet read_8_bit(const size_t operand) noexcept {
+        return (operand == ADDRESS_HL) ? (H | L | MEMORY) : REGISTERS_8_BIT[operand];
+    }
+
+    /**
+     * Returns the effects of writing the 8-bit operand @p operand, which for (HL) reads HL.
+     * @param operand 3-bit operand field
+     * @return resources read and written
+     */
+    constexpr InstructionEffects write_8_bit(const size_t operand) noexcept {
+        return (operand == ADDRESS_HL) ? InstructionEffects{H | L, MEMORY} : InstructionEffects{0, REGISTERS_8_BIT[operand]};
+    }
+
+    /**
+     * Returns the effects of the 8-bit arithmetic or logic operation @p operation with the operand read from @p operand.
+     * @param operation 3-bit field selecting ADD, ADC, SUB, SBC, AND, XOR, OR or CP
+     * @param operand resources read for the second operand
+     * @param isOperandA true if the second operand is A, so that SUB, XOR and CP do not depend on A's value
+     * @return the operation's effects
+     */
+    constexpr InstructionEffects arithmetic_effects(const size_t operation, const ResourceSet operand, const bool isOperandA) noexcept {
+        constexpr size_t ADC = 1, SUB = 2, SBC = 3, XOR = 5, CP = 7;
+        const bool isIndependent = isOperandA && (operation == SUB || operation == XOR || operation == CP);
+        ResourceSet reads = isIndependent ? 0 : static_cast<ResourceSet>(A | operand);
+        if (operation == ADC || operation == SBC) {
+            reads |= CARRY;
+        }
+        return {reads, static_cast<ResourceSet>((operation == CP) ? FLAGS : (A | FLAGS))};
+    }
+
+    /**
+     * Returns the flag read by the condition of the conditional branch @p opcode.
+     * @param opcode unprefixed opcode of a conditional branch, whose bits 3 and 4 select NZ, Z, NC or C
+     * @return ZERO or CARRY
+     */
+    constexpr ResourceSet condition_flag(const byte opcode) noexcept {
+        return (opcode & 0x10) ? CARRY : ZERO;
+    }
+
+    /**
+     * Returns the effects of the prefixed instruction 0xCB @p operation.
+     * @param operation the byte following the prefix
+     * @return the instruction's effects
+     */
+    constexpr InstructionEffects prefixed_effects(const byte operation) noexcept {
+        const size_t operand = operation & 0x07;
+        const InstructionEffects write = write_8_bit(operand);
+        if (operation < 0x40) { // rotations, shifts and SWAP, of which RL and RR shift the carry in
+            const bool readsCarry = (operation >= 0x10 && operation < 0x20);
+            return {static_cast<ResourceSet>(read_8_bit(operand) | write.reads | (readsCarry ? CARRY : 0)),
+                    static_cast<ResourceSet>(write.writes | FLAGS)};
+        }
+        if (operation < 0x80) { // BIT
+            return {read_8_bit(operand), ZERO | SUBTRACT | HALF_CARRY};
+        }
+        return {static_cast<ResourceSet>(read_8_bit(operand) | write.reads), write.writes}; // RES, SET
+    }
+
+    /**
+     * Returns the effects of the unprefixed instruction @p opcode.
+     * @param opcode unprefixed opcode
+     * @return the instruction's effects
+     */
+    constexpr InstructionEffects unprefixed_effects(const byte opcode) noexcept {
+        const size_t destination = (opcode >> 3) & 0x07;
+        const size_t source = opcode & 0x07;
+        const size_t pair = (opcode >> 4) & 0x03;
+
+        if (opcode >= 0x40 && opcode < 0x80) {
+            if (opcode == 0x76) { // HALT
+                return {};
+            }
+            const InstructionEffects write = write_8_bit(destination);
+            return {static_cast<ResourceSet>(read_8_bit(source) | write.reads), write.writes}; // LD r, r'
+        }
+        if (opcode >= 0x80 && opcode < 0xC0) {
+            return arithmetic_effects(destination, read_8_bit(source), source == 7);
+        }
+        if (opcode < 0x40) {
+            switch (opcode & 0x0F) {
+                case 0x01: return {0, REGISTERS_16_BIT[pair]};                         // LD rr, d16
+                case 0x03: case 0x0B:
+                           return {REGISTERS_16_BIT[pair], REGISTERS_16_BIT[pair]};    // INC rr, DEC rr
+                case 0x09: return {static_cast<ResourceSet>(H | L | REGISTERS_16_BIT[pair]),
+                                   H | L | SUBTRACT | HALF_CARRY | CARRY};             // ADD HL, rr
+                default:   break;
+            }
+            switch (source) {
+                case 0x04: case 0x05: { // INC r, DEC r
+                    const InstructionEffects write = write_8_bit(destination);
+                    return {static_cast<ResourceSet>(read_8_bit(destination) | write.reads),
+                            static_cast<ResourceSet>(write.writes | ZERO | SUBTRACT | HALF_CARRY)};
+                }
+                case 0x06:              // LD r, d8
+                    return write_8_bit(destination);
+                default:
+                    break;
+            }
+        }
+        if ((opcode & 0xC7) == 0xC7) { // RST
+            return {SP, SP | MEMORY};
+        }
+        if ((opcode & 0xCF) == 0xC1) { // POP
+            return {SP | MEMORY, static_cast<ResourceSet>(SP | REGISTERS_PUSH_POP[(opcode >> 4) & 0x03])};
+        }
+        if ((opcode & 0xCF) == 0xC5) { // PUSH
+            return {static_cast<ResourceSet>(SP | REGISTERS_PUSH_POP[(opcode >> 4) & 0x03]), SP | MEMORY};
+        }
+        if ((opcode & 0xC7) == 0xC6) { // arithmetic and logic with an immediate
+            return arithmetic_effects(destination, 0, false);
+        }
+
+        switch (opcode) {
+            case 0x02: return {A | B | C, MEMORY};                        // LD (BC), A
+            case 0x12: return {A | D | E, MEMORY};                        // LD (DE), A
+            case 0x22: case 0x32: return {A | H | L, H | L | MEMORY};     // LD (HL+), A, LD (HL-), A
+            case 0x0A: return {B | C | MEMORY, A};                        // LD A, (BC)
+            case 0x1A: return {D | E | MEMORY, A};                        // LD A, (DE)
+            case 0x2A: case 0x3A: return {H | L | MEMORY, A | H | L};     // LD A, (HL+), LD A, (HL-)
+            case 0x07: case 0x0F: return {A, A | FLAGS};                  // RLCA, RRCA
+            case 0x17: case 0x1F: return {A | CARRY, A | FLAGS};          // RLA, RRA
+            case 0x08: return {SP, MEMORY};                               // LD (a16), SP
+            case 0x20: case 0x28: case 0x30: case 0x38:                   // JR cc
+            case 0xC2: case 0xCA: case 0xD2: case 0xDA:                   // JP cc
+                return {condition_flag(opcode), 0};
+            case 0x27: return {A | SUBTRACT | HALF_CARRY | CARRY, A | ZERO | HALF_CARRY | CARRY}; // DAA
+            case 0x2F: return {A, A | SUBTRACT | HALF_CARRY};             // CPL
+            case 0x37: return {0, SUBTRACT | HALF_CARRY | CARRY};         // SCF
+            case 0x3F: return {CARRY, SUBTRACT | HALF_CARRY | CARRY};     // CCF
+            case 0xC0: case 0xC8: case 0xD0: case 0xD8:                   // RET cc
+                return {static_cast<ResourceSet>(condition_flag(opcode) | SP | MEMORY), SP};
+            case 0xC4: case 0xCC: case 0xD4: case 0xDC:                   // CALL cc
+                return {static_cast<ResourceSet>(condition_flag(opcode) | SP), SP | MEMORY};
+            case 0xC9: case 0xD9: return {SP | MEMORY, SP};               // RET, RETI
+            case 0xCD: return {SP, SP | MEMORY};                          // CALL
+            case 0xE0: case 0xEA: return {A, MEMORY};                     // LDH (a8), A, LD (a16), A
+            case 0xF0: case 0xFA: return {MEMORY, A};                     // LDH A, (a8), LD A, (a16)
+            case 0xE2: return {A | C, MEMORY};                            // LD (C), A
+            case 0xF2: return {C | MEMORY, A};                            // LD A, (C)
+            case 0xE8: return {SP, SP | FLAGS};                           // ADD SP, e8
+            case 0xF8: return {SP, H | L | FLAGS};                        // LD HL, SP + e8
+            case 0xF9: return {H | L, SP};                                // LD SP, HL
+            case 0xE9: return {H | L, 0};                                 // JP HL
+            default:   return {};                                         // NOP, STOP, JR, JP, DI, EI and unused opcodes
+        }
+    }
+
+    // the effects of all unprefixed opcodes, followed by those of all prefixed ones
+    const std::array<InstructionEffects, 512> EFFECTS = []() {
+        std::array<InstructionEffects, 512> table{};
+        for (size_t index = 0; index < 256; ++index) {
+            table[index] = unprefixed_effects(static_cast<byte>(index));
+            table[256 + index] = prefixed_effects(static_cast<byte>(index));
+        }
+        return table;
+    }();
+}
+
+InstructionEffects instruction_effects(const Opcode opcode) noexcept {
+    return (opcode > 0x00FF) ? EFFECTS[256 + (opcode & 0x00FF)] : EFFECTS[opcode];
+}
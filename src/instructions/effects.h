@@ -0,0 +1,66 @@
+#ifndef GAMEBOY_DISASSEMBLE_EFFECTS_H
+#define GAMEBOY_DISASSEMBLE_EFFECTS_H
+
+#include "constants.h"
+
+#include <cstdint>
+
+/**
+ * Set of registers, flags and memory, represented by one bit each, so that sets are combined by bitwise operations.
+ */
+using ResourceSet = uint16_t;
+
+/**
+ * The bits of the resources. The flags are ordered like the upper nibble of F, so that (set >> 4) & 0xF0 are F's bits.
+ */
+namespace resources {
+    constexpr ResourceSet A          = 1u << 0;
+    constexpr ResourceSet B          = 1u << 1;
+    constexpr ResourceSet C          = 1u << 2;
+    constexpr ResourceSet D          = 1u << 3;
+    constexpr ResourceSet E          = 1u << 4;
+    constexpr ResourceSet H          = 1u << 5;
+    constexpr ResourceSet L          = 1u << 6;
+    constexpr ResourceSet SP         = 1u << 7;
+    constexpr ResourceSet CARRY      = 1u << 8;
+    constexpr ResourceSet HALF_CARRY = 1u << 9;
+    constexpr ResourceSet SUBTRACT   = 1u << 10;
+    constexpr ResourceSet ZERO       = 1u << 11;
+    constexpr ResourceSet MEMORY     = 1u << 12; ///< any memory or I/O register
+
+    constexpr ResourceSet FLAGS      = ZERO | SUBTRACT | HALF_CARRY | CARRY;
+    constexpr ResourceSet REGISTERS  = A | B | C | D | E | H | L | SP | FLAGS;
+    constexpr ResourceSet ALL        = REGISTERS | MEMORY;
+}
+
+/**
+ * The resources an instruction reads and writes.
+ * Results which do not depend on an operand, e.g. of XOR A, do not read it.
+ */
+struct InstructionEffects {
+    ResourceSet reads{0};
+    ResourceSet writes{0};
+
+    bool operator==(const InstructionEffects &other) const noexcept {
+        return reads == other.reads && writes == other.writes;
+    }
+};
+
+/**
+ * Returns the resources read and written by the instruction with opcode @p opcode, without those of a called routine.
+ * Unused opcodes have no effects.
+ * @param opcode opcode, where prefixed opcodes are 0xCB00 - 0xCBFF
+ * @return the instruction's effects
+ */
+InstructionEffects instruction_effects(const Opcode opcode) noexcept;
+
+/**
+ * Converts the flags of @p resourceSet into a mask of the flags register F.
+ * @param resourceSet set of resources
+ * @return the bits of F of the flags in @p resourceSet
+ */
+constexpr byte to_flags_register(const ResourceSet resourceSet) noexcept {
+    return static_cast<byte>((resourceSet >> 4) & 0xF0);
+}
+
+#endif //GAMEBOY_DISASSEMBLE_EFFECTS_H
@@ -5,6 +5,8 @@
 
 class AddAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     AddAAndImmediate(const byte immediate = {})
             : BaseInstruction("ADD A, " + to_string_hex_prefixed(immediate),
                               opcodes::ADD_A_AND_IMMEDIATE,
@@ -17,6 +19,8 @@ private:
 
 class AddWithCarryAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     AddWithCarryAAndImmediate(const byte immediate = {})
             : BaseInstruction("ADC A, " + to_string_hex_prefixed(immediate),
                               opcodes::ADD_WITH_CARRY_A_AND_IMMEDIATE,
@@ -29,6 +33,8 @@ private:
 
 class AddAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     AddAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("ADD A, " + to_string(source),
                               determine_opcode(source)),
@@ -54,6 +60,8 @@ private:
 
 class AddWithCarryAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     AddWithCarryAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("ADC A, " + to_string(source),
                               determine_opcode(source)),
@@ -79,6 +87,8 @@ private:
 
 class AddHLAnd16BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     AddHLAnd16BitRegister(const Register16Bit source = {})
             : BaseInstruction("ADD HL, " + to_string(source),
                               determine_opcode(source)),
@@ -99,6 +109,8 @@ private:
 
 class AddSPAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     AddSPAndImmediate(const byte immediate = {})
             : BaseInstruction("ADD SP, " + to_string_hex_signed_prefixed(immediate, 2),
                               opcodes::ADD_SP_AND_IMMEDIATE,
@@ -5,6 +5,8 @@
 
 class BitOf8BitRegisterComplementIntoZero : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     BitOf8BitRegisterComplementIntoZero(const uint8_t bitIndex = {}, const Register8Bit reg = {})
             : BaseInstruction("BIT " + to_string_dec(bitIndex) + ", " + to_string(reg), determine_opcode(bitIndex, reg)),
               _bitIndex(bitIndex),
@@ -5,6 +5,8 @@
 
 class IncrementRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     IncrementRegister(const Register &reg = {})
             : BaseInstruction("INC " + to_string(reg),
                               determine_opcode(reg)),
@@ -42,6 +44,8 @@ private:
 
 class DecrementRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     DecrementRegister(const Register &reg = {})
             : BaseInstruction("DEC " + to_string(reg),
                               determine_opcode(reg)),
@@ -5,6 +5,8 @@
 
 class Jump : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     Jump(const word address = {})
             : BaseInstruction(
             "JP " + to_string_hex_prefixed(address), opcodes::JUMP,
@@ -17,6 +19,8 @@ private:
 
 class JumpConditional : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     JumpConditional(const FlagCondition flagCondition = {}, const word address = {})
             : BaseInstruction("JP " + to_string(flagCondition) + ", " + to_string_hex_prefixed(address),
                               determine_opcode(flagCondition),
@@ -40,12 +44,16 @@ private:
 
 class JumpToHL : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     JumpToHL()
             : BaseInstruction("JP HL", opcodes::JUMP_TO_HL) {}
 };
 
 class JumpRelative : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     JumpRelative(const byte relativePosition = {})
             : BaseInstruction(
             "JR " + to_string_hex_signed_prefixed(relativePosition), opcodes::JUMP_RELATIVE,
@@ -58,6 +66,8 @@ private:
 
 class JumpRelativeConditional : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     JumpRelativeConditional(const FlagCondition flagCondition = {}, const byte relativePosition = {})
             : BaseInstruction("JR " + to_string(flagCondition) + ", " + to_string_hex_signed_prefixed(relativePosition),
                               determine_opcode(flagCondition),
@@ -82,6 +92,8 @@ private:
 
 class Call : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     Call(const word address = {})
             : BaseInstruction(
             "CALL " + to_string_hex_prefixed(address), opcodes::CALL,
@@ -95,6 +107,8 @@ private:
 
 class CallConditional : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     CallConditional(const FlagCondition flagCondition = {}, const word address = {})
             : BaseInstruction("CALL " + to_string(flagCondition) + ", " + to_string_hex_prefixed(address),
                               determine_opcode(flagCondition),
@@ -119,12 +133,16 @@ private:
 
 class Return : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Return()
             : BaseInstruction("RET", opcodes::RETURN) {}
 };
 
 class ReturnConditional : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     ReturnConditional(const FlagCondition flagCondition = {})
             : BaseInstruction("RET " + to_string(flagCondition), determine_opcode(flagCondition)),
               _flagCondition(flagCondition) {}
@@ -145,12 +163,16 @@ private:
 
 class ReturnFromInterrupt : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     ReturnFromInterrupt()
             : BaseInstruction("RETI", opcodes::RETURN_FROM_INTERRUPT) {}
 };
 
 class Restart : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Restart(const uint8_t jumpIndex = {})
             : BaseInstruction("RST " + to_string_dec(jumpIndex),
                               determine_opcode(jumpIndex)),
@@ -5,6 +5,8 @@
 
 class LoadImmediateInto16BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     LoadImmediateInto16BitRegister(const Register16Bit destination = {},
                                    const word immediate = {})
             : BaseInstruction("LD " + to_string(destination) + ", " + to_string_hex_prefixed(immediate),
@@ -38,6 +40,8 @@ private:
 
 class LoadSPIntoAddressImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     LoadSPIntoAddressImmediate(const word immediate = {})
             : BaseInstruction("LD (" + to_string_hex_prefixed(immediate) + "), SP",
                               opcodes::LOAD_SP_INTO_ADDRESS_IMMEDIATE,
@@ -57,6 +61,8 @@ private:
 
 class LoadHLIntoSP : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadHLIntoSP()
             : BaseInstruction("LD SP, HL",
                               opcodes::LOAD_HL_INTO_SP) {}
@@ -71,6 +77,8 @@ public:
 
 class LoadSPShiftedByImmediateIntoHL : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     LoadSPShiftedByImmediateIntoHL(const byte immediate = {})
             : BaseInstruction("LDHL SP," + to_string_hex_signed_prefixed(immediate),
                               opcodes::LOAD_SP_SHIFTED_BY_IMMEDIATE_INTO_HL,
@@ -5,6 +5,8 @@
 
 class LoadImmediateInto8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     LoadImmediateInto8BitRegister(const Register8Bit destination = {},
                                   const byte immediate = {})
             : BaseInstruction("LD " + to_string(destination) + ", " + to_string_hex_prefixed(immediate),
@@ -46,6 +48,8 @@ private:
 
 class Load8BitRegisterInto8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Load8BitRegisterInto8BitRegister(const Register8Bit source = {},
                                      const Register8Bit destination = {})
             : BaseInstruction("LD " + to_string(destination) + ", " + to_string(source),
@@ -67,8 +71,8 @@ public:
 
 private:
     Opcode determine_opcode(const Register8Bit source, const Register8Bit destination) const {
-        switch (source) {
-            case Register8Bit::B: switch (destination) {
+        switch (destination) {
+            case Register8Bit::B: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_B;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_B;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_B;
@@ -79,7 +83,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_B;
                     default:                       break;
                 }
-            case Register8Bit::C: switch (destination) {
+            case Register8Bit::C: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_C;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_C;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_C;
@@ -90,7 +94,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_C;
                     default:                       break;
                 }
-            case Register8Bit::D: switch (destination) {
+            case Register8Bit::D: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_D;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_D;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_D;
@@ -101,7 +105,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_D;
                     default:                       break;
                 }
-            case Register8Bit::E: switch (destination) {
+            case Register8Bit::E: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_E;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_E;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_E;
@@ -112,7 +116,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_E;
                     default:                       break;
                 }
-            case Register8Bit::H: switch (destination) {
+            case Register8Bit::H: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_H;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_H;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_H;
@@ -123,7 +127,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_H;
                     default:                       break;
                 }
-            case Register8Bit::L: switch (destination) {
+            case Register8Bit::L: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_L;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_L;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_L;
@@ -134,7 +138,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_L;
                     default:                       break;
                 }
-            case Register8Bit::ADDRESS_HL: switch (destination) {
+            case Register8Bit::ADDRESS_HL: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_ADDRESS_HL;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_ADDRESS_HL;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_ADDRESS_HL;
@@ -145,7 +149,7 @@ private:
                     case Register8Bit::A:          return opcodes::LOAD_A_INTO_ADDRESS_HL;
                     default:                       break;
                 }
-            case Register8Bit::A: switch (destination) {
+            case Register8Bit::A: switch (source) {
                     case Register8Bit::B:          return opcodes::LOAD_B_INTO_A;
                     case Register8Bit::C:          return opcodes::LOAD_C_INTO_A;
                     case Register8Bit::D:          return opcodes::LOAD_D_INTO_A;
@@ -167,6 +171,8 @@ private:
 
 class LoadAIntoAddressImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     LoadAIntoAddressImmediate(const word immediate = {})
             : BaseInstruction("LD (" + to_string_hex_prefixed(immediate) + "), A",
                               opcodes::LOAD_A_INTO_ADDRESS_IMMEDIATE,
@@ -187,9 +193,12 @@ private:
 
 class LoadAddressImmediateIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 3;
+
     LoadAddressImmediateIntoA(const word immediate = {})
             : BaseInstruction("LD A, (" + to_string_hex_prefixed(immediate) + ")",
-                              opcodes::LOAD_ADDRESS_IMMEDIATE_INTO_A),
+                              opcodes::LOAD_ADDRESS_IMMEDIATE_INTO_A,
+                              to_bytestring_little_endian(immediate)),
               _immediate(immediate) {}
 
 //    void emulate(const VirtualGameboy& gb)
@@ -208,6 +217,8 @@ private:
 
 class LoadAIntoAddress16BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAIntoAddress16BitRegister(const Register16Bit destination = {})
             : BaseInstruction("LD (" + to_string(destination) + "), A", determine_opcode(destination)),
               _destination(destination) {}
@@ -226,6 +237,8 @@ private:
 
 class LoadAddress16BitRegisterIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAddress16BitRegisterIntoA(const Register16Bit source = {})
             : BaseInstruction("LD A, (" + to_string(source) + ")", determine_opcode(source)),
               _source(source) {}
@@ -245,6 +258,8 @@ private:
 
 class LoadAIntoAddressHLIncrement : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAIntoAddressHLIncrement()
             : BaseInstruction(
             "LD (HL+), A", opcodes::LOAD_A_INTO_ADDRESS_HL_INCREMENT) {}
@@ -252,6 +267,8 @@ public:
 
 class LoadAddressHLIncrementIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAddressHLIncrementIntoA()
             : BaseInstruction(
             "LD A, (HL+)", opcodes::LOAD_ADDRESS_HL_INCREMENT_INTO_A) {}
@@ -259,6 +276,8 @@ public:
 
 class LoadAIntoAddressHLDecrement : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAIntoAddressHLDecrement()
             : BaseInstruction(
             "LD (HL-), A", opcodes::LOAD_A_INTO_ADDRESS_HL_DECREMENT) {}
@@ -266,6 +285,8 @@ public:
 
 class LoadAddressHLDecrementIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAddressHLDecrementIntoA()
             : BaseInstruction(
             "LD A, (HL-)", opcodes::LOAD_ADDRESS_HL_DECREMENT_INTO_A) {}
@@ -275,9 +296,12 @@ public:
 
 class LoadAIntoPortAddressImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     LoadAIntoPortAddressImmediate(const byte portAddress = {})
             : BaseInstruction("LDH (" + to_string_hex_prefixed(portAddress) + "), A",
-                              opcodes::LOAD_A_INTO_PORT_ADDRESS_IMMEDIATE),
+                              opcodes::LOAD_A_INTO_PORT_ADDRESS_IMMEDIATE,
+                              Bytestring{portAddress}),
               _portAddress(portAddress) {}
 
 private:
@@ -286,6 +310,8 @@ private:
 
 class LoadAIntoPortAddressC : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadAIntoPortAddressC()
             : BaseInstruction("LD (C), A",
                               opcodes::LOAD_A_INTO_PORT_ADDRESS_C) {}
@@ -293,9 +319,12 @@ public:
 
 class LoadPortAddressImmediateIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     LoadPortAddressImmediateIntoA(const byte portAddress = {})
             : BaseInstruction("LDH A, (" + to_string_hex_prefixed(portAddress) + ")",
-                              opcodes::LOAD_PORT_ADDRESS_IMMEDIATE_INTO_A),
+                              opcodes::LOAD_PORT_ADDRESS_IMMEDIATE_INTO_A,
+                              Bytestring{portAddress}),
               _portAddress(portAddress) {}
 
 private:
@@ -304,6 +333,8 @@ private:
 
 class LoadPortAddressCIntoA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     LoadPortAddressCIntoA()
             : BaseInstruction("LD A, (C)",
                               opcodes::LOAD_PORT_ADDRESS_C_INTO_A) {}
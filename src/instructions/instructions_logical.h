@@ -5,6 +5,8 @@
 
 class AndAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     AndAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("AND A, " + to_string(source),
                               determine_opcode(source)),
@@ -30,6 +32,8 @@ private:
 
 class OrAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     OrAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("OR A, " + to_string(source), determine_opcode(source)),
               _source(source) {}
@@ -54,6 +58,8 @@ private:
 
 class XorAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     XorAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("XOR A, " + to_string(source),
                               determine_opcode(source)),
@@ -79,6 +85,8 @@ private:
 
 class CompareAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     CompareAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("CP A, " + to_string(source),
                               determine_opcode(source)),
@@ -104,6 +112,8 @@ private:
 
 class ComplementA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     ComplementA()
             : BaseInstruction("CPL",
                               opcodes::COMPLEMENT_A) {}
@@ -111,6 +121,8 @@ public:
 
 class DecimalAdjustA : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     DecimalAdjustA()
             : BaseInstruction("DAA",
                               opcodes::DECIMAL_ADJUST_A) {}
@@ -118,9 +130,12 @@ public:
 
 class AndAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     AndAAndImmediate(const byte immediate = {})
             : BaseInstruction("AND A, " + to_string_hex(immediate),
-                              opcodes::AND_A_AND_IMMEDIATE),
+                              opcodes::AND_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
@@ -129,9 +144,12 @@ private:
 
 class OrAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     OrAAndImmediate(const byte immediate = {})
             : BaseInstruction("OR A, " + to_string_hex(immediate),
-                              opcodes::OR_A_AND_IMMEDIATE),
+                              opcodes::OR_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
@@ -140,9 +158,12 @@ private:
 
 class XorAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     XorAAndImmediate(const byte immediate = {})
             : BaseInstruction("XOR A, " + to_string_hex(immediate),
-                              opcodes::XOR_A_AND_IMMEDIATE),
+                              opcodes::XOR_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
@@ -151,9 +172,12 @@ private:
 
 class CompareAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     CompareAAndImmediate(const byte immediate = {})
             : BaseInstruction("CP A, " + to_string_hex(immediate),
-                              opcodes::COMPARE_A_AND_IMMEDIATE),
+                              opcodes::COMPARE_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
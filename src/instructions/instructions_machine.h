@@ -5,42 +5,56 @@
 
 class Nop : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Nop()
             : BaseInstruction("NOP", opcodes::NOP) {}
 };
 
 class Stop : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Stop()
             : BaseInstruction("STOP", opcodes::STOP) {}
 };
 
 class Halt : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Halt()
             : BaseInstruction("HALT", opcodes::HALT) {}
 };
 
 class SetCarry : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     SetCarry()
             : BaseInstruction("SCF", opcodes::SET_CARRY) {}
 };
 
 class FlipCarry : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     FlipCarry()
             : BaseInstruction("CCF", opcodes::FLIP_CARRY) {}
 };
 
 class EnableInterrupts : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     EnableInterrupts()
             : BaseInstruction("EI", opcodes::ENABLE_INTERRUPTS) {}
 };
 
 class DisableInterrupts : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     DisableInterrupts()
             : BaseInstruction("DI", opcodes::DISABLE_INTERRUPTS) {}
 };
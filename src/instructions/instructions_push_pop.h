@@ -5,6 +5,8 @@
 
 class Push16BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Push16BitRegister(const Register16Bit reg = {})
             : BaseInstruction("PUSH " + to_string(reg), determine_opcode(reg)),
               _register(reg) {}
@@ -25,6 +27,8 @@ private:
 
 class Pop16BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Pop16BitRegister(const Register16Bit reg = {})
             : BaseInstruction("POP " + to_string(reg), determine_opcode(reg)),
               _register(reg) {}
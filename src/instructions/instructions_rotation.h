@@ -5,6 +5,8 @@
 
 class RotateRight8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     RotateRight8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("RR " + to_string(reg),
                               determine_opcode(reg)),
@@ -30,6 +32,8 @@ private:
 
 class RotateLeft8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     RotateLeft8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("RL " + to_string(reg),
                               determine_opcode(reg)),
@@ -55,6 +59,8 @@ private:
 
 class RotateRightCircular8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     RotateRightCircular8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("RRC " + to_string(reg),
                               determine_opcode(reg)),
@@ -80,6 +86,8 @@ private:
 
 class RotateLeftCircular8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     RotateLeftCircular8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("RLC " + to_string(reg),
                               determine_opcode(reg)),
@@ -106,6 +114,8 @@ private:
 // Rotate A and clear Zero Flag
 class RotateLeftAAndClearZero : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     RotateLeftAAndClearZero()
             : BaseInstruction("RLA",
                               opcodes::ROTATE_LEFT_A_AND_CLEAR_ZERO) {}
@@ -113,6 +123,8 @@ public:
 
 class RotateRightAAndClearZero : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     RotateRightAAndClearZero()
             : BaseInstruction("RRA",
                               opcodes::ROTATE_RIGHT_A_AND_CLEAR_ZERO) {}
@@ -120,6 +132,8 @@ public:
 
 class RotateLeftCircularAAndClearZero : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     RotateLeftCircularAAndClearZero()
             : BaseInstruction("RLCA",
                               opcodes::ROTATE_LEFT_CIRCULAR_A_AND_CLEAR_ZERO) {}
@@ -127,6 +141,8 @@ public:
 
 class RotateRightCircularAAndClearZero : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     RotateRightCircularAAndClearZero()
             : BaseInstruction("RRCA",
                               opcodes::ROTATE_RIGHT_CIRCULAR_A_AND_CLEAR_ZERO) {}
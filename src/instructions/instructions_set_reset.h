@@ -5,6 +5,8 @@
 
 class SetBitOf8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     SetBitOf8BitRegister(const uint8_t bitIndex = {}, const Register8Bit reg = {})
             : BaseInstruction("SET " + to_string_dec(bitIndex) + ", " + to_string(reg),
                               determine_opcode(bitIndex, reg)),
@@ -114,6 +116,8 @@ private:
 
 class ResetBitOf8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     ResetBitOf8BitRegister(const uint8_t bitIndex = {}, const Register8Bit reg = {})
             : BaseInstruction("RES " + to_string_dec(bitIndex) + ", " + to_string(reg),
                               determine_opcode(bitIndex, reg)),
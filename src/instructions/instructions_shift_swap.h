@@ -5,6 +5,8 @@
 
 class ShiftLeftArithmetical8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     ShiftLeftArithmetical8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("SLA " + to_string(reg),
                               determine_opcode(reg)),
@@ -30,6 +32,8 @@ private:
 
 class ShiftRightArithmetical8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     ShiftRightArithmetical8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("SRA " + to_string(reg),
                               determine_opcode(reg)),
@@ -55,6 +59,8 @@ private:
 
 class ShiftRightLogical8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     ShiftRightLogical8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("SRL " + to_string(reg),
                               determine_opcode(reg)),
@@ -80,6 +86,8 @@ private:
 
 class Swap8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     Swap8BitRegister(const Register8Bit reg = {})
             : BaseInstruction("SWAP " + to_string(reg),
                               determine_opcode(reg)),
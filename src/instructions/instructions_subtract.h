@@ -5,6 +5,8 @@
 
 class SubtractAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     SubtractAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("SUB A, " + to_string(source),
                               determine_opcode(source)),
@@ -30,6 +32,8 @@ private:
 
 class SubtractWithCarryAAnd8BitRegister : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     SubtractWithCarryAAnd8BitRegister(const Register8Bit source = {})
             : BaseInstruction("SBC A, " + to_string(source),
                               determine_opcode(source)),
@@ -55,9 +59,12 @@ private:
 
 class SubtractAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     SubtractAAndImmediate(const byte immediate = {})
             : BaseInstruction("SUB A, " + to_string_hex(immediate),
-                              opcodes::SUBTRACT_A_AND_IMMEDIATE),
+                              opcodes::SUBTRACT_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
@@ -66,9 +73,12 @@ private:
 
 class SubtractWithCarryAAndImmediate : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 2;
+
     SubtractWithCarryAAndImmediate(const byte immediate = {})
             : BaseInstruction("SBC A, " + to_string_hex(immediate),
-                              opcodes::SUBTRACT_WITH_CARRY_A_AND_IMMEDIATE),
+                              opcodes::SUBTRACT_WITH_CARRY_A_AND_IMMEDIATE,
+                              Bytestring{immediate}),
               _immediate(immediate) {}
 
 private:
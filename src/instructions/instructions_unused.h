@@ -5,6 +5,8 @@
 
 class Unused : public BaseInstruction {
 public:
+    static constexpr size_t LENGTH = 1;
+
     Unused(const uint8_t index = {})
             : BaseInstruction("UNU " + to_string_dec(_index),
                               determine_opcode(index)) {}
@@ -0,0 +1,14 @@
+#ifndef GAMEBOY_DISASSEMBLE_LOOPBOUNDS_H
+#define GAMEBOY_DISASSEMBLE_LOOPBOUNDS_H
+
+#include "constants.h"
+
+#include <unordered_map>
+
+/**
+ * The maximum number of times the first instruction of a loop is executed each time the loop is entered, by its address.
+ * The assembler collects them from LOOPBOUND commands, the WcetAnalyzer applies them.
+ */
+using LoopBounds = std::unordered_map<word, size_t>;
+
+#endif //GAMEBOY_DISASSEMBLE_LOOPBOUNDS_H
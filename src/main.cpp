@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -9,8 +10,6 @@
 
 #include "assembler/pretty_format.h"
 
-#include "assembler/unresolvedinstruction.h"
-
 //void test_decoder()
 //{
 //    const Bytestring bytecode {0x00, 0x3E, 0xFF, 0x00, 0x00, 0x00};
@@ -82,8 +81,104 @@
 //}
 
 #include <string>
-int main()
+int main(int argc, char *argv[])
 {
+    // usage: gameboy_disassemble <source.asm>... <output.gb> [--optimize] [--cache <directory>] [--stats]
+    //        several source files are assembled separately and linked,
+    //        with --cache only the source files changed since the last build are assembled again,
+    //        with --optimize a single source file is assembled with the peephole optimization
+    //        gameboy_disassemble <source.asm> --listing
+    //        prints the instructions with their clock cycles and the running total
+    //        gameboy_disassemble <source.asm> --wcet <label> <budget>
+    //        prints the worst-case execution time of the routine at the label and fails if it exceeds the budget in cycles
+    //        gameboy_disassemble <source.asm> --stack <limit>
+    //        prints the worst-case stack depths of the entry point and interrupt handlers and fails if they exceed the limit in bytes
+    //        gameboy_disassemble <rom.gb> --header
+    //        prints the cartridge header and fails if one of its checksums is invalid
+    //        gameboy_disassemble <rom.gb> --disassemble
+    //        prints the cartridge header and disassembles every ROM bank it declares
+    if (argc == 3 && std::string(argv[2]) == "--listing") {
+        try {
+            print_file_listing(argv[1]);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 5 && std::string(argv[2]) == "--wcet") {
+        try {
+            if (!print_file_wcet(argv[1], argv[3], std::stoul(argv[4]))) {
+                std::cerr << "The worst-case execution time of " << argv[3] << " exceeds the budget.\n";
+                return 1;
+            }
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 4 && std::string(argv[2]) == "--stack") {
+        try {
+            if (!print_file_stack_depths(argv[1], std::stoul(argv[3]))) {
+                std::cerr << "The worst-case stack depth exceeds the limit.\n";
+                return 1;
+            }
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 3 && (std::string(argv[2]) == "--header" || std::string(argv[2]) == "--disassemble")) {
+        try {
+            const Bytestring rom = read_rom_file(argv[1]);
+            const Cartridge cartridge(rom);
+            const bool areChecksumsValid = print_cartridge_header(cartridge);
+            if (std::string(argv[2]) == "--disassemble") {
+                disassemble_cartridge(cartridge);
+            } else if (!areChecksumsValid) {
+                std::cerr << "The cartridge header has an invalid checksum.\n";
+                return 1;
+            }
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc >= 3) {
+        std::vector<std::string> arguments(argv + 1, argv + argc);
+        const auto optimizeOption = std::find(arguments.begin(), arguments.end(), "--optimize");
+        const bool optimize = (optimizeOption != arguments.end());
+        if (optimize) {
+            arguments.erase(optimizeOption);
+        }
+        const bool reportThroughput = (arguments.back() == "--stats");
+        if (reportThroughput) {
+            arguments.pop_back();
+        }
+        std::string cacheDirectory{};
+        if (arguments.size() >= 2 && arguments[arguments.size() - 2] == "--cache") {
+            cacheDirectory = arguments.back();
+            arguments.resize(arguments.size() - 2);
+        }
+        try {
+            if (arguments.size() == 2 && cacheDirectory.empty()) {
+                assemble_file(arguments[0], arguments[1], reportThroughput, optimize);
+            } else if (arguments.size() >= 2) {
+                const std::vector<std::string> sourcePaths(arguments.begin(), arguments.end() - 1);
+                assemble_and_link_files(sourcePaths, arguments.back(), reportThroughput, cacheDirectory);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
 //    const Bytestring bytecode{
 //                0x00,
 //    /*loop:*/   0x00,
@@ -0,0 +1,70 @@
+#include "../src/analysis/callgraph.h"
+#include "../src/assembler/assemble.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+TEST_CASE("The call graph bounds the stack depth and finds recursion", "[CallGraph]") {
+    const auto build = [](const std::string &code) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        return parser.assemble();
+    };
+
+    SECTION("The deepest path adds the pushed bytes and return addresses of the calls") {
+        const Bytestring memory = build("MAIN:\nPUSH BC\nCALL FIRST\nPOP BC\nCALL SECOND\nRET\n"
+                                        "FIRST:\nPUSH AF\nPUSH HL\nCALL SECOND\nPOP HL\nPOP AF\nRET\n"
+                                        "SECOND:\nPUSH DE\nPOP DE\nRET\n");
+        const CallGraph callGraph(memory, {0x0000});
+        const std::vector<CallGraphRoutine> &routines = callGraph.get_routines();
+        REQUIRE(routines.size() == 3);
+        REQUIRE(routines[0].callSites.size() == 2);
+        REQUIRE(routines[0].callSites[0].stackOffset == 2);
+        REQUIRE(routines[0].localStackDepth == 2);
+        REQUIRE(routines[1].stackDepth == std::optional<size_t>{4 + 2 + 2});
+        REQUIRE(routines[0].stackDepth == std::optional<size_t>{2 + 2 + 8});
+        REQUIRE(callGraph.deepest_call_path(0) == std::vector<word>{0x0000, 0x0009, 0x0011});
+        REQUIRE(callGraph.get_components().size() == 3);
+        REQUIRE(callGraph.get_components().back() == std::vector<size_t>{0}); // callers follow their callees
+    }
+
+    SECTION("Recursive routines form a strongly connected component and have no bound") {
+        const Bytestring memory = build("MAIN:\nCALL FIRST\nRST 0x08\nRET\nFIRST:\nCALL NZ, SECOND\nRET\nSECOND:\nCALL FIRST\nRET\n");
+        const CallGraph callGraph(memory, {0x0000});
+        const std::vector<CallGraphRoutine> &routines = callGraph.get_routines();
+        REQUIRE(routines.size() == 4);
+        REQUIRE(routines[1].isRecursive);
+        REQUIRE(routines[1].component == routines[3].component);
+        REQUIRE_FALSE(routines[0].isRecursive);
+        REQUIRE_FALSE(routines[0].stackDepth.has_value());
+        REQUIRE(routines[2].address == 0x0008); // the RST leads to the RET of FIRST
+        REQUIRE_FALSE(routines[2].isRecursive);
+        REQUIRE(routines[2].stackDepth == std::optional<size_t>{0});
+    }
+
+    SECTION("Stack usage which cannot be bounded is reported") {
+        const Bytestring memory = build("MAIN:\nCALL GROWING\nCALL SETTING\nRET\nGROWING:\nPUSH BC\nJR GROWING\nSETTING:\nLD SP, HL\nRET\n");
+        const CallGraph callGraph(memory, {0x0000});
+        const std::vector<CallGraphRoutine> &routines = callGraph.get_routines();
+        REQUIRE_THAT(routines[1].error, Catch::Contains("grows in the loop"));
+        REQUIRE_THAT(routines[2].error, Catch::Contains("loaded from HL"));
+        REQUIRE_FALSE(routines[0].stackDepth.has_value());
+    }
+
+    SECTION("The worst case adds the deepest interrupt handler to the entry point") {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gameboy_stack_test";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        const std::filesystem::path path = directory / "main.asm";
+        std::ofstream(path) << "ORG 0x0040\nPUSH AF\nPUSH BC\nPOP BC\nPOP AF\nRETI\n"
+                               "ORG 0x0100\nLD SP, 0xFFFE\nPUSH HL\nCALL SUB\nPOP HL\nHALT\nSUB:\nRET\n";
+        std::ostringstream report{};
+        REQUIRE(print_file_stack_depths(path.string(), 10, report));
+        REQUIRE_THAT(report.str(), Catch::Contains("Entry 0x0100: 4 bytes") && Catch::Contains("Interrupt 0x0040: 6 bytes")
+                                   && Catch::Contains("Worst-case stack depth: 10 bytes"));
+        std::ostringstream exceeded{};
+        REQUIRE_FALSE(print_file_stack_depths(path.string(), 9, exceeded));
+
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,54 @@
+#include "../src/analysis/controlflow.h"
+#include "../src/analysis/liveness.h"
+#include "../src/assembler/parser.h"
+
+#include <functional>
+
+TEST_CASE("Liveness of registers and flags follows their reads and writes", "[LivenessAnalysis]") {
+    SECTION("The effects table gives the registers, flags and memory read and written") {
+        REQUIRE(instruction_effects(0x78) == InstructionEffects{resources::B, resources::A}); // LD A, B
+        REQUIRE(instruction_effects(0xAF) == InstructionEffects{0, resources::A | resources::FLAGS}); // XOR A
+        REQUIRE(instruction_effects(0x8E) == InstructionEffects{resources::A | resources::H | resources::L | resources::MEMORY | resources::CARRY,
+                                                                resources::A | resources::FLAGS}); // ADC A, (HL)
+        REQUIRE(instruction_effects(0xC5) == InstructionEffects{resources::B | resources::C | resources::SP, resources::SP | resources::MEMORY}); // PUSH BC
+        REQUIRE(instruction_effects(0x38) == InstructionEffects{resources::CARRY, 0}); // JR C
+        REQUIRE(instruction_effects(0xCB7E) == InstructionEffects{resources::H | resources::L | resources::MEMORY,
+                                                                  resources::ZERO | resources::SUBTRACT | resources::HALF_CARRY}); // BIT 7, (HL)
+        REQUIRE(to_flags_register(resources::ZERO | resources::CARRY | resources::A) == 0x90);
+        REQUIRE(Call(0x1234).effects().writes == (resources::SP | resources::MEMORY));
+    }
+
+    const auto analyze = [](const std::string &code, const std::function<void(const ControlFlowGraph&, const LivenessAnalysis&)> &check) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring memory = parser.assemble();
+        const ControlFlowGraph graph(memory, 0);
+        check(graph, LivenessAnalysis(graph));
+    };
+
+    SECTION("Flags overwritten before being read are dead") {
+        analyze("XOR A\nCP 5\nJR Z, DONE\nINC B\nDONE:\nRET\n", [](const ControlFlowGraph&, const LivenessAnalysis &liveness) {
+            REQUIRE((liveness.live_after(0x0000) & resources::A) != 0);
+            REQUIRE((liveness.live_after(0x0000) & resources::FLAGS) == 0);
+            REQUIRE((liveness.live_after(0x0001) & resources::ZERO) != 0);
+            REQUIRE_THROWS(liveness.live_after(0x0002)); // the immediate of CP
+        });
+    }
+
+    SECTION("Values live around a loop") {
+        analyze("LD B, 3\nLOOP:\nDEC B\nJR NZ, LOOP\nLD B, 0\nRET\n", [](const ControlFlowGraph &graph, const LivenessAnalysis &liveness) {
+            REQUIRE(graph.get_blocks().size() == 3);
+            REQUIRE((liveness.get_live_in(1) & resources::B) != 0);
+            REQUIRE((liveness.get_live_out(1) & resources::B) != 0); // read again by the next iteration
+            REQUIRE(liveness.find_dead_stores().empty());
+        });
+    }
+
+    SECTION("Writes which are overwritten before being read are dead stores") {
+        analyze("LD B, 1\nLD C, B\nLD B, 2\nLD C, 3\nCP 4\nXOR A\nCALL SUB\nLD D, 1\nLD D, 2\nRET\nSUB:\nRET\n",
+                [](const ControlFlowGraph&, const LivenessAnalysis &liveness) {
+            // LD C, B is dead, thus LD B, 1 is dead too, and XOR A overwrites the flags of CP 4, while the call reads every register
+            const std::vector<word> deadStores = liveness.find_dead_stores();
+            REQUIRE(deadStores == std::vector<word>{0x0000, 0x0002, 0x0007, 0x000D});
+        });
+    }
+}
@@ -0,0 +1,70 @@
+#include "../src/analysis/controlflow.h"
+#include "../src/analysis/wcet.h"
+#include "../src/assembler/parser.h"
+
+TEST_CASE("The worst-case execution time of a routine is its longest path with bounded loops", "[WcetAnalyzer::analyze]") {
+    // without ORG, the offsets of the bytecode are the addresses
+    const auto analyze = [](const std::string &code, const word entryAddress = 0) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring memory = parser.assemble();
+        WcetAnalyzer analyzer(memory, parser.get_loop_bounds());
+        return analyzer.analyze(entryAddress);
+    };
+
+    SECTION("Relative jumps are taken from the address following them") {
+        REQUIRE(relative_jump_target(0x0153, 0xFE) == 0x0153); // a spin loop
+        REQUIRE(relative_jump_target(0x0100, 0x7F) == 0x0181);
+        REQUIRE(relative_jump_target(0x0100, 0x80) == 0x0082);
+    }
+
+    SECTION("The slower side of a branch is taken") {
+        const WcetResult wcet = analyze("LD A, 1\nCP B\nJR Z, SKIP\nNOP\nNOP\nNOP\nSKIP:\nRET\n");
+        REQUIRE(wcet.cycles == 8 + 4 + 8 + 12 + 16);
+        REQUIRE(wcet.criticalPath.size() == 3);
+        REQUIRE(wcet.criticalPath[1].address == 0x0005);
+    }
+
+    SECTION("Loops are executed as often as their bounds permit") {
+        const WcetResult wcet = analyze("LD B, 10\nLOOPBOUND 10\nLOOP:\nDEC B\nJR NZ, LOOP\nRET\n");
+        REQUIRE(wcet.cycles == 8 + 9 * (4 + 12) + (4 + 8) + 16);
+        REQUIRE(wcet.criticalPath.size() == 4);
+        REQUIRE(wcet.criticalPath[1].address == 0x0002);
+        REQUIRE(wcet.criticalPath[1].executions == 9);
+        REQUIRE(wcet.criticalPath[1].cycles == 16);
+        REQUIRE(wcet.criticalPath[2].executions == 1);
+        REQUIRE(wcet.criticalPath[2].cycles == 12);
+    }
+
+    SECTION("Nested loops multiply") {
+        const WcetResult wcet = analyze("LD C, 3\nLOOPBOUND 3\nOUTER:\nLD B, 4\nLOOPBOUND 4\nINNER:\nDEC B\nJR NZ, INNER\n"
+                                        "DEC C\nJR NZ, OUTER\nRET\n");
+        const size_t inner = 3 * (4 + 12) + (4 + 8);
+        REQUIRE(wcet.cycles == 8 + 2 * (8 + inner + 4 + 12) + (8 + inner + 4 + 8) + 16);
+    }
+
+    SECTION("Called routines add their worst-case execution time") {
+        const WcetResult wcet = analyze("CALL SUB\nRET\nSUB:\nNOP\nRET\n");
+        REQUIRE(wcet.cycles == 24 + 16 + 4 + 16);
+        REQUIRE(wcet.criticalPath.front().callee == std::optional<word>{0x0004});
+    }
+
+    SECTION("Unbounded loops, recursion and indirect jumps are rejected") {
+        REQUIRE_THROWS_WITH(analyze("LOOP:\nDEC B\nJR NZ, LOOP\nRET\n"), Catch::Contains("has no bound"));
+        REQUIRE_THROWS_WITH(analyze("START:\nCALL START\nRET\n"), Catch::Contains("recursively"));
+        REQUIRE_THROWS_WITH(analyze("JP HL\n"), Catch::Contains("Indirect jump"));
+        REQUIRE_THROWS_WITH(analyze("LOOPBOUND 0\nNOP\n"), Catch::Contains("at least once"));
+    }
+
+    SECTION("Routines whose analysis failed can be analysed again") {
+        const std::string code = "CALL SUB\nRET\nSUB:\nLOOP:\nDEC B\nJR NZ, LOOP\nRET\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring memory = parser.assemble();
+        LoopBounds loopBounds{};
+        WcetAnalyzer analyzer(memory, loopBounds);
+        REQUIRE_THROWS_WITH(analyzer.analyze(0x0000), Catch::Contains("has no bound"));
+        REQUIRE_THROWS_WITH(analyzer.analyze(0x0000), Catch::Contains("has no bound"));
+
+        loopBounds[0x0004] = 2;
+        REQUIRE(analyzer.analyze(0x0000).cycles == 24 + 16 + (4 + 12) + (4 + 8) + 16);
+    }
+}
@@ -39,6 +39,12 @@ TEST_CASE("get_length function returns correct length for some instructions", "[
         const InstructionPtr ld_address_1234_sp = std::make_unique<LoadSPIntoAddressImmediate>(0x1234);
         REQUIRE( get_length(ld_address_1234_sp) == 3 );
     }
+    SECTION("The compile-time LENGTH matches the length of the encoded instruction") {
+        REQUIRE( Nop::LENGTH == Nop().length() );
+        REQUIRE( RotateLeft8BitRegister::LENGTH == RotateLeft8BitRegister(Register8Bit::H).length() );
+        REQUIRE( LoadImmediateInto16BitRegister::LENGTH == LoadImmediateInto16BitRegister(Register16Bit::DE, 0x1234).length() );
+        REQUIRE( AddHLAnd16BitRegister::LENGTH == AddHLAnd16BitRegister(Register16Bit::BC).length() );
+    }
 }
 
 TEST_CASE("throw_exception_and_highlight throws a logic_error", "[throw_exception_and_highlight]") {
@@ -210,4 +216,20 @@ TEST_CASE("Test whether a token can be converted to a 16-bit register", "[is_reg
         REQUIRE( is_register_16_bit(Token3) == false );
         REQUIRE( is_register_16_bit(Token4) == false );
     }
-}
\ No newline at end of file
+}
+TEST_CASE("The line index slices single lines out of the source code", "[LineIndex]") {
+    const std::string code = "NOP\nLD A, B\n\nHALT\n";
+    const LineIndex lineIndex(code);
+
+    REQUIRE(lineIndex.number_of_lines() == 4);
+    REQUIRE(lineIndex.line(code, 1) == "NOP");
+    REQUIRE(lineIndex.line(code, 2) == "LD A, B");
+    REQUIRE(lineIndex.line(code, 3) == "");
+    REQUIRE(lineIndex.line(code, 4) == "HALT");
+    REQUIRE(lineIndex.line(code, 0) == "");
+    REQUIRE(lineIndex.line(code, 9) == "");
+
+    REQUIRE(to_string_single_line(code, lineIndex, 2) == to_string_single_line(code, 2));
+    REQUIRE(LineIndex("NOP").number_of_lines() == 1);
+    REQUIRE(LineIndex("").number_of_lines() == 0);
+}
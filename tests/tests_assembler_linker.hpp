@@ -0,0 +1,246 @@
+#include "../src/assembler/assemble.h"
+#include "../src/assembler/linker.h"
+
+#include <numeric>
+
+TEST_CASE("ORG sets the address of the following code", "[Parser::assemble]") {
+    const std::string code = "ORG 0x0150\nLOOP:\nJP LOOP\n";
+    Parser parser(code, Tokenizer(code).tokenize());
+    REQUIRE(parser.assemble() == Bytestring{0xC3, 0x50, 0x01});
+}
+
+TEST_CASE("Separately assembled files are linked into a ROM image", "[Linker]") {
+    SECTION("Pinned and floating sections refer to each other") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"Entry\", ROM0\n"
+                                   "ORG 0x0100\n"
+                                   "    NOP\n"
+                                   "    JP START\n", "entry.asm"));
+        linker.add(assemble_object("SECTION \"Code\", ROMX, 2\n"
+                                   "START:\n"
+                                   "    LD A, HIGH(START)\n"
+                                   "    JR START\n"
+                                   "    DW TABLE + 1\n"
+                                   "SECTION \"Table\", ROM0\n"
+                                   "TABLE:\n"
+                                   "    DB 0x12, 0x34\n", "code.asm"));
+        const RomImage romImage = linker.link(0x00);
+
+        REQUIRE(romImage.number_of_banks() == 3);
+        REQUIRE(linker.get_symbol_value("START") == 0x4000);
+        REQUIRE(linker.get_symbol_value("TABLE") == 0x0000); // the smaller free block of bank 0
+        const Bytestring &bytes = romImage.bytes();
+        REQUIRE(Bytestring(bytes.begin() + 0x0100, bytes.begin() + 0x0104) == Bytestring{0x00, 0xC3, 0x00, 0x40});
+        REQUIRE(Bytestring(bytes.begin() + 0x8000, bytes.begin() + 0x8006) == Bytestring{0x3E, 0x40, 0x18, 0xFC, 0x01, 0x00});
+        REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 2) == Bytestring{0x12, 0x34});
+    }
+
+    SECTION("Floating sections are placed into the smallest free block") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"Low\", ROM0\nORG 0x0000\nDS 4, 0xAA\n"
+                                   "SECTION \"High\", ROM0\nORG 0x0008\nDS 4, 0xBB\n", "pinned.asm"));
+        linker.add(assemble_object("SECTION \"Small\", ROM0\nSMALL:\nDS 4, 0xCC\n"
+                                   "SECTION \"Large\", ROM0\nLARGE:\nDS 8, 0xDD\n", "floating.asm"));
+        const RomImage romImage = linker.link();
+
+        REQUIRE(linker.get_symbol_value("SMALL") == 0x0004);
+        REQUIRE(linker.get_symbol_value("LARGE") == 0x000C);
+        REQUIRE(romImage.bytes()[0x0007] == 0xCC);
+        REQUIRE(romImage.bytes()[0x0013] == 0xDD);
+    }
+
+    SECTION("Link errors are reported at once") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"A\", ROM0\nORG 0x0000\nTWICE:\nDS 0x10\nJP MISSING\n", "a.asm"));
+        linker.add(assemble_object("SECTION \"B\", ROM0\nORG 0x0008\nTWICE:\nNOP\n", "b.asm"));
+        REQUIRE_THROWS_WITH(linker.link(), Catch::Contains("Section \"B\" of \"b.asm\" (1 bytes) does not fit into bank 0 at address 0x0008")
+                                           && Catch::Contains("Symbol TWICE is defined in \"a.asm\" and in \"b.asm\"")
+                                           && Catch::Contains("2 errors found"));
+
+        Linker unresolvedLinker{};
+        unresolvedLinker.add(assemble_object("SECTION \"A\", ROMX\nJP MISSING\n", "a.asm"));
+        REQUIRE_THROWS_WITH(unresolvedLinker.link(), Catch::Contains("a.asm:2:4: Link error: Symbol MISSING is not defined in any object file"));
+    }
+
+    SECTION("ORG must precede the code of its section in object files") {
+        REQUIRE_THROWS_WITH(assemble_object("SECTION \"A\", ROMX\nNOP\nORG 0x4000\n"), Catch::Contains("ORG must precede the code of its section"));
+        REQUIRE_THROWS_WITH(assemble_object("SECTION \"A\", ROM0\nORG 0x4000\n"), Catch::Contains("is not in bank 0"));
+    }
+}
+
+TEST_CASE("Floating sections are packed into the banks best-fit decreasing", "[Linker]") {
+    SECTION("Larger sections are placed first, which needs fewer banks than placing them in order") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"A\", ROMX\nDS 0x1000\n"
+                                   "SECTION \"B\", ROMX\nDS 0x2000\n"
+                                   "SECTION \"C\", ROMX\nC:\nDS 0x3000\n"
+                                   "SECTION \"D\", ROMX\nD:\nDS 0x2000\n", "banks.asm"));
+        const RomImage romImage = linker.link();
+
+        REQUIRE(romImage.number_of_banks() == 3);
+        REQUIRE(linker.get_symbol_value("C") == 0x4000);
+        REQUIRE(linker.get_symbol_value("D") == 0x6000);
+        REQUIRE(linker.get_free_space() == std::vector<size_t>{0x4000, 0, 0});
+    }
+
+    SECTION("Aligned sections start at a multiple of their alignment") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"Header\", ROM0\nORG 0x0000\nDS 3\n"
+                                   "SECTION \"Table\", ROM0, ALIGN 8\nTABLE:\nDB 1\n"
+                                   "SECTION \"Byte\", ROM0\nBYTE:\nDB 2\n"
+                                   "SECTION \"Code\", ROMX, 2, ALIGN 14\nCODE:\nNOP\n", "aligned.asm"));
+        const RomImage romImage = linker.link();
+
+        REQUIRE(linker.get_symbol_value("TABLE") == 0x0100);
+        REQUIRE(linker.get_symbol_value("BYTE") == 0x0003); // the smallest block left in front of the table
+        REQUIRE(linker.get_symbol_value("CODE") == 0x4000);
+        REQUIRE(linker.get_free_space() == std::vector<size_t>{0x4000 - 5, 0x4000, 0x4000 - 1});
+        REQUIRE_THROWS_WITH(assemble_object("SECTION \"A\", ROM0, ALIGN 4\nORG 0x0101\n"), Catch::Contains("is not aligned to 16 bytes"));
+        REQUIRE_THROWS_WITH(assemble_object("SECTION \"A\", ROM0, ALIGN 15\n"), Catch::Contains("between 0 and 14"));
+    }
+
+    SECTION("Sections which do not fit report the largest free block") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"Full\", ROM0\nORG 0x0000\nDS 0x3000\n"
+                                   "SECTION \"Large\", ROM0\nDS 0x1001\n", "full.asm"));
+        REQUIRE_THROWS_WITH(linker.link(), Catch::Contains("Section \"Large\" of \"full.asm\" (4097 bytes) does not fit into bank 0, "
+                                                           "the largest free block has 4096 bytes"));
+    }
+
+    SECTION("Thousands of sections fill the banks almost completely") {
+        std::string code{};
+        size_t totalSize = 0;
+        for (size_t i = 0; i < 4000; ++i) {
+            const size_t size = 1 + (i * 7919) % 250;
+            code += "SECTION \"S" + std::to_string(i) + "\", ROMX\nDS " + std::to_string(size) + "\n";
+            totalSize += size;
+        }
+        Linker linker{};
+        linker.add(assemble_object(code, "many.asm"));
+        const RomImage romImage = linker.link();
+
+        const size_t minimumBanks = (totalSize + RomImage::BANK_SIZE - 1) / RomImage::BANK_SIZE;
+        REQUIRE(romImage.number_of_banks() == 1 + minimumBanks);
+        const std::vector<size_t> freeSpace = linker.get_free_space();
+        REQUIRE(std::accumulate(freeSpace.begin() + 1, freeSpace.end(), size_t{0}) == minimumBanks * RomImage::BANK_SIZE - totalSize);
+    }
+}
+
+TEST_CASE("Object files are encoded in a binary format which is used in place", "[ObjectFileView]") {
+    const ObjectFile objectFile = assemble_object("SECTION \"Code\", ROMX, 3\n"
+                                                  "START:\n"
+                                                  "    JP EXTERNAL + 2\n"
+                                                  "    DB LOW(START)\n", "code.asm");
+    const auto bytes = std::make_shared<const Bytestring>(serialize_object_file(objectFile));
+
+    SECTION("Tables, strings and section bytes survive the encoding") {
+        const ObjectFileView view(bytes);
+        REQUIRE(view.number_of_files() == 1);
+        REQUIRE(view.file(0) == "code.asm");
+        REQUIRE(view.file_hash(0) == objectFile.fileHashes[0]);
+        REQUIRE(view.number_of_sections() == 1);
+        const ObjectFileView::Section section = view.section(0);
+        REQUIRE(section.name == "Code");
+        REQUIRE(section.type == SectionType::ROMX);
+        REQUIRE(section.bank == 3u);
+        REQUIRE_FALSE(section.address.has_value());
+        REQUIRE(Bytestring(section.data, section.data + section.size) == objectFile.sections[0].data);
+        REQUIRE(view.number_of_symbols() == objectFile.symbols.size());
+        REQUIRE(view.number_of_relocations() == 2);
+        const ObjectFileView::Relocation relocation = view.relocation(0);
+        REQUIRE(relocation.offset == 1);
+        REQUIRE(relocation.kind == FixupKind::UNSIGNED_NUMBER_16_BIT);
+        REQUIRE(relocation.line == 3);
+        REQUIRE(view.symbol(view.instruction(relocation.firstInstruction).operand).name == "EXTERNAL");
+    }
+
+    SECTION("Linking from a saved and mapped object file") {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "gameboy_object_test.gbo";
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes->data()), static_cast<std::streamsize>(bytes->size()));
+
+        Linker linker{};
+        linker.add(ObjectFileView(std::make_shared<const MappedFile>(path.string())));
+        linker.add(assemble_object("EXTERNAL EQU 0x1234\n", "constants.asm"));
+        const RomImage romImage = linker.link();
+        REQUIRE(Bytestring(romImage.bytes().begin() + 0xC000, romImage.bytes().begin() + 0xC004) == Bytestring{0xC3, 0x36, 0x12, 0x00});
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Malformed object files are rejected") {
+        REQUIRE_THROWS_AS(ObjectFileView(std::make_shared<const Bytestring>(Bytestring(bytes->begin(), bytes->begin() + 40))), std::runtime_error);
+        Bytestring wrongVersion = *bytes;
+        wrongVersion[4] = 0xFF;
+        REQUIRE_THROWS_AS(ObjectFileView(std::make_shared<const Bytestring>(wrongVersion)), std::runtime_error);
+        Bytestring truncated(bytes->begin(), bytes->end() - 1);
+        REQUIRE_THROWS_AS(ObjectFileView(std::make_shared<const Bytestring>(truncated)), std::runtime_error);
+    }
+}
+
+TEST_CASE("Only changed source files are assembled again with an object cache", "[load_or_assemble_objects]") {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gameboy_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string cacheDirectory = (directory / "cache").string();
+    const std::string mainPath = (directory / "main.asm").string();
+    const std::string dataPath = (directory / "data.asm").string();
+    std::ofstream(directory / "value.asm") << "VALUE EQU 0x11\n";
+    std::ofstream(mainPath) << "SECTION \"Main\", ROM0\nORG 0x0000\nJP DATA\n";
+    std::ofstream(dataPath) << "SECTION \"Data\", ROM0\nINCLUDE \"value.asm\"\nDATA:\nDB VALUE\n";
+
+    const auto link = [&](const std::vector<ObjectFileView> &objectFiles) {
+        Linker linker{};
+        for (const ObjectFileView &objectFile : objectFiles) {
+            linker.add(objectFile);
+        }
+        return linker.link();
+    };
+
+    const std::vector<ObjectFileView> first = load_or_assemble_objects({mainPath, dataPath}, cacheDirectory, 1);
+    REQUIRE(link(first).bytes()[3] == 0x11);
+
+    // object files which are written again get a new modification time
+    std::vector<std::filesystem::path> objectPaths{std::filesystem::directory_iterator(cacheDirectory), std::filesystem::directory_iterator()};
+    REQUIRE(objectPaths.size() == 2);
+    const std::filesystem::file_time_type past = std::filesystem::last_write_time(objectPaths[0]) - std::chrono::hours(1);
+    const auto count_rewritten = [&]() {
+        return std::count_if(objectPaths.begin(), objectPaths.end(),
+                             [&](const std::filesystem::path &path) { return std::filesystem::last_write_time(path) != past; });
+    };
+    for (const std::filesystem::path &path : objectPaths) {
+        std::filesystem::last_write_time(path, past);
+    }
+
+    // unchanged files are mapped from the cache, which yields the same bytes
+    const std::vector<ObjectFileView> second = load_or_assemble_objects({mainPath, dataPath}, cacheDirectory, 1);
+    REQUIRE(link(second).bytes() == link(first).bytes());
+    REQUIRE(count_rewritten() == 0);
+
+    // a change of an included file invalidates the object file of the including file only
+    std::ofstream(directory / "value.asm") << "VALUE EQU 0x22\n";
+    REQUIRE(link(load_or_assemble_objects({mainPath, dataPath}, cacheDirectory, 1)).bytes()[3] == 0x22);
+    REQUIRE(count_rewritten() == 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Source files assembled together share their included tokens", "[assemble_objects]") {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gameboy_shared_include_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string firstPath = (directory / "first.asm").string();
+    const std::string secondPath = (directory / "second.asm").string();
+    std::ofstream(directory / "macros.asm") << "VALUE EQU 0x42\n";
+    std::ofstream(firstPath) << "SECTION \"First\", ROM0\nINCLUDE \"macros.asm\"\nLD A, VALUE\n";
+    std::ofstream(secondPath) << "SECTION \"Second\", ROM0\nINCLUDE \"macros.asm\"\nLD B, VALUE\n";
+
+    for (const size_t numberOfThreads : {1, 2}) {
+        auto tokenCache = std::make_shared<TokenCache>();
+        const std::vector<ObjectFile> objectFiles = assemble_objects({firstPath, secondPath}, numberOfThreads, tokenCache);
+        REQUIRE(objectFiles[0].sections.back().data == Bytestring{0x3E, 0x42});
+        REQUIRE(objectFiles[1].sections.back().data == Bytestring{0x06, 0x42});
+        REQUIRE(tokenCache->get_misses() == 1);
+        REQUIRE(tokenCache->get_hits() == 1);
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -216,7 +216,7 @@ TEST_CASE("'JR' commands are parsed correctly", "[Parser::parse]") {
         REQUIRE(instructionVector.size() == 4);
 
         const BaseInstruction currentInstruction = *instructionVector[3];
-        const BaseInstruction correctInstruction = JumpRelative(-0x03);
+        const BaseInstruction correctInstruction = JumpRelative(-0x05);
         REQUIRE(currentInstruction == correctInstruction);
     }
 
@@ -239,7 +239,7 @@ TEST_CASE("'JR' commands are parsed correctly", "[Parser::parse]") {
         REQUIRE(instructionVector.size() == 2);
 
         const BaseInstruction currentInstruction = *instructionVector[0];
-        const BaseInstruction correctInstruction = JumpRelative(0x02);
+        const BaseInstruction correctInstruction = JumpRelative(0x00);
         REQUIRE(currentInstruction == correctInstruction);
     }
 
@@ -269,7 +269,7 @@ TEST_CASE("'JR' commands are parsed correctly", "[Parser::parse]") {
         REQUIRE(instructionVector.size() == 3);
 
         const BaseInstruction currentInstruction = *instructionVector[2];
-        const BaseInstruction correctInstruction = JumpRelative(-0x01);
+        const BaseInstruction correctInstruction = JumpRelative(-0x03);
         REQUIRE(currentInstruction == correctInstruction);
     }
 
@@ -299,7 +299,7 @@ TEST_CASE("'JR' commands are parsed correctly", "[Parser::parse]") {
         REQUIRE(instructionVector.size() == 3);
 
         const BaseInstruction currentInstruction = *instructionVector[0];
-        const BaseInstruction correctInstruction = JumpRelative(0x03);
+        const BaseInstruction correctInstruction = JumpRelative(0x01);
         REQUIRE(currentInstruction == correctInstruction);
     }
 
@@ -362,4 +362,88 @@ TEST_CASE("'JR' commands are parsed correctly", "[Parser::parse]") {
         Parser parser("", tokenVectorMult);
         REQUIRE_THROWS(parser.parse());
     }
-}
\ No newline at end of file
+}
+TEST_CASE("'JMP' pseudo-instructions are assembled as JR or JP", "[Parser::assemble]") {
+    const auto assemble = [](const std::string &code, const bool isRelaxing = true) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        parser.set_branch_relaxation(isRelaxing);
+        const Bytestring bytes = parser.assemble();
+        return std::make_pair(bytes, parser.get_number_of_passes());
+    };
+
+    SECTION("Backward jumps are assembled directly") {
+        REQUIRE(assemble("LOOP:\nDEC A\nJMP NZ, LOOP\n").first == Bytestring{0x3D, 0x20, 0xFD});
+        const Bytestring farBytes = assemble("FAR:\nDS 200\nJMP FAR\n").first;
+        REQUIRE(Bytestring(farBytes.begin() + 200, farBytes.end()) == Bytestring{0xC3, 0x00, 0x00});
+        REQUIRE(assemble("JMP 0x0003\nNOP\n").first == Bytestring{0x18, 0x01, 0x00});
+    }
+
+    SECTION("Forward jumps are lengthened only if they are out of range") {
+        const auto [nearBytes, nearPasses] = assemble("JMP C, END\nNOP\nEND:\n");
+        REQUIRE(nearBytes == Bytestring{0x38, 0x01, 0x00});
+        REQUIRE(nearPasses == 1);
+
+        const auto [farBytes, farPasses] = assemble("JMP END\nDS 200\nEND:\n");
+        REQUIRE(Bytestring(farBytes.begin(), farBytes.begin() + 3) == Bytestring{0xC3, 0xCB, 0x00});
+        REQUIRE(farPasses == 2);
+    }
+
+    SECTION("The range of JR reaches from 126 bytes before to 129 bytes after the jump") {
+        const Bytestring backward = assemble("TARGET:\nDS 126\nJMP TARGET\n").first;
+        REQUIRE(Bytestring(backward.begin() + 126, backward.end()) == Bytestring{0x18, 0x80});
+        const Bytestring tooFarBackward = assemble("TARGET:\nDS 127\nJMP TARGET\n").first;
+        REQUIRE(Bytestring(tooFarBackward.begin() + 127, tooFarBackward.end()) == Bytestring{0xC3, 0x00, 0x00});
+
+        const auto [forward, forwardPasses] = assemble("JMP END\nDS 127\nEND:\n");
+        REQUIRE(Bytestring(forward.begin(), forward.begin() + 2) == Bytestring{0x18, 0x7F});
+        REQUIRE(forwardPasses == 1);
+        const auto [tooFarForward, tooFarPasses] = assemble("JMP END\nDS 128\nEND:\n");
+        REQUIRE(Bytestring(tooFarForward.begin(), tooFarForward.begin() + 3) == Bytestring{0xC3, 0x83, 0x00});
+        REQUIRE(tooFarPasses == 2);
+    }
+
+    SECTION("Lengthening a jump may push other jumps out of range") {
+        // X is in range until the jump to Y is lengthened
+        const auto [bytes, passes] = assemble("JMP X\nJMP Y\nDS 125\nX:\nDS 200\nY:\n");
+        REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 6) == Bytestring{0xC3, 0x83, 0x00, 0xC3, 0x4B, 0x01});
+        REQUIRE(passes == 3);
+    }
+
+    SECTION("Further passes parse the tokens passed to the constructor") {
+        const std::string code = "JMP END\nDS 200\nEND:\n";
+        Parser parser("", Tokenizer(code).tokenize());
+        const Bytestring bytes = parser.assemble();
+        REQUIRE(bytes.size() == 203);
+        REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 3) == Bytestring{0xC3, 0xCB, 0x00});
+        REQUIRE(parser.get_number_of_passes() == 2);
+    }
+
+    SECTION("Without relaxation, forward jumps are assembled as JP") {
+        const auto [bytes, passes] = assemble("JMP END\nNOP\nEND:\n", false);
+        REQUIRE(bytes == Bytestring{0xC3, 0x04, 0x00, 0x00});
+        REQUIRE(passes == 1);
+    }
+
+    SECTION("Only jumps within a section of an object file are assembled as JR") {
+        const std::string code = "SECTION \"A\", ROMX\nLOOP:\nJMP LOOP\nJMP LATER\nJMP EXTERNAL\nLATER:\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const ObjectFile objectFile = parser.assemble_object();
+        REQUIRE(objectFile.sections[0].data == Bytestring{0x18, 0xFE, 0x18, 0x00, 0xC3, 0x00, 0x00});
+        REQUIRE(objectFile.relocations.size() == 2); // the offset to LATER is patched by the linker
+        REQUIRE(objectFile.relocations[0].kind == FixupKind::RELATIVE_OFFSET);
+        REQUIRE(objectFile.relocations[1].kind == FixupKind::UNSIGNED_NUMBER_16_BIT);
+    }
+}
+
+TEST_CASE("'CALL', 'RET', 'RETI', 'RST' and conditional 'JR' commands", "[Parser::assemble]") {
+    const auto assemble = [](const std::string &code) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        return parser.assemble();
+    };
+
+    REQUIRE(assemble("CALL 0x1234\nCALL NC, 0x1234\n") == Bytestring{0xCD, 0x34, 0x12, 0xD4, 0x34, 0x12});
+    REQUIRE(assemble("CALL FUNCTION\nFUNCTION:\nRET\nRET Z\nRETI\n") == Bytestring{0xCD, 0x03, 0x00, 0xC9, 0xC8, 0xD9});
+    REQUIRE(assemble("LOOP:\nJR NZ, LOOP\nJR C, END\nEND:\n") == Bytestring{0x20, 0xFE, 0x38, 0x00});
+    REQUIRE(assemble("RST 0x00\nRST 0x08\nRST 0x38\n") == Bytestring{0xC7, 0xCF, 0xFF});
+    REQUIRE_THROWS_WITH(assemble("RST 0x09\n"), Catch::Contains("restart addresses"));
+}
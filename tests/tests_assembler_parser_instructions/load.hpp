@@ -363,6 +363,24 @@ TEST_CASE("Loading commands ('LD', 'LDI', 'LDD', 'LDH') are parsed correctly", "
         REQUIRE(currentInstruction == correctInstruction);
     }
 
+    SECTION("LD A, immediate") {
+        TokenVector tokenVector {
+                {1, 1, TokenType::IDENTIFIER, "LD"},
+                {1, 1, TokenType::IDENTIFIER, "A"},
+                {1, 1, TokenType::COMMA, ","},
+                {1, 1, TokenType::NUMBER, "0x12"},
+                {1, 1, TokenType::END_OF_FILE, "[EOF]"}
+        };
+        Parser parser("", tokenVector);
+        InstructionVector instructionVector = parser.parse();
+
+        REQUIRE(instructionVector.size() == 1);
+
+        const BaseInstruction currentInstruction = *instructionVector[0];
+        const BaseInstruction correctInstruction = LoadImmediateInto8BitRegister(Register8Bit::A, 0x12);
+        REQUIRE(currentInstruction == correctInstruction);
+    }
+
     SECTION("LD B, (immediate) does not work, since only A can be correct") {
         TokenVector tokenVector {
                 {1, 1, TokenType::IDENTIFIER, "LD"},
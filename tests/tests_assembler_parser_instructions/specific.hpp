@@ -1,4 +1,9 @@
+#include "../../src/assembler/assemble.h"
 #include "../../src/assembler/parser.h"
+#include "../../src/assembler/tokencache.h"
+
+#include <filesystem>
+#include <fstream>
 
 TEST_CASE("Numeric conversions throw when a number cannot be converted properly", "[Parser::parse]") {
     SECTION("8-bit numbers") {
@@ -183,4 +188,409 @@ TEST_CASE("Assembler specific commands are parsed correctly", "[Parser::parse]")
         const BaseInstruction firstCorrectInstruction = AddWithCarryAAndImmediate(0xBF);
         REQUIRE(firstInstruction == firstCorrectInstruction);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Forward references are patched into the emitted bytes", "[Parser::assemble]") {
+    SECTION("Global label referenced before its definition") {
+        TokenVector tokenVector {
+                {1, 1, TokenType::IDENTIFIER, "JP"},
+                {1, 1, TokenType::IDENTIFIER, "TARGET"},
+                {1, 1, TokenType::END_OF_LINE, "\\n"},
+
+                {1, 1, TokenType::IDENTIFIER, "NOP"},
+                {1, 1, TokenType::END_OF_LINE, "\\n"},
+
+                {1, 1, TokenType::GLOBAL_LABEL, "TARGET:"},
+                {1, 1, TokenType::END_OF_LINE, "\\n"},
+
+                {1, 1, TokenType::IDENTIFIER, "BIT"},
+                {1, 1, TokenType::IDENTIFIER, "index"},
+                {1, 1, TokenType::COMMA, ","},
+                {1, 1, TokenType::IDENTIFIER, "A"},
+                {1, 1, TokenType::END_OF_LINE, "\\n"},
+
+                {1, 1, TokenType::IDENTIFIER, "index"},
+                {1, 1, TokenType::IDENTIFIER, "EQU"},
+                {1, 1, TokenType::NUMBER, "3"},
+                {1, 1, TokenType::END_OF_FILE, "[EOF]"}
+        };
+        Parser parser("", tokenVector);
+        const Bytestring correctBytes {0xC3, 0x04, 0x00, 0x00, 0xCB, 0x5F};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+}
+
+TEST_CASE("Fixups resolved in parallel yield the same bytes and errors as serial resolution", "[Parser::assemble]") {
+    std::string code{};
+    for (int i = 0; i < 300; ++i) {
+        const std::string n = std::to_string(i);
+        code += "JP LABEL" + n + "\n"
+                "JR LABEL" + n + "\n"
+                "LD A, VALUE" + n + "\n"
+                "BIT INDEX" + n + ", B\n"
+                "LABEL" + n + ":\n"
+                "VALUE" + n + " EQU " + std::to_string(i % 256) + "\n"
+                "INDEX" + n + " EQU " + std::to_string(i % 8) + "\n";
+    }
+    code += "LD B, TOOLARGE\nJP MISSING\nTOOLARGE EQU 0x1234\n";
+
+    const TokenVector tokenVector = Tokenizer(code).tokenize();
+
+    Diagnostics serialDiagnostics{};
+    Parser serialParser(code, tokenVector);
+    serialParser.set_resolution_threads(1);
+    const Bytestring serialBytes = serialParser.assemble(serialDiagnostics);
+
+    Diagnostics parallelDiagnostics{};
+    Parser parallelParser(code, tokenVector);
+    parallelParser.set_resolution_threads(8, 1);
+    const Bytestring parallelBytes = parallelParser.assemble(parallelDiagnostics);
+
+    REQUIRE(parallelBytes == serialBytes);
+    REQUIRE(parallelDiagnostics.to_string() == serialDiagnostics.to_string());
+    REQUIRE(parallelDiagnostics.size() == 2);
+    REQUIRE(parallelBytes[0] == 0xC3);
+    REQUIRE(parallelBytes[1] == 0x09); // LABEL0 follows JP (3), JR (2), LD (2) and BIT (2)
+}
+
+TEST_CASE("INCLUDE inserts the tokens of another file", "[Parser::parse]") {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gameboy_include_test";
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / "constants.asm") << "VALUE EQU 0x42\n";
+    std::ofstream(directory / "code.asm") << "; shared code\nINC A\n";
+    std::ofstream(directory / "recursive.asm") << "INCLUDE \"recursive.asm\"\n";
+
+    const std::string mainPath = (directory / "main.asm").string();
+    auto tokenCache = std::make_shared<TokenCache>();
+
+    SECTION("Included symbols and code are assembled in place") {
+        const std::string code = "INCLUDE \"constants.asm\"\nLD A, VALUE\nINCLUDE \"code.asm\"\nINCLUDE \"code.asm\"";
+        Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+        parser.set_token_cache(tokenCache);
+
+        const Bytestring correctBytes {0x3E, 0x42, 0x3C, 0x3C};
+        REQUIRE(parser.assemble() == correctBytes);
+        REQUIRE(tokenCache->get_misses() == 2);
+        REQUIRE(tokenCache->get_hits() == 1);
+    }
+
+    SECTION("Unchanged files are taken from a shared cache") {
+        const std::string code = "INCLUDE \"code.asm\"\n";
+        for (int i = 0; i < 3; ++i) {
+            Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+            parser.set_token_cache(tokenCache);
+            REQUIRE(parser.assemble() == Bytestring{0x3C});
+        }
+        REQUIRE(tokenCache->get_misses() == 1);
+        REQUIRE(tokenCache->get_hits() == 2);
+    }
+
+    SECTION("Further passes reuse the included files of the first one") {
+        std::ofstream(directory / "table.asm") << "TABLE:\nDS 200\n";
+        const std::string code = "JMP END\nINCLUDE \"table.asm\"\nEND:\n";
+        Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+        parser.set_token_cache(tokenCache);
+        const Bytestring bytes = parser.assemble();
+        REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 3) == Bytestring{0xC3, 0xCB, 0x00});
+        REQUIRE(parser.get_number_of_passes() == 2);
+        REQUIRE(tokenCache->get_misses() == 1);
+    }
+
+    SECTION("Recursive and missing includes are reported") {
+        const std::string code = "INCLUDE \"recursive.asm\"\nINCLUDE \"missing.asm\"\n";
+        Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("included recursively") && Catch::Contains("Cannot open"));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("INCBIN copies bytes of a binary file into the output", "[Parser::assemble]") {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gameboy_incbin_test";
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / "data.bin", std::ios::binary) << std::string("\x10\x11\x12\x13\x14\x15", 6);
+    const std::string mainPath = (directory / "main.asm").string();
+
+    SECTION("Whole file, offset and length") {
+        const std::string code = "INCBIN \"data.bin\"\n"
+                                 "INCBIN \"data.bin\", 4\n"
+                                 "INCBIN \"data.bin\", 1, 2\n"
+                                 "LABEL:\n"
+                                 "JP LABEL\n";
+        Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+        const Bytestring correctBytes {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x14, 0x15, 0x11, 0x12, 0xC3, 0x0A, 0x00};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Ranges outside of the file are reported") {
+        const std::string code = "INCBIN \"data.bin\", 7\nINCBIN \"data.bin\", 2, 5\nINCBIN \"nothing.bin\"\n";
+        Parser parser(code, Tokenizer(code).tokenize(), mainPath);
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("3 errors found"));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("Data directives DB, DW and DS", "[Parser::assemble]") {
+    SECTION("Literals, strings, symbols and forward references") {
+        const std::string code = "CONSTANT EQU 0x42\n"
+                                 "DB 1, CONSTANT, \"Hi\", TABLE\n"
+                                 "DW 0x1234, TABLE\n"
+                                 "DS 3\n"
+                                 "DS 2, 0xAA\n"
+                                 "TABLE:\n"
+                                 "NOP\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x01, 0x42, 'H', 'i', 0x0E, 0x34, 0x12, 0x0E, 0x00, 0x00, 0x00, 0x00, 0xAA, 0xAA, 0x00};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Values out of range and unknown counts are reported") {
+        const std::string code = "DB 0x100\nDW 0x10000\nDS LATER\nDB LATER\nLATER:\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("3 errors found"));
+    }
+}
+
+TEST_CASE("Constant expressions in EQU commands and operands", "[Parser::assemble]") {
+    SECTION("Constant expressions are folded") {
+        const std::string code = "BASE EQU 2\n"
+                                 "NEXT EQU BASE*3+1\n"
+                                 "FLAGS EQU (NEXT << 2) | 1\n"
+                                 "LD A, FLAGS - 1\n"
+                                 "LD DE, HIGH(0x1234) * 0x100 + LOW(NEXT)\n"
+                                 "LD B, ~0 & 0x0F\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x3E, 0x1C, 0x11, 0x07, 0x12, 0x06, 0x0F};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Expressions depending on later symbols are deferred") {
+        const std::string code = "LD A, LATER + 1\n"
+                                 "DW TABLE * 2\n"
+                                 "LATER EQU OFFSET - 2\n"
+                                 "OFFSET EQU 0x10\n"
+                                 "TABLE:\n"
+                                 "NOP\n"
+                                 "JR TABLE+1\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x3E, 0x0F, 0x08, 0x00, 0x00, 0x18, 0xFE};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Parenthesized expressions are memory operands where the instruction has a memory variant") {
+        const std::string code = "X EQU 0xC000\n"
+                                 "LD A, (2+3)\n"
+                                 "LD A, 2+3\n"
+                                 "LD A, (1+2)*2\n"
+                                 "LD A, (X+1)\n"
+                                 "LD A, (LATER+1)\n"
+                                 "LD (X+1), A\n"
+                                 "LDH (0x10+2), A\n"
+                                 "DB (1+2)\n"
+                                 "LATER EQU 0xD000\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0xFA, 0x05, 0x00, 0x3E, 0x05, 0x3E, 0x06, 0xFA, 0x01, 0xC0, 0xFA, 0x01, 0xD0,
+                                       0xEA, 0x01, 0xC0, 0xE0, 0x12, 0x03};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Erroneous expressions are reported") {
+        const std::string code = "LD A, 1/0\n"
+                                 "X EQU Y+1\n"
+                                 "Y EQU X\n"
+                                 "LD A, (1+2\n"
+                                 "LD A, 2 * * 3\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("Division by zero") && Catch::Contains("recursively")
+                                               && Catch::Contains("4 errors found"));
+    }
+}
+
+TEST_CASE("Macros are expanded with their arguments", "[Parser::assemble]") {
+    const std::string definitions = "ADDTWICE MACRO\n"
+                                    "    ADD A, \\1\n"
+                                    "    ADD A, \\1\n"
+                                    "ENDM\n"
+                                    "STORE MACRO\n"
+                                    "    LD \\1, \\2\n"
+                                    "    ADDTWICE \\2\n"
+                                    "ENDM\n";
+
+    SECTION("Nested and repeated invocations") {
+        const std::string code = definitions +
+                                 "ADDTWICE 1\n"
+                                 "STORE B, 5\n"
+                                 "ADDTWICE 1\n"
+                                 "STORE B, 2+3";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0xC6, 0x01, 0xC6, 0x01,
+                                       0x06, 0x05, 0xC6, 0x05, 0xC6, 0x05,
+                                       0xC6, 0x01, 0xC6, 0x01,
+                                       0x06, 0x05, 0xC6, 0x05, 0xC6, 0x05};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Missing arguments, missing ENDM and recursion are reported") {
+        const std::string code = definitions +
+                                 "STORE B\n"
+                                 "FOREVER MACRO\n"
+                                 "    FOREVER\n"
+                                 "ENDM\n"
+                                 "FOREVER\n"
+                                 "UNTERMINATED MACRO\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("only 1 arguments are given") && Catch::Contains("probably recursive")
+                                               && Catch::Contains("not terminated by ENDM") && Catch::Contains("3 errors found"));
+    }
+}
+
+TEST_CASE("Conditional assembly with IF, ELSE and ENDC", "[Parser::assemble]") {
+    SECTION("Only the taken branches are assembled") {
+        const std::string code = "DEBUG EQU 0\n"
+                                 "LEVEL EQU 2\n"
+                                 "IF DEBUG\n"
+                                 "    LD A, ? ; never tokenized\n"
+                                 "    NOP\n"
+                                 "ELSE\n"
+                                 "    LD A, 1\n"
+                                 "    IF LEVEL - 2\n"
+                                 "        LD B, 1\n"
+                                 "    ELSE\n"
+                                 "        LD B, 2\n"
+                                 "    ENDC\n"
+                                 "ENDC\n"
+                                 "IF LEVEL\n"
+                                 "    LD C, 3\n"
+                                 "ENDC";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x3E, 0x01, 0x06, 0x02, 0x0E, 0x03};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Conditions inside of macros use the macro's arguments") {
+        const std::string code = "LOADIF MACRO\n"
+                                 "    IF \\1\n"
+                                 "        LD A, \\2\n"
+                                 "    ELSE\n"
+                                 "        XOR A\n"
+                                 "    ENDC\n"
+                                 "ENDM\n"
+                                 "LOADIF 1, 5\n"
+                                 "LOADIF 0, 5\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x3E, 0x05, 0xAF};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Unmatched directives are reported") {
+        const std::string code = "ELSE\nENDC\nIF 1\nNOP\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("ELSE without matching IF") && Catch::Contains("ENDC without matching IF")
+                                               && Catch::Contains("not terminated by ENDC") && Catch::Contains("3 errors found"));
+    }
+}
+
+TEST_CASE("Blocks are repeated by REPT", "[Parser::assemble]") {
+    SECTION("Repetitions with and without counter") {
+        const std::string code = "REPT 3\n"
+                                 "    INC A\n"
+                                 "ENDR\n"
+                                 "REPT 2, ROW\n"
+                                 "    REPT 2, COLUMN\n"
+                                 "        DB ROW * 0x10 + COLUMN\n"
+                                 "    ENDR\n"
+                                 "ENDR\n"
+                                 "REPT 0\n"
+                                 "    NOP\n"
+                                 "ENDR";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const Bytestring correctBytes {0x3C, 0x3C, 0x3C, 0x00, 0x01, 0x10, 0x11};
+        REQUIRE(parser.assemble() == correctBytes);
+    }
+
+    SECTION("Unknown counts and unmatched directives are reported") {
+        const std::string code = "REPT LATER\nNOP\nENDR\nENDR\nLATER EQU 2\nREPT 2\nNOP\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("defined before") && Catch::Contains("ENDR without matching REPT")
+                                               && Catch::Contains("not terminated by ENDR") && Catch::Contains("3 errors found"));
+    }
+
+    SECTION("Labels in a repeated block are reported as redefined") {
+        const std::string code = "TOP:\nREPT 2\n.LOOP\nDEC B\nJR NZ, .LOOP\nENDR\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("Label \".LOOP\" is already defined at 3:1"));
+    }
+
+    SECTION("Labels defined twice are reported") {
+        const std::string code = "X:\nNOP\nX:\nJP X\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        REQUIRE_THROWS_WITH(parser.assemble(), Catch::Contains("Label \"X\" is already defined") && Catch::Contains("referring to"));
+    }
+}
+
+TEST_CASE("The peephole optimization rewrites instructions where the flags permit", "[Parser::assemble]") {
+    const auto assemble = [](const std::string &code) {
+        Parser parser(code, Tokenizer(code).tokenize());
+        parser.set_peephole_optimization(true);
+        const Bytestring bytes = parser.assemble();
+        return std::make_tuple(bytes, parser.get_peephole_statistics(), parser.get_number_of_passes());
+    };
+
+    SECTION("Loading zero becomes XOR A only if the flags are overwritten before being read") {
+        const auto [bytes, statistics, passes] = assemble("LD A, 0\nADD A, B\n");
+        REQUIRE(bytes == Bytestring{0xAF, 0x80});
+        REQUIRE(passes == 2);
+        REQUIRE(statistics[0].applications == 1);
+        REQUIRE(statistics[0].bytesSaved == 1);
+        REQUIRE(statistics[0].cyclesSaved == 4);
+
+        REQUIRE(std::get<0>(assemble("LD A, 0\nADC A, B\n")) == Bytestring{0x3E, 0x00, 0x88}); // ADC reads the carry
+        REQUIRE(std::get<0>(assemble("LD A, 0\nRET\n")) == Bytestring{0x3E, 0x00, 0xC9});
+        REQUIRE(std::get<0>(assemble("LD A, 1\nADD A, B\n")) == Bytestring{0x3E, 0x01, 0x80});
+        REQUIRE(std::get<2>(assemble("LD A, 1\nADD A, B\n")) == 1);
+    }
+
+    SECTION("Comparing with zero becomes OR A unless DAA may read the subtract flag") {
+        REQUIRE(std::get<0>(assemble("LOOP:\nCP 0\nJR Z, LOOP\n")) == Bytestring{0xB7, 0x28, 0xFD});
+        REQUIRE(std::get<0>(assemble("LOOP:\nCP 0\nJR Z, LOOP\nDAA\n")) == Bytestring{0xFE, 0x00, 0x28, 0xFC, 0x27});
+    }
+
+    SECTION("A call followed by a return becomes a jump, unless the return is jumped to") {
+        const auto [bytes, statistics, passes] = assemble("CALL FUNCTION\nRET\nFUNCTION:\nNOP\n");
+        REQUIRE(bytes == Bytestring{0xC3, 0x03, 0x00, 0x00});
+        REQUIRE(statistics[2].applications == 1);
+        REQUIRE(statistics[2].cyclesSaved == 24);
+
+        REQUIRE(std::get<0>(assemble("CALL FUNCTION\nEND:\nRET\nFUNCTION:\nJR END\n")) == Bytestring{0xCD, 0x04, 0x00, 0xC9, 0x18, 0xFD});
+    }
+
+    SECTION("Jumps in range become relative") {
+        const auto [bytes, statistics, passes] = assemble("LOOP:\nDEC A\nJP NZ, LOOP\nJP END\nNOP\nEND:\n");
+        REQUIRE(bytes == Bytestring{0x3D, 0x20, 0xFD, 0x18, 0x01, 0x00});
+        REQUIRE(statistics[3].applications == 1);
+        REQUIRE(statistics[4].applications == 1);
+        REQUIRE(passes == 2);
+
+        // the offset is relative to the JR following the rewrite, which reaches back 126 bytes from its start
+        const Bytestring edge = std::get<0>(assemble("TARGET:\nDS 126\nJP TARGET\n"));
+        REQUIRE(Bytestring(edge.begin() + 126, edge.end()) == Bytestring{0x18, 0x80});
+        const Bytestring beyond = std::get<0>(assemble("TARGET:\nDS 127\nJP TARGET\n"));
+        REQUIRE(Bytestring(beyond.begin() + 127, beyond.end()) == Bytestring{0xC3, 0x00, 0x00});
+    }
+
+    SECTION("A jump to a fixed address which is out of range once the code shrank stays absolute") {
+        const auto [bytes, statistics, passes] = assemble("LD A, 0\nADD A, B\nJP TARGET\nDS 124\nORG 0x84\nTARGET:\n");
+        REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 5) == Bytestring{0xAF, 0x80, 0xC3, 0x84, 0x00});
+        REQUIRE(statistics[0].applications == 1);
+        REQUIRE(statistics[3].applications == 0);
+        REQUIRE(passes == 3);
+    }
+
+    SECTION("Relocatable operands are not rewritten") {
+        const std::string code = "SECTION \"A\", ROMX\nLD A, EXTERNAL\nADD A, B\nJP EXTERNAL\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        parser.set_peephole_optimization(true);
+        REQUIRE(parser.assemble_object().sections[0].data == Bytestring{0x3E, 0x00, 0x80, 0xC3, 0x00, 0x00});
+        REQUIRE(parser.get_number_of_passes() == 1);
+    }
+}
@@ -0,0 +1,154 @@
+#include "../src/assembler/assemble.h"
+#include "../src/assembler/linker.h"
+#include "../src/assembler/romimage.h"
+#include "../src/disassembler/cartridge.h"
+
+#include <numeric>
+
+TEST_CASE("ROM images are preallocated in whole banks and keep the fill byte", "[RomImage]") {
+    SECTION("A new image holds at least two banks of fill bytes") {
+        const RomImage romImage(0, 0xAB);
+        REQUIRE(romImage.size() == 2 * RomImage::BANK_SIZE);
+        REQUIRE(romImage.bytes()[0] == 0xAB);
+        REQUIRE(romImage.bytes()[romImage.size() - 1] == 0xAB);
+    }
+
+    SECTION("Writing leaves the gaps filled") {
+        RomImage romImage;
+        romImage.write(0x0150, Bytestring{0x00, 0xC3, 0x50, 0x01});
+        REQUIRE(romImage.bytes()[0x014F] == 0xFF);
+        REQUIRE(romImage.bytes()[0x0151] == 0xC3);
+        REQUIRE(romImage.bytes()[0x0154] == 0xFF);
+    }
+
+    SECTION("Writing beyond the image grows it by whole banks") {
+        RomImage romImage;
+        romImage.write(2 * RomImage::BANK_SIZE + 1, Bytestring{0x12});
+        REQUIRE(romImage.number_of_banks() == 3);
+        REQUIRE(romImage.bytes()[2 * RomImage::BANK_SIZE] == 0xFF);
+        REQUIRE(romImage.bytes()[2 * RomImage::BANK_SIZE + 1] == 0x12);
+    }
+}
+
+TEST_CASE("The checksums are written into the header of the ROM image", "[RomImage]") {
+    RomImage romImage(RomImage::MAXIMUM_BANKS);
+    romImage.write(cartridge::TITLE_BEGIN, Bytestring{'G', 'A', 'M', 'E'});
+    romImage.write(romImage.size() - 1, Bytestring{0x00});
+    REQUIRE(romImage.has_header_region());
+    REQUIRE(romImage.update_checksums());
+
+    const Bytestring &bytes = romImage.bytes();
+    REQUIRE(bytes[cartridge::HEADER_CHECKSUM] == compute_header_checksum(bytes));
+    const size_t sum = std::accumulate(bytes.begin(), bytes.end(), size_t{0}) - bytes[cartridge::GLOBAL_CHECKSUM] - bytes[cartridge::GLOBAL_CHECKSUM + 1];
+    REQUIRE(big_endian_to_number(bytes[cartridge::GLOBAL_CHECKSUM], bytes[cartridge::GLOBAL_CHECKSUM + 1]) == static_cast<word>(sum));
+
+    SECTION("Updating again keeps the checksums") {
+        const Bytestring updated = bytes;
+        romImage.update_checksums();
+        REQUIRE(romImage.bytes() == updated);
+    }
+}
+
+TEST_CASE("The checksums are not written over assembled code", "[RomImage]") {
+    std::string code{};
+    for (size_t index = 0; index < 200; ++index) {
+        code += "LD A, 0x12\n";
+    }
+    RomImage romImage = assemble_rom(code);
+    const Bytestring assembled = romImage.bytes();
+    REQUIRE(romImage.find_code(cartridge::HEADER_CHECKSUM, cartridge::HEADER_END) == std::make_pair(size_t{0x014D}, size_t{0x0150}));
+    REQUIRE_FALSE(romImage.has_header_region());
+    REQUIRE_FALSE(romImage.update_checksums());
+    REQUIRE(romImage.bytes() == assembled);
+    REQUIRE(Bytestring(assembled.begin() + 0x014C, assembled.begin() + 0x0150) == Bytestring{0x3E, 0x12, 0x3E, 0x12});
+
+    SECTION("Code ending right before the checksums leaves the header region") {
+        RomImage shortImage = assemble_rom("ORG 0x0100\nNOP\nJP 0x0150\nORG 0x0134\nDB 0x47, 0x41, 0x4D, 0x45\nORG 0x0150\nHALT\n");
+        REQUIRE_FALSE(shortImage.find_code(cartridge::TITLE_BEGIN, cartridge::HEADER_END).has_value());
+        REQUIRE(shortImage.update_checksums());
+        REQUIRE(shortImage.bytes()[cartridge::HEADER_CHECKSUM] == compute_header_checksum(shortImage.bytes()));
+        REQUIRE(shortImage.bytes()[0x0150] == 0x76);
+    }
+}
+
+TEST_CASE("Data reserving the header is replaced by the checksums", "[RomImage]") {
+    RomImage romImage = assemble_rom("ORG 0x0100\nNOP\nJP 0x0150\nDS 48\nDB 0x47, 0x41, 0x4D, 0x45\nDS 21\nDB 0, 0, 0\n"
+                                     "ORG 0x0150\nHALT\n");
+    REQUIRE(romImage.find_code(cartridge::TITLE_BEGIN, cartridge::HEADER_END) == std::nullopt);
+    REQUIRE(romImage.has_header_region());
+    REQUIRE(romImage.update_checksums());
+
+    const Bytestring &bytes = romImage.bytes();
+    REQUIRE(bytes[cartridge::TITLE_BEGIN] == 0x47);
+    REQUIRE(bytes[cartridge::HEADER_CHECKSUM] == compute_header_checksum(bytes));
+    const size_t sum = std::accumulate(bytes.begin(), bytes.end(), size_t{0}) - bytes[cartridge::GLOBAL_CHECKSUM] - bytes[cartridge::GLOBAL_CHECKSUM + 1];
+    REQUIRE(big_endian_to_number(bytes[cartridge::GLOBAL_CHECKSUM], bytes[cartridge::GLOBAL_CHECKSUM + 1]) == static_cast<word>(sum));
+    REQUIRE(bytes[0x0150] == 0x76);
+
+    SECTION("Linked sections keep their instructions apart from their data") {
+        Linker linker{};
+        linker.add(assemble_object("SECTION \"Header\", ROM0\nORG 0x0100\nNOP\nJP 0x0150\nDS 0x4C\n"
+                                   "SECTION \"Main\", ROM0\nORG 0x0150\nHALT\n", "header.asm"));
+        RomImage linkedImage = linker.link();
+        REQUIRE(linkedImage.find_code(0x0100, 0x0160) == std::make_pair(size_t{0x0100}, size_t{0x0151}));
+        REQUIRE(linkedImage.has_header_region());
+
+        Linker coveringLinker{};
+        coveringLinker.add(assemble_object("SECTION \"Code\", ROM0\nORG 0x0148\nDS 4\nNOP\nNOP\nNOP\n", "code.asm"));
+        const RomImage coveredImage = coveringLinker.link();
+        REQUIRE(coveredImage.find_code(cartridge::HEADER_CHECKSUM, cartridge::HEADER_END) == std::make_pair(size_t{0x014D}, size_t{0x014F}));
+        REQUIRE_FALSE(coveredImage.has_header_region());
+    }
+}
+
+TEST_CASE("Assembled code is placed at the start of the ROM image", "[assemble_rom]") {
+    const RomImage romImage = assemble_rom("LOOP:\nNOP\nJP LOOP\n", 0x00);
+    REQUIRE(romImage.size() == 2 * RomImage::BANK_SIZE);
+    REQUIRE(Bytestring(romImage.bytes().begin(), romImage.bytes().begin() + 5) == Bytestring{0x00, 0xC3, 0x00, 0x00, 0x00});
+
+    // like the CPU, relative jumps count from the instruction following them
+    const RomImage relativeImage = assemble_rom("LOOP:\nJR LOOP\nJR END\nNOP\nEND:\n", 0x00);
+    REQUIRE(Bytestring(relativeImage.bytes().begin(), relativeImage.bytes().begin() + 5) == Bytestring{0x18, 0xFE, 0x18, 0x01, 0x00});
+}
+
+TEST_CASE("Code following ORG is placed at its address in the ROM image", "[assemble_rom]") {
+    const RomImage romImage = assemble_rom("ORG 0x0100\nNOP\nJP MAIN\nORG 0x0150\nMAIN:\nHALT\nJR MAIN\n", 0x00);
+    const Bytestring &bytes = romImage.bytes();
+    REQUIRE(Bytestring(bytes.begin(), bytes.begin() + 4) == Bytestring{0x00, 0x00, 0x00, 0x00});
+    REQUIRE(Bytestring(bytes.begin() + 0x0100, bytes.begin() + 0x0104) == Bytestring{0x00, 0xC3, 0x50, 0x01});
+    REQUIRE(Bytestring(bytes.begin() + 0x0150, bytes.begin() + 0x0153) == Bytestring{0x76, 0x18, 0xFD});
+
+    SECTION("Blocks may be given in any order and grow the image") {
+        const RomImage reversedImage = assemble_rom("ORG 0x4000\nHALT\nORG 0x0000\nNOP\n", 0xFF);
+        REQUIRE(reversedImage.bytes()[0x0000] == 0x00);
+        REQUIRE(reversedImage.bytes()[0x0001] == 0xFF);
+        REQUIRE(reversedImage.bytes()[0x4000] == 0x76);
+    }
+
+    SECTION("Overlapping blocks are reported") {
+        try {
+            assemble_rom("ORG 0x0100\nNOP\nNOP\nORG 0x0101\nHALT\n");
+            FAIL("no exception was thrown");
+        } catch (const std::logic_error &e) {
+            REQUIRE_THAT(std::string(e.what()), Catch::Contains("The code at 0x0101 overlaps the code at 0x0100"));
+        }
+    }
+}
+
+TEST_CASE("All errors of a source are reported in one run", "[assemble_rom]") {
+    const std::string code = "LD B, 0xFFFF\n"
+                             "NOP\n"
+                             "LD A, ?\n"
+                             "JP UNDEFINED\n"
+                             "NOP ; trailing comment";
+    try {
+        assemble_rom(code);
+        FAIL("no exception was thrown");
+    } catch (const std::logic_error &e) {
+        const std::string message = e.what();
+        REQUIRE_THAT(message, Catch::Contains("8-bit"));
+        REQUIRE_THAT(message, Catch::Contains("Unknown character '?'"));
+        REQUIRE_THAT(message, Catch::Contains("UNDEFINED"));
+        REQUIRE_THAT(message, Catch::Contains("3 errors found"));
+    }
+}
@@ -0,0 +1,109 @@
+#include "../src/assembler/tokenizer.h"
+
+/**
+ * Converts tokens into their pretty string representation, which contains type, position and string.
+ * @param tokens tokens to convert
+ * @return vector of the pretty strings of @p tokens
+ */
+std::vector<std::string> to_pretty_strings(const TokenVector &tokens) {
+    std::vector<std::string> strings{};
+    for (const Token &token : tokens) {
+        strings.push_back(to_pretty_string(token));
+    }
+    return strings;
+}
+
+void require_equal_tokens(const TokenVector &tokens, const TokenVector &correctTokens) {
+    REQUIRE(to_pretty_strings(tokens) == to_pretty_strings(correctTokens));
+}
+
+TEST_CASE("Parallel tokenization yields the same tokens as serial tokenization", "[Tokenizer::tokenize_parallel]") {
+    std::string code{};
+    for (int i = 0; i < 200; ++i) {
+        code += "LABEL" + std::to_string(i) + ":\n"
+                "    LD A, " + std::to_string(i % 100) + " ; comment\n"
+                "\n"
+                "  \n"
+                ".local JP LABEL0\n"
+                "; only a comment\n"
+                "    ADD SP+0x02\n";
+    }
+
+    SECTION("Source ending with a newline") {
+        const TokenVector serialTokens = Tokenizer(code).tokenize();
+        for (const size_t numberOfThreads : {2, 3, 8, 64}) {
+            require_equal_tokens(Tokenizer(code).tokenize_parallel(numberOfThreads, 1), serialTokens);
+        }
+    }
+
+    SECTION("Source ending with trailing blank lines") {
+        const std::string paddedCode = code + "\n\n   \n\n";
+        const TokenVector serialTokens = Tokenizer(paddedCode).tokenize();
+        for (const size_t numberOfThreads : {2, 7, 64}) {
+            require_equal_tokens(Tokenizer(paddedCode).tokenize_parallel(numberOfThreads, 1), serialTokens);
+        }
+    }
+
+    SECTION("Lexical errors are reported in source order") {
+        const std::string erroneousCode = "NOP\nLD A, ?\n" + code + "LD B, !\n";
+        Diagnostics serialDiagnostics{};
+        const TokenVector serialTokens = Tokenizer(erroneousCode).tokenize(serialDiagnostics);
+        Diagnostics parallelDiagnostics{};
+        const TokenVector parallelTokens = Tokenizer(erroneousCode).tokenize_parallel(parallelDiagnostics, 16, 1);
+
+        require_equal_tokens(parallelTokens, serialTokens);
+        REQUIRE(parallelDiagnostics.to_string() == serialDiagnostics.to_string());
+        REQUIRE(parallelDiagnostics.size() == 2);
+        REQUIRE(parallelDiagnostics.get_diagnostics()[1].span.lineNumber == 1403);
+    }
+}
+
+TEST_CASE("Operators of expressions are tokenized separately from parenthesized operands", "[Tokenizer::tokenize]") {
+    const TokenVector tokens = Tokenizer("LD A, (HL+)\nLD A, (X + 1) << -2\n").tokenize();
+    std::vector<std::pair<TokenType, std::string>> typesAndStrings{};
+    for (const Token &token : tokens) {
+        typesAndStrings.emplace_back(token.get_token_type(), token.get_string());
+    }
+
+    const std::vector<std::pair<TokenType, std::string>> correctTypesAndStrings {
+        {TokenType::IDENTIFIER, "LD"}, {TokenType::IDENTIFIER, "A"}, {TokenType::COMMA, ","}, {TokenType::IDENTIFIER, "(HL+)"},
+        {TokenType::END_OF_LINE, "\\n"},
+        {TokenType::IDENTIFIER, "LD"}, {TokenType::IDENTIFIER, "A"}, {TokenType::COMMA, ","},
+        {TokenType::OPERATOR, "("}, {TokenType::IDENTIFIER, "X"}, {TokenType::OPERATOR, "+"}, {TokenType::NUMBER, "1"},
+        {TokenType::OPERATOR, ")"}, {TokenType::OPERATOR, "<<"}, {TokenType::NUMBER, "-2"},
+        {TokenType::END_OF_FILE, "[EOF]"}
+    };
+    REQUIRE(typesAndStrings == correctTypesAndStrings);
+}
+
+TEST_CASE("Branches of conditional blocks are skipped without tokenizing", "[Tokenizer::tokenize]") {
+    const std::string block = "IF DEBUG\n"
+                              "    LD A, ? ; not tokenized\n"
+                              "    IF NESTED\n"
+                              "        NOP\n"
+                              "    ENDC\n"
+                              "ELSE\n"
+                              "    NOP\n"
+                              "ENDC\n";
+
+    SECTION("A branch becomes a single token") {
+        std::vector<TokenType> types{};
+        for (const Token &token : Tokenizer(block).tokenize()) {
+            types.push_back(token.get_token_type());
+        }
+        const std::vector<TokenType> correctTypes {
+            TokenType::IDENTIFIER, TokenType::IDENTIFIER, TokenType::END_OF_LINE, TokenType::CONDITIONAL_BLOCK,
+            TokenType::IDENTIFIER, TokenType::END_OF_LINE, TokenType::CONDITIONAL_BLOCK,
+            TokenType::IDENTIFIER, TokenType::END_OF_FILE
+        };
+        REQUIRE(types == correctTypes);
+    }
+
+    SECTION("Chunks of parallel tokenization do not start inside of blocks") {
+        std::string code{};
+        for (int i = 0; i < 100; ++i) {
+            code += "NOP\n" + block;
+        }
+        require_equal_tokens(Tokenizer(code).tokenize_parallel(16, 1), Tokenizer(code).tokenize());
+    }
+}
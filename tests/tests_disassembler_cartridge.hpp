@@ -0,0 +1,121 @@
+#include "../src/analysis/controlflow.h"
+#include "../src/disassembler/cartridge.h"
+#include "../src/disassembler/disassemble.h"
+
+#include <numeric>
+#include <sstream>
+
+namespace {
+    /**
+     * Returns a ROM of @p numberOfBanks banks filled with 0xFF, whose header declares the banks and a title,
+     * and whose entry point jumps to 0x0150.
+     */
+    Bytestring make_cartridge_rom(const size_t numberOfBanks, const byte romSizeCode) {
+        Bytestring rom(numberOfBanks * cartridge::BANK_SIZE, 0xFF);
+        const Bytestring entry{0x00, 0xC3, 0x50, 0x01};                  // NOP, JP 0x0150
+        std::copy(entry.begin(), entry.end(), rom.begin() + cartridge::ENTRY_POINT);
+        std::fill(rom.begin() + cartridge::LOGO_BEGIN, rom.begin() + cartridge::HEADER_END, 0x00);
+        const std::string title = "CHECKSUMS";
+        std::copy(title.begin(), title.end(), rom.begin() + cartridge::TITLE_BEGIN);
+        rom[cartridge::CARTRIDGE_TYPE] = 0x03;                           // MBC1+RAM+BATTERY
+        rom[cartridge::ROM_SIZE] = romSizeCode;
+        rom[cartridge::RAM_SIZE] = 0x02;                                 // 8 KiB
+        const Bytestring code{0xCD, 0x00, 0x02, 0x18, 0xFB};             // CALL 0x0200, JR back to the CALL
+        std::copy(code.begin(), code.end(), rom.begin() + cartridge::HEADER_END);
+        rom[0x0200] = 0xC9;                                              // RET
+        return rom;
+    }
+}
+
+TEST_CASE("The cartridge header is parsed", "[Cartridge]") {
+    const Bytestring rom = make_cartridge_rom(4, 0x01);
+    const Cartridge cartridge(rom);
+    const CartridgeHeader &header = cartridge.get_header();
+    REQUIRE(header.title == "CHECKSUMS");
+    REQUIRE(cartridge_type_name(header.cartridgeType) == "MBC1+RAM+BATTERY");
+    REQUIRE(cartridge.number_of_banks() == 4);
+    REQUIRE(header.ramSize == 8 * 1024);
+    REQUIRE(cartridge_type_name(0x42) == "unknown 0x42");
+
+    SECTION("Each bank is mapped at 0x4000 after bank 0") {
+        Bytestring bankedRom = rom;
+        bankedRom[2 * cartridge::BANK_SIZE] = 0x12;
+        const Cartridge bankedCartridge(bankedRom);
+        const Bytestring memory = bankedCartridge.bank_memory(2);
+        REQUIRE(memory.size() == 0x8000);
+        REQUIRE(memory[cartridge::ENTRY_POINT + 1] == 0xC3);
+        REQUIRE(memory[cartridge::SWITCHABLE_BANK_BEGIN] == 0x12);
+        REQUIRE_THROWS_AS(bankedCartridge.bank_memory(0), std::out_of_range);
+        REQUIRE_THROWS_AS(bankedCartridge.bank_memory(4), std::out_of_range);
+    }
+
+    SECTION("The entry point and the vectors holding code are entry points") {
+        Bytestring vectorRom = rom;
+        vectorRom[0x0040] = 0xD9; // RETI
+        std::fill(vectorRom.begin() + 0x0008, vectorRom.begin() + 0x0010, 0x00);
+        REQUIRE(Cartridge(vectorRom).entry_points() == std::vector<word>{0x0100, 0x0040});
+    }
+
+    SECTION("Invalid headers are rejected") {
+        REQUIRE_THROWS_AS(Cartridge(Bytestring(cartridge::HEADER_END - 1, 0x00)), std::runtime_error);
+        REQUIRE_THROWS_AS(Cartridge(make_cartridge_rom(2, 0x01)), std::runtime_error); // declares 4 banks
+        REQUIRE_THROWS_AS(Cartridge(make_cartridge_rom(2, 0x09)), std::runtime_error); // unknown size code
+    }
+}
+
+TEST_CASE("The header and global checksums are verified", "[Cartridge]") {
+    SECTION("The byte sum matches the scalar sum for every length") {
+        Bytestring bytes(100);
+        std::iota(bytes.begin(), bytes.end(), byte{150});
+        for (size_t size = 0; size <= bytes.size(); ++size) {
+            REQUIRE(sum_bytes(bytes.data(), size) == std::accumulate(bytes.begin(), bytes.begin() + size, size_t{0}));
+        }
+    }
+
+    Bytestring rom = make_cartridge_rom(2, 0x00);
+    REQUIRE(compute_header_checksum(Bytestring(cartridge::HEADER_END, 0x00)) == 0xE7); // -25
+    rom[cartridge::HEADER_CHECKSUM] = compute_header_checksum(rom);
+    const word globalChecksum = compute_global_checksum(rom);
+    rom[cartridge::GLOBAL_CHECKSUM] = static_cast<byte>(globalChecksum >> 8);
+    rom[cartridge::GLOBAL_CHECKSUM + 1] = static_cast<byte>(globalChecksum);
+    REQUIRE(compute_global_checksum(rom) == globalChecksum); // the checksum bytes are not summed
+    REQUIRE(Cartridge(rom).is_header_checksum_valid());
+    REQUIRE(Cartridge(rom).is_global_checksum_valid());
+
+    rom[0x7FFF] = 0x00;
+    REQUIRE(Cartridge(rom).is_header_checksum_valid());
+    REQUIRE_FALSE(Cartridge(rom).is_global_checksum_valid());
+    rom[cartridge::TITLE_BEGIN] = 'X';
+    REQUIRE_FALSE(Cartridge(rom).is_header_checksum_valid());
+}
+
+TEST_CASE("Cartridges are disassembled bank by bank without the header", "[Cartridge]") {
+    const Bytestring rom = make_cartridge_rom(4, 0x01);
+    std::ostringstream output;
+    disassemble_cartridge(Cartridge(rom), output);
+    const std::string listing = output.str();
+    REQUIRE_THAT(listing, Catch::Contains("0x0101 : [0xC3] JP 0x0150"));
+    REQUIRE_THAT(listing, Catch::Contains("; 0x0104 - 0x014F : cartridge header"));
+    REQUIRE_THAT(listing, Catch::Contains("; routine 0x0200\n0x0200 : [0xC9] RET"));
+    REQUIRE_THAT(listing, Catch::Contains("; bank 3\n0x4000 : "));
+    REQUIRE(listing.find("0x0104 : ") == std::string::npos);
+}
+
+TEST_CASE("Relative jumps of cartridges are traced from the address following them", "[Cartridge]") {
+    Bytestring rom = make_cartridge_rom(2, 0x00);
+    rom[cartridge::HEADER_END + 4] = 0xFE; // JR to itself at 0x0153, a spin loop
+    const Cartridge cartridge(rom);
+    const Bytestring memory = cartridge.bank_memory(1);
+
+    const ControlFlowGraph graph(memory, cartridge::HEADER_END);
+    const std::vector<ControlFlowGraph::BasicBlock> &blocks = graph.get_blocks();
+    REQUIRE(blocks.size() == 2);
+    REQUIRE(blocks[1].begin == 0x0153);
+    REQUIRE(blocks[1].successors.size() == 1);
+    REQUIRE(blocks[blocks[1].successors[0].target].begin == 0x0153);
+
+    std::ostringstream output;
+    disassemble_cartridge(cartridge, output);
+    REQUIRE_THAT(output.str(), Catch::Contains("; routine 0x0100\n") && Catch::Contains("; routine 0x0200\n"));
+    REQUIRE(output.str().find("; routine 0x0038") == std::string::npos); // the padding is never reached
+}
@@ -0,0 +1,32 @@
+#include "../src/assembler/parser.h"
+#include "../src/disassembler/disassemble.h"
+#include "../src/instructions/cycles.h"
+
+#include <sstream>
+
+TEST_CASE("Instructions report their clock cycles, which a listing sums up", "[Parser::parse_decoded]") {
+    SECTION("Cycles of instruction classes, taken and not taken for conditional branches") {
+        REQUIRE(Nop().cycles() == InstructionCycles{4, 4});
+        REQUIRE(LoadImmediateInto8BitRegister(Register8Bit::A, 0).cycles() == InstructionCycles{8, 8});
+        REQUIRE(Call(0x1234).cycles() == InstructionCycles{24, 24});
+        REQUIRE(JumpRelativeConditional(FlagCondition::NOT_ZERO, 0).cycles() == InstructionCycles{12, 8});
+        REQUIRE(ReturnConditional(FlagCondition::CARRY).cycles() == InstructionCycles{20, 8});
+        REQUIRE(instruction_cycles(0xCB46) == InstructionCycles{12, 12}); // BIT 0, (HL)
+        REQUIRE(instruction_cycles(0xCBC6) == InstructionCycles{16, 16}); // SET 0, (HL)
+        REQUIRE(to_string_cycles(InstructionCycles{16, 12}) == "16/12");
+    }
+
+    SECTION("The listing shows the cycles of each instruction and the running total") {
+        const std::string code = "ORG 0x0150\nLOOP:\nDEC B\nJR NZ, LOOP\nRET\n";
+        Parser parser(code, Tokenizer(code).tokenize());
+        const std::vector<DecodedInstruction> instructions = parser.parse_decoded();
+        REQUIRE(instructions.size() == 3);
+        REQUIRE(instructions[1].address == 0x0151);
+        REQUIRE(instructions[1].cycles == InstructionCycles{12, 8});
+
+        std::ostringstream listing{};
+        print_listing(instructions, listing);
+        REQUIRE_THAT(listing.str(), Catch::Contains("; 4 cycles, total 4\n") && Catch::Contains("; 12/8 cycles, total 16/12\n")
+                                    && Catch::Contains("RET") && Catch::Contains("; 16 cycles, total 32/28\n"));
+    }
+}
@@ -1,5 +1,13 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
 
+#include "tests_analysis_callgraph.hpp"
+#include "tests_analysis_liveness.hpp"
+#include "tests_analysis_wcet.hpp"
 #include "tests_assembler_auxiliary.hpp"
-#include "tests_assembler_parser.hpp"
\ No newline at end of file
+#include "tests_assembler_linker.hpp"
+#include "tests_assembler_parser.hpp"
+#include "tests_assembler_romimage.hpp"
+#include "tests_assembler_tokenizer.hpp"
+#include "tests_disassembler_cartridge.hpp"
+#include "tests_instructions_cycles.hpp"
\ No newline at end of file